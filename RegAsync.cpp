@@ -0,0 +1,279 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegAsync.h"
+#include "RegPath.h"
+#include <chrono>
+
+void REGQUEUEEXECUTOR::Post(std::function<void()> fTask) {
+	// Notify under the lock: the owner may destroy the executor as soon as it has run the task
+	std::lock_guard<std::mutex> lGuard(mLock);
+	dqTasks.push_back(std::move(fTask));
+	cvPosted.notify_all();
+}
+
+size_t REGQUEUEEXECUTOR::RunPending() {
+	size_t ulRun = 0;
+	for (;;) {
+		std::function<void()> fTask;
+		{
+			std::lock_guard<std::mutex> lGuard(mLock);
+			if (dqTasks.empty()) break;
+			fTask = std::move(dqTasks.front());
+			dqTasks.pop_front();
+		}
+		fTask();
+		++ulRun;
+	}
+	return ulRun;
+}
+
+BOOL REGQUEUEEXECUTOR::WaitPending(DWORD dwMilliseconds) {
+	std::unique_lock<std::mutex> lGuard(mLock);
+	return cvPosted.wait_for(lGuard, std::chrono::milliseconds(dwMilliseconds), [this] { return !dqTasks.empty(); }) ? TRUE : FALSE;
+}
+
+// Queue key of a request: root handle and folded path
+static ULONGLONG MakeQueueKey(HKEY hRoot, REGPATHID idPath) {
+	return ((ULONGLONG)(DWORD)(ULONG_PTR)hRoot << 32) | (ULONGLONG)GetRegPathTable()->GetFold(idPath);
+}
+
+REGIOPOOL::REGIOPOOL(DWORD dwThreads, size_t ulMaxPending, REGBACKEND* pBackend) :
+	pBackend(pBackend == nullptr ? GetDefaultRegBackend() : pBackend), ulMaxPending(ulMaxPending == 0 ? 1 : ulMaxPending), ulPending(0), bStop(FALSE) {
+	if (dwThreads == 0) dwThreads = 1;
+	vWorkers.reserve(dwThreads);
+	for (DWORD i = 0; i < dwThreads; ++i) vWorkers.emplace_back(&REGIOPOOL::WorkerMain, this);
+}
+
+REGIOPOOL::~REGIOPOOL() {
+	std::vector<REQUEST> vLeft;
+	std::vector<REGPATHID> vPaths;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		bStop = TRUE;
+		for (std::pair<const ULONGLONG, KEYQUEUE>& rPair : mQueues) {
+			for (REQUEST& rRequest : rPair.second.dqRequests) vLeft.push_back(std::move(rRequest));
+			vPaths.push_back(rPair.second.idPath);
+		}
+		mQueues.clear();
+		dqReady.clear();
+		ulPending = 0;
+	}
+	cvReady.notify_all();
+	for (std::thread& tWorker : vWorkers) tWorker.join();
+	// A running batch uses the path of its queue until its worker returns
+	for (REGPATHID idPath : vPaths) GetRegPathTable()->Release(idPath);
+	for (REQUEST& rRequest : vLeft) Complete(&rRequest, REG_CANCELLED);
+}
+
+HRESULT REGIOPOOL::Submit(HKEY hRoot, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, REGASYNCWORK fWork, REGASYNCDONE fDone,
+	REGEXECUTOR* pExecutor, const REGCANCELTOKEN& tCancel) {
+	if (hRoot == nullptr) return REG_INVAILD_ROOT;
+	if (!fWork || !fDone) return REG_INVAILD_POINTER;
+	REGPATHID idPath = GetRegPathTable()->Intern(lpPath == nullptr ? "" : lpPath);
+	ULONGLONG ullKey = MakeQueueKey(hRoot, idPath);
+	HRESULT hRes = REG_SUCCESS;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		if (bStop) hRes = REG_CANCELLED;
+		else if (ulPending >= ulMaxPending) hRes = REG_QUEUE_FULL;
+		else {
+			KEYQUEUE& rQueue = mQueues[ullKey];
+			// A busy key is made ready again by its worker when the batch ends
+			if (rQueue.dqRequests.empty() && !rQueue.bBusy) {
+				rQueue.hRoot = hRoot;
+				std::swap(rQueue.idPath, idPath);
+				dqReady.push_back(ullKey);
+			}
+			rQueue.dqRequests.push_back(REQUEST{ ulSam, bCreate, std::move(fWork), std::move(fDone), pExecutor, tCancel });
+			++ulPending;
+		}
+	}
+	// The queue keeps the path of its first request
+	GetRegPathTable()->Release(idPath);
+	if (hRes != REG_SUCCESS) return hRes;
+	cvReady.notify_one();
+	return REG_SUCCESS;
+}
+
+size_t REGIOPOOL::GetPendingCount() {
+	std::lock_guard<std::mutex> lGuard(mLock);
+	return ulPending;
+}
+
+void REGIOPOOL::Complete(REQUEST* pRequest, HRESULT hRes) {
+	if (pRequest->pExecutor == nullptr) {
+		pRequest->fDone(hRes);
+		return;
+	}
+	REGASYNCDONE fDone = std::move(pRequest->fDone);
+	pRequest->pExecutor->Post([fDone, hRes]() { fDone(hRes); });
+}
+
+void REGIOPOOL::WorkerMain() {
+	std::vector<REQUEST> vBatch;
+	for (;;) {
+		HKEY hRoot = nullptr;
+		REGPATHID idPath = REG_PATH_EMPTY;
+		ULONGLONG ullKey = 0;
+		{
+			std::unique_lock<std::mutex> lGuard(mLock);
+			cvReady.wait(lGuard, [this] { return bStop || !dqReady.empty(); });
+			if (bStop) return;
+			ullKey = dqReady.front();
+			dqReady.pop_front();
+			KEYQUEUE& rQueue = mQueues[ullKey];
+			hRoot = rQueue.hRoot;
+			idPath = rQueue.idPath;
+			while (!rQueue.dqRequests.empty() && vBatch.size() < REGASYNC_MAX_BATCH) {
+				// A creating request starts a batch, so the requests before it do not see the key it creates
+				if (!vBatch.empty() && rQueue.dqRequests.front().bCreate) break;
+				vBatch.push_back(std::move(rQueue.dqRequests.front()));
+				rQueue.dqRequests.pop_front();
+			}
+			ulPending -= vBatch.size();
+			// One worker per key at a time keeps the requests of a key in order
+			rQueue.bBusy = TRUE;
+		}
+		RunBatch(hRoot, idPath, &vBatch);
+		vBatch.clear();
+		{
+			std::lock_guard<std::mutex> lGuard(mLock);
+			if (bStop) return;
+			std::unordered_map<ULONGLONG, KEYQUEUE>::iterator it = mQueues.find(ullKey);
+			if (it != mQueues.end()) {
+				it->second.bBusy = FALSE;
+				if (it->second.dqRequests.empty()) {
+					GetRegPathTable()->Release(it->second.idPath);
+					mQueues.erase(it);
+				}
+				else {
+					// Requests came in while the batch ran: queue the key again behind the others
+					dqReady.push_back(ullKey);
+					cvReady.notify_one();
+				}
+			}
+		}
+	}
+}
+
+void REGIOPOOL::RunBatch(HKEY hRoot, REGPATHID idPath, std::vector<REQUEST>* pBatch) {
+	REGSAM ulSam = 0;
+	BOOL bCreate = FALSE;
+	size_t ulLive = 0;
+	for (REQUEST& rRequest : *pBatch) {
+		if (rRequest.tCancel.IsCancelled()) continue;
+		ulSam |= rRequest.ulSam;
+		bCreate |= rRequest.bCreate;
+		++ulLive;
+	}
+
+	// Open the key once with the access of every request
+	std::string cPath;
+	REGKEY rKey(pBackend);
+	HRESULT hOpen = REG_CANCELLED;
+	if (ulLive != 0) {
+		GetRegPathTable()->GetPath(idPath, &cPath);
+		hOpen = (bCreate ? rKey.Create(hRoot, cPath.c_str(), ulSam) : rKey.Open(hRoot, cPath.c_str(), ulSam));
+	}
+
+	for (REQUEST& rRequest : *pBatch) {
+		HRESULT hRes;
+		if (rRequest.tCancel.IsCancelled()) hRes = REG_CANCELLED;
+		else if (hOpen == REG_SUCCESS) hRes = rRequest.fWork(rKey);
+		else if (rRequest.ulSam != ulSam || rRequest.bCreate != bCreate) {
+			// The combined access was refused: the request may still pass with its own
+			REGKEY rOwn(pBackend);
+			hRes = (rRequest.bCreate ? rOwn.Create(hRoot, cPath.c_str(), rRequest.ulSam) : rOwn.Open(hRoot, cPath.c_str(), rRequest.ulSam));
+			if (hRes == REG_SUCCESS) hRes = rRequest.fWork(rOwn);
+		}
+		else hRes = hOpen;
+		Complete(&rRequest, hRes);
+	}
+}
+
+REGDELAYBACKEND::REGDELAYBACKEND(REGBACKEND* pInner, DWORD dwDelay) : pInner(pInner == nullptr ? GetWin32RegBackend() : pInner), dwDelay(dwDelay) {}
+
+void REGDELAYBACKEND::Wait() const {
+	if (dwDelay != 0) std::this_thread::sleep_for(std::chrono::milliseconds(dwDelay));
+}
+
+LSTATUS REGDELAYBACKEND::OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	Wait();
+	return pInner->OpenKey(hParent, lpPath, ulSam, bCreate, phOutKey);
+}
+LSTATUS REGDELAYBACKEND::CloseKey(HKEY hKey) {
+	Wait();
+	return pInner->CloseKey(hKey);
+}
+LSTATUS REGDELAYBACKEND::DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) {
+	Wait();
+	return pInner->DeleteKey(hKey, lpSubKey, ulSam);
+}
+LSTATUS REGDELAYBACKEND::SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	Wait();
+	return pInner->SetValue(hKey, lpName, dwType, lpData, dwSize);
+}
+LSTATUS REGDELAYBACKEND::QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	Wait();
+	return pInner->QueryValue(hKey, lpName, pdwType, lpData, pdwSize);
+}
+LSTATUS REGDELAYBACKEND::DeleteValue(HKEY hKey, LPCSTR lpName) {
+	Wait();
+	return pInner->DeleteValue(hKey, lpName);
+}
+LSTATUS REGDELAYBACKEND::EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) {
+	Wait();
+	return pInner->EnumKey(hKey, dwIndex, lpName, pdwNameSize);
+}
+LSTATUS REGDELAYBACKEND::EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	Wait();
+	return pInner->EnumValue(hKey, dwIndex, lpName, pdwNameSize, pdwType, lpData, pdwSize);
+}
+LSTATUS REGDELAYBACKEND::SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) {
+	Wait();
+	return pInner->SetSecurity(hKey, ulInfo, pSD);
+}
+LSTATUS REGDELAYBACKEND::QueryMultipleValues(HKEY hKey, VALENTA* pValues, DWORD dwCount, LPSTR lpBuffer, DWORD* pdwTotalSize) {
+	Wait();
+	return pInner->QueryMultipleValues(hKey, pValues, dwCount, lpBuffer, pdwTotalSize);
+}
+LSTATUS REGDELAYBACKEND::QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo) {
+	Wait();
+	return pInner->QueryInfoKey(hKey, pInfo);
+}
+LSTATUS REGDELAYBACKEND::OpenKeyW(HKEY hParent, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	Wait();
+	return pInner->OpenKeyW(hParent, lpPath, ulSam, bCreate, phOutKey);
+}
+LSTATUS REGDELAYBACKEND::SetValueW(HKEY hKey, LPCWSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	Wait();
+	return pInner->SetValueW(hKey, lpName, dwType, lpData, dwSize);
+}
+LSTATUS REGDELAYBACKEND::QueryValueW(HKEY hKey, LPCWSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	Wait();
+	return pInner->QueryValueW(hKey, lpName, pdwType, lpData, pdwSize);
+}
+LSTATUS REGDELAYBACKEND::DeleteValueW(HKEY hKey, LPCWSTR lpName) {
+	Wait();
+	return pInner->DeleteValueW(hKey, lpName);
+}
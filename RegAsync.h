@@ -0,0 +1,307 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGASYNC_H
+#define REGASYNC_H
+
+#include "RegKey.h"
+#include "RegValue.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#define REGASYNC_COROUTINE
+#include <coroutine>
+#include <exception>
+#endif
+
+#define REGASYNC_MAX_BATCH 64 // Requests of one key run by a worker before it moves on to another key
+
+// Executor completions are delivered on
+class REGEXECUTOR {
+public:
+	virtual ~REGEXECUTOR() {}
+
+	// Run fTask, now or later, on the executor's thread. Can be called from any thread.
+	virtual void Post(std::function<void()> fTask) = 0;
+};
+
+// Executor running every task at once on the posting thread (a pool worker)
+class REGINLINEEXECUTOR : public REGEXECUTOR {
+public:
+	void Post(std::function<void()> fTask) override { fTask(); }
+};
+
+// Executor queueing tasks until the owning thread runs them, for event loops
+class REGQUEUEEXECUTOR : public REGEXECUTOR {
+private:
+	std::deque<std::function<void()>> dqTasks;
+	std::mutex mLock;
+	std::condition_variable cvPosted;
+
+public:
+	void Post(std::function<void()> fTask) override;
+	// Run the queued tasks (including tasks posted while they run). Return the number of tasks run.
+	size_t RunPending();
+	// Wait up to dwMilliseconds for a task to be queued. Return TRUE if one is queued.
+	BOOL WaitPending(DWORD dwMilliseconds);
+};
+
+// Cancellation token of a request
+class REGCANCELTOKEN {
+private:
+	std::shared_ptr<std::atomic<bool>> pFlag; // Empty if the request cannot be cancelled
+
+	friend class REGCANCELSOURCE;
+
+public:
+	BOOL IsCancelled() const { return pFlag != nullptr && pFlag->load(std::memory_order_acquire); }
+};
+
+// Cancels every request holding one of its tokens. A request that has not started completes with REG_CANCELLED;
+// a request that is running completes normally.
+class REGCANCELSOURCE {
+private:
+	std::shared_ptr<std::atomic<bool>> pFlag;
+
+public:
+	REGCANCELSOURCE() : pFlag(std::make_shared<std::atomic<bool>>(false)) {}
+
+	void Cancel() { pFlag->store(true, std::memory_order_release); }
+	REGCANCELTOKEN GetToken() const {
+		REGCANCELTOKEN tToken;
+		tToken.pFlag = pFlag;
+		return tToken;
+	}
+};
+
+// Work run on a pool worker with the opened key. Its result is the result of the request.
+typedef std::function<HRESULT(const REGKEY& rKey)> REGASYNCWORK;
+// Completion of a request
+typedef std::function<void(HRESULT hRes)> REGASYNCDONE;
+
+// Blocking registry I/O pool
+// A fixed number of workers run requests. Requests for the same key (root and case-insensitive path) are queued
+// together and run in submission order by one worker at a time, which opens the key once for the whole batch.
+// A request that creates the key only leads a batch, so the requests queued before it run on the key as it was.
+// At most ulMaxPending requests can wait; further submissions fail with REG_QUEUE_FULL instead of blocking.
+class REGIOPOOL {
+private:
+	struct REQUEST {
+		REGSAM ulSam; // Access needed
+		BOOL bCreate; // Create the key if it does not exist
+		REGASYNCWORK fWork;
+		REGASYNCDONE fDone;
+		REGEXECUTOR* pExecutor; // Executor of fDone, nullptr runs it on the worker
+		REGCANCELTOKEN tCancel;
+	};
+	struct KEYQUEUE {
+		HKEY hRoot;
+		REGPATHID idPath = REG_PATH_EMPTY; // Path of the first request, a reference held by the queue
+		std::deque<REQUEST> dqRequests;
+		BOOL bBusy = FALSE; // A worker is running a batch of this key
+	};
+
+	REGBACKEND* pBackend;
+	size_t ulMaxPending;
+	std::unordered_map<ULONGLONG, KEYQUEUE> mQueues; // (root, folded path) -> requests
+	std::deque<ULONGLONG> dqReady; // Keys with requests, in the order they got them
+	size_t ulPending; // Requests queued
+	BOOL bStop;
+	std::mutex mLock;
+	std::condition_variable cvReady;
+	std::vector<std::thread> vWorkers;
+
+	void WorkerMain();
+	void RunBatch(HKEY hRoot, REGPATHID idPath, std::vector<REQUEST>* pBatch);
+	static void Complete(REQUEST* pRequest, HRESULT hRes);
+
+public:
+	// pBackend must outlive the pool, nullptr means the default backend.
+	explicit REGIOPOOL(DWORD dwThreads = 4, size_t ulMaxPending = 1024, REGBACKEND* pBackend = nullptr);
+	REGIOPOOL(const REGIOPOOL&) = delete;
+	REGIOPOOL& operator=(const REGIOPOOL&) = delete;
+	// Requests that have not started complete with REG_CANCELLED; running requests are waited for.
+	// Executors of pending completions must outlive the pool.
+	~REGIOPOOL();
+
+	// Queue fWork for the key (hRoot, lpPath), opened with ulSam (created if bCreate is TRUE).
+	// fDone receives the result of fWork, or the error of opening the key, through pExecutor.
+	// Return REG_SUCCESS if the request was queued; otherwise fDone is not called.
+	HRESULT Submit(HKEY hRoot, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, REGASYNCWORK fWork, REGASYNCDONE fDone,
+		REGEXECUTOR* pExecutor = nullptr, const REGCANCELTOKEN& tCancel = REGCANCELTOKEN());
+	// Number of queued requests
+	size_t GetPendingCount();
+	// Get the backend the requests run on
+	REGBACKEND* GetBackend() const { return pBackend; }
+};
+
+// Blocking backend stub
+// Forwards every call to another backend after a fixed delay, to test asynchronous callers against slow hives.
+class REGDELAYBACKEND : public REGBACKEND {
+private:
+	REGBACKEND* pInner; // Backend the calls are forwarded to
+	DWORD dwDelay; // Delay of every call in milliseconds
+
+	void Wait() const;
+
+public:
+	// pInner must outlive this backend. nullptr means the Windows registry backend.
+	REGDELAYBACKEND(REGBACKEND* pInner, DWORD dwDelay);
+	REGDELAYBACKEND(const REGDELAYBACKEND&) = delete;
+	REGDELAYBACKEND& operator=(const REGDELAYBACKEND&) = delete;
+
+	LSTATUS OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override;
+	LSTATUS CloseKey(HKEY hKey) override;
+	LSTATUS DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) override;
+	LSTATUS SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) override;
+	LSTATUS QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS DeleteValue(HKEY hKey, LPCSTR lpName) override;
+	LSTATUS EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) override;
+	LSTATUS EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) override;
+	LSTATUS QueryMultipleValues(HKEY hKey, VALENTA* pValues, DWORD dwCount, LPSTR lpBuffer, DWORD* pdwTotalSize) override;
+	LSTATUS QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo) override;
+	LSTATUS OpenKeyW(HKEY hParent, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override;
+	LSTATUS SetValueW(HKEY hKey, LPCWSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) override;
+	LSTATUS QueryValueW(HKEY hKey, LPCWSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS DeleteValueW(HKEY hKey, LPCWSTR lpName) override;
+};
+
+// Names of the sub keys and values of a key (EnumAsync)
+struct REGENUMRESULT {
+	std::vector<std::string> vKeys; // Sub key names
+	std::vector<std::string> vValues; // Value names
+	std::vector<DWORD> vTypes; // Type of every value
+};
+
+#ifdef REGASYNC_COROUTINE
+
+// C++20 coroutine interface
+// co_await on the result of OpenAsync / ReadAsync / WriteAsync / EnumAsync suspends the coroutine, runs the
+// operation on the pool and resumes the coroutine through pExecutor (on the worker if it is empty).
+// The result is a REGASYNCRESULT with the HRESULT of the operation. If the request cannot be queued the coroutine
+// is not suspended and gets REG_QUEUE_FULL / REG_CANCELLED at once.
+
+template <typename T> struct REGASYNCRESULT {
+	HRESULT hRes;
+	T rValue;
+};
+
+template <typename T> class REGAWAITABLE {
+private:
+	REGIOPOOL* pPool;
+	HKEY hRoot;
+	std::string cPath;
+	REGSAM ulSam;
+	BOOL bCreate;
+	std::function<HRESULT(const REGKEY& rKey, T* pOut)> fWork;
+	REGEXECUTOR* pExecutor;
+	REGCANCELTOKEN tCancel;
+	HRESULT hRes;
+	T rValue;
+
+public:
+	REGAWAITABLE(REGIOPOOL* pInPool, HKEY hInRoot, LPCSTR lpPath, REGSAM ulInSam, BOOL bInCreate,
+		std::function<HRESULT(const REGKEY& rKey, T* pOut)> fInWork, REGEXECUTOR* pInExecutor, const REGCANCELTOKEN& tInCancel) :
+		pPool(pInPool), hRoot(hInRoot), cPath(lpPath == nullptr ? "" : lpPath), ulSam(ulInSam), bCreate(bInCreate),
+		fWork(std::move(fInWork)), pExecutor(pInExecutor), tCancel(tInCancel), hRes(REG_SUCCESS), rValue() {}
+
+	bool await_ready() const noexcept { return false; }
+	bool await_suspend(std::coroutine_handle<> hCoroutine) {
+		// The awaitable lives in the coroutine frame, which may be resumed (and freed) before Submit returns
+		HRESULT hSubmit = pPool->Submit(hRoot, cPath.c_str(), ulSam, bCreate,
+			[this](const REGKEY& rKey) { return fWork(rKey, &rValue); },
+			[this, hCoroutine](HRESULT hInRes) {
+				hRes = hInRes;
+				hCoroutine.resume();
+			},
+			pExecutor, tCancel);
+		if (hSubmit == REG_SUCCESS) return true;
+		hRes = hSubmit;
+		return false;
+	}
+	REGASYNCRESULT<T> await_resume() { return REGASYNCRESULT<T>{ hRes, std::move(rValue) }; }
+};
+
+// Open a key (created if bCreate is TRUE). The key is returned opened.
+inline REGAWAITABLE<REGKEY> OpenAsync(REGIOPOOL& rPool, HKEY hRoot, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate = FALSE,
+	REGEXECUTOR* pExecutor = nullptr, const REGCANCELTOKEN& tCancel = REGCANCELTOKEN()) {
+	return REGAWAITABLE<REGKEY>(&rPool, hRoot, lpPath, ulSam, bCreate, [](const REGKEY& rKey, REGKEY* pOut) {
+		*pOut = rKey;
+		return REG_SUCCESS;
+	}, pExecutor, tCancel);
+}
+
+// Read a value of any type
+inline REGAWAITABLE<REGVALUE> ReadAsync(REGIOPOOL& rPool, HKEY hRoot, LPCSTR lpPath, LPCSTR lpName,
+	REGEXECUTOR* pExecutor = nullptr, const REGCANCELTOKEN& tCancel = REGCANCELTOKEN()) {
+	std::string cName(lpName == nullptr ? REG_DEFAULTVALUE : lpName);
+	return REGAWAITABLE<REGVALUE>(&rPool, hRoot, lpPath, KEY_READ, FALSE, [cName](const REGKEY& rKey, REGVALUE* pOut) {
+		return ReadRegValue(rKey, cName.c_str(), pOut);
+	}, pExecutor, tCancel);
+}
+
+// Write a value of any type. The key is created if it does not exist. rValue is the written value.
+inline REGAWAITABLE<REGVALUE> WriteAsync(REGIOPOOL& rPool, HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, REGVALUE rValue,
+	REGEXECUTOR* pExecutor = nullptr, const REGCANCELTOKEN& tCancel = REGCANCELTOKEN()) {
+	std::string cName(lpName == nullptr ? REG_DEFAULTVALUE : lpName);
+	return REGAWAITABLE<REGVALUE>(&rPool, hRoot, lpPath, KEY_READ | KEY_WRITE, TRUE, [cName, rValue](const REGKEY& rKey, REGVALUE* pOut) {
+		*pOut = rValue;
+		return WriteRegValue(rKey, cName.c_str(), rValue);
+	}, pExecutor, tCancel);
+}
+
+// Enumerate the sub keys and values of a key
+inline REGAWAITABLE<REGENUMRESULT> EnumAsync(REGIOPOOL& rPool, HKEY hRoot, LPCSTR lpPath,
+	REGEXECUTOR* pExecutor = nullptr, const REGCANCELTOKEN& tCancel = REGCANCELTOKEN()) {
+	return REGAWAITABLE<REGENUMRESULT>(&rPool, hRoot, lpPath, KEY_READ, FALSE, [](const REGKEY& rKey, REGENUMRESULT* pOut) {
+		HRESULT hRes = rKey.VisitKey([pOut](const REGKEY& rParent, LPCSTR lpName) {
+			pOut->vKeys.emplace_back(lpName);
+		});
+		if (hRes != REG_SUCCESS) return hRes;
+		return rKey.VisitValue([pOut](const REGKEY& rParent, const REGVALUEINFO& rInfo) {
+			pOut->vValues.emplace_back(rInfo.lpName);
+			pOut->vTypes.push_back(rInfo.dwType);
+		}, FALSE);
+	}, pExecutor, tCancel);
+}
+
+// Coroutine return type that starts at once and frees itself when it ends, for fire-and-forget coroutines
+struct REGDETACHEDTASK {
+	struct promise_type {
+		REGDETACHEDTASK get_return_object() noexcept { return REGDETACHEDTASK(); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() noexcept {}
+		void unhandled_exception() noexcept { std::terminate(); }
+	};
+};
+
+#endif
+
+#endif
@@ -0,0 +1,504 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegBaseline.h"
+#include "RegSearch.h"
+#include <array>
+#include <cstddef>
+#include <fstream>
+#include <unordered_map>
+
+#define BASELINE_MAGIC 0x4C424752 // "RGBL"
+#define BASELINE_VERSION 1
+#define BASELINE_NO_PARENT 0xFFFFFFFF
+
+struct REGBASELINEBACKEND::HEADER {
+	DWORD dwMagic; // BASELINE_MAGIC
+	DWORD dwVersion; // BASELINE_VERSION
+	DWORD dwHeaderSize; // sizeof(HEADER)
+	DWORD dwKeyCount;
+	DWORD dwChildCount;
+	DWORD dwValueCount;
+	ULONGLONG ullStrings; // Offset of the string table
+	ULONGLONG ullStringsSize;
+	ULONGLONG ullKeys; // Offset of the key records
+	ULONGLONG ullChildren; // Offset of the child index
+	ULONGLONG ullValues; // Offset of the value records
+	ULONGLONG ullData; // Offset of the value data
+	ULONGLONG ullDataSize;
+	DWORD dwStringsCrc;
+	DWORD dwKeysCrc;
+	DWORD dwChildrenCrc;
+	DWORD dwValuesCrc;
+	DWORD dwDataCrc;
+	DWORD dwHeaderCrc; // CRC-32 of the fields above
+};
+
+struct REGBASELINEBACKEND::KEYREC {
+	DWORD dwPath; // Path offset in the string table
+	DWORD dwPathLen; // Path length
+	DWORD dwNameLen; // Length of the last path component
+	DWORD dwParent; // Parent key, BASELINE_NO_PARENT for key 0
+	DWORD dwFirstChild; // First entry in the child index
+	DWORD dwChildCount;
+	DWORD dwFirstValue; // First value record
+	DWORD dwValueCount;
+};
+
+struct REGBASELINEBACKEND::VALUEREC {
+	DWORD dwName; // Name offset in the string table
+	DWORD dwNameLen; // Name length
+	DWORD dwType; // Type
+	DWORD dwSize; // Size of the data
+	ULONGLONG ullData; // Data offset in the data section
+};
+
+// CRC-32 (IEEE 802.3), dwCrc is the result for the preceding data or 0
+static DWORD Crc32(DWORD dwCrc, const void* lpData, size_t ulSize) {
+	static const std::array<DWORD, 256> aTable = [] {
+		std::array<DWORD, 256> aRes;
+		for (DWORD i = 0; i < 256; i++) {
+			DWORD c = i;
+			for (INT k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			aRes[i] = c;
+		}
+		return aRes;
+	}();
+	const BYTE* p = static_cast<const BYTE*>(lpData);
+	DWORD c = ~dwCrc;
+	for (size_t i = 0; i < ulSize; i++) c = aTable[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+	return ~c;
+}
+
+static ULONGLONG Align8(ULONGLONG ullOffset) {
+	return (ullOffset + 7) & ~7ULL;
+}
+
+// Write a section followed by zero padding up to a multiple of 8 bytes
+static BOOL WriteSection(std::ostream& osOutput, const void* lpData, size_t ulSize) {
+	static const CHAR lpZero[8] = {};
+	if (ulSize != 0) osOutput.write(static_cast<const CHAR*>(lpData), ulSize);
+	osOutput.write(lpZero, Align8(ulSize) - ulSize);
+	return osOutput.good();
+}
+
+
+HRESULT SaveBaseline(const REGSNAPSHOT& rSnap, LPCSTR lpFileName) {
+	if (lpFileName == nullptr) return REG_INVAILD_POINTER;
+	std::ofstream osOutput(lpFileName, std::ios::binary | std::ios::trunc);
+	if (!osOutput.is_open()) return REG_ACCESS_DENIED;
+	return SaveBaselineStream(rSnap, osOutput);
+}
+
+HRESULT SaveBaselineStream(const REGSNAPSHOT& rSnap, std::ostream& osOutput) {
+	typedef REGBASELINEBACKEND::HEADER HEADER;
+	typedef REGBASELINEBACKEND::KEYREC KEYREC;
+	typedef REGBASELINEBACKEND::VALUEREC VALUEREC;
+	DWORD dwKeys = rSnap.GetKeyCount();
+	// Key 0 must be the captured key
+	if (dwKeys == 0 || !rSnap.GetKeyPath(0).empty()) return REG_INVAILD_VALUE;
+
+	std::vector<CHAR> vStrings;
+	std::unordered_map<std::string_view, DWORD> mIntern; // Views into rSnap
+	auto fIntern = [&](std::string_view vStr) -> DWORD {
+		auto it = mIntern.find(vStr);
+		if (it != mIntern.end()) return it->second;
+		DWORD dwOffset = static_cast<DWORD>(vStrings.size());
+		vStrings.insert(vStrings.end(), vStr.begin(), vStr.end());
+		mIntern.emplace(vStr, dwOffset);
+		return dwOffset;
+	};
+
+	// Key records and parents
+	std::vector<KEYREC> vKeys(dwKeys);
+	std::vector<VALUEREC> vValues;
+	vValues.reserve(rSnap.GetValueCount());
+	ULONGLONG ullDataSize = 0;
+	for (DWORD i = 0; i < dwKeys; i++) {
+		std::string_view vPath = rSnap.GetKeyPath(i);
+		KEYREC& k = vKeys[i];
+		k.dwPath = fIntern(vPath);
+		k.dwPathLen = static_cast<DWORD>(vPath.size());
+		k.dwParent = BASELINE_NO_PARENT;
+		k.dwChildCount = 0;
+		if (i != 0) {
+			size_t ulPos = vPath.rfind('\\');
+			std::string_view vParent = (ulPos == std::string_view::npos ? std::string_view() : vPath.substr(0, ulPos));
+			k.dwNameLen = static_cast<DWORD>(ulPos == std::string_view::npos ? vPath.size() : vPath.size() - ulPos - 1);
+			if (!rSnap.FindKey(vParent, &k.dwParent) || k.dwParent >= i) return REG_INVAILD_VALUE;
+			vKeys[k.dwParent].dwChildCount++;
+		}
+		else k.dwNameLen = 0;
+		k.dwFirstValue = static_cast<DWORD>(vValues.size());
+		k.dwValueCount = rSnap.GetKeyValueCount(i);
+		for (DWORD j = 0; j < k.dwValueCount; j++) {
+			REGSNAPVALUE vValue = rSnap.GetValue(i, j);
+			VALUEREC v;
+			v.dwName = fIntern(vValue.vName);
+			v.dwNameLen = static_cast<DWORD>(vValue.vName.size());
+			v.dwType = vValue.dwType;
+			v.dwSize = vValue.dwSize;
+			v.ullData = ullDataSize;
+			ullDataSize += vValue.dwSize;
+			vValues.push_back(v);
+		}
+	}
+
+	// Child index: keys are in path order, so the children of every parent are appended in name order
+	std::vector<DWORD> vChildren(dwKeys - 1);
+	DWORD dwNext = 0;
+	for (KEYREC& k : vKeys) {
+		k.dwFirstChild = dwNext;
+		dwNext += k.dwChildCount;
+		k.dwChildCount = 0;
+	}
+	for (DWORD i = 1; i < dwKeys; i++) {
+		KEYREC& p = vKeys[vKeys[i].dwParent];
+		vChildren[p.dwFirstChild + p.dwChildCount++] = i;
+	}
+
+	HEADER hHeader;
+	memset(&hHeader, 0, sizeof(hHeader));
+	hHeader.dwMagic = BASELINE_MAGIC;
+	hHeader.dwVersion = BASELINE_VERSION;
+	hHeader.dwHeaderSize = sizeof(HEADER);
+	hHeader.dwKeyCount = dwKeys;
+	hHeader.dwChildCount = static_cast<DWORD>(vChildren.size());
+	hHeader.dwValueCount = static_cast<DWORD>(vValues.size());
+	hHeader.ullStrings = Align8(sizeof(HEADER));
+	hHeader.ullStringsSize = vStrings.size();
+	hHeader.ullKeys = Align8(hHeader.ullStrings + vStrings.size());
+	hHeader.ullChildren = Align8(hHeader.ullKeys + vKeys.size() * sizeof(KEYREC));
+	hHeader.ullValues = Align8(hHeader.ullChildren + vChildren.size() * sizeof(DWORD));
+	hHeader.ullData = Align8(hHeader.ullValues + vValues.size() * sizeof(VALUEREC));
+	hHeader.ullDataSize = ullDataSize;
+	hHeader.dwStringsCrc = Crc32(0, vStrings.data(), vStrings.size());
+	hHeader.dwKeysCrc = Crc32(0, vKeys.data(), vKeys.size() * sizeof(KEYREC));
+	hHeader.dwChildrenCrc = Crc32(0, vChildren.data(), vChildren.size() * sizeof(DWORD));
+	hHeader.dwValuesCrc = Crc32(0, vValues.data(), vValues.size() * sizeof(VALUEREC));
+	DWORD dwDataCrc = 0;
+	for (DWORD i = 0; i < dwKeys; i++) {
+		for (DWORD j = 0; j < rSnap.GetKeyValueCount(i); j++) {
+			REGSNAPVALUE vValue = rSnap.GetValue(i, j);
+			dwDataCrc = Crc32(dwDataCrc, vValue.lpData, vValue.dwSize);
+		}
+	}
+	hHeader.dwDataCrc = dwDataCrc;
+	hHeader.dwHeaderCrc = Crc32(0, &hHeader, offsetof(HEADER, dwHeaderCrc));
+
+	if (!WriteSection(osOutput, &hHeader, sizeof(hHeader))) return REG_UNKNOWN_ERROR;
+	if (!WriteSection(osOutput, vStrings.data(), vStrings.size())) return REG_UNKNOWN_ERROR;
+	if (!WriteSection(osOutput, vKeys.data(), vKeys.size() * sizeof(KEYREC))) return REG_UNKNOWN_ERROR;
+	if (!WriteSection(osOutput, vChildren.data(), vChildren.size() * sizeof(DWORD))) return REG_UNKNOWN_ERROR;
+	if (!WriteSection(osOutput, vValues.data(), vValues.size() * sizeof(VALUEREC))) return REG_UNKNOWN_ERROR;
+	for (DWORD i = 0; i < dwKeys; i++) {
+		for (DWORD j = 0; j < rSnap.GetKeyValueCount(i); j++) {
+			REGSNAPVALUE vValue = rSnap.GetValue(i, j);
+			if (vValue.dwSize != 0) osOutput.write(reinterpret_cast<const CHAR*>(vValue.lpData), vValue.dwSize);
+		}
+	}
+	static const CHAR lpZero[8] = {};
+	osOutput.write(lpZero, Align8(ullDataSize) - ullDataSize);
+	if (!osOutput.good()) return REG_UNKNOWN_ERROR;
+	return REG_SUCCESS;
+}
+
+
+REGBASELINEBACKEND::REGBASELINEBACKEND() : hFile(INVALID_HANDLE_VALUE), hMapping(nullptr), pView(nullptr), ulViewSize(0),
+	pHeader(nullptr), pStrings(nullptr), pKeys(nullptr), pChildren(nullptr), pValues(nullptr), pData(nullptr) {
+	return;
+}
+REGBASELINEBACKEND::~REGBASELINEBACKEND() {
+	if (Loaded()) Unload();
+}
+
+HRESULT REGBASELINEBACKEND::Load(LPCSTR lpFileName) {
+	if (lpFileName == nullptr) return REG_INVAILD_POINTER;
+	if (Loaded()) Unload();
+	hFile = CreateFileA(lpFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		DWORD dwErr = GetLastError();
+		if (dwErr == ERROR_FILE_NOT_FOUND || dwErr == ERROR_PATH_NOT_FOUND) return REG_PATH_NOT_EXIST;
+		if (dwErr == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		return REG_UNKNOWN_ERROR;
+	}
+	LARGE_INTEGER liSize;
+	if (!GetFileSizeEx(hFile, &liSize) || liSize.QuadPart < static_cast<LONGLONG>(sizeof(HEADER))) {
+		Unload();
+		return REG_INVAILD_FILE;
+	}
+	hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const BYTE* pImage = (hMapping != nullptr ? static_cast<const BYTE*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr);
+	if (pImage == nullptr) {
+		Unload();
+		return REG_UNKNOWN_ERROR;
+	}
+	HRESULT hRes = Parse(pImage, static_cast<SIZE_T>(liSize.QuadPart));
+	if (hRes != REG_SUCCESS) {
+		UnmapViewOfFile(pImage);
+		Unload();
+	}
+	return hRes;
+}
+
+HRESULT REGBASELINEBACKEND::Load(const BYTE* pImage, SIZE_T ulSize) {
+	if (pImage == nullptr) return REG_INVAILD_POINTER;
+	// The records are read in place
+	if (reinterpret_cast<ULONG_PTR>(pImage) % 8 != 0) return REG_INVAILD_POINTER;
+	if (Loaded()) Unload();
+	return Parse(pImage, ulSize);
+}
+
+HRESULT REGBASELINEBACKEND::Parse(const BYTE* pImage, SIZE_T ulSize) {
+	if (ulSize < sizeof(HEADER)) return REG_INVAILD_FILE;
+	const HEADER* p = reinterpret_cast<const HEADER*>(pImage);
+	if (p->dwMagic != BASELINE_MAGIC || p->dwVersion != BASELINE_VERSION || p->dwHeaderSize != sizeof(HEADER)) return REG_INVAILD_FILE;
+	if (Crc32(0, p, offsetof(HEADER, dwHeaderCrc)) != p->dwHeaderCrc) return REG_INVAILD_FILE;
+	if (p->dwKeyCount == 0 || p->dwChildCount != p->dwKeyCount - 1) return REG_INVAILD_FILE;
+	// Every section must be aligned and inside the image
+	auto fInside = [ulSize](ULONGLONG ullOffset, ULONGLONG ullSize) {
+		return ullOffset % 8 == 0 && ullOffset >= sizeof(HEADER) && ullOffset <= ulSize && ullSize <= ulSize - ullOffset;
+	};
+	if (!fInside(p->ullStrings, p->ullStringsSize) || !fInside(p->ullKeys, static_cast<ULONGLONG>(p->dwKeyCount) * sizeof(KEYREC)) ||
+		!fInside(p->ullChildren, static_cast<ULONGLONG>(p->dwChildCount) * sizeof(DWORD)) ||
+		!fInside(p->ullValues, static_cast<ULONGLONG>(p->dwValueCount) * sizeof(VALUEREC)) || !fInside(p->ullData, p->ullDataSize)) {
+		return REG_INVAILD_FILE;
+	}
+	pView = pImage;
+	ulViewSize = ulSize;
+	pHeader = p;
+	pStrings = reinterpret_cast<const CHAR*>(pImage + p->ullStrings);
+	pKeys = reinterpret_cast<const KEYREC*>(pImage + p->ullKeys);
+	pChildren = reinterpret_cast<const DWORD*>(pImage + p->ullChildren);
+	pValues = reinterpret_cast<const VALUEREC*>(pImage + p->ullValues);
+	pData = pImage + p->ullData;
+	return REG_SUCCESS;
+}
+
+BOOL REGBASELINEBACKEND::Loaded() const {
+	return (pView != nullptr || hFile != INVALID_HANDLE_VALUE);
+}
+
+HRESULT REGBASELINEBACKEND::Unload() {
+	if (!Loaded()) return REG_KEY_NOT_OPENED;
+	if (hMapping != nullptr) {
+		if (pView != nullptr) UnmapViewOfFile(pView);
+		CloseHandle(hMapping);
+		hMapping = nullptr;
+	}
+	if (hFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(hFile);
+		hFile = INVALID_HANDLE_VALUE;
+	}
+	pView = nullptr;
+	ulViewSize = 0;
+	pHeader = nullptr;
+	pStrings = nullptr;
+	pKeys = nullptr;
+	pChildren = nullptr;
+	pValues = nullptr;
+	pData = nullptr;
+	return REG_SUCCESS;
+}
+
+HRESULT REGBASELINEBACKEND::Verify() const {
+	if (pHeader == nullptr) return REG_KEY_NOT_OPENED;
+	if (Crc32(0, pStrings, static_cast<size_t>(pHeader->ullStringsSize)) != pHeader->dwStringsCrc) return REG_INVAILD_FILE;
+	if (Crc32(0, pKeys, pHeader->dwKeyCount * sizeof(KEYREC)) != pHeader->dwKeysCrc) return REG_INVAILD_FILE;
+	if (Crc32(0, pChildren, pHeader->dwChildCount * sizeof(DWORD)) != pHeader->dwChildrenCrc) return REG_INVAILD_FILE;
+	if (Crc32(0, pValues, pHeader->dwValueCount * sizeof(VALUEREC)) != pHeader->dwValuesCrc) return REG_INVAILD_FILE;
+	if (Crc32(0, pData, static_cast<size_t>(pHeader->ullDataSize)) != pHeader->dwDataCrc) return REG_INVAILD_FILE;
+	return REG_SUCCESS;
+}
+
+DWORD REGBASELINEBACKEND::GetKeyCount() const {
+	return (pHeader == nullptr ? 0 : pHeader->dwKeyCount);
+}
+DWORD REGBASELINEBACKEND::GetValueCount() const {
+	return (pHeader == nullptr ? 0 : pHeader->dwValueCount);
+}
+
+const REGBASELINEBACKEND::KEYREC* REGBASELINEBACKEND::GetKeyRec(HKEY hKey) const {
+	if (pKeys == nullptr) return nullptr;
+	if (hKey == HKEY_CLASSES_ROOT || hKey == HKEY_CURRENT_USER || hKey == HKEY_LOCAL_MACHINE || hKey == HKEY_USERS || hKey == HKEY_CURRENT_CONFIG) {
+		return pKeys;
+	}
+	const KEYREC* pKey = reinterpret_cast<const KEYREC*>(hKey);
+	if (pKey < pKeys || pKey >= pKeys + pHeader->dwKeyCount) return nullptr;
+	return pKey;
+}
+
+BOOL REGBASELINEBACKEND::GetString(DWORD dwOffset, DWORD dwLen, std::string_view* pOut) const {
+	if (static_cast<ULONGLONG>(dwOffset) + dwLen > pHeader->ullStringsSize) return FALSE;
+	*pOut = std::string_view(pStrings + dwOffset, dwLen);
+	return TRUE;
+}
+
+LSTATUS REGBASELINEBACKEND::GetSubKey(const KEYREC* pKey, DWORD dwIndex, const KEYREC** ppOut, std::string_view* pName) const {
+	if (dwIndex >= pKey->dwChildCount) return ERROR_NO_MORE_ITEMS;
+	ULONGLONG ullEntry = static_cast<ULONGLONG>(pKey->dwFirstChild) + dwIndex;
+	if (ullEntry >= pHeader->dwChildCount) return ERROR_REGISTRY_CORRUPT;
+	DWORD dwSon = pChildren[ullEntry];
+	if (dwSon >= pHeader->dwKeyCount) return ERROR_REGISTRY_CORRUPT;
+	const KEYREC* pSon = pKeys + dwSon;
+	if (pSon->dwNameLen > pSon->dwPathLen) return ERROR_REGISTRY_CORRUPT;
+	if (!GetString(pSon->dwPath + (pSon->dwPathLen - pSon->dwNameLen), pSon->dwNameLen, pName)) return ERROR_REGISTRY_CORRUPT;
+	*ppOut = pSon;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGBASELINEBACKEND::FindSubKey(const KEYREC* pKey, std::string_view vName, const KEYREC** ppOut) const {
+	DWORD dwLow = 0, dwHigh = pKey->dwChildCount;
+	while (dwLow < dwHigh) {
+		DWORD dwMid = (dwLow + dwHigh) / 2;
+		std::string_view vSon;
+		LSTATUS lRes = GetSubKey(pKey, dwMid, ppOut, &vSon);
+		if (lRes != ERROR_SUCCESS) return lRes;
+		INT iCmp = CompareNoCase(vSon, vName);
+		if (iCmp == 0) return ERROR_SUCCESS;
+		if (iCmp < 0) dwLow = dwMid + 1;
+		else dwHigh = dwMid;
+	}
+	return ERROR_FILE_NOT_FOUND;
+}
+
+LSTATUS REGBASELINEBACKEND::GetValue(const KEYREC* pKey, DWORD dwIndex, const VALUEREC** ppOut, std::string_view* pName) const {
+	if (dwIndex >= pKey->dwValueCount) return ERROR_NO_MORE_ITEMS;
+	ULONGLONG ullEntry = static_cast<ULONGLONG>(pKey->dwFirstValue) + dwIndex;
+	if (ullEntry >= pHeader->dwValueCount) return ERROR_REGISTRY_CORRUPT;
+	const VALUEREC* pValue = pValues + ullEntry;
+	if (!GetString(pValue->dwName, pValue->dwNameLen, pName)) return ERROR_REGISTRY_CORRUPT;
+	*ppOut = pValue;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGBASELINEBACKEND::FindValue(const KEYREC* pKey, std::string_view vName, const VALUEREC** ppOut) const {
+	DWORD dwLow = 0, dwHigh = pKey->dwValueCount;
+	while (dwLow < dwHigh) {
+		DWORD dwMid = (dwLow + dwHigh) / 2;
+		std::string_view vValue;
+		LSTATUS lRes = GetValue(pKey, dwMid, ppOut, &vValue);
+		if (lRes != ERROR_SUCCESS) return lRes;
+		INT iCmp = CompareNoCase(vValue, vName);
+		if (iCmp == 0) return ERROR_SUCCESS;
+		if (iCmp < 0) dwLow = dwMid + 1;
+		else dwHigh = dwMid;
+	}
+	return ERROR_FILE_NOT_FOUND;
+}
+
+LSTATUS REGBASELINEBACKEND::CopyValueData(const VALUEREC* pValue, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) const {
+	if (lpData != nullptr && pdwSize == nullptr) return ERROR_INVALID_PARAMETER;
+	if (pValue->ullData > pHeader->ullDataSize || pValue->dwSize > pHeader->ullDataSize - pValue->ullData) return ERROR_REGISTRY_CORRUPT;
+	if (pdwType != nullptr) *pdwType = pValue->dwType;
+	if (lpData != nullptr) {
+		if (*pdwSize < pValue->dwSize) {
+			*pdwSize = pValue->dwSize;
+			return ERROR_MORE_DATA;
+		}
+		if (pValue->dwSize != 0) memcpy(lpData, pData + pValue->ullData, pValue->dwSize);
+	}
+	if (pdwSize != nullptr) *pdwSize = pValue->dwSize;
+	return ERROR_SUCCESS;
+}
+
+// Copy a name to a caller buffer like the Enum functions do
+static LSTATUS CopyName(std::string_view vName, LPSTR lpOut, DWORD* pdwSize) {
+	if (lpOut == nullptr || pdwSize == nullptr || *pdwSize == 0) return ERROR_INVALID_PARAMETER;
+	if (vName.size() + 1 > *pdwSize) return ERROR_MORE_DATA;
+	memcpy(lpOut, vName.data(), vName.size());
+	lpOut[vName.size()] = '\0';
+	*pdwSize = static_cast<DWORD>(vName.size());
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGBASELINEBACKEND::OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	if (phOutKey == nullptr) return ERROR_INVALID_PARAMETER;
+	const KEYREC* pKey = GetKeyRec(hParent);
+	if (pKey == nullptr) return ERROR_INVALID_HANDLE;
+	if (lpPath == nullptr) lpPath = "";
+	LPCSTR p = lpPath;
+	while (*p) {
+		LPCSTR pEnd = strchr(p, '\\');
+		size_t ulLen = (pEnd == nullptr ? strlen(p) : static_cast<size_t>(pEnd - p));
+		if (ulLen != 0) {
+			LSTATUS lRes = FindSubKey(pKey, std::string_view(p, ulLen), &pKey);
+			if (lRes != ERROR_SUCCESS) return (bCreate ? ERROR_ACCESS_DENIED : lRes);
+		}
+		if (pEnd == nullptr) break;
+		p = pEnd + 1;
+	}
+	*phOutKey = reinterpret_cast<HKEY>(const_cast<KEYREC*>(pKey));
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGBASELINEBACKEND::CloseKey(HKEY hKey) {
+	if (GetKeyRec(hKey) == nullptr) return ERROR_INVALID_HANDLE;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGBASELINEBACKEND::DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) {
+	return ERROR_ACCESS_DENIED;
+}
+
+LSTATUS REGBASELINEBACKEND::SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	return ERROR_ACCESS_DENIED;
+}
+
+LSTATUS REGBASELINEBACKEND::QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	const KEYREC* pKey = GetKeyRec(hKey);
+	if (pKey == nullptr) return ERROR_INVALID_HANDLE;
+	const VALUEREC* pValue = nullptr;
+	LSTATUS lRes = FindValue(pKey, (lpName == nullptr ? std::string_view() : std::string_view(lpName)), &pValue);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	return CopyValueData(pValue, pdwType, lpData, pdwSize);
+}
+
+LSTATUS REGBASELINEBACKEND::DeleteValue(HKEY hKey, LPCSTR lpName) {
+	return ERROR_ACCESS_DENIED;
+}
+
+LSTATUS REGBASELINEBACKEND::EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) {
+	const KEYREC* pKey = GetKeyRec(hKey);
+	if (pKey == nullptr) return ERROR_INVALID_HANDLE;
+	const KEYREC* pSon = nullptr;
+	std::string_view vName;
+	LSTATUS lRes = GetSubKey(pKey, dwIndex, &pSon, &vName);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	return CopyName(vName, lpName, pdwNameSize);
+}
+
+LSTATUS REGBASELINEBACKEND::EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	const KEYREC* pKey = GetKeyRec(hKey);
+	if (pKey == nullptr) return ERROR_INVALID_HANDLE;
+	const VALUEREC* pValue = nullptr;
+	std::string_view vName;
+	LSTATUS lRes = GetValue(pKey, dwIndex, &pValue, &vName);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	lRes = CopyName(vName, lpName, pdwNameSize);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	return CopyValueData(pValue, pdwType, lpData, pdwSize);
+}
+
+LSTATUS REGBASELINEBACKEND::SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) {
+	return ERROR_ACCESS_DENIED;
+}
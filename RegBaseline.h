@@ -0,0 +1,112 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGBASELINE_H
+#define REGBASELINE_H
+
+#include "RegSnapshot.h"
+#include <ostream>
+
+// Binary baseline files
+// A baseline stores a snapshot in a versioned little-endian format:
+//   header      magic, version, section offsets and sizes, CRC-32 of every section and of the header itself
+//   strings     interned key paths and value names
+//   keys        key records sorted by path (case-insensitive); key 0 is the captured key, every record has its
+//               parent and the range of its sub keys in the child index
+//   children    key indexes grouped by parent and sorted by name
+//   values      type-tagged value records grouped by key and sorted by name, pointing into the data blob
+//   data        value data, stored contiguously
+// Every section starts at a multiple of 8 bytes.
+
+// Write a snapshot to a baseline file
+HRESULT SaveBaseline(const REGSNAPSHOT& rSnap, LPCSTR lpFileName);
+// Write a snapshot to a stream (opened in binary mode)
+HRESULT SaveBaselineStream(const REGSNAPSHOT& rSnap, std::ostream& osOutput);
+
+// Baseline backend
+// Read-only access to a baseline file. The file is mapped into memory and opening it only checks the header,
+// so only the pages touched by lookups are read. Sub keys are found by binary search in the child index and
+// values by binary search in the value records of the key, and nothing is copied except into the buffers
+// passed by the caller, so the usual REGKEY functions read from it:
+// REGKEY(&rBaseline).Open(HKEY_LOCAL_MACHINE, "Sub\\Key", KEY_READ) opens <captured key>\Sub\Key (the captured
+// key is shown as every predefined root key).
+// All write operations return ERROR_ACCESS_DENIED.
+class REGBASELINEBACKEND : public REGBACKEND {
+private:
+	struct HEADER;
+	struct KEYREC;
+	struct VALUEREC;
+
+	HANDLE hFile; // Baseline file
+	HANDLE hMapping; // File mapping
+	const BYTE* pView; // Mapped view (or the image given to Load)
+	SIZE_T ulViewSize; // Size of the view
+	const HEADER* pHeader;
+	const CHAR* pStrings; // String table
+	const KEYREC* pKeys; // Key records
+	const DWORD* pChildren; // Child index
+	const VALUEREC* pValues; // Value records
+	const BYTE* pData; // Value data
+
+	friend HRESULT SaveBaselineStream(const REGSNAPSHOT& rSnap, std::ostream& osOutput);
+
+	HRESULT Parse(const BYTE* pImage, SIZE_T ulSize);
+	const KEYREC* GetKeyRec(HKEY hKey) const;
+	BOOL GetString(DWORD dwOffset, DWORD dwLen, std::string_view* pOut) const;
+	LSTATUS GetSubKey(const KEYREC* pKey, DWORD dwIndex, const KEYREC** ppOut, std::string_view* pName) const;
+	LSTATUS FindSubKey(const KEYREC* pKey, std::string_view vName, const KEYREC** ppOut) const;
+	LSTATUS GetValue(const KEYREC* pKey, DWORD dwIndex, const VALUEREC** ppOut, std::string_view* pName) const;
+	LSTATUS FindValue(const KEYREC* pKey, std::string_view vName, const VALUEREC** ppOut) const;
+	LSTATUS CopyValueData(const VALUEREC* pValue, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) const;
+
+public:
+	REGBASELINEBACKEND();
+	REGBASELINEBACKEND(const REGBASELINEBACKEND&) = delete;
+	REGBASELINEBACKEND& operator=(const REGBASELINEBACKEND&) = delete;
+	~REGBASELINEBACKEND();
+
+	// Map a baseline file
+	HRESULT Load(LPCSTR lpFileName);
+	// Use a baseline image that is already in memory. The memory must stay valid until Unload.
+	HRESULT Load(const BYTE* pImage, SIZE_T ulSize);
+	// Whether a baseline is loaded
+	BOOL Loaded() const;
+	// Unmap the baseline. Keys opened from it must not be used any more.
+	HRESULT Unload();
+	// Check the CRC-32 of every section (reads the whole file)
+	HRESULT Verify() const;
+	// Number of keys / values in the baseline
+	DWORD GetKeyCount() const;
+	DWORD GetValueCount() const;
+
+	LSTATUS OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override;
+	LSTATUS CloseKey(HKEY hKey) override;
+	LSTATUS DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) override;
+	LSTATUS SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) override;
+	LSTATUS QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS DeleteValue(HKEY hKey, LPCSTR lpName) override;
+	LSTATUS EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) override;
+	LSTATUS EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) override;
+};
+
+#endif
@@ -0,0 +1,227 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegBatch.h"
+#include <ktmw32.h>
+
+static std::string FoldName(LPCSTR lpName) {
+	std::string cRes(lpName);
+	for (CHAR& c : cRes) {
+		if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+	}
+	return cRes;
+}
+
+static HRESULT StatusToHRESULT(LSTATUS lRes) {
+	if (lRes == ERROR_SUCCESS) return REG_SUCCESS;
+	if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+	if (lRes == ERROR_FILE_NOT_FOUND) return REG_PATH_NOT_EXIST;
+	return REG_UNKNOWN_ERROR;
+}
+
+// Path of the first key of cPath that does not exist (empty if every key exists)
+static std::string FindMissing(REGBACKEND* pBackend, HKEY hRoot, const std::string& cPath) {
+	REGKEY rProbe(pBackend);
+	if (rProbe.Open(hRoot, cPath.c_str(), KEY_READ) != REG_PATH_NOT_EXIST) return std::string();
+	size_t ulEnd = 0;
+	while (ulEnd != std::string::npos) {
+		ulEnd = cPath.find('\\', ulEnd + 1);
+		std::string cPrefix = cPath.substr(0, ulEnd);
+		if (rProbe.Open(hRoot, cPrefix.c_str(), KEY_READ) == REG_PATH_NOT_EXIST) return cPrefix;
+	}
+	return cPath;
+}
+
+REGWRITEBATCH::OP* REGWRITEBATCH::Record(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName) {
+	std::string cKeyId(reinterpret_cast<const CHAR*>(&hRoot), sizeof hRoot);
+	cKeyId += FoldName(lpPath);
+	auto itKey = mKeyIndex.find(cKeyId);
+	if (itKey == mKeyIndex.end()) {
+		itKey = mKeyIndex.emplace(cKeyId, vKeys.size()).first;
+		vKeys.emplace_back();
+		vKeys.back().hRoot = hRoot;
+		vKeys.back().cPath = lpPath;
+	}
+	KEYOPS& rKey = vKeys[itKey->second];
+	std::string cFold = FoldName(lpName);
+	auto itOp = rKey.mIndex.find(cFold);
+	if (itOp != rKey.mIndex.end()) return &rKey.vOps[itOp->second];
+	rKey.mIndex.emplace(cFold, rKey.vOps.size());
+	rKey.vOps.emplace_back();
+	rKey.vOps.back().cName = lpName;
+	return &rKey.vOps.back();
+}
+
+HRESULT REGWRITEBATCH::Put(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	if (lpPath == nullptr) return REG_INVAILD_POINTER;
+	if (lpData == nullptr && dwSize != 0) return REG_INVAILD_POINTER;
+	if (lpName == nullptr) lpName = REG_DEFAULTVALUE;
+	OP* pOp = Record(hRoot, lpPath, lpName);
+	pOp->bDelete = FALSE;
+	pOp->dwType = dwType;
+	pOp->lpData.assign(lpData, lpData + dwSize);
+	return REG_SUCCESS;
+}
+HRESULT REGWRITEBATCH::PutREGSZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, LPCSTR lpVal) {
+	if (lpVal == nullptr) return REG_INVAILD_VALUE;
+	return Put(hRoot, lpPath, lpName, REG_SZ, reinterpret_cast<const BYTE*>(lpVal), static_cast<DWORD>(strlen(lpVal) + 1));
+}
+HRESULT REGWRITEBATCH::PutREGEXPANDSZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, LPCSTR lpVal) {
+	if (lpVal == nullptr) return REG_INVAILD_VALUE;
+	return Put(hRoot, lpPath, lpName, REG_EXPAND_SZ, reinterpret_cast<const BYTE*>(lpVal), static_cast<DWORD>(strlen(lpVal) + 1));
+}
+HRESULT REGWRITEBATCH::PutREGDWORD(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, DWORD dwVal) {
+	return Put(hRoot, lpPath, lpName, REG_DWORD, reinterpret_cast<const BYTE*>(&dwVal), sizeof(DWORD));
+}
+HRESULT REGWRITEBATCH::PutREGQWORD(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, QWORD ullVal) {
+	return Put(hRoot, lpPath, lpName, REG_QWORD, reinterpret_cast<const BYTE*>(&ullVal), sizeof(QWORD));
+}
+HRESULT REGWRITEBATCH::PutREGBINARY(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, const BYTE* lpData, DWORD dwSize) {
+	return Put(hRoot, lpPath, lpName, REG_BINARY, lpData, dwSize);
+}
+
+HRESULT REGWRITEBATCH::Delete(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName) {
+	if (lpPath == nullptr) return REG_INVAILD_POINTER;
+	if (lpName == nullptr) lpName = REG_DEFAULTVALUE;
+	OP* pOp = Record(hRoot, lpPath, lpName);
+	pOp->bDelete = TRUE;
+	pOp->dwType = REG_NONE;
+	pOp->lpData.clear();
+	return REG_SUCCESS;
+}
+
+size_t REGWRITEBATCH::GetCount() const {
+	size_t ulCount = 0;
+	for (const KEYOPS& rKey : vKeys) ulCount += rKey.vOps.size();
+	return ulCount;
+}
+void REGWRITEBATCH::Clear() {
+	vKeys.clear();
+	mKeyIndex.clear();
+}
+
+HRESULT REGWRITEBATCH::Apply(REGBACKEND* pBackend, BOOL bRollback) const {
+	// Previous state of a written value
+	struct UNDO {
+		size_t ulKey; // Position in vOpened
+		const std::string* pName;
+		BOOL bExisted;
+		DWORD dwType;
+		std::vector<BYTE> lpData;
+	};
+	std::vector<UNDO> vUndo;
+	std::vector<REGKEY> vOpened;
+	std::vector<std::pair<HKEY, std::string>> vCreated; // Topmost key created for every key, in creation order
+	HRESULT hRes = REG_SUCCESS;
+
+	for (const KEYOPS& rKeyOps : vKeys) {
+		BOOL bWrite = FALSE;
+		for (const OP& rOp : rKeyOps.vOps) bWrite = bWrite || !rOp.bDelete;
+		REGKEY rKey(pBackend);
+		if (bWrite && bRollback) {
+			std::string cMissing = FindMissing(pBackend, rKeyOps.hRoot, rKeyOps.cPath);
+			if (!cMissing.empty()) vCreated.emplace_back(rKeyOps.hRoot, std::move(cMissing));
+		}
+		if (bWrite) hRes = rKey.Create(rKeyOps.hRoot, rKeyOps.cPath.c_str(), KEY_READ | KEY_WRITE);
+		else hRes = rKey.Open(rKeyOps.hRoot, rKeyOps.cPath.c_str(), KEY_READ | KEY_WRITE);
+		if (!bWrite && hRes == REG_PATH_NOT_EXIST) {
+			// Nothing to delete
+			hRes = REG_SUCCESS;
+			continue;
+		}
+		if (hRes != REG_SUCCESS) break;
+		vOpened.push_back(std::move(rKey));
+		const REGKEY& rOpened = vOpened.back();
+
+		for (const OP& rOp : rKeyOps.vOps) {
+			if (bRollback) {
+				vUndo.emplace_back();
+				UNDO& rUndo = vUndo.back();
+				rUndo.ulKey = vOpened.size() - 1;
+				rUndo.pName = &rOp.cName;
+				rUndo.bExisted = (rOpened.ReadValue(rOp.cName.c_str(), &rUndo.dwType, &rUndo.lpData) == REG_SUCCESS);
+			}
+			if (rOp.bDelete) {
+				hRes = rOpened.DeleteValue(rOp.cName.c_str());
+				if (hRes == REG_VALUE_NOT_EXIST) hRes = REG_SUCCESS;
+			}
+			else hRes = rOpened.WriteValue(rOp.cName.c_str(), rOp.dwType, rOp.lpData.data(), static_cast<DWORD>(rOp.lpData.size()));
+			if (hRes != REG_SUCCESS) break;
+		}
+		if (hRes != REG_SUCCESS) break;
+	}
+	if (hRes == REG_SUCCESS || !bRollback) return hRes;
+
+	// Restore the previous values, newest first
+	for (auto it = vUndo.rbegin(); it != vUndo.rend(); ++it) {
+		const REGKEY& rOpened = vOpened[it->ulKey];
+		if (it->bExisted) rOpened.WriteValue(it->pName->c_str(), it->dwType, it->lpData.data(), static_cast<DWORD>(it->lpData.size()));
+		else rOpened.DeleteValue(it->pName->c_str());
+	}
+	// Delete the keys the batch created, newest first
+	vOpened.clear();
+	for (auto it = vCreated.rbegin(); it != vCreated.rend(); ++it) {
+		REGKEY rCreated(pBackend);
+		if (rCreated.Open(it->first, it->second.c_str(), KEY_ALL_ACCESS) == REG_SUCCESS) rCreated.DeleteTree();
+	}
+	return hRes;
+}
+
+HRESULT REGWRITEBATCH::ApplyTransacted() const {
+	HANDLE hTrans = CreateTransaction(nullptr, nullptr, 0, 0, 0, 0, nullptr);
+	if (hTrans == INVALID_HANDLE_VALUE) return REG_UNKNOWN_ERROR;
+	HRESULT hRes = REG_SUCCESS;
+
+	for (const KEYOPS& rKeyOps : vKeys) {
+		BOOL bWrite = FALSE;
+		for (const OP& rOp : rKeyOps.vOps) bWrite = bWrite || !rOp.bDelete;
+		HKEY hKey = NULL;
+		LSTATUS lRes = ERROR_SUCCESS;
+		if (bWrite) lRes = RegCreateKeyTransactedA(rKeyOps.hRoot, rKeyOps.cPath.c_str(), 0, nullptr, REG_OPTION_NON_VOLATILE, KEY_READ | KEY_WRITE, nullptr, &hKey, nullptr, hTrans, nullptr);
+		else lRes = RegOpenKeyTransactedA(rKeyOps.hRoot, rKeyOps.cPath.c_str(), 0, KEY_READ | KEY_WRITE, &hKey, hTrans, nullptr);
+		if (!bWrite && lRes == ERROR_FILE_NOT_FOUND) continue;
+		if (lRes != ERROR_SUCCESS) {
+			hRes = StatusToHRESULT(lRes);
+			break;
+		}
+		for (const OP& rOp : rKeyOps.vOps) {
+			if (rOp.bDelete) {
+				lRes = RegDeleteValueA(hKey, rOp.cName.c_str());
+				if (lRes == ERROR_FILE_NOT_FOUND) lRes = ERROR_SUCCESS;
+			}
+			else lRes = RegSetValueExA(hKey, rOp.cName.c_str(), 0, rOp.dwType, rOp.lpData.data(), static_cast<DWORD>(rOp.lpData.size()));
+			if (lRes != ERROR_SUCCESS) break;
+		}
+		RegCloseKey(hKey);
+		if (lRes != ERROR_SUCCESS) {
+			hRes = (lRes == ERROR_ACCESS_DENIED ? REG_ACCESS_DENIED : REG_UNKNOWN_ERROR);
+			break;
+		}
+	}
+
+	if (hRes == REG_SUCCESS) {
+		if (!CommitTransaction(hTrans)) hRes = REG_UNKNOWN_ERROR;
+	}
+	else RollbackTransaction(hTrans);
+	CloseHandle(hTrans);
+	return hRes;
+}
@@ -0,0 +1,78 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGBATCH_H
+#define REGBATCH_H
+
+#include "RegKey.h"
+#include <unordered_map>
+
+// Write batch
+// Records value writes and deletions across keys and applies them grouped per key, with one open per key.
+// A later operation on the same value (names are case-insensitive) replaces the earlier one, so only the last
+// state of every value is written. Deleting a value that does not exist is not an error.
+class REGWRITEBATCH {
+private:
+	struct OP {
+		std::string cName; // Value name
+		BOOL bDelete; // Delete the value instead of writing it
+		DWORD dwType; // Type
+		std::vector<BYTE> lpData; // Data
+	};
+	struct KEYOPS {
+		HKEY hRoot; // Root term
+		std::string cPath; // Path
+		std::vector<OP> vOps; // Operations in the order they were first recorded
+		std::unordered_map<std::string, size_t> mIndex; // Folded value name -> position in vOps
+	};
+
+	std::vector<KEYOPS> vKeys; // Keys in the order they were first recorded
+	std::unordered_map<std::string, size_t> mKeyIndex; // Root and folded path -> position in vKeys
+
+	OP* Record(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName);
+
+public:
+	// Write a value of any type
+	HRESULT Put(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize);
+	HRESULT PutREGSZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, LPCSTR lpVal);
+	HRESULT PutREGEXPANDSZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, LPCSTR lpVal);
+	HRESULT PutREGDWORD(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, DWORD dwVal);
+	HRESULT PutREGQWORD(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, QWORD ullVal);
+	HRESULT PutREGBINARY(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, const BYTE* lpData, DWORD dwSize);
+	// Delete a value
+	HRESULT Delete(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName);
+
+	// Number of recorded operations (after coalescing)
+	size_t GetCount() const;
+	// Remove all operations
+	void Clear();
+
+	// Apply the batch to a backend (nullptr means the default backend). Keys are created when a value is written.
+	// If bRollback is TRUE the previous state of every value is read first and restored when an operation fails,
+	// and the keys created by the batch are deleted.
+	HRESULT Apply(REGBACKEND* pBackend, BOOL bRollback) const;
+	// Apply the batch to the Windows registry inside one kernel transaction (KtmW32).
+	// Either every operation is committed or none is.
+	HRESULT ApplyTransacted() const;
+};
+
+#endif
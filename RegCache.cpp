@@ -0,0 +1,455 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegCache.h"
+#include "RegSearch.h"
+
+// FNV-1a over the ASCII lower case characters of lpStr, continuing from ullHash
+static ULONGLONG HashNoCase(ULONGLONG ullHash, LPCSTR lpStr) {
+	for (const BYTE* p = reinterpret_cast<const BYTE*>(lpStr); *p; p++) {
+		BYTE c = *p;
+		if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+		ullHash = (ullHash ^ c) * 0x100000001B3ull;
+	}
+	// Terminator, so that ("ab", "c") and ("a", "bc") differ
+	return (ullHash ^ 0xFF) * 0x100000001B3ull;
+}
+
+static ULONGLONG HashPath(HKEY hRoot, LPCSTR lpPath) {
+	ULONGLONG ullHash = 0xCBF29CE484222325ull ^ static_cast<ULONGLONG>(reinterpret_cast<ULONG_PTR>(hRoot));
+	return HashNoCase(ullHash * 0x100000001B3ull, lpPath);
+}
+
+// Whether lpPath is a sub key of cBase ("" is the parent of every key)
+static BOOL IsBelowNoCase(const std::string& cBase, LPCSTR lpPath) {
+	if (cBase.empty()) return lpPath[0] != '\0';
+	size_t i = 0;
+	for (; i < cBase.size(); i++) {
+		CHAR a = cBase[i], b = lpPath[i];
+		if (b == '\0') return FALSE;
+		if (a >= 'A' && a <= 'Z') a = a - 'A' + 'a';
+		if (b >= 'A' && b <= 'Z') b = b - 'A' + 'a';
+		if (a != b) return FALSE;
+	}
+	return lpPath[i] == '\\';
+}
+
+
+struct REGWIN32NOTIFYSOURCE::WATCH {
+	HKEY hRoot;
+	std::string cPath;
+	BOOL bSubtree; // Watch the sub keys too
+	REGNOTIFYSINK* pSink;
+	HKEY hKey; // Key opened with KEY_NOTIFY
+	HANDLE hEvent; // Auto reset event signaled by the registry
+	HANDLE hWait; // Thread pool wait
+	std::atomic<bool> bArmed; // FALSE after the notification could not be armed again (the key was deleted)
+};
+
+static LSTATUS ArmWatch(HKEY hKey, BOOL bSubtree, HANDLE hEvent) {
+	// A subtree watch also reports sub keys being added or removed
+	DWORD dwFilter = REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC;
+	if (bSubtree) dwFilter |= REG_NOTIFY_CHANGE_NAME;
+	return RegNotifyChangeKeyValue(hKey, bSubtree, dwFilter, hEvent, TRUE);
+}
+
+REGWIN32NOTIFYSOURCE::REGWIN32NOTIFYSOURCE() {
+	return;
+}
+REGWIN32NOTIFYSOURCE::~REGWIN32NOTIFYSOURCE() {
+	std::vector<WATCH*> vOld;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		vOld.swap(vWatches);
+	}
+	FreeWatches(vOld);
+}
+
+VOID CALLBACK REGWIN32NOTIFYSOURCE::OnSignaled(PVOID pContext, BOOLEAN bTimeout) {
+	WATCH* pWatch = static_cast<WATCH*>(pContext);
+	// Arm again first, so that changes made while the sink runs are reported
+	if (ArmWatch(pWatch->hKey, pWatch->bSubtree, pWatch->hEvent) != ERROR_SUCCESS) pWatch->bArmed.store(false);
+	pWatch->pSink->OnKeyChanged(pWatch->hRoot, pWatch->cPath.c_str());
+}
+
+HRESULT REGWIN32NOTIFYSOURCE::Watch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) {
+	if (pSink == nullptr || lpPath == nullptr) return REG_INVAILD_POINTER;
+	std::lock_guard<std::mutex> lGuard(mLock);
+	WATCH* pWatch = nullptr;
+	for (WATCH* p : vWatches) {
+		if (p->pSink == pSink && p->hRoot == hRoot && p->bSubtree == bSubtree && EqualsNoCase(p->cPath, lpPath)) pWatch = p;
+	}
+	HKEY hKey = NULL;
+	LSTATUS lRes = ERROR_SUCCESS;
+	if (pWatch != nullptr) {
+		if (pWatch->bArmed.load()) return REG_SUCCESS;
+		// The key was deleted, watch the key that has the path now
+		lRes = RegOpenKeyExA(hRoot, lpPath, 0, KEY_NOTIFY, &hKey);
+		if (lRes == ERROR_SUCCESS) lRes = ArmWatch(hKey, pWatch->bSubtree, pWatch->hEvent);
+		if (lRes != ERROR_SUCCESS) {
+			if (hKey != NULL) RegCloseKey(hKey);
+			if (lRes == ERROR_FILE_NOT_FOUND) return REG_PATH_NOT_EXIST;
+			if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+			return REG_UNKNOWN_ERROR;
+		}
+		RegCloseKey(pWatch->hKey);
+		pWatch->hKey = hKey;
+		pWatch->bArmed.store(true);
+		return REG_SUCCESS;
+	}
+
+	lRes = RegOpenKeyExA(hRoot, lpPath, 0, KEY_NOTIFY, &hKey);
+	if (lRes != ERROR_SUCCESS) {
+		if (lRes == ERROR_FILE_NOT_FOUND) return REG_PATH_NOT_EXIST;
+		if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		return REG_UNKNOWN_ERROR;
+	}
+	HANDLE hEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+	if (hEvent == NULL || ArmWatch(hKey, bSubtree, hEvent) != ERROR_SUCCESS) {
+		if (hEvent != NULL) CloseHandle(hEvent);
+		RegCloseKey(hKey);
+		return REG_UNKNOWN_ERROR;
+	}
+	pWatch = new WATCH;
+	pWatch->hRoot = hRoot;
+	pWatch->cPath = lpPath;
+	pWatch->bSubtree = bSubtree;
+	pWatch->pSink = pSink;
+	pWatch->hKey = hKey;
+	pWatch->hEvent = hEvent;
+	pWatch->hWait = NULL;
+	pWatch->bArmed.store(true);
+	if (!RegisterWaitForSingleObject(&pWatch->hWait, hEvent, OnSignaled, pWatch, INFINITE, WT_EXECUTEDEFAULT)) {
+		CloseHandle(hEvent);
+		RegCloseKey(hKey);
+		delete pWatch;
+		return REG_UNKNOWN_ERROR;
+	}
+	vWatches.push_back(pWatch);
+	return REG_SUCCESS;
+}
+
+void REGWIN32NOTIFYSOURCE::Unwatch(REGNOTIFYSINK* pSink) {
+	std::vector<WATCH*> vOld;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		for (size_t i = 0; i < vWatches.size();) {
+			if (vWatches[i]->pSink == pSink) {
+				vOld.push_back(vWatches[i]);
+				vWatches[i] = vWatches.back();
+				vWatches.pop_back();
+			}
+			else i++;
+		}
+	}
+	// Wait for running callbacks outside the lock
+	FreeWatches(vOld);
+}
+
+void REGWIN32NOTIFYSOURCE::Unwatch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) {
+	if (lpPath == nullptr) return;
+	std::vector<WATCH*> vOld;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		for (size_t i = 0; i < vWatches.size(); i++) {
+			WATCH* p = vWatches[i];
+			if (p->pSink == pSink && p->hRoot == hRoot && p->bSubtree == bSubtree && EqualsNoCase(p->cPath, lpPath)) {
+				vOld.push_back(p);
+				vWatches[i] = vWatches.back();
+				vWatches.pop_back();
+				break;
+			}
+		}
+	}
+	FreeWatches(vOld);
+}
+
+void REGWIN32NOTIFYSOURCE::FreeWatches(const std::vector<WATCH*>& vOld) {
+	for (WATCH* pWatch : vOld) {
+		UnregisterWaitEx(pWatch->hWait, INVALID_HANDLE_VALUE);
+		RegCloseKey(pWatch->hKey);
+		CloseHandle(pWatch->hEvent);
+		delete pWatch;
+	}
+}
+
+
+
+HRESULT REGSIMNOTIFYSOURCE::Watch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) {
+	if (pSink == nullptr || lpPath == nullptr) return REG_INVAILD_POINTER;
+	std::lock_guard<std::mutex> lGuard(mLock);
+	for (const WATCH& w : vWatches) {
+		if (w.pSink == pSink && w.hRoot == hRoot && w.bSubtree == bSubtree && EqualsNoCase(w.cPath, lpPath)) return REG_SUCCESS;
+	}
+	vWatches.push_back({ hRoot, lpPath, bSubtree, pSink });
+	return REG_SUCCESS;
+}
+
+void REGSIMNOTIFYSOURCE::Unwatch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) {
+	if (lpPath == nullptr) return;
+	std::lock_guard<std::mutex> lDeliver(mDeliver);
+	std::lock_guard<std::mutex> lGuard(mLock);
+	for (size_t i = 0; i < vWatches.size(); i++) {
+		const WATCH& w = vWatches[i];
+		if (w.pSink == pSink && w.hRoot == hRoot && w.bSubtree == bSubtree && EqualsNoCase(w.cPath, lpPath)) {
+			vWatches[i] = std::move(vWatches.back());
+			vWatches.pop_back();
+			break;
+		}
+	}
+}
+
+void REGSIMNOTIFYSOURCE::Unwatch(REGNOTIFYSINK* pSink) {
+	// Taking mDeliver waits for a running Notify
+	std::lock_guard<std::mutex> lDeliver(mDeliver);
+	std::lock_guard<std::mutex> lGuard(mLock);
+	for (size_t i = 0; i < vWatches.size();) {
+		if (vWatches[i].pSink == pSink) {
+			vWatches[i] = std::move(vWatches.back());
+			vWatches.pop_back();
+		}
+		else i++;
+	}
+}
+
+void REGSIMNOTIFYSOURCE::Notify(HKEY hRoot, LPCSTR lpPath) {
+	if (lpPath == nullptr) return;
+	std::lock_guard<std::mutex> lDeliver(mDeliver);
+	std::vector<std::pair<REGNOTIFYSINK*, std::string>> vSinks;
+	{
+		// Sinks are called without mLock, they may call Watch
+		std::lock_guard<std::mutex> lGuard(mLock);
+		for (const WATCH& w : vWatches) {
+			if (w.hRoot != hRoot) continue;
+			if (EqualsNoCase(w.cPath, lpPath) || (w.bSubtree && IsBelowNoCase(w.cPath, lpPath))) vSinks.emplace_back(w.pSink, w.cPath);
+		}
+	}
+	for (const auto& itSink : vSinks) itSink.first->OnKeyChanged(hRoot, itSink.second.c_str());
+}
+
+size_t REGSIMNOTIFYSOURCE::GetWatchCount() {
+	std::lock_guard<std::mutex> lGuard(mLock);
+	return vWatches.size();
+}
+
+
+static REGWIN32NOTIFYSOURCE* GetWin32NotifySource() {
+	static REGWIN32NOTIFYSOURCE Win32Source;
+	return &Win32Source;
+}
+
+REGVALUECACHE::REGVALUECACHE(REGBACKEND* pBackend, REGNOTIFYSOURCE* pSource) :
+	pBackend(pBackend == nullptr ? GetDefaultRegBackend() : pBackend),
+	pSource(pSource == nullptr ? GetWin32NotifySource() : pSource),
+	ullHits(0), ullMisses(0), ullInvalidations(0) {
+	return;
+}
+REGVALUECACHE::~REGVALUECACHE() {
+	pSource->Unwatch(this);
+}
+
+std::shared_ptr<REGVALUECACHE::KEYSTATE> REGVALUECACHE::FindKey(HKEY hRoot, LPCSTR lpPath, ULONGLONG ullHash) const {
+	auto range = mKeys.equal_range(ullHash);
+	for (auto it = range.first; it != range.second; ++it) {
+		const KEYSTATE* pKey = it->second.get();
+		if (pKey->hRoot == hRoot && EqualsNoCase(pKey->cPath, lpPath)) return it->second;
+	}
+	return nullptr;
+}
+
+std::shared_ptr<REGVALUECACHE::KEYSTATE> REGVALUECACHE::AddKey(HKEY hRoot, LPCSTR lpPath) {
+	ULONGLONG ullPathHash = HashPath(hRoot, lpPath);
+	{
+		std::shared_lock<std::shared_mutex> lRead(mLock);
+		std::shared_ptr<KEYSTATE> pKey = FindKey(hRoot, lpPath, ullPathHash);
+		if (pKey != nullptr) return pKey;
+	}
+	std::unique_lock<std::shared_mutex> lWrite(mLock);
+	std::shared_ptr<KEYSTATE> pKey = FindKey(hRoot, lpPath, ullPathHash);
+	if (pKey != nullptr) return pKey;
+	pKey = std::make_shared<KEYSTATE>(pBackend);
+	pKey->hRoot = hRoot;
+	pKey->cPath = lpPath;
+	pKey->ullHash = ullPathHash;
+	mKeys.emplace(ullPathHash, pKey);
+	return pKey;
+}
+
+const REGVALUECACHE::ENTRY* REGVALUECACHE::Lookup(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName) const {
+	ULONGLONG ullHash = HashNoCase(HashPath(hRoot, lpPath), lpName);
+	auto range = mEntries.equal_range(ullHash);
+	for (auto it = range.first; it != range.second; ++it) {
+		const ENTRY& rEntry = it->second;
+		if (rEntry.pKey->hRoot != hRoot || !EqualsNoCase(rEntry.cName, lpName) || !EqualsNoCase(rEntry.pKey->cPath, lpPath)) continue;
+		if (rEntry.ullGen != rEntry.pKey->ullGen.load(std::memory_order_acquire)) return nullptr;
+		return &rEntry;
+	}
+	return nullptr;
+}
+
+// Called with pKey->mFill held, not mLock
+HRESULT REGVALUECACHE::Fill(KEYSTATE* pKey, LPCSTR lpName, ENTRY* pOut) {
+	if (!pKey->bWatched || pKey->bStale.load()) {
+		// The watch must exist before the value is read, so that no change is missed
+		pKey->bWatched = (pSource->Watch(pKey->hRoot, pKey->cPath.c_str(), FALSE, this) == REG_SUCCESS);
+	}
+	ULONGLONG ullGen = pKey->ullGen.load(std::memory_order_acquire);
+	if (pKey->bStale.exchange(false) && pKey->rKey.Opened()) pKey->rKey.Close();
+	if (!pKey->rKey.Opened()) {
+		HRESULT hRes = pKey->rKey.Open(pKey->hRoot, pKey->cPath.c_str(), KEY_READ);
+		if (hRes != REG_SUCCESS) return hRes;
+	}
+
+	std::vector<BYTE> lpData;
+	DWORD dwType = 0;
+	HRESULT hRes = pKey->rKey.ReadValue(lpName, &dwType, &lpData);
+	if (hRes != REG_SUCCESS) return hRes;
+	pOut->pKey = (pKey->bWatched ? pKey : nullptr);
+	pOut->ullGen = ullGen;
+	pOut->cName = lpName;
+	pOut->dwType = dwType;
+	pOut->qwValue = 0;
+	switch (dwType) {
+	case REG_SZ:
+	case REG_EXPAND_SZ:
+		pOut->cStr.assign(reinterpret_cast<const CHAR*>(lpData.data()), strnlen(reinterpret_cast<const CHAR*>(lpData.data()), lpData.size()));
+		break;
+	case REG_DWORD:
+		if (lpData.size() < sizeof(DWORD)) return REG_INVAILD_VALUE;
+		memcpy(&pOut->qwValue, lpData.data(), sizeof(DWORD));
+		break;
+	case REG_QWORD:
+		if (lpData.size() < sizeof(QWORD)) return REG_INVAILD_VALUE;
+		memcpy(&pOut->qwValue, lpData.data(), sizeof(QWORD));
+		break;
+	case REG_MULTI_SZ: {
+		REGMULTISZVIEW vMulti(reinterpret_cast<const CHAR*>(lpData.data()), lpData.size());
+		pOut->vMulti.reserve(vMulti.Count());
+		for (std::string_view vStr : vMulti) pOut->vMulti.emplace_back(vStr);
+		break;
+	}
+	default:
+		pOut->lpData = std::move(lpData);
+		break;
+	}
+	return REG_SUCCESS;
+}
+
+template <typename T, typename F>
+HRESULT REGVALUECACHE::Read(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, DWORD dwType, T* pRes, F fGet) {
+	if (pRes == nullptr || lpPath == nullptr) return REG_INVAILD_POINTER;
+	if (lpName == nullptr) lpName = REG_DEFAULTVALUE;
+	{
+		std::shared_lock<std::shared_mutex> lRead(mLock);
+		const ENTRY* pEntry = Lookup(hRoot, lpPath, lpName);
+		if (pEntry != nullptr) {
+			ullHits.fetch_add(1, std::memory_order_relaxed);
+			if (pEntry->dwType != dwType) return REG_INCORRECT_TYPE;
+			fGet(*pEntry, pRes);
+			return REG_SUCCESS;
+		}
+	}
+	ullMisses.fetch_add(1, std::memory_order_relaxed);
+	std::shared_ptr<KEYSTATE> pKey = AddKey(hRoot, lpPath);
+	ENTRY eNew;
+	HRESULT hRes = REG_SUCCESS;
+	{
+		// The backend is read without mLock, hits and misses of other keys go on meanwhile
+		std::lock_guard<std::mutex> lFill(pKey->mFill);
+		hRes = Fill(pKey.get(), lpName, &eNew);
+	}
+	if (hRes != REG_SUCCESS) return hRes;
+	if (eNew.dwType != dwType) hRes = REG_INCORRECT_TYPE;
+	else fGet(eNew, pRes);
+	if (eNew.pKey == nullptr) return hRes;
+
+	std::unique_lock<std::shared_mutex> lWrite(mLock);
+	// The key changed or the cache was cleared during the read: the value is returned but not cached
+	if (eNew.ullGen != pKey->ullGen.load(std::memory_order_acquire)) return hRes;
+	if (FindKey(hRoot, lpPath, pKey->ullHash) != pKey) return hRes;
+
+	// Replace the stale entry of the value, if any
+	ULONGLONG ullHash = HashNoCase(pKey->ullHash, lpName);
+	auto range = mEntries.equal_range(ullHash);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second.pKey == eNew.pKey && EqualsNoCase(it->second.cName, lpName)) {
+			it->second = std::move(eNew);
+			return hRes;
+		}
+	}
+	mEntries.emplace(ullHash, std::move(eNew));
+	return hRes;
+}
+
+HRESULT REGVALUECACHE::ReadREGSZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, std::string* lpRes) {
+	return Read(hRoot, lpPath, lpName, REG_SZ, lpRes, [](const ENTRY& e, std::string* p) { *p = e.cStr; });
+}
+HRESULT REGVALUECACHE::ReadREGEXPANDSZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, std::string* lpRes) {
+	return Read(hRoot, lpPath, lpName, REG_EXPAND_SZ, lpRes, [](const ENTRY& e, std::string* p) { *p = e.cStr; });
+}
+HRESULT REGVALUECACHE::ReadREGDWORD(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, DWORD* dwRes) {
+	return Read(hRoot, lpPath, lpName, REG_DWORD, dwRes, [](const ENTRY& e, DWORD* p) { *p = static_cast<DWORD>(e.qwValue); });
+}
+HRESULT REGVALUECACHE::ReadREGQWORD(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, QWORD* qwRes) {
+	return Read(hRoot, lpPath, lpName, REG_QWORD, qwRes, [](const ENTRY& e, QWORD* p) { *p = e.qwValue; });
+}
+HRESULT REGVALUECACHE::ReadREGBINARY(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, std::vector<BYTE>* lpRes) {
+	return Read(hRoot, lpPath, lpName, REG_BINARY, lpRes, [](const ENTRY& e, std::vector<BYTE>* p) { *p = e.lpData; });
+}
+HRESULT REGVALUECACHE::ReadREGMULTISZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, std::vector<std::string>* lpRes) {
+	return Read(hRoot, lpPath, lpName, REG_MULTI_SZ, lpRes, [](const ENTRY& e, std::vector<std::string>* p) { *p = e.vMulti; });
+}
+
+void REGVALUECACHE::Invalidate(HKEY hRoot, LPCSTR lpPath) {
+	if (lpPath == nullptr) return;
+	std::shared_lock<std::shared_mutex> lRead(mLock);
+	std::shared_ptr<KEYSTATE> pKey = FindKey(hRoot, lpPath, HashPath(hRoot, lpPath));
+	if (pKey == nullptr) return;
+	pKey->ullGen.fetch_add(1, std::memory_order_release);
+	pKey->bStale.store(true);
+}
+
+void REGVALUECACHE::Clear() {
+	// Stop the notifications first, a running one takes the lock
+	pSource->Unwatch(this);
+	std::unique_lock<std::shared_mutex> lWrite(mLock);
+	mEntries.clear();
+	mKeys.clear();
+}
+
+REGCACHESTATS REGVALUECACHE::GetStats() const {
+	REGCACHESTATS sRes;
+	sRes.ullHits = ullHits.load(std::memory_order_relaxed);
+	sRes.ullMisses = ullMisses.load(std::memory_order_relaxed);
+	sRes.ullInvalidations = ullInvalidations.load(std::memory_order_relaxed);
+	return sRes;
+}
+void REGVALUECACHE::ResetStats() {
+	ullHits.store(0, std::memory_order_relaxed);
+	ullMisses.store(0, std::memory_order_relaxed);
+	ullInvalidations.store(0, std::memory_order_relaxed);
+}
+
+void REGVALUECACHE::OnKeyChanged(HKEY hRoot, LPCSTR lpPath) {
+	ullInvalidations.fetch_add(1, std::memory_order_relaxed);
+	Invalidate(hRoot, lpPath);
+}
@@ -0,0 +1,192 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGCACHE_H
+#define REGCACHE_H
+
+#include "RegKey.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+// Receiver of key change notifications
+class REGNOTIFYSINK {
+public:
+	virtual ~REGNOTIFYSINK() {}
+
+	// A value of the key (hRoot, lpPath) was added, changed or removed, or the key was deleted.
+	// Can be called from any thread.
+	virtual void OnKeyChanged(HKEY hRoot, LPCSTR lpPath) = 0;
+};
+
+// Source of key change notifications
+class REGNOTIFYSOURCE {
+public:
+	virtual ~REGNOTIFYSOURCE() {}
+
+	// Start watching the key (hRoot, lpPath) for pSink, with all its sub keys if bSubtree is TRUE. The key must exist.
+	// A change below a subtree watch is reported with the path of the watched key.
+	virtual HRESULT Watch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) = 0;
+	// Stop one watch of pSink
+	virtual void Unwatch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) = 0;
+	// Stop all watches of pSink. No notification is delivered to pSink after this returns.
+	virtual void Unwatch(REGNOTIFYSINK* pSink) = 0;
+};
+
+// Windows registry notification source (RegNotifyChangeKeyValue)
+// Every watched key gets an event that is waited for on the system thread pool. The watch is armed again
+// before the sink is called, so no change between two notifications is lost.
+class REGWIN32NOTIFYSOURCE : public REGNOTIFYSOURCE {
+private:
+	struct WATCH;
+
+	std::vector<WATCH*> vWatches;
+	std::mutex mLock;
+
+	static VOID CALLBACK OnSignaled(PVOID pContext, BOOLEAN bTimeout);
+	static void FreeWatches(const std::vector<WATCH*>& vOld);
+
+public:
+	REGWIN32NOTIFYSOURCE();
+	REGWIN32NOTIFYSOURCE(const REGWIN32NOTIFYSOURCE&) = delete;
+	REGWIN32NOTIFYSOURCE& operator=(const REGWIN32NOTIFYSOURCE&) = delete;
+	~REGWIN32NOTIFYSOURCE();
+
+	HRESULT Watch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) override;
+	void Unwatch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) override;
+	void Unwatch(REGNOTIFYSINK* pSink) override;
+};
+
+// Simulated notification source
+// Notifications are only delivered when Notify is called, so a cache can be driven by a synthetic change feed.
+class REGSIMNOTIFYSOURCE : public REGNOTIFYSOURCE {
+private:
+	struct WATCH {
+		HKEY hRoot;
+		std::string cPath;
+		BOOL bSubtree;
+		REGNOTIFYSINK* pSink;
+	};
+
+	std::vector<WATCH> vWatches;
+	std::mutex mLock;
+	std::mutex mDeliver; // Held while sinks are called
+
+public:
+	HRESULT Watch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) override;
+	void Unwatch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) override;
+	void Unwatch(REGNOTIFYSINK* pSink) override;
+
+	// Deliver a change of the key (hRoot, lpPath) to every sink watching it or, with a subtree watch, one of its
+	// parents (names are case-insensitive)
+	void Notify(HKEY hRoot, LPCSTR lpPath);
+	// Number of active watches
+	size_t GetWatchCount();
+};
+
+// Cache statistics
+struct REGCACHESTATS {
+	ULONGLONG ullHits; // Reads answered from the cache
+	ULONGLONG ullMisses; // Reads that went to the backend
+	ULONGLONG ullInvalidations; // Change notifications received
+};
+
+// Read-through value cache
+// Values are cached by (root, path, value name) in decoded form. The first read of a key starts a watch on it,
+// and every change notification of the key invalidates all its cached values. Reads of a key that cannot be
+// watched are not cached. A hit takes a shared lock and one hash lookup and does not touch the backend.
+// A miss reads the backend without the lock; misses of the same key are serialized by the key.
+// Names are case-insensitive. Failed reads are not cached.
+class REGVALUECACHE : public REGNOTIFYSINK {
+private:
+	struct KEYSTATE {
+		HKEY hRoot;
+		std::string cPath;
+		ULONGLONG ullHash; // HashPath(hRoot, cPath)
+		BOOL bWatched; // Whether the values of the key can be cached
+		std::atomic<ULONGLONG> ullGen; // Incremented by every change notification
+		std::atomic<bool> bStale; // The key changed since rKey was opened
+		REGKEY rKey; // Key used for misses
+		std::mutex mFill; // Held by a miss while it watches, opens and reads the key
+
+		KEYSTATE(REGBACKEND* pBackend) : hRoot(NULL), ullHash(0), bWatched(FALSE), ullGen(0), bStale(false), rKey(pBackend) {}
+	};
+
+	struct ENTRY {
+		KEYSTATE* pKey; // Key of the value, empty if the key is not watched
+		ULONGLONG ullGen; // KEYSTATE::ullGen when the value was read
+		std::string cName; // Value name
+		DWORD dwType; // Value type
+		std::string cStr; // REG_SZ / REG_EXPAND_SZ
+		QWORD qwValue; // REG_DWORD / REG_QWORD
+		std::vector<BYTE> lpData; // REG_BINARY and other types
+		std::vector<std::string> vMulti; // REG_MULTI_SZ
+	};
+
+	REGBACKEND* pBackend; // Backend used for misses
+	REGNOTIFYSOURCE* pSource; // Change notification source
+	std::unordered_multimap<ULONGLONG, std::shared_ptr<KEYSTATE>> mKeys; // Path hash -> key (a miss holds its key while it runs)
+	std::unordered_multimap<ULONGLONG, ENTRY> mEntries; // Value hash -> cached value
+	mutable std::shared_mutex mLock;
+	std::atomic<ULONGLONG> ullHits;
+	std::atomic<ULONGLONG> ullMisses;
+	std::atomic<ULONGLONG> ullInvalidations;
+
+	std::shared_ptr<KEYSTATE> FindKey(HKEY hRoot, LPCSTR lpPath, ULONGLONG ullHash) const;
+	std::shared_ptr<KEYSTATE> AddKey(HKEY hRoot, LPCSTR lpPath);
+	const ENTRY* Lookup(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName) const;
+	HRESULT Fill(KEYSTATE* pKey, LPCSTR lpName, ENTRY* pOut);
+
+	template <typename T, typename F>
+	HRESULT Read(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, DWORD dwType, T* pRes, F fGet);
+
+public:
+	// pBackend can be empty to use the default backend, pSource can be empty to use the Windows registry notifications.
+	// Both must outlive the cache.
+	explicit REGVALUECACHE(REGBACKEND* pBackend = nullptr, REGNOTIFYSOURCE* pSource = nullptr);
+	REGVALUECACHE(const REGVALUECACHE&) = delete;
+	REGVALUECACHE& operator=(const REGVALUECACHE&) = delete;
+	~REGVALUECACHE();
+
+	// Read values (same results as the REGKEY functions of the same name)
+	HRESULT ReadREGSZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, std::string* lpRes);
+	HRESULT ReadREGEXPANDSZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, std::string* lpRes);
+	HRESULT ReadREGDWORD(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, DWORD* dwRes);
+	HRESULT ReadREGQWORD(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, QWORD* qwRes);
+	HRESULT ReadREGBINARY(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, std::vector<BYTE>* lpRes);
+	HRESULT ReadREGMULTISZ(HKEY hRoot, LPCSTR lpPath, LPCSTR lpName, std::vector<std::string>* lpRes);
+
+	// Drop the cached values of a key
+	void Invalidate(HKEY hRoot, LPCSTR lpPath);
+	// Drop all cached values and stop all watches
+	void Clear();
+	// Get the hit / miss / invalidation counters
+	REGCACHESTATS GetStats() const;
+	// Reset the counters to zero
+	void ResetStats();
+
+	void OnKeyChanged(HKEY hRoot, LPCSTR lpPath) override;
+};
+
+#endif
@@ -0,0 +1,101 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegCounting.h"
+
+REGCOUNTINGBACKEND::REGCOUNTINGBACKEND(REGBACKEND* pInner) : pInner(pInner == nullptr ? GetWin32RegBackend() : pInner) {
+	Reset();
+}
+
+LSTATUS REGCOUNTINGBACKEND::OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	Count(REG_OP_OPENKEY);
+	return pInner->OpenKey(hParent, lpPath, ulSam, bCreate, phOutKey);
+}
+LSTATUS REGCOUNTINGBACKEND::CloseKey(HKEY hKey) {
+	Count(REG_OP_CLOSEKEY);
+	return pInner->CloseKey(hKey);
+}
+LSTATUS REGCOUNTINGBACKEND::DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) {
+	Count(REG_OP_DELETEKEY);
+	return pInner->DeleteKey(hKey, lpSubKey, ulSam);
+}
+LSTATUS REGCOUNTINGBACKEND::SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	Count(REG_OP_SETVALUE);
+	return pInner->SetValue(hKey, lpName, dwType, lpData, dwSize);
+}
+LSTATUS REGCOUNTINGBACKEND::QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	Count(REG_OP_QUERYVALUE);
+	return pInner->QueryValue(hKey, lpName, pdwType, lpData, pdwSize);
+}
+LSTATUS REGCOUNTINGBACKEND::DeleteValue(HKEY hKey, LPCSTR lpName) {
+	Count(REG_OP_DELETEVALUE);
+	return pInner->DeleteValue(hKey, lpName);
+}
+LSTATUS REGCOUNTINGBACKEND::EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) {
+	Count(REG_OP_ENUMKEY);
+	return pInner->EnumKey(hKey, dwIndex, lpName, pdwNameSize);
+}
+LSTATUS REGCOUNTINGBACKEND::EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	Count(REG_OP_ENUMVALUE);
+	return pInner->EnumValue(hKey, dwIndex, lpName, pdwNameSize, pdwType, lpData, pdwSize);
+}
+LSTATUS REGCOUNTINGBACKEND::SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) {
+	Count(REG_OP_SETSECURITY);
+	return pInner->SetSecurity(hKey, ulInfo, pSD);
+}
+LSTATUS REGCOUNTINGBACKEND::QueryMultipleValues(HKEY hKey, VALENTA* pValues, DWORD dwCount, LPSTR lpBuffer, DWORD* pdwTotalSize) {
+	Count(REG_OP_QUERYMULTIPLE);
+	return pInner->QueryMultipleValues(hKey, pValues, dwCount, lpBuffer, pdwTotalSize);
+}
+LSTATUS REGCOUNTINGBACKEND::QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo) {
+	Count(REG_OP_QUERYINFO);
+	return pInner->QueryInfoKey(hKey, pInfo);
+}
+LSTATUS REGCOUNTINGBACKEND::OpenKeyW(HKEY hParent, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	Count(REG_OP_OPENKEY);
+	return pInner->OpenKeyW(hParent, lpPath, ulSam, bCreate, phOutKey);
+}
+LSTATUS REGCOUNTINGBACKEND::SetValueW(HKEY hKey, LPCWSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	Count(REG_OP_SETVALUE);
+	return pInner->SetValueW(hKey, lpName, dwType, lpData, dwSize);
+}
+LSTATUS REGCOUNTINGBACKEND::QueryValueW(HKEY hKey, LPCWSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	Count(REG_OP_QUERYVALUE);
+	return pInner->QueryValueW(hKey, lpName, pdwType, lpData, pdwSize);
+}
+LSTATUS REGCOUNTINGBACKEND::DeleteValueW(HKEY hKey, LPCWSTR lpName) {
+	Count(REG_OP_DELETEVALUE);
+	return pInner->DeleteValueW(hKey, lpName);
+}
+
+ULONGLONG REGCOUNTINGBACKEND::GetCount(REGBACKENDOP eOp) const {
+	if (eOp < 0 || eOp >= REG_OP_COUNT) return 0;
+	return ullCount[eOp].load(std::memory_order_relaxed);
+}
+ULONGLONG REGCOUNTINGBACKEND::GetTotal() const {
+	ULONGLONG ullTotal = 0;
+	for (const std::atomic<ULONGLONG>& c : ullCount) ullTotal += c.load(std::memory_order_relaxed);
+	return ullTotal;
+}
+void REGCOUNTINGBACKEND::Reset() {
+	for (std::atomic<ULONGLONG>& c : ullCount) c.store(0, std::memory_order_relaxed);
+}
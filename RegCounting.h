@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGCOUNTING_H
+#define REGCOUNTING_H
+
+#include "RegKey.h"
+#include <atomic>
+
+// Backend operations counted by REGCOUNTINGBACKEND
+enum REGBACKENDOP {
+	REG_OP_OPENKEY,
+	REG_OP_CLOSEKEY,
+	REG_OP_DELETEKEY,
+	REG_OP_SETVALUE,
+	REG_OP_QUERYVALUE,
+	REG_OP_DELETEVALUE,
+	REG_OP_ENUMKEY,
+	REG_OP_ENUMVALUE,
+	REG_OP_SETSECURITY,
+	REG_OP_QUERYMULTIPLE,
+	REG_OP_QUERYINFO,
+	REG_OP_COUNT
+};
+
+// Call counting backend
+// Forwards every call to another backend and counts the calls per operation.
+// Use it to measure how many registry API calls a REGKEY operation costs.
+class REGCOUNTINGBACKEND : public REGBACKEND {
+private:
+	REGBACKEND* pInner; // Backend the calls are forwarded to
+	std::atomic<ULONGLONG> ullCount[REG_OP_COUNT];
+
+	void Count(REGBACKENDOP eOp) { ullCount[eOp].fetch_add(1, std::memory_order_relaxed); }
+
+public:
+	// pInner must outlive this backend. nullptr means the Windows registry backend.
+	explicit REGCOUNTINGBACKEND(REGBACKEND* pInner = nullptr);
+	REGCOUNTINGBACKEND(const REGCOUNTINGBACKEND&) = delete;
+	REGCOUNTINGBACKEND& operator=(const REGCOUNTINGBACKEND&) = delete;
+
+	LSTATUS OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override;
+	LSTATUS CloseKey(HKEY hKey) override;
+	LSTATUS DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) override;
+	LSTATUS SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) override;
+	LSTATUS QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS DeleteValue(HKEY hKey, LPCSTR lpName) override;
+	LSTATUS EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) override;
+	LSTATUS EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) override;
+	LSTATUS QueryMultipleValues(HKEY hKey, VALENTA* pValues, DWORD dwCount, LPSTR lpBuffer, DWORD* pdwTotalSize) override;
+	LSTATUS QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo) override;
+	LSTATUS OpenKeyW(HKEY hParent, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override;
+	LSTATUS SetValueW(HKEY hKey, LPCWSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) override;
+	LSTATUS QueryValueW(HKEY hKey, LPCWSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS DeleteValueW(HKEY hKey, LPCWSTR lpName) override;
+
+	// Get the number of calls of one operation
+	ULONGLONG GetCount(REGBACKENDOP eOp) const;
+	// Get the number of calls of all operations
+	ULONGLONG GetTotal() const;
+	// Reset all counters to zero
+	void Reset();
+};
+
+#endif
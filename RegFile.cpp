@@ -0,0 +1,447 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegFile.h"
+#include <fstream>
+
+#define REGFILE_HEADER4 "REGEDIT4"
+#define REGFILE_HEADER5 "Windows Registry Editor Version 5.00"
+#define REGFILE_LINE_WIDTH 76
+
+// Encoding of the input file
+#define REGFILE_ANSI 0
+#define REGFILE_UTF8 1
+#define REGFILE_UTF16 2
+
+static std::string WideToAnsi(const WCHAR* lpWide, size_t ulLen) {
+	std::string cRes;
+	if (ulLen == 0) return cRes;
+	INT nLen = WideCharToMultiByte(CP_ACP, 0, lpWide, static_cast<INT>(ulLen), nullptr, 0, nullptr, nullptr);
+	if (nLen <= 0) return cRes;
+	cRes.resize(nLen);
+	WideCharToMultiByte(CP_ACP, 0, lpWide, static_cast<INT>(ulLen), &cRes[0], nLen, nullptr, nullptr);
+	return cRes;
+}
+static std::wstring MultiByteToWide(UINT uCodePage, LPCSTR lpStr, size_t ulLen) {
+	std::wstring cRes;
+	if (ulLen == 0) return cRes;
+	INT nLen = MultiByteToWideChar(uCodePage, 0, lpStr, static_cast<INT>(ulLen), nullptr, 0);
+	if (nLen <= 0) return cRes;
+	cRes.resize(nLen);
+	MultiByteToWideChar(uCodePage, 0, lpStr, static_cast<INT>(ulLen), &cRes[0], nLen);
+	return cRes;
+}
+
+// Buffered line reader, returns every line in the ANSI code page
+class REGLINEREADER {
+private:
+	std::istream& isInput;
+	std::vector<CHAR> lpBuffer;
+	size_t ulPos;
+	size_t ulEnd;
+	INT nEncoding;
+
+	BOOL Fill() {
+		if (ulPos < ulEnd) {
+			memmove(lpBuffer.data(), lpBuffer.data() + ulPos, ulEnd - ulPos);
+			ulEnd -= ulPos;
+		}
+		else ulEnd = 0;
+		ulPos = 0;
+		isInput.read(lpBuffer.data() + ulEnd, lpBuffer.size() - ulEnd);
+		size_t ulRead = static_cast<size_t>(isInput.gcount());
+		ulEnd += ulRead;
+		return ulRead != 0;
+	}
+
+public:
+	REGLINEREADER(std::istream& isIn) : isInput(isIn), lpBuffer(65536), ulPos(0), ulEnd(0), nEncoding(REGFILE_ANSI) {
+		Fill();
+		const BYTE* p = reinterpret_cast<const BYTE*>(lpBuffer.data());
+		if (ulEnd >= 2 && p[0] == 0xFF && p[1] == 0xFE) {
+			nEncoding = REGFILE_UTF16;
+			ulPos = 2;
+		}
+		else if (ulEnd >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) {
+			nEncoding = REGFILE_UTF8;
+			ulPos = 3;
+		}
+	}
+
+	BOOL GetLine(std::string* lpLine) {
+		size_t ulUnit = (nEncoding == REGFILE_UTF16 ? 2 : 1);
+		std::string cRaw;
+		BOOL bAny = FALSE;
+		while (1) {
+			if (ulEnd - ulPos < ulUnit && !Fill()) break;
+			if (ulEnd - ulPos < ulUnit) break;
+			bAny = TRUE;
+			size_t i = ulPos;
+			BOOL bFound = FALSE;
+			for (; i + ulUnit <= ulEnd; i += ulUnit) {
+				if (lpBuffer[i] == '\n' && (ulUnit == 1 || lpBuffer[i + 1] == '\0')) {
+					bFound = TRUE;
+					break;
+				}
+			}
+			cRaw.append(lpBuffer.data() + ulPos, i - ulPos);
+			ulPos = (bFound ? i + ulUnit : i);
+			if (bFound) break;
+		}
+		if (!bAny) return FALSE;
+		if (nEncoding == REGFILE_UTF16) {
+			std::wstring wLine(cRaw.size() / 2, L'\0');
+			if (!wLine.empty()) memcpy(&wLine[0], cRaw.data(), wLine.size() * 2);
+			if (!wLine.empty() && wLine.back() == L'\r') wLine.pop_back();
+			*lpLine = WideToAnsi(wLine.data(), wLine.size());
+		}
+		else {
+			if (!cRaw.empty() && cRaw.back() == '\r') cRaw.pop_back();
+			if (nEncoding == REGFILE_UTF8) {
+				std::wstring wLine = MultiByteToWide(CP_UTF8, cRaw.data(), cRaw.size());
+				*lpLine = WideToAnsi(wLine.data(), wLine.size());
+			}
+			else lpLine->swap(cRaw);
+		}
+		return TRUE;
+	}
+};
+
+static void TrimRight(std::string& cStr) {
+	while (!cStr.empty() && (cStr.back() == ' ' || cStr.back() == '\t')) cStr.pop_back();
+}
+static size_t SkipSpace(const std::string& cStr, size_t ulPos) {
+	while (ulPos < cStr.size() && (cStr[ulPos] == ' ' || cStr[ulPos] == '\t')) ulPos++;
+	return ulPos;
+}
+
+// Read a logical line: lines ending with '\' continue on the next line
+static BOOL GetLogicalLine(REGLINEREADER& rReader, std::string* lpLine) {
+	std::string cPart;
+	if (!rReader.GetLine(lpLine)) return FALSE;
+	TrimRight(*lpLine);
+	while (!lpLine->empty() && lpLine->back() == '\\' && (*lpLine)[SkipSpace(*lpLine, 0)] != '[') {
+		lpLine->pop_back();
+		if (!rReader.GetLine(&cPart)) break;
+		TrimRight(cPart);
+		lpLine->append(cPart, SkipSpace(cPart, 0), std::string::npos);
+	}
+	return TRUE;
+}
+
+static BOOL ParseRoot(const std::string& cRoot, HKEY* phRoot) {
+	static LPCSTR lpNames[] = {
+		"HKEY_CLASSES_ROOT", "HKCR", "HKEY_CURRENT_USER", "HKCU", "HKEY_LOCAL_MACHINE", "HKLM", 
+		"HKEY_USERS", "HKU", "HKEY_CURRENT_CONFIG", "HKCC"
+	};
+	for (LPCSTR lpName : lpNames) {
+		if (cRoot == lpName) {
+			*phRoot = StringToHKEY(cRoot);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+// Parse a quoted string starting at cLine[*pulPos] == '"'
+static BOOL ParseQuoted(const std::string& cLine, size_t* pulPos, std::string* lpRes) {
+	size_t i = *pulPos + 1;
+	lpRes->clear();
+	for (; i < cLine.size() && cLine[i] != '"'; i++) {
+		if (cLine[i] == '\\' && i + 1 < cLine.size()) i++;
+		lpRes->push_back(cLine[i]);
+	}
+	if (i >= cLine.size()) return FALSE;
+	*pulPos = i + 1;
+	return TRUE;
+}
+
+// Parse comma separated hex bytes
+static BOOL ParseHexList(const std::string& cLine, size_t ulPos, std::vector<BYTE>* lpRes) {
+	lpRes->clear();
+	while (1) {
+		ulPos = SkipSpace(cLine, ulPos);
+		if (ulPos >= cLine.size()) break;
+		if (ulPos + 1 >= cLine.size() || !isxdigit(static_cast<BYTE>(cLine[ulPos])) || !isxdigit(static_cast<BYTE>(cLine[ulPos + 1]))) return FALSE;
+		lpRes->push_back((HexCharToByte(cLine[ulPos]) << 4) | HexCharToByte(cLine[ulPos + 1]));
+		ulPos = SkipSpace(cLine, ulPos + 2);
+		if (ulPos >= cLine.size()) break;
+		if (cLine[ulPos] != ',') return FALSE;
+		ulPos++;
+	}
+	return TRUE;
+}
+
+static HRESULT ApplyValueLine(const REGKEY& rKey, const std::string& cLine, BOOL bUnicodeData) {
+	std::string cName;
+	size_t ulPos = SkipSpace(cLine, 0);
+	if (cLine[ulPos] == '@') ulPos++;
+	else if (cLine[ulPos] != '"' || !ParseQuoted(cLine, &ulPos, &cName)) return REG_INVAILD_FILE;
+	ulPos = SkipSpace(cLine, ulPos);
+	if (ulPos >= cLine.size() || cLine[ulPos] != '=') return REG_INVAILD_FILE;
+	ulPos = SkipSpace(cLine, ulPos + 1);
+	if (ulPos >= cLine.size()) return REG_INVAILD_FILE;
+
+	if (cLine[ulPos] == '-') {
+		HRESULT hRes = rKey.DeleteValue(cName.c_str());
+		return (hRes == REG_VALUE_NOT_EXIST ? REG_SUCCESS : hRes);
+	}
+	if (cLine[ulPos] == '"') {
+		std::string cData;
+		if (!ParseQuoted(cLine, &ulPos, &cData)) return REG_INVAILD_FILE;
+		return rKey.WriteValue(cName.c_str(), REG_SZ, reinterpret_cast<const BYTE*>(cData.c_str()), static_cast<DWORD>(cData.size() + 1));
+	}
+	if (cLine.compare(ulPos, 6, "dword:") == 0) {
+		std::string cHex = cLine.substr(ulPos + 6);
+		TrimRight(cHex);
+		if (cHex.empty() || cHex.size() > 8) return REG_INVAILD_FILE;
+		for (CHAR c : cHex) {
+			if (!isxdigit(static_cast<BYTE>(c))) return REG_INVAILD_FILE;
+		}
+		DWORD dwVal = static_cast<DWORD>(strtoul(cHex.c_str(), nullptr, 16));
+		return rKey.WriteValue(cName.c_str(), REG_DWORD, reinterpret_cast<const BYTE*>(&dwVal), sizeof(DWORD));
+	}
+	if (cLine.compare(ulPos, 3, "hex") != 0) return REG_INVAILD_FILE;
+	ulPos += 3;
+	DWORD dwType = REG_BINARY;
+	if (ulPos < cLine.size() && cLine[ulPos] == '(') {
+		size_t ulClose = cLine.find(')', ulPos);
+		if (ulClose == std::string::npos || ulClose == ulPos + 1) return REG_INVAILD_FILE;
+		std::string cType = cLine.substr(ulPos + 1, ulClose - ulPos - 1);
+		for (CHAR c : cType) {
+			if (!isxdigit(static_cast<BYTE>(c))) return REG_INVAILD_FILE;
+		}
+		dwType = static_cast<DWORD>(strtoul(cType.c_str(), nullptr, 16));
+		ulPos = ulClose + 1;
+	}
+	if (ulPos >= cLine.size() || cLine[ulPos] != ':') return REG_INVAILD_FILE;
+	std::vector<BYTE> lpData;
+	if (!ParseHexList(cLine, ulPos + 1, &lpData)) return REG_INVAILD_FILE;
+	if (bUnicodeData && (dwType == REG_SZ || dwType == REG_EXPAND_SZ || dwType == REG_MULTI_SZ)) {
+		// Version 5 files store strings as UTF-16LE, REGKEY writes through the ANSI code page
+		std::wstring wData(lpData.size() / 2, L'\0');
+		if (!wData.empty()) memcpy(&wData[0], lpData.data(), wData.size() * 2);
+		std::string cData = WideToAnsi(wData.data(), wData.size());
+		lpData.assign(cData.begin(), cData.end());
+	}
+	return rKey.WriteValue(cName.c_str(), dwType, lpData.data(), static_cast<DWORD>(lpData.size()));
+}
+
+HRESULT ImportRegStream(std::istream& isInput, REGBACKEND* pBackend) {
+	REGLINEREADER rReader(isInput);
+	std::string cLine;
+
+	// Header
+	while (GetLogicalLine(rReader, &cLine) && cLine.empty());
+	BOOL bUnicodeData = FALSE;
+	if (cLine == REGFILE_HEADER5) bUnicodeData = TRUE;
+	else if (cLine != REGFILE_HEADER4) return REG_INVAILD_FILE;
+
+	REGKEY rKey(pBackend);
+	BOOL bSkip = FALSE; // Values after a deleted key are ignored
+	while (GetLogicalLine(rReader, &cLine)) {
+		size_t ulPos = SkipSpace(cLine, 0);
+		if (ulPos >= cLine.size() || cLine[ulPos] == ';') continue;
+
+		if (cLine[ulPos] == '[') {
+			if (rKey.Opened()) rKey.Close();
+			size_t ulClose = cLine.rfind(']');
+			if (ulClose == std::string::npos || ulClose <= ulPos) return REG_INVAILD_FILE;
+			BOOL bDelete = (cLine[ulPos + 1] == '-');
+			std::string cFull = cLine.substr(ulPos + (bDelete ? 2 : 1), ulClose - ulPos - (bDelete ? 2 : 1));
+			size_t ulSlash = cFull.find('\\');
+			HKEY hRoot = nullptr;
+			if (!ParseRoot(cFull.substr(0, ulSlash), &hRoot)) return REG_INVAILD_ROOT;
+			std::string cPath = (ulSlash == std::string::npos ? "" : cFull.substr(ulSlash + 1));
+			HRESULT hRes = REG_SUCCESS;
+			if (bDelete) {
+				hRes = rKey.Open(hRoot, cPath.c_str(), KEY_ALL_ACCESS);
+				if (hRes == REG_SUCCESS) hRes = rKey.DeleteTree();
+				else if (hRes == REG_PATH_NOT_EXIST) hRes = REG_SUCCESS;
+			}
+			else hRes = rKey.Create(hRoot, cPath.c_str(), KEY_READ | KEY_WRITE);
+			if (hRes != REG_SUCCESS) return hRes;
+			bSkip = bDelete;
+			continue;
+		}
+
+		if (bSkip) continue;
+		if (!rKey.Opened()) return REG_INVAILD_FILE;
+		HRESULT hRes = ApplyValueLine(rKey, cLine, bUnicodeData);
+		if (hRes != REG_SUCCESS) return hRes;
+	}
+	return REG_SUCCESS;
+}
+
+HRESULT ImportRegFile(LPCSTR lpFileName, REGBACKEND* pBackend) {
+	if (lpFileName == nullptr) return REG_INVAILD_POINTER;
+	std::ifstream isInput(lpFileName, std::ios::binary);
+	if (!isInput.is_open()) return REG_PATH_NOT_EXIST;
+	return ImportRegStream(isInput, pBackend);
+}
+
+
+// Line writer for ANSI or UTF-16LE output
+class REGLINEWRITER {
+private:
+	std::ostream& osOutput;
+	BOOL bUnicode;
+
+public:
+	REGLINEWRITER(std::ostream& osOut, BOOL bUni) : osOutput(osOut), bUnicode(bUni) {
+		return;
+	}
+	BOOL Unicode() const {
+		return bUnicode;
+	}
+	BOOL Write(const std::string& cLine) {
+		if (!bUnicode) osOutput.write(cLine.data(), cLine.size());
+		else {
+			std::wstring wLine = MultiByteToWide(CP_ACP, cLine.data(), cLine.size());
+			for (WCHAR wChar : wLine) {
+				CHAR lpPair[2] = { static_cast<CHAR>(wChar & 0xFF), static_cast<CHAR>((wChar >> 8) & 0xFF) };
+				osOutput.write(lpPair, 2);
+			}
+		}
+		return osOutput.good();
+	}
+};
+
+static void AppendQuoted(std::string* lpLine, const CHAR* lpStr, size_t ulLen) {
+	lpLine->push_back('"');
+	for (size_t i = 0; i < ulLen; i++) {
+		if (lpStr[i] == '\\' || lpStr[i] == '"') lpLine->push_back('\\');
+		lpLine->push_back(lpStr[i]);
+	}
+	lpLine->push_back('"');
+}
+
+static void FormatValue(std::string* lpLine, const std::string& cName, DWORD dwType, const std::vector<BYTE>& lpData, BOOL bUnicode) {
+	static const CHAR lpHex[] = "0123456789abcdef";
+	lpLine->clear();
+	if (cName.empty()) lpLine->push_back('@');
+	else AppendQuoted(lpLine, cName.data(), cName.size());
+	lpLine->push_back('=');
+
+	if (dwType == REG_SZ && !lpData.empty() && lpData.back() == '\0' && memchr(lpData.data(), '\0', lpData.size() - 1) == nullptr) {
+		AppendQuoted(lpLine, reinterpret_cast<const CHAR*>(lpData.data()), lpData.size() - 1);
+		lpLine->append("\r\n");
+		return;
+	}
+	if (dwType == REG_DWORD && lpData.size() == sizeof(DWORD)) {
+		DWORD dwVal = 0;
+		memcpy(&dwVal, lpData.data(), sizeof(DWORD));
+		CHAR lpNum[16];
+		sprintf_s(lpNum, sizeof lpNum, "dword:%08x", dwVal);
+		lpLine->append(lpNum);
+		lpLine->append("\r\n");
+		return;
+	}
+
+	const BYTE* pData = lpData.data();
+	size_t ulSize = lpData.size();
+	std::wstring wData;
+	if (bUnicode && (dwType == REG_SZ || dwType == REG_EXPAND_SZ || dwType == REG_MULTI_SZ)) {
+		wData = MultiByteToWide(CP_ACP, reinterpret_cast<LPCSTR>(lpData.data()), lpData.size());
+		pData = reinterpret_cast<const BYTE*>(wData.data());
+		ulSize = wData.size() * sizeof(WCHAR);
+	}
+	if (dwType == REG_BINARY) lpLine->append("hex:");
+	else {
+		CHAR lpPrefix[16];
+		sprintf_s(lpPrefix, sizeof lpPrefix, "hex(%x):", dwType);
+		lpLine->append(lpPrefix);
+	}
+	size_t ulLineStart = 0;
+	for (size_t i = 0; i < ulSize; i++) {
+		lpLine->push_back(lpHex[pData[i] >> 4]);
+		lpLine->push_back(lpHex[pData[i] & 0xF]);
+		if (i + 1 == ulSize) break;
+		lpLine->push_back(',');
+		if (lpLine->size() - ulLineStart > REGFILE_LINE_WIDTH) {
+			lpLine->append("\\\r\n  ");
+			ulLineStart = lpLine->size() - 2;
+		}
+	}
+	lpLine->append("\r\n");
+}
+
+static HRESULT ExportKey(const REGKEY& rKey, std::string& cFullPath, REGLINEWRITER& rWriter) {
+	std::string cLine = "\r\n[" + cFullPath + "]\r\n";
+	if (!rWriter.Write(cLine)) return REG_UNKNOWN_ERROR;
+
+	std::string cName;
+	std::vector<BYTE> lpData;
+	for (DWORD dwIndex = 0; ; dwIndex++) {
+		DWORD dwType = 0;
+		HRESULT hRes = rKey.GetValueName(dwIndex, &cName, &dwType);
+		if (hRes == REG_NO_MORE_ITEMS) break;
+		if (hRes != REG_SUCCESS) return hRes;
+		hRes = rKey.ReadValue(cName.c_str(), &dwType, &lpData);
+		if (hRes != REG_SUCCESS) return hRes;
+		FormatValue(&cLine, cName, dwType, lpData, rWriter.Unicode());
+		if (!rWriter.Write(cLine)) return REG_UNKNOWN_ERROR;
+	}
+
+	REGBACKEND* pBackend = nullptr;
+	rKey.GetBackend(&pBackend);
+	for (DWORD dwIndex = 0; ; dwIndex++) {
+		HRESULT hRes = rKey.GetSonName(dwIndex, &cName);
+		if (hRes == REG_NO_MORE_ITEMS) break;
+		if (hRes != REG_SUCCESS) return hRes;
+		REGKEY rSon(pBackend);
+		hRes = rKey.GetSon(cName.c_str(), &rSon, KEY_READ);
+		if (hRes != REG_SUCCESS) return hRes;
+		size_t ulLen = cFullPath.size();
+		cFullPath += "\\" + cName;
+		hRes = ExportKey(rSon, cFullPath, rWriter);
+		cFullPath.resize(ulLen);
+		if (hRes != REG_SUCCESS) return hRes;
+	}
+	return REG_SUCCESS;
+}
+
+HRESULT ExportRegStream(const REGKEY& rKey, std::ostream& osOutput, BOOL bUnicode) {
+	if (!rKey.Opened()) return REG_KEY_NOT_OPENED;
+	HKEY hRoot = nullptr;
+	std::string cPath;
+	rKey.GetRootKey(&hRoot);
+	rKey.GetPath(&cPath);
+	std::string cFullPath = HKEYToString(hRoot);
+	if (!cPath.empty()) cFullPath += "\\" + cPath;
+
+	REGLINEWRITER rWriter(osOutput, bUnicode);
+	if (bUnicode) osOutput.write("\xFF\xFE", 2);
+	if (!rWriter.Write(std::string(bUnicode ? REGFILE_HEADER5 : REGFILE_HEADER4) + "\r\n")) return REG_UNKNOWN_ERROR;
+	HRESULT hRes = ExportKey(rKey, cFullPath, rWriter);
+	if (hRes != REG_SUCCESS) return hRes;
+	if (!rWriter.Write("\r\n")) return REG_UNKNOWN_ERROR;
+	return REG_SUCCESS;
+}
+
+HRESULT ExportRegFile(const REGKEY& rKey, LPCSTR lpFileName, BOOL bUnicode) {
+	if (lpFileName == nullptr) return REG_INVAILD_POINTER;
+	if (!rKey.Opened()) return REG_KEY_NOT_OPENED;
+	std::ofstream osOutput(lpFileName, std::ios::binary | std::ios::trunc);
+	if (!osOutput.is_open()) return REG_ACCESS_DENIED;
+	return ExportRegStream(rKey, osOutput, bUnicode);
+}
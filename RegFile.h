@@ -0,0 +1,48 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGFILE_H
+#define REGFILE_H
+
+#include "RegKey.h"
+#include <istream>
+#include <ostream>
+
+// .reg file import and export
+// Both "REGEDIT4" and "Windows Registry Editor Version 5.00" files are supported, in ANSI, UTF-8 (with BOM)
+// or UTF-16LE (with BOM) encoding, including hex(N) values split over continuation lines.
+// Files are processed line by line: each [key] section is opened once and its values are written as they are read,
+// so the memory used does not depend on the size of the file.
+// pBackend can be empty to use the default backend.
+
+// Import a .reg file
+HRESULT ImportRegFile(LPCSTR lpFileName, REGBACKEND* pBackend);
+// Import .reg data from a stream (opened in binary mode)
+HRESULT ImportRegStream(std::istream& isInput, REGBACKEND* pBackend);
+
+// Export an opened key and all its sub items to a .reg file
+// bUnicode selects the "Windows Registry Editor Version 5.00" UTF-16LE format, otherwise REGEDIT4 (ANSI) is written.
+HRESULT ExportRegFile(const REGKEY& rKey, LPCSTR lpFileName, BOOL bUnicode);
+// Export to a stream (opened in binary mode)
+HRESULT ExportRegStream(const REGKEY& rKey, std::ostream& osOutput, BOOL bUnicode);
+
+#endif
@@ -0,0 +1,236 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegKey.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define REGHEX_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define REGHEX_AVX2
+#else
+#define REGHEX_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static const CHAR lpHexDigits[] = "0123456789ABCDEF";
+
+// Nibble value of every character, 0 for invalid characters (same as HexCharToByte)
+struct HEXTABLE {
+	BYTE lpValue[256];
+};
+static constexpr HEXTABLE MakeHexTable() {
+	HEXTABLE tRes = {};
+	for (INT i = '0'; i <= '9'; i++) tRes.lpValue[i] = static_cast<BYTE>(i - '0');
+	for (INT i = 'a'; i <= 'f'; i++) tRes.lpValue[i] = static_cast<BYTE>(i - 'a' + 10);
+	for (INT i = 'A'; i <= 'F'; i++) tRes.lpValue[i] = static_cast<BYTE>(i - 'A' + 10);
+	return tRes;
+}
+static constexpr HEXTABLE HexTable = MakeHexTable();
+
+static size_t HexEncodeScalar(const BYTE* lpData, size_t ulSize, CHAR* lpOut) {
+	for (size_t i = 0; i < ulSize; i++) {
+		lpOut[i * 2] = lpHexDigits[lpData[i] >> 4];
+		lpOut[i * 2 + 1] = lpHexDigits[lpData[i] & 0xF];
+	}
+	return ulSize * 2;
+}
+
+static size_t HexDecodeScalar(LPCSTR lpHex, size_t ulLen, BYTE* lpOut) {
+	size_t ulSize = ulLen / 2;
+	for (size_t i = 0; i < ulSize; i++) {
+		lpOut[i] = (HexTable.lpValue[static_cast<BYTE>(lpHex[i * 2])] << 4) | HexTable.lpValue[static_cast<BYTE>(lpHex[i * 2 + 1])];
+	}
+	return ulSize;
+}
+
+#ifdef REGHEX_X86
+
+// Nibbles (0-15) to '0'-'9' / 'A'-'F': add '0', then 7 more for values above 9
+static __m128i NibbleToHex128(__m128i vNibble) {
+	__m128i vAlpha = _mm_cmpgt_epi8(vNibble, _mm_set1_epi8(9));
+	return _mm_add_epi8(_mm_add_epi8(vNibble, _mm_set1_epi8('0')), _mm_and_si128(vAlpha, _mm_set1_epi8(7)));
+}
+
+// Hex characters to nibbles, invalid characters become 0
+static __m128i HexToNibble128(__m128i vChar) {
+	__m128i vDigit = _mm_and_si128(_mm_cmpgt_epi8(vChar, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), vChar));
+	__m128i vLower = _mm_or_si128(vChar, _mm_set1_epi8(0x20));
+	__m128i vAlpha = _mm_and_si128(_mm_cmpgt_epi8(vLower, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), vLower));
+	__m128i vDigitVal = _mm_and_si128(vDigit, _mm_sub_epi8(vChar, _mm_set1_epi8('0')));
+	__m128i vAlphaVal = _mm_and_si128(vAlpha, _mm_sub_epi8(vLower, _mm_set1_epi8('a' - 10)));
+	return _mm_or_si128(vDigitVal, vAlphaVal);
+}
+
+static size_t HexEncodeSSE2(const BYTE* lpData, size_t ulSize, CHAR* lpOut) {
+	size_t i = 0;
+	const __m128i vMask = _mm_set1_epi8(0x0F);
+	for (; i + 16 <= ulSize; i += 16) {
+		__m128i vIn = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lpData + i));
+		__m128i vHigh = NibbleToHex128(_mm_and_si128(_mm_srli_epi16(vIn, 4), vMask));
+		__m128i vLow = NibbleToHex128(_mm_and_si128(vIn, vMask));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lpOut + i * 2), _mm_unpacklo_epi8(vHigh, vLow));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lpOut + i * 2 + 16), _mm_unpackhi_epi8(vHigh, vLow));
+	}
+	HexEncodeScalar(lpData + i, ulSize - i, lpOut + i * 2);
+	return ulSize * 2;
+}
+
+static size_t HexDecodeSSE2(LPCSTR lpHex, size_t ulLen, BYTE* lpOut) {
+	size_t ulSize = ulLen / 2;
+	size_t i = 0;
+	const __m128i vEven = _mm_set1_epi16(0x00FF);
+	for (; i + 8 <= ulSize; i += 8) {
+		__m128i vNibble = HexToNibble128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lpHex + i * 2)));
+		// Each 16-bit lane holds (high nibble, low nibble) in memory order
+		__m128i vByte = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(vNibble, vEven), 4), _mm_srli_epi16(vNibble, 8));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(lpOut + i), _mm_packus_epi16(vByte, vByte));
+	}
+	HexDecodeScalar(lpHex + i * 2, (ulSize - i) * 2, lpOut + i);
+	return ulSize;
+}
+
+REGHEX_AVX2 static __m256i NibbleToHex256(__m256i vNibble) {
+	__m256i vAlpha = _mm256_cmpgt_epi8(vNibble, _mm256_set1_epi8(9));
+	return _mm256_add_epi8(_mm256_add_epi8(vNibble, _mm256_set1_epi8('0')), _mm256_and_si256(vAlpha, _mm256_set1_epi8(7)));
+}
+
+REGHEX_AVX2 static __m256i HexToNibble256(__m256i vChar) {
+	__m256i vDigit = _mm256_and_si256(_mm256_cmpgt_epi8(vChar, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), vChar));
+	__m256i vLower = _mm256_or_si256(vChar, _mm256_set1_epi8(0x20));
+	__m256i vAlpha = _mm256_and_si256(_mm256_cmpgt_epi8(vLower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), vLower));
+	__m256i vDigitVal = _mm256_and_si256(vDigit, _mm256_sub_epi8(vChar, _mm256_set1_epi8('0')));
+	__m256i vAlphaVal = _mm256_and_si256(vAlpha, _mm256_sub_epi8(vLower, _mm256_set1_epi8('a' - 10)));
+	return _mm256_or_si256(vDigitVal, vAlphaVal);
+}
+
+REGHEX_AVX2 static size_t HexEncodeAVX2(const BYTE* lpData, size_t ulSize, CHAR* lpOut) {
+	size_t i = 0;
+	const __m256i vMask = _mm256_set1_epi8(0x0F);
+	for (; i + 32 <= ulSize; i += 32) {
+		__m256i vIn = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lpData + i));
+		__m256i vHigh = NibbleToHex256(_mm256_and_si256(_mm256_srli_epi16(vIn, 4), vMask));
+		__m256i vLow = NibbleToHex256(_mm256_and_si256(vIn, vMask));
+		// Unpack works inside 128-bit lanes: put the lanes back in order
+		__m256i vFirst = _mm256_unpacklo_epi8(vHigh, vLow);
+		__m256i vSecond = _mm256_unpackhi_epi8(vHigh, vLow);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lpOut + i * 2), _mm256_permute2x128_si256(vFirst, vSecond, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lpOut + i * 2 + 32), _mm256_permute2x128_si256(vFirst, vSecond, 0x31));
+	}
+	HexEncodeSSE2(lpData + i, ulSize - i, lpOut + i * 2);
+	return ulSize * 2;
+}
+
+REGHEX_AVX2 static size_t HexDecodeAVX2(LPCSTR lpHex, size_t ulLen, BYTE* lpOut) {
+	size_t ulSize = ulLen / 2;
+	size_t i = 0;
+	const __m256i vEven = _mm256_set1_epi16(0x00FF);
+	for (; i + 16 <= ulSize; i += 16) {
+		__m256i vNibble = HexToNibble256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lpHex + i * 2)));
+		__m256i vByte = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(vNibble, vEven), 4), _mm256_srli_epi16(vNibble, 8));
+		// Pack works inside 128-bit lanes: gather the low halves of both lanes
+		__m256i vPacked = _mm256_permute4x64_epi64(_mm256_packus_epi16(vByte, vByte), 0x08);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lpOut + i), _mm256_castsi256_si128(vPacked));
+	}
+	HexDecodeSSE2(lpHex + i * 2, (ulSize - i) * 2, lpOut + i);
+	return ulSize;
+}
+
+static BOOL CpuHasAVX2() {
+#ifdef _MSC_VER
+	INT lpInfo[4];
+	__cpuid(lpInfo, 0);
+	if (lpInfo[0] < 7) return FALSE;
+	__cpuid(lpInfo, 1);
+	// OSXSAVE and AVX, and the OS saves the YMM registers
+	if ((lpInfo[2] & (1 << 27)) == 0 || (lpInfo[2] & (1 << 28)) == 0) return FALSE;
+	if ((_xgetbv(0) & 6) != 6) return FALSE;
+	__cpuidex(lpInfo, 7, 0);
+	return (lpInfo[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+typedef size_t (*HEXENCODEPROC)(const BYTE*, size_t, CHAR*);
+typedef size_t (*HEXDECODEPROC)(LPCSTR, size_t, BYTE*);
+
+struct HEXDISPATCH {
+	HEXENCODEPROC pEncode;
+	HEXDECODEPROC pDecode;
+	HEXDISPATCH() : pEncode(HexEncodeScalar), pDecode(HexDecodeScalar) {
+#ifdef REGHEX_X86
+		pEncode = HexEncodeSSE2;
+		pDecode = HexDecodeSSE2;
+		if (CpuHasAVX2()) {
+			pEncode = HexEncodeAVX2;
+			pDecode = HexDecodeAVX2;
+		}
+#endif
+	}
+};
+
+// Selected on first use, so other static initializers can use the codec
+static const HEXDISPATCH& GetHexDispatch() {
+	static const HEXDISPATCH Dispatch;
+	return Dispatch;
+}
+
+size_t HexEncode(const BYTE* lpData, size_t ulSize, CHAR* lpOut) {
+	return GetHexDispatch().pEncode(lpData, ulSize, lpOut);
+}
+
+size_t HexDecode(LPCSTR lpHex, size_t ulLen, BYTE* lpOut) {
+	return GetHexDispatch().pDecode(lpHex, ulLen, lpOut);
+}
+
+BOOL HexPathSupported(REGHEXPATH ePath) {
+	switch (ePath) {
+	case REG_HEX_SCALAR: return TRUE;
+#ifdef REGHEX_X86
+	case REG_HEX_SSE2: return TRUE;
+	case REG_HEX_AVX2: return CpuHasAVX2();
+#endif
+	default: return FALSE;
+	}
+}
+
+size_t HexEncodeWith(REGHEXPATH ePath, const BYTE* lpData, size_t ulSize, CHAR* lpOut) {
+	if (!HexPathSupported(ePath)) return 0;
+#ifdef REGHEX_X86
+	if (ePath == REG_HEX_SSE2) return HexEncodeSSE2(lpData, ulSize, lpOut);
+	if (ePath == REG_HEX_AVX2) return HexEncodeAVX2(lpData, ulSize, lpOut);
+#endif
+	return HexEncodeScalar(lpData, ulSize, lpOut);
+}
+
+size_t HexDecodeWith(REGHEXPATH ePath, LPCSTR lpHex, size_t ulLen, BYTE* lpOut) {
+	if (!HexPathSupported(ePath)) return 0;
+#ifdef REGHEX_X86
+	if (ePath == REG_HEX_SSE2) return HexDecodeSSE2(lpHex, ulLen, lpOut);
+	if (ePath == REG_HEX_AVX2) return HexDecodeAVX2(lpHex, ulLen, lpOut);
+#endif
+	return HexDecodeScalar(lpHex, ulLen, lpOut);
+}
@@ -0,0 +1,481 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegHive.h"
+
+#define HIVE_BASE_BLOCK_SIZE 0x1000
+#define HIVE_BIG_DATA_SEGMENT 16344
+#define HIVE_KEY_COMP_NAME 0x0020
+#define HIVE_VALUE_COMP_NAME 0x0001
+#define HIVE_NULL_CELL 0xFFFFFFFF
+
+// Key node (nk) field offsets
+#define NK_FLAGS 0x02
+#define NK_SUBKEY_COUNT 0x14
+#define NK_SUBKEY_LIST 0x1C
+#define NK_VALUE_COUNT 0x24
+#define NK_VALUE_LIST 0x28
+#define NK_NAME_LENGTH 0x48
+#define NK_NAME 0x4C
+
+// Key value (vk) field offsets
+#define VK_NAME_LENGTH 0x02
+#define VK_DATA_SIZE 0x04
+#define VK_DATA_OFFSET 0x08
+#define VK_TYPE 0x0C
+#define VK_FLAGS 0x10
+#define VK_NAME 0x14
+
+#define CELL_IS(p, a, b) ((p)[0] == (a) && (p)[1] == (b))
+
+static WORD Read16(const BYTE* p) {
+	WORD wRes;
+	memcpy(&wRes, p, sizeof(WORD));
+	return wRes;
+}
+static DWORD Read32(const BYTE* p) {
+	DWORD dwRes;
+	memcpy(&dwRes, p, sizeof(DWORD));
+	return dwRes;
+}
+static CHAR FoldChar(CHAR c) {
+	return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+// Hash used by lh lists: hash = hash * 37 + upcase(c) over the UTF-16 characters of the name.
+// Only an ASCII name hashes the same from its ANSI form; FALSE is returned for any other name.
+static BOOL HashName(LPCSTR lpName, size_t ulLen, DWORD* pdwHash) {
+	DWORD dwHash = 0;
+	for (size_t i = 0; i < ulLen; i++) {
+		if (static_cast<BYTE>(lpName[i]) >= 0x80) return FALSE;
+		dwHash = dwHash * 37 + static_cast<BYTE>(FoldChar(lpName[i]));
+	}
+	*pdwHash = dwHash;
+	return TRUE;
+}
+
+// Convert a name stored in a cell to the ANSI code page
+static LSTATUS CopyCellName(const BYTE* pName, WORD wLen, BOOL bCompressed, LPSTR lpOut, DWORD* pdwSize) {
+	if (lpOut == nullptr || pdwSize == nullptr || *pdwSize == 0) return ERROR_INVALID_PARAMETER;
+	DWORD dwLen = 0;
+	if (bCompressed) {
+		if (wLen + 1 > *pdwSize) return ERROR_MORE_DATA;
+		memcpy(lpOut, pName, wLen);
+		dwLen = wLen;
+	}
+	else if (wLen != 0) {
+		dwLen = WideCharToMultiByte(CP_ACP, 0, reinterpret_cast<LPCWSTR>(pName), wLen / 2, lpOut, *pdwSize - 1, nullptr, nullptr);
+		if (dwLen == 0) return ERROR_MORE_DATA;
+	}
+	lpOut[dwLen] = '\0';
+	*pdwSize = dwLen;
+	return ERROR_SUCCESS;
+}
+
+// Compare a name stored in a cell with lpName (case-insensitive)
+static BOOL CellNameEquals(const BYTE* pName, WORD wLen, BOOL bCompressed, LPCSTR lpName, size_t ulLen) {
+	if (bCompressed) {
+		if (wLen != ulLen) return FALSE;
+		for (size_t i = 0; i < ulLen; i++) {
+			if (FoldChar(static_cast<CHAR>(pName[i])) != FoldChar(lpName[i])) return FALSE;
+		}
+		return TRUE;
+	}
+	BOOL bAscii = TRUE;
+	if (wLen == ulLen * 2) {
+		for (size_t i = 0; i < ulLen; i++) {
+			WORD wChar = Read16(pName + i * 2);
+			if (wChar >= 0x80 || static_cast<BYTE>(lpName[i]) >= 0x80) {
+				bAscii = FALSE;
+				break;
+			}
+			if (FoldChar(static_cast<CHAR>(wChar)) != FoldChar(lpName[i])) return FALSE;
+		}
+		if (bAscii) return TRUE;
+	}
+	else {
+		// Without non-ASCII characters the UTF-16 length is always twice the ANSI length
+		for (size_t i = 0; i < ulLen; i++) {
+			if (static_cast<BYTE>(lpName[i]) >= 0x80) bAscii = FALSE;
+		}
+		if (bAscii) return FALSE;
+	}
+	CHAR lpBuffer[512];
+	DWORD dwSize = sizeof(lpBuffer);
+	if (CopyCellName(pName, wLen, FALSE, lpBuffer, &dwSize) != ERROR_SUCCESS) return FALSE;
+	if (dwSize != ulLen) return FALSE;
+	for (size_t i = 0; i < ulLen; i++) {
+		if (FoldChar(lpBuffer[i]) != FoldChar(lpName[i])) return FALSE;
+	}
+	return TRUE;
+}
+
+
+REGHIVEBACKEND::REGHIVEBACKEND() : hFile(INVALID_HANDLE_VALUE), hMapping(nullptr), pView(nullptr), ulViewSize(0), 
+	pBins(nullptr), ulBinsSize(0), dwMinorVersion(0), dwRootCell(HIVE_NULL_CELL) {
+	return;
+}
+REGHIVEBACKEND::~REGHIVEBACKEND() {
+	if (Loaded()) Unload();
+}
+
+HRESULT REGHIVEBACKEND::Load(LPCSTR lpFileName) {
+	if (lpFileName == nullptr) return REG_INVAILD_POINTER;
+	if (Loaded()) Unload();
+	hFile = CreateFileA(lpFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		DWORD dwErr = GetLastError();
+		if (dwErr == ERROR_FILE_NOT_FOUND || dwErr == ERROR_PATH_NOT_FOUND) return REG_PATH_NOT_EXIST;
+		if (dwErr == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		return REG_UNKNOWN_ERROR;
+	}
+	LARGE_INTEGER liSize;
+	if (!GetFileSizeEx(hFile, &liSize) || liSize.QuadPart < HIVE_BASE_BLOCK_SIZE) {
+		Unload();
+		return REG_INVAILD_FILE;
+	}
+	hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const BYTE* pImage = (hMapping != nullptr ? static_cast<const BYTE*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr);
+	if (pImage == nullptr) {
+		Unload();
+		return REG_UNKNOWN_ERROR;
+	}
+	HRESULT hRes = Parse(pImage, static_cast<SIZE_T>(liSize.QuadPart));
+	if (hRes != REG_SUCCESS) {
+		UnmapViewOfFile(pImage);
+		Unload();
+	}
+	return hRes;
+}
+
+HRESULT REGHIVEBACKEND::Load(const BYTE* pImage, SIZE_T ulSize) {
+	if (pImage == nullptr) return REG_INVAILD_POINTER;
+	if (Loaded()) Unload();
+	return Parse(pImage, ulSize);
+}
+
+HRESULT REGHIVEBACKEND::Parse(const BYTE* pImage, SIZE_T ulSize) {
+	if (ulSize < HIVE_BASE_BLOCK_SIZE) return REG_INVAILD_FILE;
+	if (memcmp(pImage, "regf", 4) != 0) return REG_INVAILD_FILE;
+	if (Read32(pImage + 0x14) != 1) return REG_INVAILD_FILE;
+	SIZE_T ulDataSize = Read32(pImage + 0x28);
+	if (ulDataSize > ulSize - HIVE_BASE_BLOCK_SIZE) ulDataSize = ulSize - HIVE_BASE_BLOCK_SIZE;
+	pView = pImage;
+	ulViewSize = ulSize;
+	pBins = pImage + HIVE_BASE_BLOCK_SIZE;
+	ulBinsSize = ulDataSize;
+	dwMinorVersion = Read32(pImage + 0x18);
+	dwRootCell = Read32(pImage + 0x24);
+	DWORD dwSize = 0;
+	const BYTE* pRoot = GetCell(dwRootCell, &dwSize);
+	if (pRoot == nullptr || dwSize < NK_NAME || !CELL_IS(pRoot, 'n', 'k')) {
+		pView = nullptr;
+		pBins = nullptr;
+		ulViewSize = ulBinsSize = 0;
+		return REG_INVAILD_FILE;
+	}
+	return REG_SUCCESS;
+}
+
+BOOL REGHIVEBACKEND::Loaded() const {
+	return (pView != nullptr || hFile != INVALID_HANDLE_VALUE);
+}
+
+HRESULT REGHIVEBACKEND::Unload() {
+	if (!Loaded()) return REG_KEY_NOT_OPENED;
+	if (hMapping != nullptr) {
+		if (pView != nullptr) UnmapViewOfFile(pView);
+		CloseHandle(hMapping);
+		hMapping = nullptr;
+	}
+	if (hFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(hFile);
+		hFile = INVALID_HANDLE_VALUE;
+	}
+	pView = nullptr;
+	pBins = nullptr;
+	ulViewSize = ulBinsSize = 0;
+	dwRootCell = HIVE_NULL_CELL;
+	return REG_SUCCESS;
+}
+
+const BYTE* REGHIVEBACKEND::GetCell(DWORD dwOffset, DWORD* pdwSize) const {
+	if (pBins == nullptr || dwOffset == HIVE_NULL_CELL) return nullptr;
+	if (static_cast<SIZE_T>(dwOffset) + 4 > ulBinsSize) return nullptr;
+	LONG lSize = static_cast<LONG>(Read32(pBins + dwOffset));
+	DWORD dwSize = static_cast<DWORD>(lSize < 0 ? -lSize : lSize);
+	if (dwSize < 4 || static_cast<SIZE_T>(dwOffset) + dwSize > ulBinsSize) return nullptr;
+	*pdwSize = dwSize - 4;
+	return pBins + dwOffset + 4;
+}
+
+const BYTE* REGHIVEBACKEND::GetKeyNode(HKEY hKey) const {
+	if (pBins == nullptr) return nullptr;
+	if (hKey == HKEY_CLASSES_ROOT || hKey == HKEY_CURRENT_USER || hKey == HKEY_LOCAL_MACHINE || hKey == HKEY_USERS || hKey == HKEY_CURRENT_CONFIG) {
+		DWORD dwSize = 0;
+		return GetCell(dwRootCell, &dwSize);
+	}
+	const BYTE* pNode = reinterpret_cast<const BYTE*>(hKey);
+	if (pNode < pBins || pNode >= pBins + ulBinsSize) return nullptr;
+	return pNode;
+}
+
+LSTATUS REGHIVEBACKEND::FindInList(const BYTE* pList, DWORD dwListSize, LPCSTR lpName, size_t ulLen, const DWORD* pdwHash, const BYTE** ppOutNode) const {
+	if (dwListSize < 4) return ERROR_FILE_NOT_FOUND;
+	BOOL bHashed = CELL_IS(pList, 'l', 'h');
+	DWORD dwStride = 8;
+	if (CELL_IS(pList, 'l', 'i')) dwStride = 4;
+	else if (!bHashed && !CELL_IS(pList, 'l', 'f')) return ERROR_FILE_NOT_FOUND;
+	DWORD dwCount = Read16(pList + 2);
+	for (DWORD i = 0; i < dwCount && 4 + (i + 1) * dwStride <= dwListSize; i++) {
+		const BYTE* pEntry = pList + 4 + i * dwStride;
+		if (bHashed && pdwHash != nullptr && Read32(pEntry + 4) != *pdwHash) continue;
+		DWORD dwNodeSize = 0;
+		const BYTE* pSon = GetCell(Read32(pEntry), &dwNodeSize);
+		if (pSon == nullptr || dwNodeSize < NK_NAME || !CELL_IS(pSon, 'n', 'k')) continue;
+		WORD wLen = Read16(pSon + NK_NAME_LENGTH);
+		if (NK_NAME + wLen > dwNodeSize) continue;
+		if (CellNameEquals(pSon + NK_NAME, wLen, (Read16(pSon + NK_FLAGS) & HIVE_KEY_COMP_NAME) != 0, lpName, ulLen)) {
+			*ppOutNode = pSon;
+			return ERROR_SUCCESS;
+		}
+	}
+	return ERROR_FILE_NOT_FOUND;
+}
+
+LSTATUS REGHIVEBACKEND::FindSubKey(const BYTE* pNode, LPCSTR lpName, size_t ulLen, const BYTE** ppOutNode) const {
+	if (Read32(pNode + NK_SUBKEY_COUNT) == 0) return ERROR_FILE_NOT_FOUND;
+	// A non-ASCII name is compared with every entry, since its hash depends on the kernel's upcase table
+	DWORD dwHash = 0;
+	const DWORD* pdwHash = (HashName(lpName, ulLen, &dwHash) ? &dwHash : nullptr);
+	DWORD dwListSize = 0;
+	const BYTE* pList = GetCell(Read32(pNode + NK_SUBKEY_LIST), &dwListSize);
+	if (pList == nullptr || dwListSize < 4) return ERROR_FILE_NOT_FOUND;
+	if (!CELL_IS(pList, 'r', 'i')) return FindInList(pList, dwListSize, lpName, ulLen, pdwHash, ppOutNode);
+
+	// An ri list points to other lists, which are searched in turn
+	DWORD dwLists = Read16(pList + 2);
+	for (DWORD l = 0; l < dwLists && 4 + (l + 1) * 4 <= dwListSize; l++) {
+		DWORD dwSize = 0;
+		const BYTE* pCur = GetCell(Read32(pList + 4 + l * 4), &dwSize);
+		if (pCur == nullptr) continue;
+		if (FindInList(pCur, dwSize, lpName, ulLen, pdwHash, ppOutNode) == ERROR_SUCCESS) return ERROR_SUCCESS;
+	}
+	return ERROR_FILE_NOT_FOUND;
+}
+
+LSTATUS REGHIVEBACKEND::GetSubKey(const BYTE* pNode, DWORD dwIndex, const BYTE** ppOutNode) const {
+	if (dwIndex >= Read32(pNode + NK_SUBKEY_COUNT)) return ERROR_NO_MORE_ITEMS;
+	DWORD dwListSize = 0;
+	const BYTE* pList = GetCell(Read32(pNode + NK_SUBKEY_LIST), &dwListSize);
+	if (pList == nullptr || dwListSize < 4) return ERROR_REGISTRY_CORRUPT;
+	if (CELL_IS(pList, 'r', 'i')) {
+		// Skip whole lists until the one containing dwIndex
+		DWORD dwLists = Read16(pList + 2);
+		for (DWORD l = 0; l < dwLists && 4 + (l + 1) * 4 <= dwListSize; l++) {
+			DWORD dwSize = 0;
+			const BYTE* pCur = GetCell(Read32(pList + 4 + l * 4), &dwSize);
+			if (pCur == nullptr || dwSize < 4) return ERROR_REGISTRY_CORRUPT;
+			DWORD dwCount = Read16(pCur + 2);
+			if (dwIndex < dwCount) {
+				pList = pCur;
+				dwListSize = dwSize;
+				break;
+			}
+			dwIndex -= dwCount;
+		}
+		if (CELL_IS(pList, 'r', 'i')) return ERROR_NO_MORE_ITEMS;
+	}
+	DWORD dwStride = (CELL_IS(pList, 'l', 'i') ? 4 : 8);
+	if (dwIndex >= Read16(pList + 2) || 4 + (dwIndex + 1) * dwStride > dwListSize) return ERROR_NO_MORE_ITEMS;
+	DWORD dwNodeSize = 0;
+	const BYTE* pSon = GetCell(Read32(pList + 4 + dwIndex * dwStride), &dwNodeSize);
+	if (pSon == nullptr || dwNodeSize < NK_NAME || !CELL_IS(pSon, 'n', 'k')) return ERROR_REGISTRY_CORRUPT;
+	if (NK_NAME + Read16(pSon + NK_NAME_LENGTH) > dwNodeSize) return ERROR_REGISTRY_CORRUPT;
+	*ppOutNode = pSon;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGHIVEBACKEND::GetValue(const BYTE* pNode, DWORD dwIndex, const BYTE** ppOutValue) const {
+	if (dwIndex >= Read32(pNode + NK_VALUE_COUNT)) return ERROR_NO_MORE_ITEMS;
+	DWORD dwListSize = 0;
+	const BYTE* pList = GetCell(Read32(pNode + NK_VALUE_LIST), &dwListSize);
+	if (pList == nullptr || (dwIndex + 1) * 4 > dwListSize) return ERROR_REGISTRY_CORRUPT;
+	DWORD dwSize = 0;
+	const BYTE* pValue = GetCell(Read32(pList + dwIndex * 4), &dwSize);
+	if (pValue == nullptr || dwSize < VK_NAME || !CELL_IS(pValue, 'v', 'k')) return ERROR_REGISTRY_CORRUPT;
+	if (VK_NAME + Read16(pValue + VK_NAME_LENGTH) > dwSize) return ERROR_REGISTRY_CORRUPT;
+	*ppOutValue = pValue;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGHIVEBACKEND::FindValue(const BYTE* pNode, LPCSTR lpName, const BYTE** ppOutValue) const {
+	size_t ulLen = strlen(lpName);
+	DWORD dwCount = Read32(pNode + NK_VALUE_COUNT);
+	for (DWORD i = 0; i < dwCount; i++) {
+		const BYTE* pValue = nullptr;
+		if (GetValue(pNode, i, &pValue) != ERROR_SUCCESS) continue;
+		WORD wLen = Read16(pValue + VK_NAME_LENGTH);
+		if (CellNameEquals(pValue + VK_NAME, wLen, (Read16(pValue + VK_FLAGS) & HIVE_VALUE_COMP_NAME) != 0, lpName, ulLen)) {
+			*ppOutValue = pValue;
+			return ERROR_SUCCESS;
+		}
+	}
+	return ERROR_FILE_NOT_FOUND;
+}
+
+LSTATUS REGHIVEBACKEND::CopyValueData(const BYTE* pValue, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) const {
+	if (lpData != nullptr && pdwSize == nullptr) return ERROR_INVALID_PARAMETER;
+	DWORD dwType = Read32(pValue + VK_TYPE);
+	DWORD dwRawSize = Read32(pValue + VK_DATA_SIZE);
+	DWORD dwSize = dwRawSize & 0x7FFFFFFF;
+	const BYTE* pSrc = nullptr;
+	std::vector<BYTE> lpGather; // Only used by data split into big data segments
+
+	if (dwRawSize & 0x80000000) {
+		// Small data is stored in the offset field itself
+		if (dwSize > 4) dwSize = 4;
+		pSrc = pValue + VK_DATA_OFFSET;
+	}
+	else if (dwSize != 0) {
+		DWORD dwCellSize = 0;
+		const BYTE* pCell = GetCell(Read32(pValue + VK_DATA_OFFSET), &dwCellSize);
+		if (pCell == nullptr) return ERROR_REGISTRY_CORRUPT;
+		if (dwSize > HIVE_BIG_DATA_SEGMENT && dwMinorVersion >= 4 && dwCellSize >= 8 && CELL_IS(pCell, 'd', 'b')) {
+			DWORD dwSegments = Read16(pCell + 2);
+			DWORD dwListSize = 0;
+			const BYTE* pList = GetCell(Read32(pCell + 4), &dwListSize);
+			if (pList == nullptr) return ERROR_REGISTRY_CORRUPT;
+			lpGather.reserve(dwSize);
+			for (DWORD i = 0; i < dwSegments && (i + 1) * 4 <= dwListSize && lpGather.size() < dwSize; i++) {
+				DWORD dwSegSize = 0;
+				const BYTE* pSeg = GetCell(Read32(pList + i * 4), &dwSegSize);
+				if (pSeg == nullptr) return ERROR_REGISTRY_CORRUPT;
+				DWORD dwTake = dwSize - static_cast<DWORD>(lpGather.size());
+				if (dwTake > HIVE_BIG_DATA_SEGMENT) dwTake = HIVE_BIG_DATA_SEGMENT;
+				if (dwTake > dwSegSize) dwTake = dwSegSize;
+				lpGather.insert(lpGather.end(), pSeg, pSeg + dwTake);
+			}
+			if (lpGather.size() != dwSize) return ERROR_REGISTRY_CORRUPT;
+			pSrc = lpGather.data();
+		}
+		else {
+			if (dwSize > dwCellSize) return ERROR_REGISTRY_CORRUPT;
+			pSrc = pCell;
+		}
+	}
+
+	if (pdwType != nullptr) *pdwType = dwType;
+	if (dwType == REG_SZ || dwType == REG_EXPAND_SZ || dwType == REG_MULTI_SZ) {
+		// UTF-16 in the hive, ANSI for the caller
+		INT nChars = static_cast<INT>(dwSize / 2);
+		DWORD dwNeed = (nChars == 0 ? 0 : WideCharToMultiByte(CP_ACP, 0, reinterpret_cast<LPCWSTR>(pSrc), nChars, nullptr, 0, nullptr, nullptr));
+		if (lpData != nullptr) {
+			if (*pdwSize < dwNeed) {
+				*pdwSize = dwNeed;
+				return ERROR_MORE_DATA;
+			}
+			if (dwNeed != 0) WideCharToMultiByte(CP_ACP, 0, reinterpret_cast<LPCWSTR>(pSrc), nChars, reinterpret_cast<LPSTR>(lpData), dwNeed, nullptr, nullptr);
+		}
+		if (pdwSize != nullptr) *pdwSize = dwNeed;
+		return ERROR_SUCCESS;
+	}
+	if (lpData != nullptr) {
+		if (*pdwSize < dwSize) {
+			*pdwSize = dwSize;
+			return ERROR_MORE_DATA;
+		}
+		if (dwSize != 0) memcpy(lpData, pSrc, dwSize);
+	}
+	if (pdwSize != nullptr) *pdwSize = dwSize;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGHIVEBACKEND::OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	if (phOutKey == nullptr) return ERROR_INVALID_PARAMETER;
+	const BYTE* pNode = GetKeyNode(hParent);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	if (lpPath == nullptr) lpPath = "";
+	LPCSTR p = lpPath;
+	while (*p) {
+		LPCSTR pEnd = strchr(p, '\\');
+		size_t ulLen = (pEnd == nullptr ? strlen(p) : static_cast<size_t>(pEnd - p));
+		if (ulLen != 0) {
+			LSTATUS lRes = FindSubKey(pNode, p, ulLen, &pNode);
+			if (lRes != ERROR_SUCCESS) return (bCreate ? ERROR_ACCESS_DENIED : lRes);
+		}
+		if (pEnd == nullptr) break;
+		p = pEnd + 1;
+	}
+	*phOutKey = reinterpret_cast<HKEY>(const_cast<BYTE*>(pNode));
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGHIVEBACKEND::CloseKey(HKEY hKey) {
+	if (GetKeyNode(hKey) == nullptr) return ERROR_INVALID_HANDLE;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGHIVEBACKEND::DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) {
+	return ERROR_ACCESS_DENIED;
+}
+
+LSTATUS REGHIVEBACKEND::SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	return ERROR_ACCESS_DENIED;
+}
+
+LSTATUS REGHIVEBACKEND::QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	const BYTE* pNode = GetKeyNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	const BYTE* pValue = nullptr;
+	LSTATUS lRes = FindValue(pNode, (lpName == nullptr ? "" : lpName), &pValue);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	return CopyValueData(pValue, pdwType, lpData, pdwSize);
+}
+
+LSTATUS REGHIVEBACKEND::DeleteValue(HKEY hKey, LPCSTR lpName) {
+	return ERROR_ACCESS_DENIED;
+}
+
+LSTATUS REGHIVEBACKEND::EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) {
+	const BYTE* pNode = GetKeyNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	const BYTE* pSon = nullptr;
+	LSTATUS lRes = GetSubKey(pNode, dwIndex, &pSon);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	return CopyCellName(pSon + NK_NAME, Read16(pSon + NK_NAME_LENGTH), (Read16(pSon + NK_FLAGS) & HIVE_KEY_COMP_NAME) != 0, lpName, pdwNameSize);
+}
+
+LSTATUS REGHIVEBACKEND::EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	const BYTE* pNode = GetKeyNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	const BYTE* pValue = nullptr;
+	LSTATUS lRes = GetValue(pNode, dwIndex, &pValue);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	lRes = CopyCellName(pValue + VK_NAME, Read16(pValue + VK_NAME_LENGTH), (Read16(pValue + VK_FLAGS) & HIVE_VALUE_COMP_NAME) != 0, lpName, pdwNameSize);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	return CopyValueData(pValue, pdwType, lpData, pdwSize);
+}
+
+LSTATUS REGHIVEBACKEND::SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) {
+	return ERROR_ACCESS_DENIED;
+}
@@ -0,0 +1,83 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGHIVE_H
+#define REGHIVE_H
+
+#include "RegKey.h"
+
+// Offline hive backend
+// Read-only access to a registry hive file (regf format, such as NTUSER.DAT, SOFTWARE, SYSTEM).
+// The file is mapped into memory and nk/vk/lf/lh/li/ri/db cells are read in place; nothing is copied
+// except into the buffers passed by the caller. Lookups through lh lists compare the name hash first.
+// The root key of the hive is shown as every predefined root key, so
+// REGKEY(&rHive).Open(HKEY_LOCAL_MACHINE, "Microsoft\\Windows", KEY_READ) opens <hive root>\Microsoft\Windows.
+// String data is stored as UTF-16 in the hive and is converted to the ANSI code page like the *A functions do.
+// All write operations return ERROR_ACCESS_DENIED.
+class REGHIVEBACKEND : public REGBACKEND {
+private:
+	HANDLE hFile; // Hive file
+	HANDLE hMapping; // File mapping
+	const BYTE* pView; // Mapped view (or the image given to Load)
+	SIZE_T ulViewSize; // Size of the view
+	const BYTE* pBins; // First hive bin
+	SIZE_T ulBinsSize; // Size of the hive bins data
+	DWORD dwMinorVersion; // Minor version of the hive format
+	DWORD dwRootCell; // Offset of the root key cell
+
+	HRESULT Parse(const BYTE* pImage, SIZE_T ulSize);
+	const BYTE* GetCell(DWORD dwOffset, DWORD* pdwSize) const;
+	const BYTE* GetKeyNode(HKEY hKey) const;
+	LSTATUS FindInList(const BYTE* pList, DWORD dwListSize, LPCSTR lpName, size_t ulLen, const DWORD* pdwHash, const BYTE** ppOutNode) const;
+	LSTATUS FindSubKey(const BYTE* pNode, LPCSTR lpName, size_t ulLen, const BYTE** ppOutNode) const;
+	LSTATUS GetSubKey(const BYTE* pNode, DWORD dwIndex, const BYTE** ppOutNode) const;
+	LSTATUS FindValue(const BYTE* pNode, LPCSTR lpName, const BYTE** ppOutValue) const;
+	LSTATUS GetValue(const BYTE* pNode, DWORD dwIndex, const BYTE** ppOutValue) const;
+	LSTATUS CopyValueData(const BYTE* pValue, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) const;
+
+public:
+	REGHIVEBACKEND();
+	REGHIVEBACKEND(const REGHIVEBACKEND&) = delete;
+	REGHIVEBACKEND& operator=(const REGHIVEBACKEND&) = delete;
+	~REGHIVEBACKEND();
+
+	// Map a hive file
+	HRESULT Load(LPCSTR lpFileName);
+	// Use a hive image that is already in memory. The memory must stay valid until Unload.
+	HRESULT Load(const BYTE* pImage, SIZE_T ulSize);
+	// Whether a hive is loaded
+	BOOL Loaded() const;
+	// Unmap the hive. Keys opened from it must not be used any more.
+	HRESULT Unload();
+
+	LSTATUS OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override;
+	LSTATUS CloseKey(HKEY hKey) override;
+	LSTATUS DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) override;
+	LSTATUS SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) override;
+	LSTATUS QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS DeleteValue(HKEY hKey, LPCSTR lpName) override;
+	LSTATUS EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) override;
+	LSTATUS EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) override;
+};
+
+#endif
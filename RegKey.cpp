@@ -21,11 +21,21 @@
 // SOFTWARE.
 
 #include "RegKey.h"
+#include "RegMetrics.h"
+#include "RegPath.h"
+#include "RegPool.h"
 #include <aclapi.h>
+#include <algorithm>
 #include <tchar.h>
 
 #define REG_VAILD_ROOTKEY(i) ((i) == HKEY_CLASSES_ROOT || (i) == HKEY_CURRENT_USER || (i) == HKEY_LOCAL_MACHINE || (i) == HKEY_USERS || (i) == HKEY_CURRENT_CONFIG)
-#define REG_VAILD_PATH(i) ((i).size() <= MAX_PATH)
+#define REG_MAX_PATH_LEN 32767 // Longest key path (characters)
+#define REG_MAX_VALUE_NAME_LEN 16383 // Longest value name (characters)
+#define REG_VAILD_PATH(i) ((i).size() <= REG_MAX_PATH_LEN)
+#define REG_MAX_NAME_BUFFER ((REG_MAX_VALUE_NAME_LEN + 1) * 2) // Largest name buffer (bytes of a value name in a double-byte code page)
+#define REG_MIN_NAME_BUFFER 256 // Name buffer used before the key was queried
+// Largest string whose data size (with the terminator) fits in a DWORD
+#define REG_VAILD_STR_LEN(i) ((i) < 0xFFFFFFFFull / sizeof(CHAR))
 #define DEC(i) if (dwType == D##i) return #i;
 
 BYTE HexCharToByte(CHAR cHex) {
@@ -36,17 +46,18 @@ BYTE HexCharToByte(CHAR cHex) {
 }
 
 std::vector<BYTE> HexStringToByteArray(LPCSTR lpHex) {
-	std::vector<BYTE> bytes;
 	size_t len = strlen(lpHex);
-	for (size_t i = 0; i < len; i += 2) {
-		BYTE highNibble = HexCharToByte(lpHex[i]);
-		BYTE lowNibble = HexCharToByte(lpHex[i + 1]);
-		BYTE bNow = (highNibble << 4) | lowNibble;
-		bytes.push_back(bNow);
-	}
+	std::vector<BYTE> bytes(len / 2);
+	HexDecode(lpHex, len, bytes.data());
 	return bytes;
 }
 
+std::string ByteArrayToHexString(const BYTE* lpData, size_t ulSize) {
+	std::string cRes(ulSize * 2, '\0');
+	if (ulSize != 0) HexEncode(lpData, ulSize, &cRes[0]);
+	return cRes;
+}
+
 
 HKEY StringToHKEY(std::string lpStr) {
 	if (lpStr == "HKEY_CLASSES_ROOT" || lpStr == "HKCR") return HKEY_CLASSES_ROOT;
@@ -86,49 +97,187 @@ std::string TypeToString(DWORD dwType) {
 }
 
 
-HRESULT REGKEY::Create(HKEY hInRootKey, LPCSTR lpInPath, REGSAM ulInSam) {
-	if (!REG_VAILD_ROOTKEY(hInRootKey)) return REG_INVAILD_ROOT;
-	if (hInRootKey == 0) return REG_INVAILD_ROOT;
-	HRESULT hRes = RegCreateKeyExA(
-		hInRootKey, 
-		lpInPath, 
-		0, 
-		nullptr, 
-		REG_OPTION_NON_VOLATILE, 
-		ulInSam, 
-		nullptr, 
-		&hKey, 
-		nullptr
-	);
-	if (hRes != ERROR_SUCCESS) {
-		hKey = NULL;
-		return REG_UNKNOWN_ERROR;
+LSTATUS REGWIN32BACKEND::OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	if (bCreate) return RegCreateKeyExA(hParent, lpPath, 0, nullptr, REG_OPTION_NON_VOLATILE, ulSam, nullptr, phOutKey, nullptr);
+	return RegOpenKeyExA(hParent, lpPath, 0, ulSam, phOutKey);
+}
+LSTATUS REGWIN32BACKEND::CloseKey(HKEY hKey) {
+	return RegCloseKey(hKey);
+}
+LSTATUS REGWIN32BACKEND::DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) {
+	return RegDeleteKeyExA(hKey, lpSubKey, ulSam, 0);
+}
+LSTATUS REGWIN32BACKEND::SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	return RegSetValueExA(hKey, lpName, 0, dwType, lpData, dwSize);
+}
+LSTATUS REGWIN32BACKEND::QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	return RegQueryValueExA(hKey, lpName, nullptr, pdwType, lpData, pdwSize);
+}
+LSTATUS REGWIN32BACKEND::DeleteValue(HKEY hKey, LPCSTR lpName) {
+	return RegDeleteValueA(hKey, lpName);
+}
+LSTATUS REGWIN32BACKEND::EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) {
+	return RegEnumKeyExA(hKey, dwIndex, lpName, pdwNameSize, nullptr, nullptr, nullptr, nullptr);
+}
+LSTATUS REGWIN32BACKEND::EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	return RegEnumValueA(hKey, dwIndex, lpName, pdwNameSize, nullptr, pdwType, lpData, pdwSize);
+}
+LSTATUS REGWIN32BACKEND::SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) {
+	return RegSetKeySecurity(hKey, ulInfo, pSD);
+}
+LSTATUS REGWIN32BACKEND::QueryMultipleValues(HKEY hKey, VALENTA* pValues, DWORD dwCount, LPSTR lpBuffer, DWORD* pdwTotalSize) {
+	return RegQueryMultipleValuesA(hKey, pValues, dwCount, lpBuffer, pdwTotalSize);
+}
+LSTATUS REGWIN32BACKEND::QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo) {
+	if (pInfo == nullptr) return ERROR_INVALID_PARAMETER;
+	return RegQueryInfoKeyA(hKey, nullptr, nullptr, nullptr, &pInfo->dwSubKeys, &pInfo->dwMaxSubKeyLen, nullptr,
+		&pInfo->dwValues, &pInfo->dwMaxValueNameLen, &pInfo->dwMaxValueLen, nullptr, nullptr);
+}
+LSTATUS REGWIN32BACKEND::OpenKeyW(HKEY hParent, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	if (bCreate) return RegCreateKeyExW(hParent, lpPath, 0, nullptr, REG_OPTION_NON_VOLATILE, ulSam, nullptr, phOutKey, nullptr);
+	return RegOpenKeyExW(hParent, lpPath, 0, ulSam, phOutKey);
+}
+LSTATUS REGWIN32BACKEND::SetValueW(HKEY hKey, LPCWSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	return RegSetValueExW(hKey, lpName, 0, dwType, lpData, dwSize);
+}
+LSTATUS REGWIN32BACKEND::QueryValueW(HKEY hKey, LPCWSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	return RegQueryValueExW(hKey, lpName, nullptr, pdwType, lpData, pdwSize);
+}
+LSTATUS REGWIN32BACKEND::DeleteValueW(HKEY hKey, LPCWSTR lpName) {
+	return RegDeleteValueW(hKey, lpName);
+}
+
+LSTATUS REGBACKEND::QueryMultipleValues(HKEY hKey, VALENTA* pValues, DWORD dwCount, LPSTR lpBuffer, DWORD* pdwTotalSize) {
+	if (pValues == nullptr || pdwTotalSize == nullptr) return ERROR_INVALID_PARAMETER;
+	// Sizes first, so that nothing is written when the buffer is too small
+	DWORD dwTotal = 0;
+	for (DWORD i = 0; i < dwCount; i++) {
+		DWORD dwSize = 0;
+		LSTATUS lRes = QueryValue(hKey, pValues[i].ve_valuename, &pValues[i].ve_type, nullptr, &dwSize);
+		if (lRes != ERROR_SUCCESS) return lRes;
+		pValues[i].ve_valuelen = dwSize;
+		dwTotal += dwSize;
+	}
+	if (lpBuffer == nullptr || *pdwTotalSize < dwTotal) {
+		*pdwTotalSize = dwTotal;
+		return ERROR_MORE_DATA;
+	}
+	DWORD dwOffset = 0;
+	for (DWORD i = 0; i < dwCount; i++) {
+		DWORD dwSize = *pdwTotalSize - dwOffset;
+		LSTATUS lRes = QueryValue(hKey, pValues[i].ve_valuename, &pValues[i].ve_type, reinterpret_cast<BYTE*>(lpBuffer + dwOffset), &dwSize);
+		if (lRes == ERROR_MORE_DATA) {
+			// A value grew since its size was queried
+			*pdwTotalSize = dwTotal + dwSize;
+			return ERROR_MORE_DATA;
+		}
+		if (lRes != ERROR_SUCCESS) return lRes;
+		pValues[i].ve_valuelen = dwSize;
+		pValues[i].ve_valueptr = reinterpret_cast<DWORD_PTR>(lpBuffer + dwOffset);
+		dwOffset += dwSize;
+	}
+	*pdwTotalSize = dwOffset;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGBACKEND::QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo) {
+	if (pInfo == nullptr) return ERROR_INVALID_PARAMETER;
+	REGKEYINFO iInfo = { 0, 0, 0, 0, 0 };
+	std::vector<CHAR> vName(REG_MIN_NAME_BUFFER);
+	LSTATUS lRes = ERROR_SUCCESS;
+	for (DWORD dwIndex = 0;; dwIndex++) {
+		DWORD dwNameSize = static_cast<DWORD>(vName.size());
+		lRes = EnumKey(hKey, dwIndex, vName.data(), &dwNameSize);
+		if (lRes == ERROR_MORE_DATA && vName.size() < REG_MAX_NAME_BUFFER) {
+			vName.resize(vName.size() * 2);
+			dwIndex--;
+			continue;
+		}
+		if (lRes != ERROR_SUCCESS) break;
+		iInfo.dwSubKeys++;
+		if (dwNameSize > iInfo.dwMaxSubKeyLen) iInfo.dwMaxSubKeyLen = dwNameSize;
+	}
+	if (lRes != ERROR_NO_MORE_ITEMS) return lRes;
+	for (DWORD dwIndex = 0;; dwIndex++) {
+		DWORD dwNameSize = static_cast<DWORD>(vName.size()), dwSize = 0;
+		lRes = EnumValue(hKey, dwIndex, vName.data(), &dwNameSize, nullptr, nullptr, &dwSize);
+		if (lRes == ERROR_MORE_DATA && vName.size() < REG_MAX_NAME_BUFFER) {
+			vName.resize(vName.size() * 2);
+			dwIndex--;
+			continue;
+		}
+		if (lRes != ERROR_SUCCESS) break;
+		iInfo.dwValues++;
+		if (dwNameSize > iInfo.dwMaxValueNameLen) iInfo.dwMaxValueNameLen = dwNameSize;
+		if (dwSize > iInfo.dwMaxValueLen) iInfo.dwMaxValueLen = dwSize;
 	}
+	if (lRes != ERROR_NO_MORE_ITEMS) return lRes;
+	*pInfo = iInfo;
+	return ERROR_SUCCESS;
+}
+
+static REGWIN32BACKEND Win32Backend;
+static REGBACKEND* pDefaultBackend = &Win32Backend;
+
+REGBACKEND* GetWin32RegBackend() {
+	return &Win32Backend;
+}
+REGBACKEND* GetDefaultRegBackend() {
+	return pDefaultBackend;
+}
+void SetDefaultRegBackend(REGBACKEND* pBackend) {
+	pDefaultBackend = (pBackend != nullptr ? pBackend : &Win32Backend);
+}
+
+
+// Replace the current handle with a handle from the pool
+void REGKEY::Attach(REGHANDLE* pNewHandle, HKEY hInRootKey, REGPATHID idInPath, REGSAM ulInSam) {
+	GetRegPathTable()->AddRef(idInPath);
+	if (Opened()) Close();
+	pHandle = pNewHandle;
+	hKey = pNewHandle->hKey;
 	hRootKey = hInRootKey;
-	cPath = lpInPath;
+	idPath = idInPath;
 	ulSam = ulInSam;
+}
+
+// Open or create a key through the handle pool and replace the current handle with it
+HRESULT REGKEY::Acquire(HKEY hInRootKey, REGPATHID idInPath, REGSAM ulInSam, BOOL bCreate, BOOL bWide, LSTATUS* plRes) {
+	REGHANDLE* pNewHandle = nullptr;
+	LSTATUS lRes = ERROR_SUCCESS;
+	if (bWide) lRes = GetRegHandlePool()->AcquireW(pBackend, hInRootKey, idInPath, ulInSam, bCreate, &pNewHandle);
+	else lRes = GetRegHandlePool()->Acquire(pBackend, hInRootKey, idInPath, ulInSam, bCreate, &pNewHandle);
+	*plRes = lRes;
+	REG_METRIC_STATUS(lRes);
+	if (lRes != ERROR_SUCCESS) {
+		if (Opened()) Close();
+		return REG_UNKNOWN_ERROR;
+	}
+	Attach(pNewHandle, hInRootKey, idInPath, ulInSam);
 	return REG_SUCCESS;
 }
 
+HRESULT REGKEY::Create(HKEY hInRootKey, LPCSTR lpInPath, REGSAM ulInSam) {
+	REG_METRIC_SCOPE(REG_METRIC_OPEN, hInRootKey);
+	LSTATUS lRes = ERROR_SUCCESS;
+	if (!REG_VAILD_ROOTKEY(hInRootKey)) return REG_INVAILD_ROOT;
+	if (hInRootKey == 0) return REG_INVAILD_ROOT;
+	REGPATHID idInPath = GetRegPathTable()->Intern(lpInPath == nullptr ? "" : lpInPath);
+	HRESULT hRes = Acquire(hInRootKey, idInPath, ulInSam, TRUE, FALSE, &lRes);
+	GetRegPathTable()->Release(idInPath);
+	return hRes;
+}
+
 HRESULT REGKEY::Open(HKEY hInRootKey, LPCSTR lpInPath, REGSAM ulInSam) {
+	REG_METRIC_SCOPE(REG_METRIC_OPEN, hInRootKey);
+	LSTATUS lRes = ERROR_SUCCESS;
 	if (!REG_VAILD_ROOTKEY(hInRootKey)) return REG_INVAILD_ROOT;
 	if (hInRootKey == 0) return REG_INVAILD_ROOT;
-	HRESULT hRes = RegOpenKeyExA(
-		hInRootKey, 
-		lpInPath, 
-		0, 
-		ulInSam, 
-		&hKey
-	);
-	if (hRes != ERROR_SUCCESS) {
-		hKey = NULL;
-		if (hRes == ERROR_FILE_NOT_FOUND) return REG_PATH_NOT_EXIST;
-		return REG_UNKNOWN_ERROR;
-	}
-	hRootKey = hInRootKey;
-	cPath = lpInPath;
-	ulSam = ulInSam;
-	return REG_SUCCESS;
+	REGPATHID idInPath = GetRegPathTable()->Intern(lpInPath == nullptr ? "" : lpInPath);
+	HRESULT hRes = Acquire(hInRootKey, idInPath, ulInSam, FALSE, FALSE, &lRes);
+	GetRegPathTable()->Release(idInPath);
+	if (lRes == ERROR_FILE_NOT_FOUND) return REG_PATH_NOT_EXIST;
+	return hRes;
 }
 
 BOOL REGKEY::Opened() const {
@@ -137,12 +286,15 @@ BOOL REGKEY::Opened() const {
 }
 
 HRESULT REGKEY::Close() {
+	REG_METRIC_SCOPE(REG_METRIC_CLOSE, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
-	HRESULT hRes = RegCloseKey(hKey);
+	HRESULT hRes = GetRegHandlePool()->Release(pHandle);
 	hKey = NULL;
+	pHandle = nullptr;
+	GetRegPathTable()->Release(idPath);
+	idPath = REG_PATH_EMPTY;
 	if (hRes != ERROR_SUCCESS) return REG_UNKNOWN_ERROR;
 	hRootKey = NULL;
-	cPath = "";
 	ulSam = 0;
 	return REG_SUCCESS;
 }
@@ -156,71 +308,125 @@ HRESULT REGKEY::GetRootKey(HKEY* phOutKey) const {
 
 HRESULT REGKEY::GetPath(std::string* lpOutPath) const {
 	if (lpOutPath == nullptr) return REG_INVAILD_POINTER;
-	*lpOutPath = cPath;
+	GetRegPathTable()->GetPath(idPath, lpOutPath);
+	if (IsWide()) Utf8ToAnsi(lpOutPath);
 	return REG_SUCCESS;
 }
 
+BOOL REGKEY::IsWide() const {
+	return pHandle != nullptr && pHandle->kId.bWide;
+}
+
 HRESULT REGKEY::GetSam(REGSAM* pulOutSam) const {
 	if (pulOutSam == nullptr) return REG_INVAILD_POINTER;
 	*pulOutSam = ulSam;
 	return REG_SUCCESS;
 }
 
+HRESULT REGKEY::GetBackend(REGBACKEND** ppOutBackend) const {
+	if (ppOutBackend == nullptr) return REG_INVAILD_POINTER;
+	*ppOutBackend = pBackend;
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::SetBackend(REGBACKEND* pInBackend) {
+	if (pInBackend == nullptr) return REG_INVAILD_POINTER;
+	if (Opened()) Close();
+	pBackend = pInBackend;
+	return REG_SUCCESS;
+}
+
 HRESULT REGKEY::GetParent(REGKEY* pFather, REGSAM hInSam) const {
-	REGKEY rFather;
-	size_t LastKey = cPath.find_last_of("\\");
-	if (LastKey == std::string::npos) return REG_KEY_IS_ROOT;
-	std::string NewPath = cPath.substr(0, LastKey);
+	REG_METRIC_SCOPE(REG_METRIC_OPEN, hRootKey);
+	REGKEY rFather(pBackend);
+	REGPATHID idParent = GetRegPathTable()->GetParent(idPath);
+	if (idPath == REG_PATH_EMPTY || idParent == REG_PATH_EMPTY) return REG_KEY_IS_ROOT;
 	if (pFather == nullptr) return REG_INVAILD_POINTER;
-	HRESULT hRes = rFather.Open(hRootKey, NewPath.c_str(), hInSam);
+	LSTATUS lRes = ERROR_SUCCESS;
+	HRESULT hRes = rFather.Acquire(hRootKey, idParent, hInSam, FALSE, IsWide(), &lRes);
+	if (lRes == ERROR_FILE_NOT_FOUND) return REG_PATH_NOT_EXIST;
 	if (hRes != REG_SUCCESS) return hRes;
-	*pFather = REGKEY(rFather);
+	*pFather = std::move(rFather);
 	return REG_SUCCESS;
 }
 
 HRESULT REGKEY::GetSon(LPCSTR lpName, REGKEY* pSon, REGSAM hInSam) const {
-	REGKEY rSon;
-	std::string NewPath = cPath + "\\" + lpName;
-	if (pSon == nullptr) return REG_INVAILD_POINTER;
-	HRESULT hRes = rSon.Open(hRootKey, NewPath.c_str(), hInSam);
-	if (hRes != REG_SUCCESS) return hRes;
-	*pSon = REGKEY(rSon);
+	REG_METRIC_SCOPE(REG_METRIC_OPEN, hRootKey);
+	if (pSon == nullptr || lpName == nullptr) return REG_INVAILD_POINTER;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	// A key that is not pooled yet is opened relative to this one, without building its full path
+	REGPATHID idSon = AppendName(idPath, IsWide(), lpName);
+	REGHANDLE* pNewHandle = nullptr;
+	LSTATUS lRes = GetRegHandlePool()->AcquireSub(pHandle, idSon, lpName, hInSam, &pNewHandle);
+	REG_METRIC_STATUS(lRes);
+	if (lRes != ERROR_SUCCESS) GetRegPathTable()->Release(idSon);
+	if (lRes == ERROR_FILE_NOT_FOUND) return REG_PATH_NOT_EXIST;
+	if (lRes != ERROR_SUCCESS) return REG_UNKNOWN_ERROR;
+	REGKEY rSon(pBackend);
+	rSon.Attach(pNewHandle, hRootKey, idSon, hInSam);
+	GetRegPathTable()->Release(idSon);
+	*pSon = std::move(rSon);
 	return REG_SUCCESS;
 }
 
 
-REGKEY::REGKEY() : hKey(nullptr), hRootKey(nullptr), ulSam(0), cPath("") {
+REGKEY::REGKEY() : hKey(nullptr), hRootKey(nullptr), ulSam(0), idPath(REG_PATH_EMPTY), pBackend(GetDefaultRegBackend()), pHandle(nullptr) {
 	return;
 }
-REGKEY::REGKEY(HKEY hInRootKey, LPCSTR lpInPath, REGSAM ulInSam, BOOL bCreateIfNotExist) : hKey(nullptr), hRootKey(nullptr), ulSam(0), cPath("") {
+REGKEY::REGKEY(REGBACKEND* pInBackend) : hKey(nullptr), hRootKey(nullptr), ulSam(0), idPath(REG_PATH_EMPTY), pBackend(pInBackend), pHandle(nullptr) {
+	if (pBackend == nullptr) pBackend = GetDefaultRegBackend();
+}
+REGKEY::REGKEY(HKEY hInRootKey, LPCSTR lpInPath, REGSAM ulInSam, BOOL bCreateIfNotExist) : hKey(nullptr), hRootKey(nullptr), ulSam(0), idPath(REG_PATH_EMPTY), pBackend(GetDefaultRegBackend()), pHandle(nullptr) {
 	if (!REG_VAILD_PATH(std::string(lpInPath))) return;
-	HRESULT hRes = 0;
-	if (bCreateIfNotExist) hRes = Create(hInRootKey, lpInPath, ulInSam);
-	else hRes = Open(hInRootKey, lpInPath, ulInSam);
-	if (hRes == REG_SUCCESS) {
-		ulSam = ulInSam;
-		hRootKey = hInRootKey;
-		cPath = lpInPath;
-	}
+	if (bCreateIfNotExist) Create(hInRootKey, lpInPath, ulInSam);
+	else Open(hInRootKey, lpInPath, ulInSam);
 }
-REGKEY::REGKEY(const REGKEY& rOther) : hKey(nullptr), hRootKey(nullptr), ulSam(0), cPath("") {
+REGKEY::REGKEY(const REGKEY& rOther) : hKey(nullptr), hRootKey(nullptr), ulSam(0), idPath(REG_PATH_EMPTY), pBackend(rOther.pBackend), pHandle(nullptr) {
 	if (!rOther.Opened()) return;
-	if (!REG_VAILD_PATH(rOther.cPath)) return;
-	if (Open(rOther.hRootKey, rOther.cPath.c_str(), rOther.ulSam) == REG_SUCCESS) {
-		ulSam = rOther.ulSam;
-		hRootKey = rOther.hRootKey;
-		cPath = rOther.cPath;
-	}
+	// Share the handle instead of opening the key again
+	GetRegHandlePool()->AddRef(rOther.pHandle);
+	GetRegPathTable()->AddRef(rOther.idPath);
+	pHandle = rOther.pHandle;
+	hKey = rOther.hKey;
+	hRootKey = rOther.hRootKey;
+	idPath = rOther.idPath;
+	ulSam = rOther.ulSam;
+}
+REGKEY::REGKEY(REGKEY&& rOther) noexcept : hKey(rOther.hKey), hRootKey(rOther.hRootKey), ulSam(rOther.ulSam), idPath(rOther.idPath), pBackend(rOther.pBackend), pHandle(rOther.pHandle) {
+	rOther.hKey = NULL;
+	rOther.hRootKey = NULL;
+	rOther.idPath = REG_PATH_EMPTY;
+	rOther.ulSam = 0;
+	rOther.pHandle = nullptr;
 }
 REGKEY& REGKEY::operator=(const REGKEY& rOther) {
 	if (!rOther.Opened()) return *this;
-	if (!REG_VAILD_PATH(rOther.cPath)) return *this;
+	if (this == &rOther) return *this;
+	GetRegHandlePool()->AddRef(rOther.pHandle);
+	GetRegPathTable()->AddRef(rOther.idPath);
 	if (Opened()) Close();
-	if (Open(rOther.hRootKey, rOther.cPath.c_str(), rOther.ulSam) == REG_SUCCESS) {
-		ulSam = rOther.ulSam;
-		hRootKey = rOther.hRootKey;
-		cPath = rOther.cPath;
-	}
+	pBackend = rOther.pBackend;
+	pHandle = rOther.pHandle;
+	hKey = rOther.hKey;
+	hRootKey = rOther.hRootKey;
+	idPath = rOther.idPath;
+	ulSam = rOther.ulSam;
+	return *this;
+}
+REGKEY& REGKEY::operator=(REGKEY&& rOther) noexcept {
+	if (this == &rOther) return *this;
+	if (Opened()) Close();
+	pBackend = rOther.pBackend;
+	pHandle = rOther.pHandle;
+	hKey = rOther.hKey;
+	hRootKey = rOther.hRootKey;
+	idPath = rOther.idPath;
+	ulSam = rOther.ulSam;
+	rOther.hKey = NULL;
+	rOther.hRootKey = NULL;
+	rOther.idPath = REG_PATH_EMPTY;
+	rOther.ulSam = 0;
+	rOther.pHandle = nullptr;
 	return *this;
 }
 REGKEY::~REGKEY() {
@@ -228,127 +434,198 @@ REGKEY::~REGKEY() {
 }
 
 HRESULT REGKEY::WriteREGSZ(LPCSTR lpName, LPCSTR lpVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (lpVal == nullptr) return REG_INVAILD_VALUE;
-	if (strlen(lpVal) > 0xff) return REG_STR_TOO_LONG;
-	HRESULT hRes = RegSetValueExA(
+	size_t ulLen = strlen(lpVal);
+	if (!REG_VAILD_STR_LEN(ulLen)) return REG_STR_TOO_LONG;
+	HRESULT hRes = pBackend->SetValue(
 		hKey, 
 		lpName, 
-		0, 
 		REG_SZ, 
 		reinterpret_cast<const BYTE*>(lpVal), 
-		(DWORD)(strlen(lpVal) + 1) * sizeof(CHAR)
+		(DWORD)(ulLen + 1) * sizeof(CHAR)
 	);
+	REG_METRIC_STATUS(hRes);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
 		return REG_UNKNOWN_ERROR;
 	}
+	REG_METRIC_BYTES_WRITTEN((ulLen + 1) * sizeof(CHAR));
 	return REG_SUCCESS;
 }
 
 HRESULT REGKEY::WriteREGEXPANDSZ(LPCSTR lpName, LPCSTR lpVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (lpVal == nullptr) return REG_INVAILD_VALUE;
-	if (strlen(lpVal) > 0xff) return REG_STR_TOO_LONG;
-	HRESULT hRes = RegSetValueExA(
+	size_t ulLen = strlen(lpVal);
+	if (!REG_VAILD_STR_LEN(ulLen)) return REG_STR_TOO_LONG;
+	HRESULT hRes = pBackend->SetValue(
 		hKey,
 		lpName,
-		0,
 		REG_EXPAND_SZ,
 		reinterpret_cast<const BYTE*>(lpVal),
-		(DWORD)(strlen(lpVal) + 1) * sizeof(CHAR)
+		(DWORD)(ulLen + 1) * sizeof(CHAR)
 	);
+	REG_METRIC_STATUS(hRes);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
 		return REG_UNKNOWN_ERROR;
 	}
+	REG_METRIC_BYTES_WRITTEN((ulLen + 1) * sizeof(CHAR));
 	return REG_SUCCESS;
 }
 
 HRESULT REGKEY::WriteREGDWORD(LPCSTR lpName, DWORD dwVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
-	HRESULT hRes = RegSetValueExA(
+	HRESULT hRes = pBackend->SetValue(
 		hKey,
 		lpName,
-		0,
 		REG_DWORD,
 		reinterpret_cast<const BYTE*>(&dwVal),
 		sizeof(DWORD)
 	);
+	REG_METRIC_STATUS(hRes);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
 		return REG_UNKNOWN_ERROR;
 	}
+	REG_METRIC_BYTES_WRITTEN(sizeof(DWORD));
 	return REG_SUCCESS;
 }
 HRESULT REGKEY::WriteREGQWORD(LPCSTR lpName, QWORD ullVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
-	HRESULT hRes = RegSetValueExA(
+	HRESULT hRes = pBackend->SetValue(
 		hKey,
 		lpName,
-		0,
 		REG_QWORD,
 		reinterpret_cast<const BYTE*>(&ullVal),
 		sizeof(QWORD)
 	);
+	REG_METRIC_STATUS(hRes);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
 		return REG_UNKNOWN_ERROR;
 	}
+	REG_METRIC_BYTES_WRITTEN(sizeof(QWORD));
 	return REG_SUCCESS;
 }
 HRESULT REGKEY::WriteREGBINARY(LPCSTR lpName, LPCSTR lpVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (lpVal == nullptr) return REG_INVAILD_POINTER;
 	std::vector<BYTE> bytes = HexStringToByteArray(lpVal);
-	HRESULT hRes = RegSetValueExA(
+	HRESULT hRes = pBackend->SetValue(
 		hKey,
 		lpName,
-		0,
 		REG_BINARY,
 		bytes.data(), 
 		static_cast<DWORD>(bytes.size())
 	);
+	REG_METRIC_STATUS(hRes);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
 		return REG_UNKNOWN_ERROR;
 	}
+	REG_METRIC_BYTES_WRITTEN(bytes.size());
 	return REG_SUCCESS;
 }
-HRESULT REGKEY::WriteREGMULTISZ(LPCSTR lpName, std::vector<LPCSTR> lpVal) const {
+HRESULT REGKEY::WriteREGBINARY(LPCSTR lpName, const BYTE* lpData, DWORD dwSize) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
-	std::vector<CHAR> lpData;
-	for (const auto& itVal : lpVal) {
-		size_t ulStrSize = strlen(itVal);
-		for (INT pChar = 0; pChar < ulStrSize; pChar++) {
-			lpData.push_back(itVal[pChar]);
-		}
-		lpData.push_back('\0');
+	if (lpData == nullptr && dwSize != 0) return REG_INVAILD_POINTER;
+	HRESULT hRes = pBackend->SetValue(
+		hKey,
+		lpName,
+		REG_BINARY,
+		lpData, 
+		dwSize
+	);
+	REG_METRIC_STATUS(hRes);
+	if (hRes != ERROR_SUCCESS) {
+		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		return REG_UNKNOWN_ERROR;
 	}
-	lpData.push_back('\0');
-	HRESULT hRes = RegSetValueExA(
+	REG_METRIC_BYTES_WRITTEN(dwSize);
+	return REG_SUCCESS;
+}
+// Encode the strings with one sized allocation and write them
+template <typename T>
+static HRESULT WriteMultiSz(REGBACKEND* pBackend, HKEY hKey, LPCSTR lpName, const T& rStrs) {
+	std::vector<CHAR> lpData(MultiSzSize(rStrs));
+	if (lpData.size() > 0xFFFFFFFFull) return REG_STR_TOO_LONG;
+	MultiSzEncode(rStrs, lpData.data());
+	HRESULT hRes = pBackend->SetValue(
 		hKey, 
 		lpName, 
-		0, 
 		REG_MULTI_SZ, 
 		reinterpret_cast<const BYTE*>(lpData.data()), 
 		static_cast<DWORD>(lpData.size())
 	);
+	REG_METRIC_STATUS(hRes);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
 		return REG_UNKNOWN_ERROR;
 	}
+	REG_METRIC_BYTES_WRITTEN(lpData.size());
+	return REG_SUCCESS;
+}
+// Pointer and count as a range
+struct MULTISZRANGE {
+	const std::string_view* lpBegin;
+	const std::string_view* lpEnd;
+	const std::string_view* begin() const { return lpBegin; }
+	const std::string_view* end() const { return lpEnd; }
+};
+
+HRESULT REGKEY::WriteREGMULTISZ(LPCSTR lpName, std::vector<LPCSTR> lpVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	for (LPCSTR lpStr : lpVal) {
+		if (lpStr == nullptr) return REG_INVAILD_VALUE;
+	}
+	return WriteMultiSz(pBackend, hKey, lpName, lpVal);
+}
+HRESULT REGKEY::WriteREGMULTISZ(LPCSTR lpName, const std::string_view* lpVal, size_t ulCount) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpVal == nullptr && ulCount != 0) return REG_INVAILD_POINTER;
+	MULTISZRANGE rRange = { lpVal, lpVal + ulCount };
+	return WriteMultiSz(pBackend, hKey, lpName, rRange);
+}
+HRESULT REGKEY::WriteValue(LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpData == nullptr && dwSize != 0) return REG_INVAILD_POINTER;
+	HRESULT hRes = pBackend->SetValue(
+		hKey, 
+		lpName, 
+		dwType, 
+		lpData, 
+		dwSize
+	);
+	REG_METRIC_STATUS(hRes);
+	if (hRes != ERROR_SUCCESS) {
+		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		return REG_UNKNOWN_ERROR;
+	}
+	REG_METRIC_BYTES_WRITTEN(dwSize);
 	return REG_SUCCESS;
 }
 
 HRESULT REGKEY::DeleteValue(LPCSTR lpName) const {
+	REG_METRIC_SCOPE(REG_METRIC_DELETEVALUE, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (lpName == nullptr) return REG_INVAILD_VALUE;
-	if (strlen(lpName) > 0xff) return REG_STR_TOO_LONG;
-	HRESULT hRes = RegDeleteValueA(
+	if (strlen(lpName) > REG_MAX_VALUE_NAME_LEN) return REG_STR_TOO_LONG;
+	HRESULT hRes = pBackend->DeleteValue(
 		hKey, 
 		lpName
 	);
+	REG_METRIC_STATUS(hRes);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
 		if (hRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
@@ -357,34 +634,130 @@ HRESULT REGKEY::DeleteValue(LPCSTR lpName) const {
 	return REG_SUCCESS;
 }
 HRESULT REGKEY::Delete() {
+	REG_METRIC_SCOPE(REG_METRIC_DELETEKEY, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
-	HRESULT hRes = RegDeleteKeyExA(
+	HRESULT hRes = pBackend->DeleteKey(
 		hKey, 
 		"", 
-		ulSam, 
-		0
+		ulSam
 	);
+	REG_METRIC_STATUS(hRes);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
 		if (hRes == ERROR_FILE_NOT_FOUND) return REG_PATH_NOT_EXIST;
 		return REG_UNKNOWN_ERROR;
 	}
+	// Pooled handles of the deleted key must not be handed out again
+	GetRegHandlePool()->Detach(pHandle);
 	Close();
 	return REG_SUCCESS;
 }
+HRESULT REGKEY::DeleteTree() {
+	REG_METRIC_SCOPE(REG_METRIC_DELETEKEY, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	std::string cName;
+	while (1) {
+		// Always take the first sub item, the next one moves up after each deletion
+		HRESULT hRes = GetSonName(0, &cName);
+		if (hRes == REG_NO_MORE_ITEMS) break;
+		if (hRes != REG_SUCCESS) return hRes;
+		REGKEY rSon(pBackend);
+		hRes = GetSon(cName.c_str(), &rSon, ulSam);
+		if (hRes != REG_SUCCESS) return hRes;
+		hRes = rSon.DeleteTree();
+		if (hRes != REG_SUCCESS) return hRes;
+	}
+	return Delete();
+}
+
+// Values up to this size are read without allocation
+#define REG_SMALL_BUFFER 256
+
+// Read a value with a single backend call into lpBuffer, checking the type returned by that same call.
+// Only when the data does not fit (ERROR_MORE_DATA) is lpLarge resized to the reported size and the query repeated.
+// *ppData receives whichever buffer holds the data. lpBuffer may point into lpLarge.
+static HRESULT QueryTypedValue(REGBACKEND* pBackend, HKEY hKey, LPCSTR lpName, DWORD dwExpectType, BYTE* lpBuffer, DWORD dwBufferSize, 
+	std::vector<BYTE>* lpLarge, const BYTE** ppData, DWORD* pdwSize, DWORD* pdwType) {
+	DWORD dwType = 0;
+	DWORD dwSize = dwBufferSize;
+	BYTE* lpData = lpBuffer;
+	LSTATUS lRes = pBackend->QueryValue(hKey, lpName, &dwType, lpData, &dwSize);
+	REG_METRIC_STATUS(lRes);
+	while (lRes == ERROR_MORE_DATA) {
+		if (dwExpectType != REG_ANY_TYPE && dwType != dwExpectType) return REG_INCORRECT_TYPE;
+		// Repeat while the value keeps growing between the calls
+		lpLarge->resize(dwSize);
+		lpData = lpLarge->data();
+		lRes = pBackend->QueryValue(hKey, lpName, &dwType, lpData, &dwSize);
+		REG_METRIC_STATUS(lRes);
+	}
+	if (lRes != ERROR_SUCCESS) {
+		if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		if (lRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
+		return REG_UNKNOWN_ERROR;
+	}
+	if (dwExpectType != REG_ANY_TYPE && dwType != dwExpectType) return REG_INCORRECT_TYPE;
+	if (pdwType != nullptr) *pdwType = dwType;
+	*ppData = lpData;
+	*pdwSize = dwSize;
+	REG_METRIC_BYTES_READ(dwSize);
+	return REG_SUCCESS;
+}
+
+// Buffer of the calling thread a value of type T is read into
+template <typename T>
+static T* GetQueryBuffer() {
+	thread_local T tBuffer;
+	return &tBuffer;
+}
+
+// Read a value into the thread's buffer (std::string or std::vector<BYTE>), using its capacity first and growing it
+// only when the backend reports ERROR_MORE_DATA, so large values are neither copied nor allocated twice.
+// On success the buffer is swapped into *pBuffer, which is left sized to its capacity, and *pdwSize receives the
+// size of the data in bytes. On failure *pBuffer is left untouched.
+template <typename T>
+static HRESULT QueryValueInto(REGBACKEND* pBackend, HKEY hKey, LPCSTR lpName, DWORD dwExpectType, T* pBuffer, DWORD* pdwType, DWORD* pdwSize) {
+	T* pQuery = GetQueryBuffer<T>();
+	if (pQuery->capacity() < REG_SMALL_BUFFER) pQuery->reserve(REG_SMALL_BUFFER);
+	pQuery->resize(pQuery->capacity());
+	DWORD dwType = 0;
+	DWORD dwSize = static_cast<DWORD>(pQuery->size());
+	LSTATUS lRes = pBackend->QueryValue(hKey, lpName, &dwType, reinterpret_cast<BYTE*>(&(*pQuery)[0]), &dwSize);
+	REG_METRIC_STATUS(lRes);
+	while (lRes == ERROR_MORE_DATA) {
+		if (dwExpectType != REG_ANY_TYPE && dwType != dwExpectType) break;
+		// Repeat while the value keeps growing between the calls
+		pQuery->resize(dwSize);
+		lRes = pBackend->QueryValue(hKey, lpName, &dwType, reinterpret_cast<BYTE*>(&(*pQuery)[0]), &dwSize);
+		REG_METRIC_STATUS(lRes);
+	}
+	if (lRes != ERROR_SUCCESS && lRes != ERROR_MORE_DATA) {
+		if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		if (lRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
+		return REG_UNKNOWN_ERROR;
+	}
+	if (dwExpectType != REG_ANY_TYPE && dwType != dwExpectType) return REG_INCORRECT_TYPE;
+	// The caller's old buffer becomes the thread's buffer, so both keep their capacity
+	pBuffer->swap(*pQuery);
+	if (pdwType != nullptr) *pdwType = dwType;
+	*pdwSize = dwSize;
+	REG_METRIC_BYTES_READ(dwSize);
+	return REG_SUCCESS;
+}
 
 HRESULT REGKEY::GetTypeSize(LPCSTR lpName, DWORD* pdwType, DWORD* pdwSize) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
 	DWORD dwType = 0;
 	DWORD dwSize = 0;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
-	HRESULT hRes = RegQueryValueExA(
+	HRESULT hRes = pBackend->QueryValue(
 		hKey,
 		lpName,
-		nullptr,
 		&dwType,
 		nullptr,
 		&dwSize
 	);
+	REG_METRIC_STATUS(hRes);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
@@ -395,305 +768,623 @@ HRESULT REGKEY::GetTypeSize(LPCSTR lpName, DWORD* pdwType, DWORD* pdwSize) const
 	return REG_SUCCESS;
 }
 HRESULT REGKEY::ReadREGSZ(LPCSTR lpName, std::string* lpRes) const {
-	DWORD dwType = 0;
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
 	DWORD dwSize = 0;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (lpRes == nullptr) return REG_INVAILD_POINTER;
-	HRESULT hRes = GetTypeSize(lpName, &dwType, &dwSize);
+	HRESULT hRes = QueryValueInto(pBackend, hKey, lpName, REG_SZ, lpRes, nullptr, &dwSize);
 	if (hRes != REG_SUCCESS) return hRes;
-	if (dwType != REG_SZ) return REG_INCORRECT_TYPE;
-	DWORD dwBufferSize = dwSize / sizeof(CHAR) + 1;
-	std::vector<CHAR> buffer(dwBufferSize);
-	hRes = RegQueryValueExA(
-		hKey,
-		lpName,
-		nullptr,
-		&dwType,
-		reinterpret_cast<LPBYTE>(buffer.data()),
-		&dwSize
-	);
-	if (hRes != REG_SUCCESS) {
-		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
-		if (hRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
-		return REG_UNKNOWN_ERROR;
-	}
-	buffer[dwBufferSize - 1] = '\0';
-	*lpRes = buffer.data();
+	lpRes->resize(strnlen(lpRes->c_str(), dwSize));
 	return REG_SUCCESS;
 }
 HRESULT REGKEY::ReadREGEXPANDSZ(LPCSTR lpName, std::string* lpRes) const {
-	DWORD dwType = 0;
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
 	DWORD dwSize = 0;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (lpRes == nullptr) return REG_INVAILD_POINTER;
-	HRESULT hRes = GetTypeSize(lpName, &dwType, &dwSize);
+	HRESULT hRes = QueryValueInto(pBackend, hKey, lpName, REG_EXPAND_SZ, lpRes, nullptr, &dwSize);
 	if (hRes != REG_SUCCESS) return hRes;
-	if (dwType != REG_EXPAND_SZ) return REG_INCORRECT_TYPE;
-	DWORD dwBufferSize = dwSize / sizeof(CHAR) + 1;
-	std::vector<CHAR> buffer(dwBufferSize);
-	hRes = RegQueryValueExA(
-		hKey,
-		lpName,
-		nullptr,
-		&dwType,
-		reinterpret_cast<LPBYTE>(buffer.data()),
-		&dwSize
-	);
-	if (hRes != REG_SUCCESS) {
-		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
-		if (hRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
-		return REG_UNKNOWN_ERROR;
-	}
-	buffer[dwBufferSize - 1] = '\0';
-	*lpRes = buffer.data();
+	lpRes->resize(strnlen(lpRes->c_str(), dwSize));
 	return REG_SUCCESS;
 }
 HRESULT REGKEY::ReadREGDWORD(LPCSTR lpName, DWORD* dwRes) const {
-	DWORD dwType = 0;
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	DWORD dwValue = 0;
+	std::vector<BYTE> lpLarge;
+	const BYTE* lpData = nullptr;
 	DWORD dwSize = 0;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (dwRes == nullptr) return REG_INVAILD_POINTER;
-	HRESULT hRes = GetTypeSize(lpName, &dwType, &dwSize);
+	HRESULT hRes = QueryTypedValue(pBackend, hKey, lpName, REG_DWORD, reinterpret_cast<BYTE*>(&dwValue), sizeof(DWORD), &lpLarge, &lpData, &dwSize, nullptr);
 	if (hRes != REG_SUCCESS) return hRes;
-	if (dwType != REG_DWORD) return REG_INCORRECT_TYPE;
-	DWORD dwValue = 0;
-	hRes = RegQueryValueExA(
-		hKey, 
-		lpName, 
-		nullptr, 
-		&dwType, 
-		reinterpret_cast<LPBYTE>(&dwValue), 
-		&dwSize
-	);
-	if (hRes != REG_SUCCESS) {
-		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
-		if (hRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
-		return REG_UNKNOWN_ERROR;
-	}
+	if (lpData != reinterpret_cast<const BYTE*>(&dwValue)) memcpy(&dwValue, lpData, sizeof(DWORD));
 	*dwRes = dwValue;
 	return REG_SUCCESS;
 }
 HRESULT REGKEY::ReadREGQWORD(LPCSTR lpName, QWORD* qwRes) const {
-	DWORD dwType = 0;
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	QWORD qwValue = 0;
+	std::vector<BYTE> lpLarge;
+	const BYTE* lpData = nullptr;
 	DWORD dwSize = 0;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (qwRes == nullptr) return REG_INVAILD_POINTER;
-	HRESULT hRes = GetTypeSize(lpName, &dwType, &dwSize);
+	HRESULT hRes = QueryTypedValue(pBackend, hKey, lpName, REG_QWORD, reinterpret_cast<BYTE*>(&qwValue), sizeof(QWORD), &lpLarge, &lpData, &dwSize, nullptr);
 	if (hRes != REG_SUCCESS) return hRes;
-	if (dwType != REG_QWORD) return REG_INCORRECT_TYPE;
-	QWORD qwValue = 0;
-	hRes = RegQueryValueExA(
-		hKey,
-		lpName,
-		nullptr,
-		&dwType,
-		reinterpret_cast<LPBYTE>(&qwValue),
-		&dwSize
-	);
-	if (hRes != REG_SUCCESS) {
-		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
-		if (hRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
-		return REG_UNKNOWN_ERROR;
-	}
+	if (lpData != reinterpret_cast<const BYTE*>(&qwValue)) memcpy(&qwValue, lpData, sizeof(QWORD));
 	*qwRes = qwValue;
 	return REG_SUCCESS;
 }
 HRESULT REGKEY::ReadREGBINARY(LPCSTR lpName, std::string* lpRes) const {
-	DWORD dwType = 0;
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	BYTE lpSmall[REG_SMALL_BUFFER];
+	std::vector<BYTE> lpLarge;
+	const BYTE* lpData = nullptr;
 	DWORD dwSize = 0;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (lpRes == nullptr) return REG_INVAILD_POINTER;
-	HRESULT hRes = GetTypeSize(lpName, &dwType, &dwSize);
+	HRESULT hRes = QueryTypedValue(pBackend, hKey, lpName, REG_BINARY, lpSmall, sizeof lpSmall, &lpLarge, &lpData, &dwSize, nullptr);
 	if (hRes != REG_SUCCESS) return hRes;
-	if (dwType != REG_BINARY) return REG_INCORRECT_TYPE;
-	std::vector<BYTE> buffer(dwSize);
-	hRes = RegQueryValueExA(
-		hKey,
-		lpName,
-		nullptr,
-		&dwType,
-		buffer.data(),
-		&dwSize
-	);
-	if (hRes != REG_SUCCESS) {
-		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
-		if (hRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
-		return REG_UNKNOWN_ERROR;
-	}
-	for (const BYTE& b : buffer) {
-		CHAR hex[3];
-		sprintf_s(hex, sizeof hex, "%02X", b);
-		*lpRes += hex;
-	}
+	size_t ulOld = lpRes->size();
+	lpRes->resize(ulOld + static_cast<size_t>(dwSize) * 2);
+	if (dwSize != 0) HexEncode(lpData, dwSize, &(*lpRes)[ulOld]);
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::ReadREGBINARY(LPCSTR lpName, std::vector<BYTE>* lpRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	DWORD dwSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpRes == nullptr) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryValueInto(pBackend, hKey, lpName, REG_BINARY, lpRes, nullptr, &dwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	lpRes->resize(dwSize);
 	return REG_SUCCESS;
 }
 HRESULT REGKEY::ReadREGMULTISZ(LPCSTR lpName, std::vector<std::string>* lpRes) const {
-	DWORD dwType = 0;
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	BYTE lpSmall[REG_SMALL_BUFFER];
+	std::vector<BYTE> lpLarge;
+	const BYTE* lpData = nullptr;
 	DWORD dwSize = 0;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (lpRes == nullptr) return REG_INVAILD_POINTER;
-	HRESULT hRes = GetTypeSize(lpName, &dwType, &dwSize);
+	HRESULT hRes = QueryTypedValue(pBackend, hKey, lpName, REG_MULTI_SZ, lpSmall, sizeof lpSmall, &lpLarge, &lpData, &dwSize, nullptr);
 	if (hRes != REG_SUCCESS) return hRes;
-	std::vector<CHAR> buffer(1024);
-	std::vector<std::string> Res;
-	hRes = RegQueryValueExA(
-		hKey, 
-		lpName, 
-		nullptr, 
-		&dwType, 
-		reinterpret_cast<LPBYTE>(buffer.data()), 
-		&dwSize
-	);
-	if (hRes != REG_SUCCESS) {
-		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
-		if (hRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
+	REGMULTISZVIEW vMulti(reinterpret_cast<const CHAR*>(lpData), dwSize);
+	lpRes->clear();
+	lpRes->reserve(vMulti.Count());
+	for (std::string_view vStr : vMulti) lpRes->emplace_back(vStr);
+	return REG_SUCCESS;
+}
+
+// Read a typed value into a reusable scratch buffer. The buffer keeps its full size, so the next read does not
+// have to initialize it again.
+static HRESULT QueryScratch(REGBACKEND* pBackend, HKEY hKey, LPCSTR lpName, DWORD dwExpectType, std::vector<BYTE>* pScratch, const CHAR** ppData, DWORD* pdwSize) {
+	HRESULT hRes = QueryValueInto(pBackend, hKey, lpName, dwExpectType, pScratch, nullptr, pdwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	*ppData = reinterpret_cast<const CHAR*>(pScratch->data());
+	return REG_SUCCESS;
+}
+
+// Read a typed value into a caller buffer with one backend call
+static HRESULT QueryBuffer(REGBACKEND* pBackend, HKEY hKey, LPCSTR lpName, DWORD dwExpectType, CHAR* lpBuffer, DWORD dwBufferSize, DWORD* pdwSize) {
+	DWORD dwType = 0;
+	DWORD dwSize = dwBufferSize;
+	LSTATUS lRes = pBackend->QueryValue(hKey, lpName, &dwType, reinterpret_cast<BYTE*>(lpBuffer), &dwSize);
+	REG_METRIC_STATUS(lRes);
+	if (lRes == ERROR_SUCCESS && lpBuffer == nullptr && dwSize != 0) lRes = ERROR_MORE_DATA;
+	if (lRes != ERROR_SUCCESS && lRes != ERROR_MORE_DATA) {
+		if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		if (lRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
 		return REG_UNKNOWN_ERROR;
 	}
-	const CHAR* p = buffer.data();
-	while (*p) {
-		Res.push_back(p);
-		p += Res.back().length() + 1;
+	if (dwType != dwExpectType) return REG_INCORRECT_TYPE;
+	*pdwSize = dwSize;
+	if (lRes == ERROR_MORE_DATA) return REG_BUFFER_OVERFLOW;
+	REG_METRIC_BYTES_READ(dwSize);
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::ReadREGSZ(LPCSTR lpName, std::vector<BYTE>* pScratch, std::string_view* pRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	const CHAR* lpData = nullptr;
+	DWORD dwSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pScratch == nullptr || pRes == nullptr) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryScratch(pBackend, hKey, lpName, REG_SZ, pScratch, &lpData, &dwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	*pRes = std::string_view(lpData, strnlen(lpData, dwSize));
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::ReadREGEXPANDSZ(LPCSTR lpName, std::vector<BYTE>* pScratch, std::string_view* pRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	const CHAR* lpData = nullptr;
+	DWORD dwSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pScratch == nullptr || pRes == nullptr) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryScratch(pBackend, hKey, lpName, REG_EXPAND_SZ, pScratch, &lpData, &dwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	*pRes = std::string_view(lpData, strnlen(lpData, dwSize));
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::ReadREGMULTISZ(LPCSTR lpName, std::vector<BYTE>* pScratch, REGMULTISZVIEW* pRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	const CHAR* lpData = nullptr;
+	DWORD dwSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pScratch == nullptr || pRes == nullptr) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryScratch(pBackend, hKey, lpName, REG_MULTI_SZ, pScratch, &lpData, &dwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	*pRes = REGMULTISZVIEW(lpData, dwSize);
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::ReadREGSZ(LPCSTR lpName, CHAR* lpBuffer, DWORD dwBufferSize, std::string_view* pRes, DWORD* pdwSize) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pRes == nullptr || pdwSize == nullptr || (lpBuffer == nullptr && dwBufferSize != 0)) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryBuffer(pBackend, hKey, lpName, REG_SZ, lpBuffer, dwBufferSize, pdwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	*pRes = std::string_view(lpBuffer, strnlen(lpBuffer, *pdwSize));
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::ReadREGEXPANDSZ(LPCSTR lpName, CHAR* lpBuffer, DWORD dwBufferSize, std::string_view* pRes, DWORD* pdwSize) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pRes == nullptr || pdwSize == nullptr || (lpBuffer == nullptr && dwBufferSize != 0)) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryBuffer(pBackend, hKey, lpName, REG_EXPAND_SZ, lpBuffer, dwBufferSize, pdwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	*pRes = std::string_view(lpBuffer, strnlen(lpBuffer, *pdwSize));
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::ReadREGMULTISZ(LPCSTR lpName, CHAR* lpBuffer, DWORD dwBufferSize, REGMULTISZVIEW* pRes, DWORD* pdwSize) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pRes == nullptr || pdwSize == nullptr || (lpBuffer == nullptr && dwBufferSize != 0)) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryBuffer(pBackend, hKey, lpName, REG_MULTI_SZ, lpBuffer, dwBufferSize, pdwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	*pRes = REGMULTISZVIEW(lpBuffer, *pdwSize);
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::ReadValue(LPCSTR lpName, DWORD* pdwType, std::vector<BYTE>* lpRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	DWORD dwSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpRes == nullptr) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryValueInto(pBackend, hKey, lpName, REG_ANY_TYPE, lpRes, pdwType, &dwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	lpRes->resize(dwSize);
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::ReadValue(LPCSTR lpName, DWORD* pdwType, BYTE* lpBuffer, DWORD dwBufferSize, DWORD* pdwSize) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	DWORD dwType = 0;
+	DWORD dwSize = dwBufferSize;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pdwSize == nullptr || (lpBuffer == nullptr && dwBufferSize != 0)) return REG_INVAILD_POINTER;
+	LSTATUS lRes = pBackend->QueryValue(hKey, lpName, &dwType, lpBuffer, &dwSize);
+	REG_METRIC_STATUS(lRes);
+	// A null buffer only queries the size
+	if (lRes == ERROR_SUCCESS && lpBuffer == nullptr && dwSize != 0) lRes = ERROR_MORE_DATA;
+	if (lRes != ERROR_SUCCESS && lRes != ERROR_MORE_DATA) {
+		if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		if (lRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
+		return REG_UNKNOWN_ERROR;
 	}
-	*lpRes = Res;
+	if (pdwType != nullptr) *pdwType = dwType;
+	*pdwSize = dwSize;
+	if (lRes == ERROR_MORE_DATA) return REG_BUFFER_OVERFLOW;
+	REG_METRIC_BYTES_READ(dwSize);
 	return REG_SUCCESS;
 }
 
-HRESULT REGKEY::EnumValue(REG_VALUE_CALLBACK callback) const {
-	DWORD index = 0, vType = 0, vNameSize = 0;
-	CHAR vName[256] = "";
-	HRESULT hRes = REG_SUCCESS;
+HRESULT REGKEY::ReadValues(REGBATCHVALUE* pValues, DWORD dwCount, std::vector<BYTE>* pBuffer) const {
+	REG_METRIC_SCOPE(REG_METRIC_READBATCH, hRootKey);
 	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if ((pValues == nullptr && dwCount != 0) || pBuffer == nullptr) return REG_INVAILD_POINTER;
+	if (dwCount == 0) return REG_SUCCESS;
+	std::vector<VALENTA> vEntries(dwCount);
+	for (DWORD i = 0; i < dwCount; i++) {
+		vEntries[i].ve_valuename = const_cast<LPSTR>(pValues[i].lpName != nullptr ? pValues[i].lpName : REG_DEFAULTVALUE);
+		vEntries[i].ve_valuelen = 0;
+		vEntries[i].ve_valueptr = 0;
+		vEntries[i].ve_type = 0;
+	}
+	if (pBuffer->size() < REG_SMALL_BUFFER) pBuffer->resize(REG_SMALL_BUFFER);
 
+	// One call for the whole batch, repeated only if the buffer is too small
+	DWORD dwTotal = static_cast<DWORD>(pBuffer->size());
+	LSTATUS lRes = pBackend->QueryMultipleValues(hKey, vEntries.data(), dwCount, reinterpret_cast<LPSTR>(pBuffer->data()), &dwTotal);
+	while (lRes == ERROR_MORE_DATA) {
+		pBuffer->resize(dwTotal);
+		lRes = pBackend->QueryMultipleValues(hKey, vEntries.data(), dwCount, reinterpret_cast<LPSTR>(pBuffer->data()), &dwTotal);
+	}
+	if (lRes == ERROR_SUCCESS) {
+		REG_METRIC_BYTES_READ(dwTotal);
+		for (DWORD i = 0; i < dwCount; i++) {
+			REGBATCHVALUE& rValue = pValues[i];
+			rValue.dwType = vEntries[i].ve_type;
+			rValue.lpData = reinterpret_cast<const BYTE*>(vEntries[i].ve_valueptr);
+			rValue.dwSize = vEntries[i].ve_valuelen;
+			if (rValue.dwExpectType != REG_ANY_TYPE && rValue.dwType != rValue.dwExpectType) rValue.hRes = REG_INCORRECT_TYPE;
+			else rValue.hRes = REG_SUCCESS;
+		}
+		return REG_SUCCESS;
+	}
+	if (lRes == ERROR_ACCESS_DENIED) {
+		REG_METRIC_STATUS(lRes);
+		return REG_ACCESS_DENIED;
+	}
+
+	// Some value cannot be read (RegQueryMultipleValuesA fails the whole batch, with ERROR_FILE_NOT_FOUND for a
+	// missing name): read them one by one so that every entry gets its own result
+	std::vector<DWORD> vOffsets(dwCount);
+	DWORD dwOffset = 0;
+	for (DWORD i = 0; i < dwCount; i++) {
+		REGBATCHVALUE& rValue = pValues[i];
+		LPCSTR lpName = vEntries[i].ve_valuename;
+		const BYTE* lpData = nullptr;
+		DWORD dwSize = 0;
+		std::vector<BYTE> lpLarge;
+		if (pBuffer->size() - dwOffset < REG_SMALL_BUFFER) pBuffer->resize(dwOffset + REG_SMALL_BUFFER);
+		rValue.hRes = QueryTypedValue(pBackend, hKey, lpName, rValue.dwExpectType, pBuffer->data() + dwOffset, static_cast<DWORD>(pBuffer->size() - dwOffset), &lpLarge, &lpData, &dwSize, &rValue.dwType);
+		rValue.dwSize = 0;
+		vOffsets[i] = dwOffset;
+		if (rValue.hRes != REG_SUCCESS) continue;
+		if (lpData == lpLarge.data()) {
+			pBuffer->resize(dwOffset + dwSize);
+			memcpy(pBuffer->data() + dwOffset, lpData, dwSize);
+		}
+		rValue.dwSize = dwSize;
+		dwOffset += dwSize;
+	}
+	for (DWORD i = 0; i < dwCount; i++) pValues[i].lpData = (pValues[i].hRes == REG_SUCCESS ? pBuffer->data() + vOffsets[i] : nullptr);
+	return REG_SUCCESS;
+}
+
+// Result of a failed enumeration call
+static HRESULT EnumResult(LSTATUS lRes) {
+	if (lRes == ERROR_NO_MORE_ITEMS) return REG_NO_MORE_ITEMS;
+	if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+	return REG_UNKNOWN_ERROR;
+}
+
+void REGKEY::QueryEnumInfo(REGKEYINFO* pInfo) const {
+	LSTATUS lRes = pBackend->QueryInfoKey(hKey, pInfo);
+	REG_METRIC_STATUS(lRes);
+	if (lRes == ERROR_SUCCESS) return;
+	// Unknown: the enumeration reports the error, the buffers start at the usual size
+	pInfo->dwSubKeys = pInfo->dwValues = 0;
+	pInfo->dwMaxSubKeyLen = pInfo->dwMaxValueNameLen = REG_MIN_NAME_BUFFER - 1;
+	pInfo->dwMaxValueLen = 0;
+}
+
+void REGKEY::SizeEnumBuffers(const REGKEYINFO& rInfo, BOOL bValues, std::vector<CHAR>* pvName, std::vector<BYTE>* pvData) {
+	size_t ulName = static_cast<size_t>(bValues ? rInfo.dwMaxValueNameLen : rInfo.dwMaxSubKeyLen) + 1;
+	if (pvName->size() < ulName) pvName->resize(ulName);
+	if (pvData != nullptr && pvData->size() < rInfo.dwMaxValueLen) pvData->resize(rInfo.dwMaxValueLen);
+}
+
+LSTATUS REGKEY::EnumKeyName(DWORD dwIndex, std::vector<CHAR>* pvName, DWORD* pdwNameSize) const {
 	while (1) {
-		vNameSize = 256;
-		HRESULT lRes = RegEnumValueA(
-			hKey, 
-			index, 
-			vName, 
-			&vNameSize, 
-			nullptr, 
-			&vType, 
-			nullptr,
-			nullptr
-		);
-		if (lRes != ERROR_SUCCESS && lRes != ERROR_NO_MORE_ITEMS) {
-			if (lRes == ERROR_ACCESS_DENIED) hRes = REG_ACCESS_DENIED;
-			else hRes = REG_UNKNOWN_ERROR;
+		DWORD dwNameSize = static_cast<DWORD>(pvName->size());
+		LSTATUS lRes = pBackend->EnumKey(hKey, dwIndex, pvName->data(), &dwNameSize);
+		REG_METRIC_STATUS(lRes);
+		// Longer than reported: added since the query, or more bytes than characters in the code page
+		if (lRes == ERROR_MORE_DATA && pvName->size() < REG_MAX_NAME_BUFFER) {
+			pvName->resize(std::max<size_t>(pvName->size() * 2, REG_MIN_NAME_BUFFER));
+			continue;
 		}
-		if (lRes == ERROR_NO_MORE_ITEMS) break;
-		vName[vNameSize] = '\0';
-		callback(this, vName, vType);
-		index++;
+		if (lRes == ERROR_SUCCESS) {
+			(*pvName)[dwNameSize] = '\0';
+			*pdwNameSize = dwNameSize;
+		}
+		return lRes;
 	}
-	return hRes;
 }
-HRESULT REGKEY::EnumKey(REG_KEY_CALLBACK callback) const {
-	DWORD index = 0, kNameSize = 0;
-	CHAR kName[256] = "";
-	HRESULT hRes = REG_SUCCESS;
-	if (!Opened()) return REG_KEY_NOT_OPENED;
 
+LSTATUS REGKEY::EnumValueEntry(DWORD dwIndex, std::vector<CHAR>* pvName, DWORD* pdwNameSize, DWORD* pdwType, std::vector<BYTE>* pvData, DWORD* pdwSize) const {
+	// An empty data buffer would make the call a size query
+	if (pvData != nullptr && pvData->empty()) pvData->resize(1);
 	while (1) {
-		kNameSize = 256;
-		HRESULT lRes = RegEnumKeyExA(
+		DWORD dwNameSize = static_cast<DWORD>(pvName->size());
+		DWORD dwSize = (pvData != nullptr ? static_cast<DWORD>(pvData->size()) : 0);
+		LSTATUS lRes = pBackend->EnumValue(
 			hKey,
-			index,
-			kName,
-			&kNameSize,
-			nullptr,
-			nullptr,
-			nullptr,
-			nullptr
+			dwIndex,
+			pvName->data(),
+			&dwNameSize,
+			pdwType,
+			(pvData != nullptr ? pvData->data() : nullptr),
+			(pvData != nullptr ? &dwSize : nullptr)
 		);
-		if (lRes != ERROR_SUCCESS && lRes != ERROR_NO_MORE_ITEMS) {
-			if (lRes == ERROR_ACCESS_DENIED) hRes = REG_ACCESS_DENIED;
-			else hRes = REG_UNKNOWN_ERROR;
+		REG_METRIC_STATUS(lRes);
+		if (lRes == ERROR_MORE_DATA) {
+			if (pvData != nullptr && dwSize > pvData->size()) {
+				pvData->resize(dwSize);
+				continue;
+			}
+			if (pvName->size() < REG_MAX_NAME_BUFFER) {
+				pvName->resize(std::max<size_t>(pvName->size() * 2, REG_MIN_NAME_BUFFER));
+				continue;
+			}
+		}
+		if (lRes == ERROR_SUCCESS) {
+			(*pvName)[dwNameSize] = '\0';
+			*pdwNameSize = dwNameSize;
+			if (pdwSize != nullptr) *pdwSize = dwSize;
+		}
+		return lRes;
+	}
+}
+
+HRESULT REGKEY::GetInfo(REGKEYINFO* pInfo) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pInfo == nullptr) return REG_INVAILD_POINTER;
+	LSTATUS lRes = pBackend->QueryInfoKey(hKey, pInfo);
+	REG_METRIC_STATUS(lRes);
+	if (lRes != ERROR_SUCCESS) {
+		if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		return REG_UNKNOWN_ERROR;
+	}
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::ListKeys(std::vector<std::string>* pvNames) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	REGKEYINFO iInfo;
+	std::vector<CHAR> vName;
+	DWORD dwNameSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pvNames == nullptr) return REG_INVAILD_POINTER;
+	QueryEnumInfo(&iInfo);
+	SizeEnumBuffers(iInfo, FALSE, &vName, nullptr);
+	pvNames->clear();
+	pvNames->reserve(iInfo.dwSubKeys);
+	for (DWORD index = 0;; index++) {
+		LSTATUS lRes = EnumKeyName(index, &vName, &dwNameSize);
+		if (lRes == ERROR_NO_MORE_ITEMS) break;
+		if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+		pvNames->emplace_back(vName.data(), dwNameSize);
+	}
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::ListValues(std::vector<REGVALUEENTRY>* pvValues, BOOL bData) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	REGKEYINFO iInfo;
+	std::vector<CHAR> vName;
+	std::vector<BYTE> vData;
+	DWORD dwNameSize = 0, dwType = 0, dwSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (pvValues == nullptr) return REG_INVAILD_POINTER;
+	QueryEnumInfo(&iInfo);
+	SizeEnumBuffers(iInfo, TRUE, &vName, (bData ? &vData : nullptr));
+	pvValues->clear();
+	pvValues->reserve(iInfo.dwValues);
+	for (DWORD index = 0;; index++) {
+		LSTATUS lRes = EnumValueEntry(index, &vName, &dwNameSize, &dwType, (bData ? &vData : nullptr), &dwSize);
+		if (lRes == ERROR_NO_MORE_ITEMS) break;
+		if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+		pvValues->emplace_back();
+		REGVALUEENTRY& rEntry = pvValues->back();
+		rEntry.cName.assign(vName.data(), dwNameSize);
+		rEntry.dwType = dwType;
+		if (bData) {
+			rEntry.vData.assign(vData.data(), vData.data() + dwSize);
+			REG_METRIC_BYTES_READ(dwSize);
 		}
+	}
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::GetSonName(DWORD dwIndex, std::string* lpName) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	std::vector<CHAR> vName(REG_MIN_NAME_BUFFER);
+	DWORD kNameSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpName == nullptr) return REG_INVAILD_POINTER;
+	LSTATUS lRes = EnumKeyName(dwIndex, &vName, &kNameSize);
+	if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+	lpName->assign(vName.data(), kNameSize);
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::GetValueName(DWORD dwIndex, std::string* lpName, DWORD* pdwType) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	std::vector<CHAR> vName(REG_MIN_NAME_BUFFER);
+	DWORD vType = 0, vNameSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpName == nullptr) return REG_INVAILD_POINTER;
+	LSTATUS lRes = EnumValueEntry(dwIndex, &vName, &vNameSize, &vType, nullptr, nullptr);
+	if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+	lpName->assign(vName.data(), vNameSize);
+	if (pdwType != nullptr) *pdwType = vType;
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::EnumValue(REG_VALUE_CALLBACK callback) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	REGKEYINFO iInfo;
+	std::vector<CHAR> vName;
+	DWORD vType = 0, vNameSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	QueryEnumInfo(&iInfo);
+	SizeEnumBuffers(iInfo, TRUE, &vName, nullptr);
+
+	for (DWORD index = 0;; index++) {
+		LSTATUS lRes = EnumValueEntry(index, &vName, &vNameSize, &vType, nullptr, nullptr);
 		if (lRes == ERROR_NO_MORE_ITEMS) break;
-		kName[kNameSize] = '\0';
-		callback(this, kName);
-		index++;
+		if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+		callback(this, vName.data(), vType);
 	}
-	return hRes;
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::EnumKey(REG_KEY_CALLBACK callback) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	REGKEYINFO iInfo;
+	std::vector<CHAR> kName;
+	DWORD kNameSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	QueryEnumInfo(&iInfo);
+	SizeEnumBuffers(iInfo, FALSE, &kName, nullptr);
+
+	for (DWORD index = 0;; index++) {
+		LSTATUS lRes = EnumKeyName(index, &kName, &kNameSize);
+		if (lRes == ERROR_NO_MORE_ITEMS) break;
+		if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+		callback(this, kName.data());
+	}
+	return REG_SUCCESS;
 }
 HRESULT REGKEY::EnumAllValue(REG_VALUE_CALLBACK callback) const {
-	DWORD index = 0, kNameSize = 0;
-	CHAR kName[256] = "";
-	HRESULT hRes = REG_SUCCESS;
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	REGKEYINFO iInfo;
+	std::vector<CHAR> kName;
+	DWORD kNameSize = 0;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	EnumValue(callback);
+	QueryEnumInfo(&iInfo);
+	SizeEnumBuffers(iInfo, FALSE, &kName, nullptr);
 
-	while (1) {
-		kNameSize = 256;
-		HRESULT lRes = RegEnumKeyExA(
-			hKey,
-			index,
-			kName,
-			&kNameSize,
-			nullptr,
-			nullptr,
-			nullptr,
-			nullptr
-		);
-		if (lRes != ERROR_SUCCESS && lRes != ERROR_NO_MORE_ITEMS) {
-			if (lRes == ERROR_ACCESS_DENIED) hRes = REG_ACCESS_DENIED;
-			else hRes = REG_UNKNOWN_ERROR;
-		}
+	for (DWORD index = 0;; index++) {
+		LSTATUS lRes = EnumKeyName(index, &kName, &kNameSize);
 		if (lRes == ERROR_NO_MORE_ITEMS) break;
-		kName[kNameSize] = '\0';
-		REGKEY rSon;
-		GetSon(kName, &rSon, ulSam);
+		if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+		REGKEY rSon(pBackend);
+		GetSon(kName.data(), &rSon, ulSam);
 		rSon.EnumAllValue(callback);
 		rSon.Close();
-		index++;
 	}
-	return hRes;
+	return REG_SUCCESS;
 }
 HRESULT REGKEY::EnumAllKey(REG_KEY_CALLBACK callback) const {
-	DWORD index = 0, kNameSize = 0;
-	CHAR kName[256] = "";
-	HRESULT hRes = REG_SUCCESS;
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	REGKEYINFO iInfo;
+	std::vector<CHAR> kName;
+	DWORD kNameSize = 0;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
+	QueryEnumInfo(&iInfo);
+	SizeEnumBuffers(iInfo, FALSE, &kName, nullptr);
 
-	while (1) {
-		kNameSize = 256;
-		HRESULT lRes = RegEnumKeyExA(
-			hKey,
-			index,
-			kName,
-			&kNameSize,
-			nullptr,
-			nullptr,
-			nullptr,
-			nullptr
-		);
-		if (lRes != ERROR_SUCCESS && lRes != ERROR_NO_MORE_ITEMS) {
-			if (lRes == ERROR_ACCESS_DENIED) hRes = REG_ACCESS_DENIED;
-			else hRes = REG_UNKNOWN_ERROR;
-		}
+	for (DWORD index = 0;; index++) {
+		LSTATUS lRes = EnumKeyName(index, &kName, &kNameSize);
 		if (lRes == ERROR_NO_MORE_ITEMS) break;
-		kName[kNameSize] = '\0';
-		callback(this, kName);
-		REGKEY rSon;
-		GetSon(kName, &rSon, ulSam);
+		if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+		callback(this, kName.data());
+		REGKEY rSon(pBackend);
+		GetSon(kName.data(), &rSon, ulSam);
 		rSon.EnumAllKey(callback);
 		rSon.Close();
-		index++;
 	}
-	return hRes;
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::WalkKey(REGKEYVISITOR fVisit, BOOL bRecursive, BOOL* pbStop) const {
+	REGKEYINFO iInfo;
+	std::vector<CHAR> kName;
+	DWORD kNameSize = 0;
+	QueryEnumInfo(&iInfo);
+	SizeEnumBuffers(iInfo, FALSE, &kName, nullptr);
+	for (DWORD index = 0;; index++) {
+		LSTATUS lRes = EnumKeyName(index, &kName, &kNameSize);
+		if (lRes == ERROR_NO_MORE_ITEMS) break;
+		if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+		REGVISIT vRes = fVisit(*this, kName.data());
+		if (vRes == REG_VISIT_STOP) {
+			*pbStop = TRUE;
+			return REG_SUCCESS;
+		}
+		if (!bRecursive || vRes == REG_VISIT_SKIP) continue;
+		REGKEY rSon(pBackend);
+		if (GetSon(kName.data(), &rSon, ulSam) != REG_SUCCESS) continue;
+		HRESULT hRes = rSon.WalkKey(fVisit, TRUE, pbStop);
+		if (*pbStop || hRes != REG_SUCCESS) return hRes;
+	}
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::WalkValue(REGVALUEVISITOR fVisit, BOOL bData, BOOL bRecursive, std::vector<CHAR>* pvName, std::vector<BYTE>* pvData, BOOL* pbStop) const {
+	REGKEYINFO iInfo;
+	REGVALUEINFO vInfo;
+	DWORD vNameSize = 0, vType = 0, vDataSize = 0;
+	// The value buffers are shared by the whole walk; sub key names need one buffer per level
+	QueryEnumInfo(&iInfo);
+	SizeEnumBuffers(iInfo, TRUE, pvName, (bData ? pvData : nullptr));
+	for (DWORD index = 0;; index++) {
+		LSTATUS lRes = EnumValueEntry(index, pvName, &vNameSize, &vType, (bData ? pvData : nullptr), &vDataSize);
+		if (lRes == ERROR_NO_MORE_ITEMS) break;
+		if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+		vInfo.lpName = pvName->data();
+		vInfo.dwType = vType;
+		vInfo.lpData = (bData ? pvData->data() : nullptr);
+		vInfo.dwSize = (bData ? vDataSize : 0);
+		REGVISIT vRes = fVisit(*this, vInfo);
+		if (vRes == REG_VISIT_STOP) {
+			*pbStop = TRUE;
+			return REG_SUCCESS;
+		}
+		if (vRes == REG_VISIT_SKIP) return REG_SUCCESS;
+	}
+	if (!bRecursive) return REG_SUCCESS;
+
+	std::vector<CHAR> kName;
+	DWORD kNameSize = 0;
+	SizeEnumBuffers(iInfo, FALSE, &kName, nullptr);
+	for (DWORD index = 0;; index++) {
+		LSTATUS lRes = EnumKeyName(index, &kName, &kNameSize);
+		if (lRes == ERROR_NO_MORE_ITEMS) break;
+		if (lRes != ERROR_SUCCESS) return EnumResult(lRes);
+		REGKEY rSon(pBackend);
+		if (GetSon(kName.data(), &rSon, ulSam) != REG_SUCCESS) continue;
+		HRESULT hRes = rSon.WalkValue(fVisit, bData, TRUE, pvName, pvData, pbStop);
+		if (*pbStop || hRes != REG_SUCCESS) return hRes;
+	}
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::VisitKey(REGKEYVISITOR fVisit) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	BOOL bStop = FALSE;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	return WalkKey(fVisit, FALSE, &bStop);
+}
+HRESULT REGKEY::VisitAllKey(REGKEYVISITOR fVisit) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	BOOL bStop = FALSE;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	return WalkKey(fVisit, TRUE, &bStop);
+}
+HRESULT REGKEY::VisitValue(REGVALUEVISITOR fVisit, BOOL bData) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	BOOL bStop = FALSE;
+	std::vector<CHAR> vName;
+	std::vector<BYTE> vData;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	return WalkValue(fVisit, bData, FALSE, &vName, &vData, &bStop);
+}
+HRESULT REGKEY::VisitAllValue(REGVALUEVISITOR fVisit, BOOL bData) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	BOOL bStop = FALSE;
+	std::vector<CHAR> vName;
+	std::vector<BYTE> vData;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	return WalkValue(fVisit, bData, TRUE, &vName, &vData, &bStop);
 }
 
 HRESULT REGKEY::SetSecurityInfo(LPCSTR lpSddl) const {
+	REG_METRIC_SCOPE(REG_METRIC_SECURITY, hRootKey);
 	PSECURITY_DESCRIPTOR pSD = NULL;
 	if (!Opened()) return REG_KEY_NOT_OPENED;
 	if (!ConvertStringSecurityDescriptorToSecurityDescriptorA(
 		lpSddl, SDDL_REVISION_1, &pSD, NULL
 	)) return REG_UNKNOWN_ERROR;
-	HRESULT hRes = RegSetKeySecurity(
+	HRESULT hRes = pBackend->SetSecurity(
 		hKey, 
 		DACL_SECURITY_INFORMATION, 
 		pSD
 	);
+	REG_METRIC_STATUS(hRes);
 	LocalFree(pSD);
 	if (hRes != ERROR_SUCCESS) {
 		if (hRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
@@ -26,12 +26,19 @@
 #include <windows.h>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstring>
 #include <sddl.h>
 #include <aclapi.h>
 #include <tchar.h>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 // Default value name (empty string)
 #define REG_DEFAULTVALUE ("")
+// Accept any value type
+#define REG_ANY_TYPE ((DWORD)-1)
 
 // Default security descriptor
 #define REGSECURITY_LOCK ("O:BAG:BAD:(A;;GR;;;WD)")
@@ -53,6 +60,10 @@
 #define REG_VALUE_NOT_EXIST ((HRESULT)-0xBl)
 #define REG_BUFFER_OVERFLOW ((HRESULT)-0xCl)
 #define REG_KEY_IS_ROOT ((HRESULT)-0xDl)
+#define REG_INVAILD_FILE ((HRESULT)-0xEl)
+#define REG_NO_MORE_ITEMS ((HRESULT)-0xFl)
+#define REG_CANCELLED ((HRESULT)-0x10l)
+#define REG_QUEUE_FULL ((HRESULT)-0x11l)
 
 // Registry key class declaration
 class REGKEY;
@@ -61,9 +72,222 @@ typedef ULONG64 QWORD; // QWORD is a 64 bit integer
 typedef void (*REG_KEY_CALLBACK)(const REGKEY* pParent, LPCSTR lpName);
 typedef void (*REG_VALUE_CALLBACK)(const REGKEY* pParent, LPCSTR lpName, DWORD dwType);
 
+// Result of a visitor (VisitKey / VisitValue ...)
+enum REGVISIT {
+	REG_VISIT_CONTINUE, // Go on
+	REG_VISIT_SKIP, // Do not enter this sub item (VisitAllKey) / skip the rest of this item and its sub items (VisitAllValue)
+	REG_VISIT_STOP // End the enumeration
+};
+
+// Value seen by a value visitor
+struct REGVALUEINFO {
+	LPCSTR lpName; // Name
+	DWORD dwType; // Type
+	const BYTE* lpData; // Data (empty unless requested), valid during the call only
+	DWORD dwSize; // Size of the data
+};
+
+// Counts and longest names / data of a key (REGBACKEND::QueryInfoKey, REGKEY::GetInfo)
+// Name lengths are in characters without the terminator, as RegQueryInfoKeyA reports them.
+struct REGKEYINFO {
+	DWORD dwSubKeys; // Number of sub keys
+	DWORD dwMaxSubKeyLen; // Longest sub key name
+	DWORD dwValues; // Number of values
+	DWORD dwMaxValueNameLen; // Longest value name
+	DWORD dwMaxValueLen; // Largest value data in bytes
+};
+
+// Value of a bulk enumeration (REGKEY::ListValues)
+struct REGVALUEENTRY {
+	std::string cName; // Name
+	DWORD dwType; // Type
+	std::vector<BYTE> vData; // Data (empty unless requested)
+};
+
+// Non-owning reference to any callable (lambda, functor, function pointer)
+// A callable returning void always continues. The callable must outlive the reference.
+template <typename T> class REGFUNCREF;
+template <typename... A> class REGFUNCREF<REGVISIT(A...)> {
+private:
+	union TARGET {
+		void* pObject; // Lambda or functor
+		void (*pFunction)(); // Function
+	};
+	TARGET uTarget;
+	REGVISIT (*pCall)(TARGET uTarget, A... args);
+
+	template <typename T, typename... B> static REGVISIT Invoke(T& rCall, B&&... args) {
+		if constexpr (std::is_void<decltype(rCall(std::forward<B>(args)...))>::value) {
+			rCall(std::forward<B>(args)...);
+			return REG_VISIT_CONTINUE;
+		}
+		else return static_cast<REGVISIT>(rCall(std::forward<B>(args)...));
+	}
+
+public:
+	template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, REGFUNCREF>::value>::type>
+	REGFUNCREF(F&& f) {
+		typedef typename std::remove_reference<F>::type T;
+		if constexpr (std::is_function<T>::value || std::is_pointer<T>::value) {
+			if constexpr (std::is_pointer<T>::value) uTarget.pFunction = reinterpret_cast<void (*)()>(f);
+			else uTarget.pFunction = reinterpret_cast<void (*)()>(&f);
+			pCall = [](TARGET u, A... args) -> REGVISIT {
+				typedef typename std::conditional<std::is_pointer<T>::value, T, T*>::type P;
+				return Invoke(*reinterpret_cast<P>(u.pFunction), std::forward<A>(args)...);
+			};
+		}
+		else {
+			uTarget.pObject = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+			pCall = [](TARGET u, A... args) -> REGVISIT {
+				return Invoke(*static_cast<T*>(u.pObject), std::forward<A>(args)...);
+			};
+		}
+	}
+	REGVISIT operator()(A... args) const { return pCall(uTarget, std::forward<A>(args)...); }
+};
+typedef REGFUNCREF<REGVISIT(const REGKEY& rParent, LPCSTR lpName)> REGKEYVISITOR;
+typedef REGFUNCREF<REGVISIT(const REGKEY& rParent, const REGVALUEINFO& rValue)> REGVALUEVISITOR;
+
+// View of the strings of REG_MULTI_SZ data, without copying them
+// Iterating yields std::string_view items pointing into the data, up to the first empty string or the end of the data.
+// The view is valid as long as the data is.
+class REGMULTISZVIEW {
+private:
+	const CHAR* lpData; // Raw data
+	size_t ulSize; // Size of the data in bytes
+
+public:
+	class iterator {
+	private:
+		const CHAR* p; // Current string
+		const CHAR* pEnd; // End of the data
+		size_t ulLen; // Length of the current string
+
+		void Load() {
+			ulLen = (p < pEnd ? strnlen(p, pEnd - p) : 0);
+			if (ulLen == 0) p = pEnd;
+		}
+
+	public:
+		iterator(const CHAR* pIn, const CHAR* pInEnd) : p(pIn), pEnd(pInEnd), ulLen(0) { Load(); }
+		std::string_view operator*() const { return std::string_view(p, ulLen); }
+		iterator& operator++() {
+			p += ulLen + 1;
+			Load();
+			return *this;
+		}
+		bool operator==(const iterator& rOther) const { return p == rOther.p; }
+		bool operator!=(const iterator& rOther) const { return p != rOther.p; }
+	};
+
+	REGMULTISZVIEW() : lpData(nullptr), ulSize(0) {}
+	REGMULTISZVIEW(const CHAR* lpInData, size_t ulInSize) : lpData(lpInData), ulSize(ulInSize) {}
+
+	iterator begin() const { return iterator(lpData, lpData + ulSize); }
+	iterator end() const { return iterator(lpData + ulSize, lpData + ulSize); }
+	BOOL Empty() const { return begin() == end(); }
+	// Number of strings (counts them)
+	size_t Count() const {
+		size_t ulCount = 0;
+		for (iterator it = begin(); it != end(); ++it) ulCount++;
+		return ulCount;
+	}
+};
+
+// REG_MULTI_SZ codec over any range of string-like items (std::string, std::string_view, LPCSTR)
+// Empty strings are skipped, because the first empty string ends the list when it is read back.
+// Size of the encoded data in bytes: every string with its terminator, plus the final terminator
+template <typename T> size_t MultiSzSize(const T& rStrs) {
+	size_t ulSize = 1;
+	for (const auto& itStr : rStrs) {
+		std::string_view vStr(itStr);
+		if (!vStr.empty()) ulSize += vStr.size() + 1;
+	}
+	return ulSize;
+}
+// Encode into lpOut, which must hold MultiSzSize(rStrs) bytes. Return the number of bytes.
+template <typename T> size_t MultiSzEncode(const T& rStrs, CHAR* lpOut) {
+	CHAR* p = lpOut;
+	for (const auto& itStr : rStrs) {
+		std::string_view vStr(itStr);
+		if (vStr.empty()) continue;
+		memcpy(p, vStr.data(), vStr.size());
+		p += vStr.size();
+		*p++ = '\0';
+	}
+	*p++ = '\0';
+	return p - lpOut;
+}
+
+// Parallel enumeration options (EnumAllKey / EnumAllValue)
+#define REGENUM_ORDERED 0x1 // Deliver the callbacks in the order of the sequential enumeration
+#define REGENUM_CONCURRENT_CALLBACK 0x2 // The callback is thread-safe and may be called by several threads at once
+struct REGENUMOPTIONS {
+	DWORD dwThreads; // Number of worker threads (0 means the number of processors)
+	DWORD dwMaxDepth; // Maximum depth below the opened item (0 means unlimited, 1 means only the first level)
+	DWORD dwFlags; // REGENUM_*
+};
+
+// Name matching mode (REGKEY::Search, REGNAMEPATTERN in RegSearch.h)
+// ASCII letters are compared case-insensitively, like registry names.
+enum REGMATCHMODE {
+	REG_MATCH_EXACT, // The whole name
+	REG_MATCH_PREFIX, // Names starting with the pattern
+	REG_MATCH_SUBSTRING, // Names containing the pattern
+	REG_MATCH_GLOB // '*' matches any characters, '?' one character
+};
+
+// Search options (REGKEY::Search)
+#define REGSEARCH_KEYS 0x1 // Report matching sub keys
+#define REGSEARCH_VALUES 0x2 // Report matching values
+#define REGSEARCH_DATA 0x4 // Read the data of matching values
+struct REGSEARCHOPTIONS {
+	LPCSTR lpPath; // Glob of the keys searched below the opened item, '\' separated, "**" matches any number of keys (empty means every key)
+	LPCSTR lpName; // Pattern of the sub key / value names (empty matches every name)
+	REGMATCHMODE eMode; // Mode of lpName
+	DWORD dwMaxDepth; // Maximum depth below the opened item (0 means unlimited, 1 means only the first level)
+	DWORD dwFlags; // REGSEARCH_*
+};
+
+// Search result
+struct REGSEARCHMATCH {
+	const REGKEY* pParent; // Key holding the item, valid during the call only
+	std::string_view vPath; // Path of pParent below the opened item
+	LPCSTR lpName; // Name of the sub key or value
+	BOOL bKey; // Whether the item is a sub key
+	DWORD dwType; // Value type
+	const BYTE* lpData; // Value data (REGSEARCH_DATA), valid during the call only
+	DWORD dwSize; // Size of the data
+};
+typedef REGFUNCREF<REGVISIT(const REGSEARCHMATCH& rMatch)> REGSEARCHVISITOR;
+
 // Auxiliary function
 BYTE HexCharToByte(CHAR cHex);
 std::vector<BYTE> HexStringToByteArray(LPCSTR lpHex);
+std::string ByteArrayToHexString(const BYTE* lpData, size_t ulSize);
+
+// Hex codec (SSE2 / AVX2 selected at run time, scalar fallback)
+// Encode ulSize bytes into 2 * ulSize upper case hex characters (no terminator). Return the number of characters.
+size_t HexEncode(const BYTE* lpData, size_t ulSize, CHAR* lpOut);
+// Decode ulLen / 2 bytes from hex characters (the last odd character is ignored, invalid characters are 0).
+// Return the number of bytes.
+size_t HexDecode(LPCSTR lpHex, size_t ulLen, BYTE* lpOut);
+// Codec paths, for tests and benchmarks that compare them
+enum REGHEXPATH {
+	REG_HEX_SCALAR, // Table lookup, always available
+	REG_HEX_SSE2, // x86 only
+	REG_HEX_AVX2 // x86 with AVX2 support
+};
+BOOL HexPathSupported(REGHEXPATH ePath);
+// Same as HexEncode / HexDecode on the given path. Return 0 if the path is not supported.
+size_t HexEncodeWith(REGHEXPATH ePath, const BYTE* lpData, size_t ulSize, CHAR* lpOut);
+size_t HexDecodeWith(REGHEXPATH ePath, LPCSTR lpHex, size_t ulLen, BYTE* lpOut);
+
+// UTF-8 / UTF-16 transcoder (SSE2 for ASCII runs, scalar otherwise). Invalid sequences become U+FFFD.
+// Convert ulLen UTF-8 bytes, lpOut must hold ulLen units. Return the number of units (no terminator).
+size_t Utf8ToUtf16(const CHAR* lpIn, size_t ulLen, WCHAR* lpOut);
+// Convert ulLen UTF-16 units, lpOut must hold 3 * ulLen bytes. Return the number of bytes (no terminator).
+size_t Utf16ToUtf8(const WCHAR* lpIn, size_t ulLen, CHAR* lpOut);
 
 // Root term HKEY and std::string conversion
 HKEY StringToHKEY(std::string lpStr);
@@ -73,19 +297,134 @@ std::string HKEYToString(HKEY hKey);
 DWORD StringToType(std::string lpStr);
 std::string TypeToString(DWORD dwType);
 
+// Registry storage backend
+// REGKEY forwards every storage operation to a backend. All functions return Win32 error codes
+// (ERROR_SUCCESS, ERROR_FILE_NOT_FOUND, ERROR_MORE_DATA...) so that every backend is mapped to the same HRESULT.
+// The buffer conventions are the same as the corresponding Advapi32 functions.
+class REGBACKEND {
+public:
+	virtual ~REGBACKEND() {}
+
+	// Open the key lpPath under hParent (hParent may be a predefined root). Create it if bCreate is TRUE.
+	virtual LSTATUS OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) = 0;
+	// Close a key returned by OpenKey
+	virtual LSTATUS CloseKey(HKEY hKey) = 0;
+	// Delete the sub key lpSubKey of hKey ("" means hKey itself). The key must not have sub keys.
+	virtual LSTATUS DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) = 0;
+	// Set a value
+	virtual LSTATUS SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) = 0;
+	// Query a value. lpData can be empty to query the size only.
+	virtual LSTATUS QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) = 0;
+	// Delete a value
+	virtual LSTATUS DeleteValue(HKEY hKey, LPCSTR lpName) = 0;
+	// Get the name of the dwIndex-th sub key. *pdwNameSize is the buffer size in characters.
+	virtual LSTATUS EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) = 0;
+	// Get the name, type and data of the dwIndex-th value. lpData can be empty.
+	virtual LSTATUS EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) = 0;
+	// Set key security
+	virtual LSTATUS SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) = 0;
+	// Query several values into one buffer (same conventions as RegQueryMultipleValuesA).
+	// Return the status of the first value that cannot be read. The default implementation calls QueryValue for every value.
+	virtual LSTATUS QueryMultipleValues(HKEY hKey, VALENTA* pValues, DWORD dwCount, LPSTR lpBuffer, DWORD* pdwTotalSize);
+	// Get the number of sub keys and values and the longest names and data (same conventions as RegQueryInfoKeyA).
+	// The default implementation enumerates the key.
+	virtual LSTATUS QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo);
+
+	// UTF-16 interface (same conventions as the *W functions: names and REG_SZ / REG_EXPAND_SZ / REG_MULTI_SZ data are UTF-16).
+	// The default implementations convert through the ANSI code page and call the functions above.
+	virtual LSTATUS OpenKeyW(HKEY hParent, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey);
+	virtual LSTATUS SetValueW(HKEY hKey, LPCWSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize);
+	virtual LSTATUS QueryValueW(HKEY hKey, LPCWSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize);
+	virtual LSTATUS DeleteValueW(HKEY hKey, LPCWSTR lpName);
+};
+
+// Windows registry backend (Advapi32)
+class REGWIN32BACKEND : public REGBACKEND {
+public:
+	LSTATUS OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override;
+	LSTATUS CloseKey(HKEY hKey) override;
+	LSTATUS DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) override;
+	LSTATUS SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) override;
+	LSTATUS QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS DeleteValue(HKEY hKey, LPCSTR lpName) override;
+	LSTATUS EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) override;
+	LSTATUS EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) override;
+	LSTATUS QueryMultipleValues(HKEY hKey, VALENTA* pValues, DWORD dwCount, LPSTR lpBuffer, DWORD* pdwTotalSize) override;
+	LSTATUS QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo) override;
+	LSTATUS OpenKeyW(HKEY hParent, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override;
+	LSTATUS SetValueW(HKEY hKey, LPCWSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) override;
+	LSTATUS QueryValueW(HKEY hKey, LPCWSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS DeleteValueW(HKEY hKey, LPCWSTR lpName) override;
+};
+
+// Get the Windows registry backend
+REGBACKEND* GetWin32RegBackend();
+// Get / set the backend used by newly constructed REGKEY objects (Windows registry by default)
+REGBACKEND* GetDefaultRegBackend();
+void SetDefaultRegBackend(REGBACKEND* pBackend);
+
+// Entry of a batch read (REGKEY::ReadValues)
+struct REGBATCHVALUE {
+	LPCSTR lpName; // Value name (in)
+	DWORD dwExpectType; // Expected type, REG_ANY_TYPE accepts any type (in)
+	HRESULT hRes; // Result of this value (out)
+	DWORD dwType; // Type (out)
+	const BYTE* lpData; // Data in the buffer of the batch (out)
+	DWORD dwSize; // Size of the data (out)
+};
+
+// Pooled key handle (RegPool.h)
+struct REGHANDLE;
+
+// Interned key path (RegPath.h)
+typedef DWORD REGPATHID;
+#define REG_PATH_EMPTY ((REGPATHID)0)
+
 // Registry key class
+// Copies of a REGKEY share one pooled handle, so copying, GetSon and GetParent open each key at most once.
+// The path is held as an interned id, so copies and GetSon do not build path strings; GetPath builds it on demand.
 class REGKEY {
 private:
 	HKEY hKey; // Main clause handle
 	HKEY hRootKey; // Root term
-	std::string cPath; // Path
+	REGPATHID idPath; // Path
 	REGSAM ulSam; // Authority
+	REGBACKEND* pBackend; // Storage backend
+	REGHANDLE* pHandle; // Pooled handle of hKey
+
+	void Attach(REGHANDLE* pNewHandle, HKEY hInRootKey, REGPATHID idInPath, REGSAM ulInSam);
+	HRESULT Acquire(HKEY hInRootKey, REGPATHID idInPath, REGSAM ulInSam, BOOL bCreate, BOOL bWide, LSTATUS* plRes);
+	HRESULT AcquireW(HKEY hInRootKey, std::string_view lpInPath, REGSAM ulInSam, BOOL bCreate);
+
+	// A key opened by a UTF-16 path with non-ASCII characters holds the UTF-8 form of its path, and so do its sub keys
+	BOOL IsWide() const;
+	// Append an ANSI name to a path (converted to UTF-8 below a wide path)
+	static REGPATHID AppendName(REGPATHID idBase, BOOL bWide, std::string_view vName);
+	// Convert a UTF-8 path to the ANSI code page
+	static void Utf8ToAnsi(std::string* pPath);
+
+	// Enumeration buffers are sized from QueryInfoKey once per key and reused for every sibling. They only grow,
+	// and grow again if a longer name or larger data appears while the key is enumerated.
+	void QueryEnumInfo(REGKEYINFO* pInfo) const;
+	static void SizeEnumBuffers(const REGKEYINFO& rInfo, BOOL bValues, std::vector<CHAR>* pvName, std::vector<BYTE>* pvData);
+	LSTATUS EnumKeyName(DWORD dwIndex, std::vector<CHAR>* pvName, DWORD* pdwNameSize) const;
+	LSTATUS EnumValueEntry(DWORD dwIndex, std::vector<CHAR>* pvName, DWORD* pdwNameSize, DWORD* pdwType, std::vector<BYTE>* pvData, DWORD* pdwSize) const;
+
+	HRESULT WalkKey(REGKEYVISITOR fVisit, BOOL bRecursive, BOOL* pbStop) const;
+	HRESULT WalkValue(REGVALUEVISITOR fVisit, BOOL bData, BOOL bRecursive, std::vector<CHAR>* pvName, std::vector<BYTE>* pvData, BOOL* pbStop) const;
+
+	friend class REGPARALLELWALK;
+	friend class REGSEARCH;
 
 public:
 	REGKEY(); // Constructor function
+	explicit REGKEY(REGBACKEND* pInBackend); // Constructor function with a specified backend
 	REGKEY(HKEY hRoot, LPCSTR lpPath, REGSAM ulSam, BOOL bCreateIfNotExist);
 	REGKEY(const REGKEY& rOther); // Copy constructor function
+	REGKEY(REGKEY&& rOther) noexcept; // Move constructor function
 	REGKEY& operator=(const REGKEY& rOther);
+	REGKEY& operator=(REGKEY&& rOther) noexcept;
 	~REGKEY(); // Destructor function
 
 	// Create (Create if it does not exist when opened)
@@ -103,6 +442,10 @@ public:
 	HRESULT GetPath(std::string* lpOutPath) const;
 	// Get Authority
 	HRESULT GetSam(REGSAM* pulOutSam) const;
+	// Get backend
+	HRESULT GetBackend(REGBACKEND** ppOutBackend) const;
+	// Set backend (The opened key will be closed)
+	HRESULT SetBackend(REGBACKEND* pInBackend);
 	// Get parent item
 	HRESULT GetParent(REGKEY* pFather, REGSAM hInSam) const;
 	// Get sub item
@@ -120,13 +463,20 @@ public:
 	// The data is represented as a hexadecimal string (such as "EB589033907C"). Invalid characters will be converted to 0.
 	// If the number of characters is not even, discard the last character.
 	HRESULT WriteREGBINARY(LPCSTR lpName, LPCSTR lpVal) const;
-	// Write REG_MULTI_SZ value
+	// Write REG_BINARY value from raw bytes
+	HRESULT WriteREGBINARY(LPCSTR lpName, const BYTE* lpData, DWORD dwSize) const;
+	// Write REG_MULTI_SZ value (empty strings are skipped)
 	HRESULT WriteREGMULTISZ(LPCSTR lpName, std::vector<LPCSTR> lpVal) const;
+	HRESULT WriteREGMULTISZ(LPCSTR lpName, const std::string_view* lpVal, size_t ulCount) const;
+	// Write a value of any type from raw data
+	HRESULT WriteValue(LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) const;
 
 	// Delete registry values
 	HRESULT DeleteValue(LPCSTR lpName) const;
 	// Delete the open registry key and close
 	HRESULT Delete();
+	// Delete the open registry key with all its sub items and close
+	HRESULT DeleteTree();
 
 	// Get value type
 	// The pointer in this function can be empty, indicating that the corresponding value is not obtained.
@@ -140,10 +490,43 @@ public:
 	// Read REG_QWORD value
 	HRESULT ReadREGQWORD(LPCSTR lpName, QWORD* qwRes) const;
 	// Read REG_BINARY value
+	// The data is appended to *lpRes as an upper case hexadecimal string.
 	HRESULT ReadREGBINARY(LPCSTR lpName, std::string* lpRes) const;
+	// Read REG_BINARY value as raw bytes
+	HRESULT ReadREGBINARY(LPCSTR lpName, std::vector<BYTE>* lpRes) const;
 	// Read REG_MULTI_SZ value
 	HRESULT ReadREGMULTISZ(LPCSTR lpName, std::vector<std::string>* lpRes) const;
+	// Allocation-free string reads into a reusable scratch buffer, grown only for a value larger than any before.
+	// The result points into *pScratch and is valid until the buffer is used again.
+	HRESULT ReadREGSZ(LPCSTR lpName, std::vector<BYTE>* pScratch, std::string_view* pRes) const;
+	HRESULT ReadREGEXPANDSZ(LPCSTR lpName, std::vector<BYTE>* pScratch, std::string_view* pRes) const;
+	HRESULT ReadREGMULTISZ(LPCSTR lpName, std::vector<BYTE>* pScratch, REGMULTISZVIEW* pRes) const;
+	// String reads into a caller buffer. *pdwSize receives the size of the data; if it does not fit nothing is read
+	// and REG_BUFFER_OVERFLOW is returned.
+	HRESULT ReadREGSZ(LPCSTR lpName, CHAR* lpBuffer, DWORD dwBufferSize, std::string_view* pRes, DWORD* pdwSize) const;
+	HRESULT ReadREGEXPANDSZ(LPCSTR lpName, CHAR* lpBuffer, DWORD dwBufferSize, std::string_view* pRes, DWORD* pdwSize) const;
+	HRESULT ReadREGMULTISZ(LPCSTR lpName, CHAR* lpBuffer, DWORD dwBufferSize, REGMULTISZVIEW* pRes, DWORD* pdwSize) const;
+	// Read a value of any type as raw data
+	HRESULT ReadValue(LPCSTR lpName, DWORD* pdwType, std::vector<BYTE>* lpRes) const;
+	// Read a value of any type into a caller buffer
+	// *pdwSize receives the size of the data. If the buffer is too small (or empty) nothing is read and
+	// REG_BUFFER_OVERFLOW is returned, so the caller can grow the buffer to *pdwSize and call again.
+	HRESULT ReadValue(LPCSTR lpName, DWORD* pdwType, BYTE* lpBuffer, DWORD dwBufferSize, DWORD* pdwSize) const;
+	// Read several values at once
+	// The data of all values is stored in *pBuffer (reused across calls), every entry gets its own result.
+	// Return REG_SUCCESS if the batch was read, even if some entries failed.
+	HRESULT ReadValues(REGBATCHVALUE* pValues, DWORD dwCount, std::vector<BYTE>* pBuffer) const;
 
+	// Get the number of sub items and values and the longest names and data
+	HRESULT GetInfo(REGKEYINFO* pInfo) const;
+	// Get the names of the first level sub items / the first level sub values at once
+	// The result is reserved from the counts of the key; names (and data if bData is TRUE) are read through one buffer.
+	HRESULT ListKeys(std::vector<std::string>* pvNames) const;
+	HRESULT ListValues(std::vector<REGVALUEENTRY>* pvValues, BOOL bData) const;
+	// Get the name of the dwIndex-th sub item (Return REG_NO_MORE_ITEMS after the last one)
+	HRESULT GetSonName(DWORD dwIndex, std::string* lpName) const;
+	// Get the name and type of the dwIndex-th value (Return REG_NO_MORE_ITEMS after the last one)
+	HRESULT GetValueName(DWORD dwIndex, std::string* lpName, DWORD* pdwType) const;
 	// Enum the first level sub values under opened item
 	HRESULT EnumValue(REG_VALUE_CALLBACK callback) const;
 	// Enum the first level sub items under opened item
@@ -152,11 +535,56 @@ public:
 	HRESULT EnumAllValue(REG_VALUE_CALLBACK callback) const;
 	// Enum all sub items under opened item
 	HRESULT EnumAllKey(REG_KEY_CALLBACK callback) const;
+	// Enum all sub values / items under opened item on a work-stealing thread pool
+	// Every worker opens the keys it enumerates; pParent of the callback is only valid during the call.
+	// Unless REGENUM_CONCURRENT_CALLBACK is set the callback is never called by two threads at once.
+	// With REGENUM_ORDERED the calling thread delivers the callbacks in sequential order while the workers run ahead
+	// by at most REGWALK_ORDERED_WINDOW keys.
+	HRESULT EnumAllValue(REG_VALUE_CALLBACK callback, const REGENUMOPTIONS& rOptions) const;
+	HRESULT EnumAllKey(REG_KEY_CALLBACK callback, const REGENUMOPTIONS& rOptions) const;
+	// Visit the first level sub items / all sub items with any callable: REGVISIT f(const REGKEY& rParent, LPCSTR lpName)
+	// The enumeration stops when the callable returns REG_VISIT_STOP.
+	HRESULT VisitKey(REGKEYVISITOR fVisit) const;
+	HRESULT VisitAllKey(REGKEYVISITOR fVisit) const;
+	// Visit the first level sub values / all sub values with any callable: REGVISIT f(const REGKEY& rParent, const REGVALUEINFO& rValue)
+	// If bData is TRUE the data of every value is read by the same enumeration call.
+	HRESULT VisitValue(REGVALUEVISITOR fVisit, BOOL bData) const;
+	HRESULT VisitAllValue(REGVALUEVISITOR fVisit, BOOL bData) const;
+	// Search the sub keys / values of the keys matching rOptions.lpPath whose names match rOptions.lpName.
+	// Matches are passed to fVisit as they are found. Sub trees that cannot match lpPath are not opened, and
+	// literal path components are opened directly (vPath then has the spelling of the pattern).
+	// REG_VISIT_SKIP on a sub key does not search below it, REG_VISIT_STOP ends the search.
+	HRESULT Search(const REGSEARCHOPTIONS& rOptions, REGSEARCHVISITOR fVisit) const;
 
 	// Set registry key permissions
 	// Provide security descriptor string.
 	HRESULT SetSecurityInfo(LPCSTR lpSddl) const;
 
+	// UTF-16 and UTF-8 interface
+	// Names and strings reach the backend as UTF-16 (the *W functions), without the ANSI code page conversion.
+	// Views do not need a terminator. Conversions use thread-local buffers, so once they have grown no call
+	// allocates except for growing the caller's result. GetPath of a key opened here returns the ANSI form of the path,
+	// GetPathUTF8 returns it as it was given.
+	HRESULT CreateW(HKEY hRoot, std::wstring_view lpPath, REGSAM ulSam);
+	HRESULT OpenW(HKEY hRoot, std::wstring_view lpPath, REGSAM ulSam);
+	HRESULT CreateUTF8(HKEY hRoot, std::string_view lpPath, REGSAM ulSam);
+	HRESULT OpenUTF8(HKEY hRoot, std::string_view lpPath, REGSAM ulSam);
+	HRESULT GetPathUTF8(std::string* lpOutPath) const;
+	HRESULT WriteREGSZ(std::wstring_view lpName, std::wstring_view lpVal) const;
+	HRESULT WriteREGEXPANDSZ(std::wstring_view lpName, std::wstring_view lpVal) const;
+	HRESULT WriteValue(std::wstring_view lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) const;
+	HRESULT WriteREGSZUTF8(std::string_view lpName, std::string_view lpVal) const;
+	HRESULT WriteREGEXPANDSZUTF8(std::string_view lpName, std::string_view lpVal) const;
+	HRESULT WriteValueUTF8(std::string_view lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) const;
+	HRESULT DeleteValue(std::wstring_view lpName) const;
+	HRESULT DeleteValueUTF8(std::string_view lpName) const;
+	HRESULT ReadREGSZ(std::wstring_view lpName, std::wstring* lpRes) const;
+	HRESULT ReadREGEXPANDSZ(std::wstring_view lpName, std::wstring* lpRes) const;
+	HRESULT ReadValue(std::wstring_view lpName, DWORD* pdwType, std::vector<BYTE>* lpRes) const;
+	HRESULT ReadREGSZUTF8(std::string_view lpName, std::string* lpRes) const;
+	HRESULT ReadREGEXPANDSZUTF8(std::string_view lpName, std::string* lpRes) const;
+	HRESULT ReadValueUTF8(std::string_view lpName, DWORD* pdwType, std::vector<BYTE>* lpRes) const;
+
 };
 
 #endif
@@ -0,0 +1,260 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegMemory.h"
+#include <mutex>
+
+static std::string FoldName(LPCSTR lpName, size_t ulLen) {
+	std::string cRes(lpName, ulLen);
+	for (CHAR& c : cRes) {
+		if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+	}
+	return cRes;
+}
+
+static LSTATUS CopyData(const std::vector<BYTE>& lpSrc, BYTE* lpData, DWORD* pdwSize) {
+	DWORD dwNeed = static_cast<DWORD>(lpSrc.size());
+	if (lpData != nullptr) {
+		if (pdwSize == nullptr) return ERROR_INVALID_PARAMETER;
+		if (*pdwSize < dwNeed) {
+			*pdwSize = dwNeed;
+			return ERROR_MORE_DATA;
+		}
+		if (dwNeed != 0) memcpy(lpData, lpSrc.data(), dwNeed);
+	}
+	if (pdwSize != nullptr) *pdwSize = dwNeed;
+	return ERROR_SUCCESS;
+}
+
+static LSTATUS CopyName(const std::string& cName, LPSTR lpName, DWORD* pdwNameSize) {
+	if (lpName == nullptr || pdwNameSize == nullptr) return ERROR_INVALID_PARAMETER;
+	if (*pdwNameSize < cName.size() + 1) return ERROR_MORE_DATA;
+	memcpy(lpName, cName.c_str(), cName.size() + 1);
+	*pdwNameSize = static_cast<DWORD>(cName.size());
+	return ERROR_SUCCESS;
+}
+
+
+REGMEMORYBACKEND::REGMEMORYBACKEND() {
+	for (INT i = 0; i < 5; i++) pRoots[i] = NewNode(nullptr, "");
+}
+
+REGMEMORYBACKEND::NODE* REGMEMORYBACKEND::NewNode(NODE* pParent, const std::string& cName) {
+	dNodes.emplace_back();
+	NODE* pNode = &dNodes.back();
+	pNode->cName = cName;
+	pNode->pParent = pParent;
+	pNode->bDeleted = FALSE;
+	return pNode;
+}
+
+REGMEMORYBACKEND::NODE* REGMEMORYBACKEND::GetNode(HKEY hKey) const {
+	if (hKey == HKEY_CLASSES_ROOT) return pRoots[0];
+	if (hKey == HKEY_CURRENT_USER) return pRoots[1];
+	if (hKey == HKEY_LOCAL_MACHINE) return pRoots[2];
+	if (hKey == HKEY_USERS) return pRoots[3];
+	if (hKey == HKEY_CURRENT_CONFIG) return pRoots[4];
+	return reinterpret_cast<NODE*>(hKey);
+}
+
+LSTATUS REGMEMORYBACKEND::OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	if (phOutKey == nullptr) return ERROR_INVALID_PARAMETER;
+	NODE* pNode = GetNode(hParent);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	if (lpPath == nullptr) lpPath = "";
+
+	// Creation needs the exclusive lock, lookups share it
+	std::unique_lock<std::shared_mutex> lWrite(mLock, std::defer_lock);
+	std::shared_lock<std::shared_mutex> lRead(mLock, std::defer_lock);
+	if (bCreate) lWrite.lock();
+	else lRead.lock();
+
+	if (pNode->bDeleted) return ERROR_KEY_DELETED;
+	LPCSTR p = lpPath;
+	while (*p) {
+		LPCSTR pEnd = strchr(p, '\\');
+		size_t ulLen = (pEnd == nullptr ? strlen(p) : static_cast<size_t>(pEnd - p));
+		if (ulLen != 0) {
+			if (ulLen > 255) return ERROR_INVALID_PARAMETER;
+			std::string cFold = FoldName(p, ulLen);
+			auto it = pNode->mSubKeyIndex.find(cFold);
+			if (it != pNode->mSubKeyIndex.end()) pNode = pNode->vSubKeys[it->second];
+			else if (bCreate) {
+				NODE* pSon = NewNode(pNode, std::string(p, ulLen));
+				pNode->mSubKeyIndex.emplace(cFold, pNode->vSubKeys.size());
+				pNode->vSubKeys.push_back(pSon);
+				pNode = pSon;
+			}
+			else return ERROR_FILE_NOT_FOUND;
+		}
+		if (pEnd == nullptr) break;
+		p = pEnd + 1;
+	}
+	*phOutKey = reinterpret_cast<HKEY>(pNode);
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGMEMORYBACKEND::CloseKey(HKEY hKey) {
+	if (GetNode(hKey) == nullptr) return ERROR_INVALID_HANDLE;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGMEMORYBACKEND::DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) {
+	HKEY hTarget = hKey;
+	if (lpSubKey != nullptr && *lpSubKey) {
+		LSTATUS lRes = OpenKey(hKey, lpSubKey, ulSam, FALSE, &hTarget);
+		if (lRes != ERROR_SUCCESS) return lRes;
+	}
+	NODE* pNode = GetNode(hTarget);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	std::unique_lock<std::shared_mutex> lWrite(mLock);
+	if (pNode->bDeleted) return ERROR_KEY_DELETED;
+	if (pNode->pParent == nullptr || !pNode->vSubKeys.empty()) return ERROR_ACCESS_DENIED;
+
+	// Remove from the parent by moving the last sub key into its slot
+	NODE* pParent = pNode->pParent;
+	auto it = pParent->mSubKeyIndex.find(FoldName(pNode->cName.c_str(), pNode->cName.size()));
+	size_t ulPos = it->second;
+	pParent->mSubKeyIndex.erase(it);
+	if (ulPos != pParent->vSubKeys.size() - 1) {
+		NODE* pLast = pParent->vSubKeys.back();
+		pParent->vSubKeys[ulPos] = pLast;
+		pParent->mSubKeyIndex[FoldName(pLast->cName.c_str(), pLast->cName.size())] = ulPos;
+	}
+	pParent->vSubKeys.pop_back();
+
+	pNode->bDeleted = TRUE;
+	pNode->vValues.clear();
+	pNode->mValueIndex.clear();
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGMEMORYBACKEND::SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	NODE* pNode = GetNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	if (lpData == nullptr && dwSize != 0) return ERROR_INVALID_PARAMETER;
+	if (lpName == nullptr) lpName = "";
+	std::unique_lock<std::shared_mutex> lWrite(mLock);
+	if (pNode->bDeleted) return ERROR_KEY_DELETED;
+	std::string cFold = FoldName(lpName, strlen(lpName));
+	auto it = pNode->mValueIndex.find(cFold);
+	if (it == pNode->mValueIndex.end()) {
+		it = pNode->mValueIndex.emplace(cFold, pNode->vValues.size()).first;
+		pNode->vValues.push_back({ lpName, REG_NONE, {} });
+	}
+	VALUE& rValue = pNode->vValues[it->second];
+	rValue.dwType = dwType;
+	rValue.lpData.assign(lpData, lpData + dwSize);
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGMEMORYBACKEND::QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	NODE* pNode = GetNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	if (lpName == nullptr) lpName = "";
+	std::shared_lock<std::shared_mutex> lRead(mLock);
+	if (pNode->bDeleted) return ERROR_KEY_DELETED;
+	auto it = pNode->mValueIndex.find(FoldName(lpName, strlen(lpName)));
+	if (it == pNode->mValueIndex.end()) return ERROR_FILE_NOT_FOUND;
+	const VALUE& rValue = pNode->vValues[it->second];
+	if (pdwType != nullptr) *pdwType = rValue.dwType;
+	return CopyData(rValue.lpData, lpData, pdwSize);
+}
+
+LSTATUS REGMEMORYBACKEND::DeleteValue(HKEY hKey, LPCSTR lpName) {
+	NODE* pNode = GetNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	if (lpName == nullptr) lpName = "";
+	std::unique_lock<std::shared_mutex> lWrite(mLock);
+	if (pNode->bDeleted) return ERROR_KEY_DELETED;
+	auto it = pNode->mValueIndex.find(FoldName(lpName, strlen(lpName)));
+	if (it == pNode->mValueIndex.end()) return ERROR_FILE_NOT_FOUND;
+	size_t ulPos = it->second;
+	pNode->mValueIndex.erase(it);
+	if (ulPos != pNode->vValues.size() - 1) {
+		pNode->vValues[ulPos] = std::move(pNode->vValues.back());
+		const std::string& cMoved = pNode->vValues[ulPos].cName;
+		pNode->mValueIndex[FoldName(cMoved.c_str(), cMoved.size())] = ulPos;
+	}
+	pNode->vValues.pop_back();
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGMEMORYBACKEND::EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) {
+	NODE* pNode = GetNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	std::shared_lock<std::shared_mutex> lRead(mLock);
+	if (pNode->bDeleted) return ERROR_KEY_DELETED;
+	if (dwIndex >= pNode->vSubKeys.size()) return ERROR_NO_MORE_ITEMS;
+	return CopyName(pNode->vSubKeys[dwIndex]->cName, lpName, pdwNameSize);
+}
+
+LSTATUS REGMEMORYBACKEND::EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	NODE* pNode = GetNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	std::shared_lock<std::shared_mutex> lRead(mLock);
+	if (pNode->bDeleted) return ERROR_KEY_DELETED;
+	if (dwIndex >= pNode->vValues.size()) return ERROR_NO_MORE_ITEMS;
+	const VALUE& rValue = pNode->vValues[dwIndex];
+	LSTATUS lRes = CopyName(rValue.cName, lpName, pdwNameSize);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	if (pdwType != nullptr) *pdwType = rValue.dwType;
+	return CopyData(rValue.lpData, lpData, pdwSize);
+}
+
+LSTATUS REGMEMORYBACKEND::SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) {
+	NODE* pNode = GetNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	if (pSD == nullptr) return ERROR_INVALID_PARAMETER;
+	std::shared_lock<std::shared_mutex> lRead(mLock);
+	if (pNode->bDeleted) return ERROR_KEY_DELETED;
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGMEMORYBACKEND::QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo) {
+	NODE* pNode = GetNode(hKey);
+	if (pNode == nullptr) return ERROR_INVALID_HANDLE;
+	if (pInfo == nullptr) return ERROR_INVALID_PARAMETER;
+	std::shared_lock<std::shared_mutex> lRead(mLock);
+	if (pNode->bDeleted) return ERROR_KEY_DELETED;
+	REGKEYINFO iInfo = { static_cast<DWORD>(pNode->vSubKeys.size()), 0, static_cast<DWORD>(pNode->vValues.size()), 0, 0 };
+	for (const NODE* pSubKey : pNode->vSubKeys) {
+		if (pSubKey->cName.size() > iInfo.dwMaxSubKeyLen) iInfo.dwMaxSubKeyLen = static_cast<DWORD>(pSubKey->cName.size());
+	}
+	for (const VALUE& rValue : pNode->vValues) {
+		if (rValue.cName.size() > iInfo.dwMaxValueNameLen) iInfo.dwMaxValueNameLen = static_cast<DWORD>(rValue.cName.size());
+		if (rValue.lpData.size() > iInfo.dwMaxValueLen) iInfo.dwMaxValueLen = static_cast<DWORD>(rValue.lpData.size());
+	}
+	*pInfo = iInfo;
+	return ERROR_SUCCESS;
+}
+
+void REGMEMORYBACKEND::Clear() {
+	std::unique_lock<std::shared_mutex> lWrite(mLock);
+	for (NODE& rNode : dNodes) {
+		if (rNode.pParent != nullptr) rNode.bDeleted = TRUE;
+		rNode.vSubKeys.clear();
+		rNode.mSubKeyIndex.clear();
+		rNode.vValues.clear();
+		rNode.mValueIndex.clear();
+	}
+}
@@ -0,0 +1,81 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGMEMORY_H
+#define REGMEMORY_H
+
+#include "RegKey.h"
+#include <deque>
+#include <unordered_map>
+#include <shared_mutex>
+
+// In-memory registry backend
+// A hierarchical store with the same semantics and error codes as the Windows registry, usable without a live registry.
+// Names are case-insensitive. Every node has hash indexes of its sub keys and values.
+// Nodes are allocated from an arena and are only freed with the backend, so handles to deleted keys stay valid
+// (operations on them return ERROR_KEY_DELETED). The handle of a key is the address of its node; CloseKey does nothing.
+class REGMEMORYBACKEND : public REGBACKEND {
+private:
+	struct VALUE {
+		std::string cName; // Name
+		DWORD dwType; // Type
+		std::vector<BYTE> lpData; // Data
+	};
+	struct NODE {
+		std::string cName; // Name
+		NODE* pParent; // Parent node
+		BOOL bDeleted; // Whether the key was deleted
+		std::vector<NODE*> vSubKeys; // Sub keys in enumeration order
+		std::unordered_map<std::string, size_t> mSubKeyIndex; // Folded name -> position in vSubKeys
+		std::vector<VALUE> vValues; // Values in enumeration order
+		std::unordered_map<std::string, size_t> mValueIndex; // Folded name -> position in vValues
+	};
+
+	std::deque<NODE> dNodes; // Node arena
+	NODE* pRoots[5]; // HKCR, HKCU, HKLM, HKU, HKCC
+	mutable std::shared_mutex mLock;
+
+	NODE* NewNode(NODE* pParent, const std::string& cName);
+	NODE* GetNode(HKEY hKey) const;
+
+public:
+	REGMEMORYBACKEND();
+	REGMEMORYBACKEND(const REGMEMORYBACKEND&) = delete;
+	REGMEMORYBACKEND& operator=(const REGMEMORYBACKEND&) = delete;
+
+	LSTATUS OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override;
+	LSTATUS CloseKey(HKEY hKey) override;
+	LSTATUS DeleteKey(HKEY hKey, LPCSTR lpSubKey, REGSAM ulSam) override;
+	LSTATUS SetValue(HKEY hKey, LPCSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) override;
+	LSTATUS QueryValue(HKEY hKey, LPCSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	LSTATUS DeleteValue(HKEY hKey, LPCSTR lpName) override;
+	LSTATUS EnumKey(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize) override;
+	LSTATUS EnumValue(HKEY hKey, DWORD dwIndex, LPSTR lpName, DWORD* pdwNameSize, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) override;
+	// Security descriptors are accepted and ignored
+	LSTATUS SetSecurity(HKEY hKey, SECURITY_INFORMATION ulInfo, PSECURITY_DESCRIPTOR pSD) override;
+	LSTATUS QueryInfoKey(HKEY hKey, REGKEYINFO* pInfo) override;
+
+	// Remove all keys and values
+	void Clear();
+};
+
+#endif
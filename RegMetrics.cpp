@@ -0,0 +1,410 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegMetrics.h"
+
+#ifndef REGKEY_NO_METRICS
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdio.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Counters of one thread. Only the owning thread writes them; snapshots read them with relaxed loads.
+struct REGMETRICBLOCK {
+	struct OPCOUNTERS {
+		std::atomic<ULONGLONG> ullCalls[REG_METRIC_ROOT_COUNT];
+		std::atomic<ULONGLONG> ullFailures[REG_METRIC_ROOT_COUNT];
+		std::atomic<ULONGLONG> ullBytesRead;
+		std::atomic<ULONGLONG> ullBytesWritten;
+		std::atomic<ULONGLONG> ullTotalNs;
+		std::atomic<ULONGLONG> ullMaxNs;
+		std::atomic<ULONGLONG> ullHistogram[REG_METRIC_BUCKETS];
+	};
+	// Failure ring entry, published with a sequence number (0 while it is written)
+	struct FAILURE {
+		std::atomic<ULONGLONG> ullSeq;
+		std::atomic<DWORD> dwOp;
+		std::atomic<DWORD> dwRoot;
+		std::atomic<LSTATUS> lStatus;
+		std::atomic<ULONGLONG> ullTime;
+	};
+
+	std::atomic<ULONGLONG> ullEpoch; // Reset epoch the counters belong to
+	OPCOUNTERS rOps[REG_METRIC_OP_COUNT];
+	FAILURE rFailures[REG_METRIC_FAILURE_RING];
+	ULONGLONG ullFailureSeq; // Written by the owner only
+};
+
+// Per-thread state of the operation in progress
+struct REGMETRICTHREAD {
+	DWORD dwDepth; // Nesting of REGMETRICSCOPE
+	LSTATUS lStatus; // Failure of the current operation
+	LSTATUS lLastStatus; // Failure of the last finished operation
+	ULONGLONG ullRead;
+	ULONGLONG ullWritten;
+	REGMETRICBLOCK* pBlock; // Taken on the first operation of the thread
+
+	REGMETRICTHREAD() : dwDepth(0), lStatus(ERROR_SUCCESS), lLastStatus(ERROR_SUCCESS), ullRead(0), ullWritten(0), pBlock(nullptr) {}
+	~REGMETRICTHREAD();
+};
+
+// All blocks ever created. A block of an exited thread is reused by the next new thread, so counters are never lost
+// and the number of blocks is bounded by the peak number of threads.
+struct REGMETRICREGISTRY {
+	std::mutex mLock;
+	std::vector<REGMETRICBLOCK*> vBlocks;
+	std::vector<REGMETRICBLOCK*> vFree;
+	std::atomic<ULONGLONG> ullEpoch;
+
+	REGMETRICREGISTRY() : ullEpoch(1) {}
+};
+
+static REGMETRICREGISTRY* GetRegMetricRegistry() {
+	// Never destroyed, blocks can be returned by threads exiting after static destruction
+	static REGMETRICREGISTRY* pRegistry = new REGMETRICREGISTRY();
+	return pRegistry;
+}
+
+static thread_local REGMETRICTHREAD tThread;
+
+REGMETRICTHREAD::~REGMETRICTHREAD() {
+	if (pBlock == nullptr) return;
+	REGMETRICREGISTRY* pRegistry = GetRegMetricRegistry();
+	std::lock_guard<std::mutex> lGuard(pRegistry->mLock);
+	pRegistry->vFree.push_back(pBlock);
+}
+
+static REGMETRICBLOCK* TakeBlock() {
+	REGMETRICREGISTRY* pRegistry = GetRegMetricRegistry();
+	std::lock_guard<std::mutex> lGuard(pRegistry->mLock);
+	if (!pRegistry->vFree.empty()) {
+		REGMETRICBLOCK* pBlock = pRegistry->vFree.back();
+		pRegistry->vFree.pop_back();
+		return pBlock;
+	}
+	// Value-initialized: all counters and epoch 0, so the first operation clears nothing but sets the epoch
+	REGMETRICBLOCK* pBlock = new REGMETRICBLOCK();
+	pRegistry->vBlocks.push_back(pBlock);
+	return pBlock;
+}
+
+// Single writer increment, no read-modify-write needed
+static inline void Bump(std::atomic<ULONGLONG>& rCounter, ULONGLONG ullAdd) {
+	rCounter.store(rCounter.load(std::memory_order_relaxed) + ullAdd, std::memory_order_relaxed);
+}
+
+static void ClearBlock(REGMETRICBLOCK* pBlock) {
+	for (REGMETRICBLOCK::OPCOUNTERS& rOp : pBlock->rOps) {
+		for (DWORD i = 0; i < REG_METRIC_ROOT_COUNT; i++) {
+			rOp.ullCalls[i].store(0, std::memory_order_relaxed);
+			rOp.ullFailures[i].store(0, std::memory_order_relaxed);
+		}
+		rOp.ullBytesRead.store(0, std::memory_order_relaxed);
+		rOp.ullBytesWritten.store(0, std::memory_order_relaxed);
+		rOp.ullTotalNs.store(0, std::memory_order_relaxed);
+		rOp.ullMaxNs.store(0, std::memory_order_relaxed);
+		for (std::atomic<ULONGLONG>& rBucket : rOp.ullHistogram) rBucket.store(0, std::memory_order_relaxed);
+	}
+	for (REGMETRICBLOCK::FAILURE& rFailure : pBlock->rFailures) rFailure.ullSeq.store(0, std::memory_order_relaxed);
+}
+
+static DWORD HighBit(ULONGLONG ullValue) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long ulIndex = 0;
+	_BitScanReverse64(&ulIndex, ullValue);
+	return ulIndex;
+#elif defined(__GNUC__)
+	return 63 - __builtin_clzll(ullValue);
+#else
+	DWORD dwIndex = 0;
+	while (ullValue >>= 1) dwIndex++;
+	return dwIndex;
+#endif
+}
+
+// Values below REG_METRIC_SUB_COUNT get their own bucket; above, every power of two is split into
+// REG_METRIC_SUB_COUNT linear sub buckets.
+static DWORD BucketOf(ULONGLONG ullNs) {
+	const ULONGLONG ullMax = (2ull << REG_METRIC_MAX_SHIFT) - 1;
+	if (ullNs > ullMax) ullNs = ullMax;
+	if (ullNs < REG_METRIC_SUB_COUNT) return static_cast<DWORD>(ullNs);
+	DWORD dwShift = HighBit(ullNs);
+	DWORD dwSub = static_cast<DWORD>(ullNs >> (dwShift - REG_METRIC_SUB_BITS)) & (REG_METRIC_SUB_COUNT - 1);
+	return (dwShift - REG_METRIC_SUB_BITS + 1) * REG_METRIC_SUB_COUNT + dwSub;
+}
+
+ULONGLONG GetRegMetricBucketLow(DWORD dwIndex) {
+	if (dwIndex < REG_METRIC_SUB_COUNT) return dwIndex;
+	DWORD dwShift = dwIndex / REG_METRIC_SUB_COUNT + REG_METRIC_SUB_BITS - 1;
+	ULONGLONG ullSub = dwIndex % REG_METRIC_SUB_COUNT;
+	return (REG_METRIC_SUB_COUNT + ullSub) << (dwShift - REG_METRIC_SUB_BITS);
+}
+
+static REGMETRICROOT RootOf(HKEY hRoot) {
+	if (hRoot == HKEY_CLASSES_ROOT) return REG_METRIC_ROOT_HKCR;
+	if (hRoot == HKEY_CURRENT_USER) return REG_METRIC_ROOT_HKCU;
+	if (hRoot == HKEY_LOCAL_MACHINE) return REG_METRIC_ROOT_HKLM;
+	if (hRoot == HKEY_USERS) return REG_METRIC_ROOT_HKU;
+	if (hRoot == HKEY_CURRENT_CONFIG) return REG_METRIC_ROOT_HKCC;
+	return REG_METRIC_ROOT_OTHER;
+}
+
+static ULONGLONG NowNs(std::chrono::steady_clock::time_point tTime) {
+	return static_cast<ULONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(tTime.time_since_epoch()).count());
+}
+
+REGMETRICSCOPE::REGMETRICSCOPE(REGMETRICOP eInOp, HKEY hInRoot) : pThread(&tThread), eOp(eInOp), hRoot(hInRoot) {
+	if (pThread->dwDepth++ != 0) return;
+	pThread->lStatus = ERROR_SUCCESS;
+	pThread->ullRead = 0;
+	pThread->ullWritten = 0;
+	tStart = std::chrono::steady_clock::now();
+}
+
+REGMETRICSCOPE::~REGMETRICSCOPE() {
+	if (--pThread->dwDepth != 0) return;
+	std::chrono::steady_clock::time_point tEnd = std::chrono::steady_clock::now();
+	ULONGLONG ullNs = static_cast<ULONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(tEnd - tStart).count());
+	pThread->lLastStatus = pThread->lStatus;
+
+	if (pThread->pBlock == nullptr) pThread->pBlock = TakeBlock();
+	REGMETRICBLOCK* pBlock = pThread->pBlock;
+	// Counters written before a reset are cleared by their owner, so a reset never races with an update
+	ULONGLONG ullEpoch = GetRegMetricRegistry()->ullEpoch.load(std::memory_order_acquire);
+	if (pBlock->ullEpoch.load(std::memory_order_relaxed) != ullEpoch) {
+		ClearBlock(pBlock);
+		pBlock->ullEpoch.store(ullEpoch, std::memory_order_release);
+	}
+
+	REGMETRICROOT eRoot = RootOf(hRoot);
+	REGMETRICBLOCK::OPCOUNTERS& rOp = pBlock->rOps[eOp];
+	Bump(rOp.ullCalls[eRoot], 1);
+	Bump(rOp.ullTotalNs, ullNs);
+	Bump(rOp.ullHistogram[BucketOf(ullNs)], 1);
+	if (ullNs > rOp.ullMaxNs.load(std::memory_order_relaxed)) rOp.ullMaxNs.store(ullNs, std::memory_order_relaxed);
+	if (pThread->ullRead != 0) Bump(rOp.ullBytesRead, pThread->ullRead);
+	if (pThread->ullWritten != 0) Bump(rOp.ullBytesWritten, pThread->ullWritten);
+	if (pThread->lStatus == ERROR_SUCCESS) return;
+
+	Bump(rOp.ullFailures[eRoot], 1);
+	ULONGLONG ullSeq = ++pBlock->ullFailureSeq;
+	REGMETRICBLOCK::FAILURE& rFailure = pBlock->rFailures[ullSeq % REG_METRIC_FAILURE_RING];
+	rFailure.ullSeq.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	rFailure.dwOp.store(eOp, std::memory_order_relaxed);
+	rFailure.dwRoot.store(eRoot, std::memory_order_relaxed);
+	rFailure.lStatus.store(pThread->lStatus, std::memory_order_relaxed);
+	rFailure.ullTime.store(NowNs(tEnd), std::memory_order_relaxed);
+	rFailure.ullSeq.store(ullSeq, std::memory_order_release);
+}
+
+void RegMetricStatus(LSTATUS lRes) {
+	if (lRes == ERROR_SUCCESS || lRes == ERROR_MORE_DATA || lRes == ERROR_NO_MORE_ITEMS) return;
+	if (tThread.dwDepth != 0) tThread.lStatus = lRes;
+}
+
+void RegMetricBytes(ULONGLONG ullRead, ULONGLONG ullWritten) {
+	REGMETRICTHREAD* pThread = &tThread;
+	if (pThread->dwDepth == 0) return;
+	pThread->ullRead += ullRead;
+	pThread->ullWritten += ullWritten;
+}
+
+LSTATUS GetRegLastStatus() {
+	return tThread.lLastStatus;
+}
+
+void ResetRegMetrics() {
+	GetRegMetricRegistry()->ullEpoch.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void CaptureRegMetrics(REGMETRICSSNAPSHOT* pOut) {
+	if (pOut == nullptr) return;
+	for (REGMETRICSSNAPSHOT::OPSTATS& rOp : pOut->rOps) {
+		std::fill(rOp.ullCalls, rOp.ullCalls + REG_METRIC_ROOT_COUNT, 0);
+		std::fill(rOp.ullFailures, rOp.ullFailures + REG_METRIC_ROOT_COUNT, 0);
+		rOp.ullBytesRead = 0;
+		rOp.ullBytesWritten = 0;
+		rOp.ullTotalNs = 0;
+		rOp.ullMaxNs = 0;
+		rOp.vHistogram.assign(REG_METRIC_BUCKETS, 0);
+	}
+	pOut->vFailures.clear();
+
+	REGMETRICREGISTRY* pRegistry = GetRegMetricRegistry();
+	ULONGLONG ullEpoch = pRegistry->ullEpoch.load(std::memory_order_acquire);
+	std::vector<REGMETRICBLOCK*> vBlocks;
+	{
+		std::lock_guard<std::mutex> lGuard(pRegistry->mLock);
+		vBlocks = pRegistry->vBlocks;
+	}
+	for (REGMETRICBLOCK* pBlock : vBlocks) {
+		// A block of an older epoch has not recorded anything since the reset
+		if (pBlock->ullEpoch.load(std::memory_order_acquire) != ullEpoch) continue;
+		for (DWORD dwOp = 0; dwOp < REG_METRIC_OP_COUNT; dwOp++) {
+			const REGMETRICBLOCK::OPCOUNTERS& rIn = pBlock->rOps[dwOp];
+			REGMETRICSSNAPSHOT::OPSTATS& rOp = pOut->rOps[dwOp];
+			for (DWORD i = 0; i < REG_METRIC_ROOT_COUNT; i++) {
+				rOp.ullCalls[i] += rIn.ullCalls[i].load(std::memory_order_relaxed);
+				rOp.ullFailures[i] += rIn.ullFailures[i].load(std::memory_order_relaxed);
+			}
+			rOp.ullBytesRead += rIn.ullBytesRead.load(std::memory_order_relaxed);
+			rOp.ullBytesWritten += rIn.ullBytesWritten.load(std::memory_order_relaxed);
+			rOp.ullTotalNs += rIn.ullTotalNs.load(std::memory_order_relaxed);
+			rOp.ullMaxNs = std::max(rOp.ullMaxNs, rIn.ullMaxNs.load(std::memory_order_relaxed));
+			for (DWORD i = 0; i < REG_METRIC_BUCKETS; i++) rOp.vHistogram[i] += rIn.ullHistogram[i].load(std::memory_order_relaxed);
+		}
+		for (const REGMETRICBLOCK::FAILURE& rIn : pBlock->rFailures) {
+			ULONGLONG ullSeq = rIn.ullSeq.load(std::memory_order_acquire);
+			if (ullSeq == 0) continue;
+			REGMETRICFAILURE rFailure;
+			rFailure.eOp = static_cast<REGMETRICOP>(rIn.dwOp.load(std::memory_order_relaxed));
+			rFailure.eRoot = static_cast<REGMETRICROOT>(rIn.dwRoot.load(std::memory_order_relaxed));
+			rFailure.lStatus = rIn.lStatus.load(std::memory_order_relaxed);
+			rFailure.ullTime = rIn.ullTime.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			// Skip an entry that was overwritten while it was read
+			if (rIn.ullSeq.load(std::memory_order_relaxed) != ullSeq) continue;
+			pOut->vFailures.push_back(rFailure);
+		}
+	}
+	std::sort(pOut->vFailures.begin(), pOut->vFailures.end(), [](const REGMETRICFAILURE& a, const REGMETRICFAILURE& b) {
+		return a.ullTime < b.ullTime;
+	});
+}
+
+ULONGLONG REGMETRICSSNAPSHOT::GetCalls(REGMETRICOP eOp) const {
+	ULONGLONG ullRes = 0;
+	for (DWORD i = 0; i < REG_METRIC_ROOT_COUNT; i++) ullRes += rOps[eOp].ullCalls[i];
+	return ullRes;
+}
+
+ULONGLONG REGMETRICSSNAPSHOT::GetFailures(REGMETRICOP eOp) const {
+	ULONGLONG ullRes = 0;
+	for (DWORD i = 0; i < REG_METRIC_ROOT_COUNT; i++) ullRes += rOps[eOp].ullFailures[i];
+	return ullRes;
+}
+
+ULONGLONG REGMETRICSSNAPSHOT::GetPercentile(REGMETRICOP eOp, double dPercent) const {
+	const OPSTATS& rOp = rOps[eOp];
+	ULONGLONG ullCount = 0;
+	for (ULONGLONG ullBucket : rOp.vHistogram) ullCount += ullBucket;
+	if (ullCount == 0) return 0;
+	if (dPercent < 0.0) dPercent = 0.0;
+	if (dPercent > 100.0) dPercent = 100.0;
+	ULONGLONG ullRank = static_cast<ULONGLONG>(dPercent / 100.0 * static_cast<double>(ullCount) + 0.5);
+	if (ullRank == 0) ullRank = 1;
+	ULONGLONG ullSeen = 0;
+	for (DWORD i = 0; i < rOp.vHistogram.size(); i++) {
+		ullSeen += rOp.vHistogram[i];
+		if (ullSeen < ullRank) continue;
+		ULONGLONG ullHigh = (i + 1 < REG_METRIC_BUCKETS) ? GetRegMetricBucketLow(i + 1) - 1 : rOp.ullMaxNs;
+		return std::min(ullHigh, rOp.ullMaxNs);
+	}
+	return rOp.ullMaxNs;
+}
+
+LPCSTR GetRegMetricOpName(REGMETRICOP eOp) {
+	static const LPCSTR lpNames[REG_METRIC_OP_COUNT] = {
+		"open", "close", "read", "readbatch", "write", "deletevalue", "deletekey", "enum", "search", "security"
+	};
+	if (eOp < 0 || eOp >= REG_METRIC_OP_COUNT) return "";
+	return lpNames[eOp];
+}
+
+LPCSTR GetRegMetricRootName(REGMETRICROOT eRoot) {
+	static const LPCSTR lpNames[REG_METRIC_ROOT_COUNT] = { "HKCR", "HKCU", "HKLM", "HKU", "HKCC", "other" };
+	if (eRoot < 0 || eRoot >= REG_METRIC_ROOT_COUNT) return "";
+	return lpNames[eRoot];
+}
+
+static void AppendField(std::string* lpOut, LPCSTR lpName, ULONGLONG ullValue, BOOL bLast = FALSE) {
+	CHAR kBuffer[64];
+	snprintf(kBuffer, sizeof(kBuffer), "\"%s\":%llu%s", lpName, ullValue, bLast ? "" : ",");
+	lpOut->append(kBuffer);
+}
+
+HRESULT ExportRegMetrics(const REGMETRICSSNAPSHOT& rSnapshot, std::string* lpOut) {
+	if (lpOut == nullptr) return REG_INVAILD_POINTER;
+	lpOut->clear();
+	lpOut->append("{\"ops\":[");
+	BOOL bFirst = TRUE;
+	for (DWORD dwOp = 0; dwOp < REG_METRIC_OP_COUNT; dwOp++) {
+		REGMETRICOP eOp = static_cast<REGMETRICOP>(dwOp);
+		const REGMETRICSSNAPSHOT::OPSTATS& rOp = rSnapshot.rOps[dwOp];
+		ULONGLONG ullCalls = rSnapshot.GetCalls(eOp);
+		if (ullCalls == 0) continue;
+		if (!bFirst) lpOut->push_back(',');
+		bFirst = FALSE;
+		lpOut->append("{\"op\":\"").append(GetRegMetricOpName(eOp)).append("\",");
+		AppendField(lpOut, "calls", ullCalls);
+		AppendField(lpOut, "failures", rSnapshot.GetFailures(eOp));
+		AppendField(lpOut, "bytes_read", rOp.ullBytesRead);
+		AppendField(lpOut, "bytes_written", rOp.ullBytesWritten);
+		AppendField(lpOut, "mean_ns", rOp.ullTotalNs / ullCalls);
+		AppendField(lpOut, "p50_ns", rSnapshot.GetPercentile(eOp, 50.0));
+		AppendField(lpOut, "p90_ns", rSnapshot.GetPercentile(eOp, 90.0));
+		AppendField(lpOut, "p99_ns", rSnapshot.GetPercentile(eOp, 99.0));
+		AppendField(lpOut, "p999_ns", rSnapshot.GetPercentile(eOp, 99.9));
+		AppendField(lpOut, "max_ns", rOp.ullMaxNs);
+		lpOut->append("\"roots\":{");
+		BOOL bFirstRoot = TRUE;
+		for (DWORD i = 0; i < REG_METRIC_ROOT_COUNT; i++) {
+			if (rOp.ullCalls[i] == 0) continue;
+			if (!bFirstRoot) lpOut->push_back(',');
+			bFirstRoot = FALSE;
+			lpOut->append("\"").append(GetRegMetricRootName(static_cast<REGMETRICROOT>(i))).append("\":{");
+			AppendField(lpOut, "calls", rOp.ullCalls[i]);
+			AppendField(lpOut, "failures", rOp.ullFailures[i], TRUE);
+			lpOut->push_back('}');
+		}
+		// Non-empty buckets as [lowest ns, count]
+		lpOut->append("},\"histogram\":[");
+		BOOL bFirstBucket = TRUE;
+		for (DWORD i = 0; i < rOp.vHistogram.size(); i++) {
+			if (rOp.vHistogram[i] == 0) continue;
+			CHAR kBuffer[64];
+			snprintf(kBuffer, sizeof(kBuffer), "%s[%llu,%llu]", bFirstBucket ? "" : ",", GetRegMetricBucketLow(i), rOp.vHistogram[i]);
+			lpOut->append(kBuffer);
+			bFirstBucket = FALSE;
+		}
+		lpOut->append("]}");
+	}
+	lpOut->append("],\"failures\":[");
+	for (size_t i = 0; i < rSnapshot.vFailures.size(); i++) {
+		const REGMETRICFAILURE& rFailure = rSnapshot.vFailures[i];
+		if (i != 0) lpOut->push_back(',');
+		lpOut->append("{\"op\":\"").append(GetRegMetricOpName(rFailure.eOp)).append("\",\"root\":\"");
+		lpOut->append(GetRegMetricRootName(rFailure.eRoot)).append("\",");
+		AppendField(lpOut, "status", static_cast<ULONGLONG>(static_cast<DWORD>(rFailure.lStatus)));
+		AppendField(lpOut, "time_ns", rFailure.ullTime, TRUE);
+		lpOut->push_back('}');
+	}
+	lpOut->append("]}");
+	return REG_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGMETRICS_H
+#define REGMETRICS_H
+
+#include "RegKey.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+// REGKEY operation instrumentation
+// Every REGKEY operation that reaches the backend is timed and counted per operation and per root. Latencies go into
+// a per-thread log-linear histogram (HDR style, 16 sub buckets per power of two, so about 6% relative error).
+// A thread only writes its own counters without atomic read-modify-write or locks; snapshots merge all threads.
+// Define REGKEY_NO_METRICS to compile all of it away: the hooks expand to nothing and this API is not declared.
+
+// Operation classes
+enum REGMETRICOP {
+	REG_METRIC_OPEN, // Create, Open, GetParent, GetSon
+	REG_METRIC_CLOSE, // Close
+	REG_METRIC_READ, // Read*, GetTypeSize
+	REG_METRIC_READBATCH, // ReadValues
+	REG_METRIC_WRITE, // Write*
+	REG_METRIC_DELETEVALUE, // DeleteValue
+	REG_METRIC_DELETEKEY, // Delete, DeleteTree
+	REG_METRIC_ENUM, // Enum*, Visit*, GetSonName, GetValueName
+	REG_METRIC_SEARCH, // Search
+	REG_METRIC_SECURITY, // SetSecurityInfo
+	REG_METRIC_OP_COUNT
+};
+
+// Roots counted separately (REG_METRIC_ROOT_OTHER is a key that is not opened or has another root)
+enum REGMETRICROOT {
+	REG_METRIC_ROOT_HKCR,
+	REG_METRIC_ROOT_HKCU,
+	REG_METRIC_ROOT_HKLM,
+	REG_METRIC_ROOT_HKU,
+	REG_METRIC_ROOT_HKCC,
+	REG_METRIC_ROOT_OTHER,
+	REG_METRIC_ROOT_COUNT
+};
+
+#define REG_METRIC_SUB_BITS 4
+#define REG_METRIC_SUB_COUNT (1 << REG_METRIC_SUB_BITS)
+#define REG_METRIC_MAX_SHIFT 36 // Latencies are clamped to 2^37 - 1 ns (about 137 s)
+#define REG_METRIC_BUCKETS ((REG_METRIC_MAX_SHIFT - REG_METRIC_SUB_BITS + 2) * REG_METRIC_SUB_COUNT)
+#define REG_METRIC_FAILURE_RING 64 // Recent failures kept per thread
+
+#ifndef REGKEY_NO_METRICS
+
+// Per-thread state of the operation in progress (RegMetrics.cpp)
+struct REGMETRICTHREAD;
+
+// Times one REGKEY operation. Nested operations (a REGKEY function calling another) are counted once, by the
+// outermost scope.
+class REGMETRICSCOPE {
+private:
+	REGMETRICTHREAD* pThread;
+	REGMETRICOP eOp;
+	HKEY hRoot;
+	std::chrono::steady_clock::time_point tStart;
+
+public:
+	REGMETRICSCOPE(REGMETRICOP eInOp, HKEY hInRoot);
+	REGMETRICSCOPE(const REGMETRICSCOPE&) = delete;
+	REGMETRICSCOPE& operator=(const REGMETRICSCOPE&) = delete;
+	~REGMETRICSCOPE();
+};
+
+// Report the result of a backend call of the current operation. Any status other than ERROR_SUCCESS, ERROR_MORE_DATA
+// and ERROR_NO_MORE_ITEMS marks the operation as failed with that status.
+void RegMetricStatus(LSTATUS lRes);
+// Report bytes of value data read from / written to the backend by the current operation
+void RegMetricBytes(ULONGLONG ullRead, ULONGLONG ullWritten);
+
+#define REG_METRIC_SCOPE(eOp, hRoot) REGMETRICSCOPE rMetricScope((eOp), (hRoot))
+#define REG_METRIC_STATUS(lRes) RegMetricStatus(static_cast<LSTATUS>(lRes))
+#define REG_METRIC_BYTES_READ(ullSize) RegMetricBytes((ullSize), 0)
+#define REG_METRIC_BYTES_WRITTEN(ullSize) RegMetricBytes(0, (ullSize))
+
+// Failed operation
+struct REGMETRICFAILURE {
+	REGMETRICOP eOp;
+	REGMETRICROOT eRoot;
+	LSTATUS lStatus; // Original status of the backend call that failed
+	ULONGLONG ullTime; // steady_clock time in ns
+};
+
+// Merged counters of all threads
+struct REGMETRICSSNAPSHOT {
+	struct OPSTATS {
+		ULONGLONG ullCalls[REG_METRIC_ROOT_COUNT];
+		ULONGLONG ullFailures[REG_METRIC_ROOT_COUNT];
+		ULONGLONG ullBytesRead;
+		ULONGLONG ullBytesWritten;
+		ULONGLONG ullTotalNs;
+		ULONGLONG ullMaxNs;
+		std::vector<ULONGLONG> vHistogram; // REG_METRIC_BUCKETS counts, see GetRegMetricBucketLow
+	};
+	OPSTATS rOps[REG_METRIC_OP_COUNT];
+	std::vector<REGMETRICFAILURE> vFailures; // Recent failures, oldest first
+
+	// Number of calls / failures of an operation over all roots
+	ULONGLONG GetCalls(REGMETRICOP eOp) const;
+	ULONGLONG GetFailures(REGMETRICOP eOp) const;
+	// Latency in ns below which dPercent percent of the calls of an operation completed (upper bound of its bucket)
+	ULONGLONG GetPercentile(REGMETRICOP eOp, double dPercent) const;
+};
+
+// Lowest latency in ns counted by a histogram bucket
+ULONGLONG GetRegMetricBucketLow(DWORD dwIndex);
+// Short name of an operation / root ("read", "HKLM")
+LPCSTR GetRegMetricOpName(REGMETRICOP eOp);
+LPCSTR GetRegMetricRootName(REGMETRICROOT eRoot);
+
+// Merge the counters of all threads. Counters of threads that have exited are kept.
+void CaptureRegMetrics(REGMETRICSSNAPSHOT* pOut);
+// Reset all counters. Each thread clears its own counters when it records its next operation.
+void ResetRegMetrics();
+// Export a snapshot as JSON (counters, percentiles, non-empty histogram buckets and recent failures)
+HRESULT ExportRegMetrics(const REGMETRICSSNAPSHOT& rSnapshot, std::string* lpOut);
+// Get the original status of the backend call that failed in the last REGKEY operation of this thread
+// (ERROR_SUCCESS if it did not fail in the backend)
+LSTATUS GetRegLastStatus();
+
+#else
+
+#define REG_METRIC_SCOPE(eOp, hRoot) ((void)0)
+#define REG_METRIC_STATUS(lRes) ((void)0)
+#define REG_METRIC_BYTES_READ(ullSize) ((void)0)
+#define REG_METRIC_BYTES_WRITTEN(ullSize) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,363 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegKey.h"
+#include "RegMetrics.h"
+#include "RegPath.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Keys enumerated ahead of the delivery (ordered mode). Workers wait when this many results are not delivered yet.
+#define REGWALK_ORDERED_WINDOW 1024
+
+enum REGWALKSTATE {
+	REGWALK_QUEUED,
+	REGWALK_RUNNING,
+	REGWALK_DONE
+};
+
+// Enumeration result of one key, kept until it is delivered (ordered mode)
+// The worker closes the key when it has enumerated it; the delivery opens it again as the parent of the callbacks.
+struct REGWALKNODE {
+	REGPATHID idPath; // Path of the key, a reference held by the node
+	DWORD dwDepth; // Depth below the opened item
+	std::vector<std::pair<std::string, DWORD>> vValues; // Values (EnumAllValue)
+	std::vector<std::string> vKeys; // Sub keys
+	std::vector<std::shared_ptr<REGWALKNODE>> vChildren; // Results of the sub keys, empty if they are not visited
+	REGWALKSTATE eState; // Guarded by REGPARALLELWALK::mDone
+	BOOL bOpened; // Whether the worker could open the key
+
+	REGWALKNODE(REGPATHID idInPath, DWORD dwInDepth) : idPath(idInPath), dwDepth(dwInDepth), eState(REGWALK_QUEUED), bOpened(FALSE) {
+		GetRegPathTable()->AddRef(idPath);
+	}
+	~REGWALKNODE() {
+		GetRegPathTable()->Release(idPath);
+	}
+};
+
+// Key waiting to be enumerated
+struct REGWALKTASK {
+	REGPATHID idPath; // Path of the key, a reference held by the task
+	DWORD dwDepth; // Depth below the opened item
+	std::shared_ptr<REGWALKNODE> pNode; // Result (ordered mode), also held while the task stays queued after the delivery ran it
+};
+
+// Parallel walk of a key tree
+// Every worker has a task deque: it takes its own newest task (depth first, so few keys are open at once)
+// and steals the oldest task of another worker (the largest sub trees) when its deque is empty.
+// In ordered mode the workers stop taking tasks while REGWALK_ORDERED_WINDOW results wait for the delivery, and the
+// delivering thread enumerates a key itself when it needs one that no worker has taken.
+class REGPARALLELWALK {
+private:
+	struct QUEUE {
+		std::mutex mLock;
+		std::deque<REGWALKTASK> dTasks;
+	};
+
+	const REGKEY& rRoot; // Opened item
+	BOOL bWide; // Paths are UTF-8 (REGKEY::IsWide)
+	REG_KEY_CALLBACK fKey; // Sub item callback (EnumAllKey)
+	REG_VALUE_CALLBACK fValue; // Sub value callback (EnumAllValue)
+	DWORD dwMaxDepth;
+	DWORD dwFlags;
+	std::vector<std::unique_ptr<QUEUE>> vQueues; // One per worker
+	std::atomic<LONGLONG> llQueued; // Tasks in the deques
+	std::atomic<LONGLONG> llPending; // Tasks queued or running
+	std::mutex mIdle; // Idle workers wait on cvIdle
+	std::condition_variable cvIdle;
+	std::mutex mCallback; // Serializes the callbacks
+	std::mutex mDone; // Guards REGWALKNODE::eState
+	std::condition_variable cvDone;
+	std::atomic<LONGLONG> llAhead; // Results not delivered yet (ordered mode)
+	std::atomic<HRESULT> hError; // First error
+
+	BOOL Visit(DWORD dwDepth) const { return dwMaxDepth == 0 || dwDepth <= dwMaxDepth; }
+	void Fail(HRESULT hRes);
+	BOOL Claim(REGWALKNODE* pNode);
+	BOOL Full() const { return llAhead.load() >= REGWALK_ORDERED_WINDOW; }
+	void Push(DWORD dwWorker, REGWALKTASK&& rTask);
+	BOOL Pop(DWORD dwWorker, REGWALKTASK* pTask);
+	void Process(DWORD dwWorker, REGWALKTASK& rTask);
+	void Finish();
+	void Work(DWORD dwWorker);
+	void Deliver(const std::shared_ptr<REGWALKNODE>& pNode);
+
+public:
+	REGPARALLELWALK(const REGKEY& rInRoot, REG_KEY_CALLBACK fInKey, REG_VALUE_CALLBACK fInValue, const REGENUMOPTIONS& rOptions);
+	HRESULT Run(DWORD dwThreads);
+};
+
+REGPARALLELWALK::REGPARALLELWALK(const REGKEY& rInRoot, REG_KEY_CALLBACK fInKey, REG_VALUE_CALLBACK fInValue, const REGENUMOPTIONS& rOptions) :
+	rRoot(rInRoot), bWide(rInRoot.IsWide()), fKey(fInKey), fValue(fInValue), dwMaxDepth(rOptions.dwMaxDepth), dwFlags(rOptions.dwFlags),
+	llQueued(0), llPending(0), llAhead(0), hError(REG_SUCCESS) {
+	return;
+}
+
+void REGPARALLELWALK::Fail(HRESULT hRes) {
+	HRESULT hExpected = REG_SUCCESS;
+	hError.compare_exchange_strong(hExpected, hRes);
+}
+
+// Take a queued ordered task, FALSE if another thread runs it
+BOOL REGPARALLELWALK::Claim(REGWALKNODE* pNode) {
+	std::lock_guard<std::mutex> lGuard(mDone);
+	if (pNode->eState != REGWALK_QUEUED) return FALSE;
+	pNode->eState = REGWALK_RUNNING;
+	return TRUE;
+}
+
+void REGPARALLELWALK::Push(DWORD dwWorker, REGWALKTASK&& rTask) {
+	llPending.fetch_add(1);
+	{
+		QUEUE& rQueue = *vQueues[dwWorker];
+		std::lock_guard<std::mutex> lGuard(rQueue.mLock);
+		rQueue.dTasks.push_back(std::move(rTask));
+	}
+	llQueued.fetch_add(1);
+	{
+		// Taking the lock orders the wake up after the wait predicate of an idle worker
+		std::lock_guard<std::mutex> lGuard(mIdle);
+	}
+	cvIdle.notify_one();
+}
+
+BOOL REGPARALLELWALK::Pop(DWORD dwWorker, REGWALKTASK* pTask) {
+	DWORD dwCount = static_cast<DWORD>(vQueues.size());
+	for (DWORD i = 0; i < dwCount; i++) {
+		QUEUE& rQueue = *vQueues[(dwWorker + i) % dwCount];
+		std::lock_guard<std::mutex> lGuard(rQueue.mLock);
+		if (rQueue.dTasks.empty()) continue;
+		if (i == 0) {
+			*pTask = std::move(rQueue.dTasks.back());
+			rQueue.dTasks.pop_back();
+		}
+		else {
+			*pTask = std::move(rQueue.dTasks.front());
+			rQueue.dTasks.pop_front();
+		}
+		llQueued.fetch_sub(1);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+void REGPARALLELWALK::Process(DWORD dwWorker, REGWALKTASK& rTask) {
+	REGKEY rKey(rRoot.pBackend);
+	BOOL bOrdered = (rTask.pNode != nullptr);
+	BOOL bLock = !(dwFlags & REGENUM_CONCURRENT_CALLBACK);
+	LSTATUS lOpen = ERROR_SUCCESS;
+	HRESULT hRes = rKey.Acquire(rRoot.hRootKey, rTask.idPath, rRoot.ulSam, FALSE, bWide, &lOpen);
+	if (lOpen == ERROR_FILE_NOT_FOUND) hRes = REG_PATH_NOT_EXIST;
+	if (hRes != REG_SUCCESS) Fail(hRes);
+
+	// One name buffer per key, used for the values and then for the sub keys
+	REGKEYINFO iInfo;
+	std::vector<CHAR> vName;
+	if (hRes == REG_SUCCESS) rKey.QueryEnumInfo(&iInfo);
+
+	if (hRes == REG_SUCCESS && fValue != nullptr) {
+		REGKEY::SizeEnumBuffers(iInfo, TRUE, &vName, nullptr);
+		if (bOrdered) rTask.pNode->vValues.reserve(iInfo.dwValues);
+		for (DWORD dwIndex = 0;; dwIndex++) {
+			DWORD dwNameSize = 0, dwType = 0;
+			LSTATUS lRes = rKey.EnumValueEntry(dwIndex, &vName, &dwNameSize, &dwType, nullptr, nullptr);
+			if (lRes == ERROR_NO_MORE_ITEMS) break;
+			if (lRes != ERROR_SUCCESS) {
+				Fail(lRes == ERROR_ACCESS_DENIED ? REG_ACCESS_DENIED : REG_UNKNOWN_ERROR);
+				break;
+			}
+			if (bOrdered) rTask.pNode->vValues.emplace_back(std::string(vName.data(), dwNameSize), dwType);
+			else if (bLock) {
+				std::lock_guard<std::mutex> lGuard(mCallback);
+				fValue(&rKey, vName.data(), dwType);
+			}
+			else fValue(&rKey, vName.data(), dwType);
+		}
+	}
+
+	// Sub keys are reported by EnumAllKey at depth + 1, and visited when something below them is reported
+	BOOL bReport = (fKey != nullptr && Visit(rTask.dwDepth + 1));
+	BOOL bDescend = Visit(rTask.dwDepth + (fKey != nullptr ? 2 : 1));
+	if (hRes == REG_SUCCESS && (bReport || bDescend)) {
+		REGKEY::SizeEnumBuffers(iInfo, FALSE, &vName, nullptr);
+		if (bOrdered) {
+			rTask.pNode->vKeys.reserve(iInfo.dwSubKeys);
+			rTask.pNode->vChildren.reserve(iInfo.dwSubKeys);
+		}
+		for (DWORD dwIndex = 0;; dwIndex++) {
+			DWORD dwNameSize = 0;
+			LSTATUS lRes = rKey.EnumKeyName(dwIndex, &vName, &dwNameSize);
+			if (lRes == ERROR_NO_MORE_ITEMS) break;
+			if (lRes != ERROR_SUCCESS) {
+				Fail(lRes == ERROR_ACCESS_DENIED ? REG_ACCESS_DENIED : REG_UNKNOWN_ERROR);
+				break;
+			}
+			const CHAR* kName = vName.data();
+			if (bReport && !bOrdered) {
+				if (bLock) {
+					std::lock_guard<std::mutex> lGuard(mCallback);
+					fKey(&rKey, kName);
+				}
+				else fKey(&rKey, kName);
+			}
+			std::shared_ptr<REGWALKNODE> pChild;
+			if (bOrdered) {
+				rTask.pNode->vKeys.emplace_back(kName, dwNameSize);
+			}
+			if (bDescend) {
+				REGWALKTASK tChild;
+				tChild.idPath = REGKEY::AppendName(rTask.idPath, bWide, std::string_view(kName, dwNameSize));
+				tChild.dwDepth = rTask.dwDepth + 1;
+				if (bOrdered) pChild = std::make_shared<REGWALKNODE>(tChild.idPath, tChild.dwDepth);
+				tChild.pNode = pChild;
+				Push(dwWorker, std::move(tChild));
+			}
+			if (bOrdered) rTask.pNode->vChildren.emplace_back(std::move(pChild));
+		}
+	}
+
+	if (bOrdered) {
+		// The key is closed here, not when the result is delivered
+		rTask.pNode->bOpened = (hRes == REG_SUCCESS);
+		rKey.Close();
+		llAhead.fetch_add(1);
+		std::lock_guard<std::mutex> lGuard(mDone);
+		rTask.pNode->eState = REGWALK_DONE;
+		cvDone.notify_all();
+	}
+}
+
+void REGPARALLELWALK::Finish() {
+	if (llPending.fetch_sub(1) == 1) {
+		std::lock_guard<std::mutex> lGuard(mIdle);
+		cvIdle.notify_all();
+	}
+}
+
+void REGPARALLELWALK::Work(DWORD dwWorker) {
+	REGWALKTASK tTask;
+	while (1) {
+		if (!Full() && Pop(dwWorker, &tTask)) {
+			// An ordered task the delivering thread has taken is only dropped from the deque
+			BOOL bRun = (tTask.pNode == nullptr || Claim(tTask.pNode.get()));
+			if (bRun) Process(dwWorker, tTask);
+			GetRegPathTable()->Release(tTask.idPath);
+			if (bRun) Finish();
+			tTask.pNode.reset();
+			continue;
+		}
+		std::unique_lock<std::mutex> lIdle(mIdle);
+		cvIdle.wait(lIdle, [this]() { return (llQueued.load() > 0 && !Full()) || llPending.load() == 0; });
+		if (llPending.load() == 0) return;
+	}
+}
+
+void REGPARALLELWALK::Deliver(const std::shared_ptr<REGWALKNODE>& pNode) {
+	BOOL bClaimed = FALSE;
+	{
+		std::unique_lock<std::mutex> lDone(mDone);
+		if (pNode->eState == REGWALK_QUEUED) {
+			pNode->eState = REGWALK_RUNNING;
+			bClaimed = TRUE;
+		}
+		else cvDone.wait(lDone, [pNode]() { return pNode->eState == REGWALK_DONE; });
+	}
+	if (bClaimed) {
+		// No worker has taken the key yet (they may be waiting for the window): enumerate it here
+		REGWALKTASK tTask;
+		tTask.idPath = pNode->idPath;
+		tTask.dwDepth = pNode->dwDepth;
+		tTask.pNode = pNode;
+		Process(0, tTask);
+		Finish();
+	}
+	if (llAhead.fetch_sub(1) == REGWALK_ORDERED_WINDOW) {
+		std::lock_guard<std::mutex> lGuard(mIdle);
+		cvIdle.notify_all();
+	}
+	if (!pNode->bOpened) return;
+
+	// Open the key again as the parent of the callbacks. If it was deleted meanwhile its results are dropped,
+	// but the sub trees are still waited for.
+	REGKEY rKey(rRoot.pBackend);
+	LSTATUS lOpen = ERROR_SUCCESS;
+	BOOL bReport = (!pNode->vValues.empty() || (fKey != nullptr && !pNode->vKeys.empty()));
+	if (bReport) bReport = (rKey.Acquire(rRoot.hRootKey, pNode->idPath, rRoot.ulSam, FALSE, bWide, &lOpen) == REG_SUCCESS);
+	if (bReport && fValue != nullptr) {
+		for (const auto& rValue : pNode->vValues) fValue(&rKey, rValue.first.c_str(), rValue.second);
+	}
+	for (size_t i = 0; i < pNode->vKeys.size(); i++) {
+		if (bReport && fKey != nullptr) fKey(&rKey, pNode->vKeys[i].c_str());
+		if (pNode->vChildren[i] == nullptr) continue;
+		Deliver(pNode->vChildren[i]);
+		// Free the results of a delivered sub tree
+		pNode->vChildren[i].reset();
+	}
+}
+
+HRESULT REGPARALLELWALK::Run(DWORD dwThreads) {
+	if (dwThreads == 0) dwThreads = std::thread::hardware_concurrency();
+	if (dwThreads == 0) dwThreads = 1;
+	for (DWORD i = 0; i < dwThreads; i++) vQueues.emplace_back(new QUEUE);
+
+	BOOL bOrdered = (dwFlags & REGENUM_ORDERED) != 0;
+	std::shared_ptr<REGWALKNODE> pRoot(bOrdered ? std::make_shared<REGWALKNODE>(rRoot.idPath, 0) : nullptr);
+	REGWALKTASK tRoot;
+	GetRegPathTable()->AddRef(rRoot.idPath);
+	tRoot.idPath = rRoot.idPath;
+	tRoot.dwDepth = 0;
+	tRoot.pNode = pRoot;
+	Push(0, std::move(tRoot));
+
+	// The calling thread delivers in ordered mode and works otherwise
+	std::vector<std::thread> vThreads;
+	for (DWORD i = (bOrdered ? 0 : 1); i < dwThreads; i++) vThreads.emplace_back(&REGPARALLELWALK::Work, this, i);
+	if (bOrdered) Deliver(pRoot);
+	else Work(0);
+	for (std::thread& tThread : vThreads) tThread.join();
+	// Tasks the delivering thread ran are still in the deques
+	for (std::unique_ptr<QUEUE>& pQueue : vQueues) {
+		for (REGWALKTASK& rTask : pQueue->dTasks) GetRegPathTable()->Release(rTask.idPath);
+		pQueue->dTasks.clear();
+	}
+	return hError.load();
+}
+
+
+HRESULT REGKEY::EnumAllValue(REG_VALUE_CALLBACK callback, const REGENUMOPTIONS& rOptions) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (callback == nullptr) return REG_INVAILD_POINTER;
+	REGPARALLELWALK wWalk(*this, nullptr, callback, rOptions);
+	return wWalk.Run(rOptions.dwThreads);
+}
+HRESULT REGKEY::EnumAllKey(REG_KEY_CALLBACK callback, const REGENUMOPTIONS& rOptions) const {
+	REG_METRIC_SCOPE(REG_METRIC_ENUM, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (callback == nullptr) return REG_INVAILD_POINTER;
+	REGPARALLELWALK wWalk(*this, callback, nullptr, rOptions);
+	return wWalk.Run(rOptions.dwThreads);
+}
@@ -0,0 +1,283 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegPath.h"
+
+#define REGPATH_ARENA_BLOCK 16384
+
+// FNV-1a over the name in lower case
+static DWORD HashName(std::string_view vName) {
+	DWORD dwHash = 2166136261u;
+	for (CHAR c : vName) {
+		if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+		dwHash = (dwHash ^ static_cast<BYTE>(c)) * 16777619u;
+	}
+	return dwHash;
+}
+
+static BOOL EqualsNoCase(const CHAR* a, const CHAR* b, size_t ulLen) {
+	for (size_t i = 0; i < ulLen; i++) {
+		CHAR x = a[i], y = b[i];
+		if (x >= 'A' && x <= 'Z') x = x - 'A' + 'a';
+		if (y >= 'A' && y <= 'Z') y = y - 'A' + 'a';
+		if (x != y) return FALSE;
+	}
+	return TRUE;
+}
+
+static ULONGLONG ChildKey(REGPATHID idParent, DWORD dwHash) {
+	return (static_cast<ULONGLONG>(idParent) << 32) | dwHash;
+}
+
+
+REGPATHTABLE::REGPATHTABLE() : ulArenaFree(0) {
+	NODE& nRoot = dNodes.emplace_back();
+	nRoot.idParent = REG_PATH_EMPTY;
+	nRoot.idFold = REG_PATH_EMPTY;
+	nRoot.dwHash = 0;
+	nRoot.dwLen = 0;
+	nRoot.lpName = nullptr;
+	nRoot.dwNameLen = 0;
+	nRoot.lRef = 1;
+	nRoot.bLive = TRUE;
+}
+
+CHAR* REGPATHTABLE::Store(std::string_view vName) {
+	if (vName.empty()) return nullptr;
+	// Storage of a freed name of the same length
+	auto itFree = mFreeNames.find(static_cast<DWORD>(vName.size()));
+	if (itFree != mFreeNames.end() && !itFree->second.empty()) {
+		CHAR* lpName = itFree->second.back();
+		itFree->second.pop_back();
+		memcpy(lpName, vName.data(), vName.size());
+		return lpName;
+	}
+	if (vName.size() > ulArenaFree) {
+		// Long names get a block of their own at the front, so the last block keeps its free space
+		if (vName.size() > REGPATH_ARENA_BLOCK / 4) {
+			vArena.emplace(vArena.begin(), new CHAR[vName.size()]);
+			CHAR* lpName = vArena.front().get();
+			memcpy(lpName, vName.data(), vName.size());
+			return lpName;
+		}
+		vArena.emplace_back(new CHAR[REGPATH_ARENA_BLOCK]);
+		ulArenaFree = REGPATH_ARENA_BLOCK;
+	}
+	CHAR* lpName = vArena.back().get() + (REGPATH_ARENA_BLOCK - ulArenaFree);
+	memcpy(lpName, vName.data(), vName.size());
+	ulArenaFree -= vName.size();
+	return lpName;
+}
+
+BOOL REGPATHTABLE::Find(REGPATHID idParent, std::string_view vName, DWORD dwHash, REGPATHID* pidOut) const {
+	auto pRange = mChildren.equal_range(ChildKey(idParent, dwHash));
+	for (auto it = pRange.first; it != pRange.second; ++it) {
+		const NODE& n = dNodes[it->second];
+		if (n.dwNameLen == vName.size() && (vName.empty() || memcmp(n.lpName, vName.data(), vName.size()) == 0)) {
+			*pidOut = it->second;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+// New node with no reference, the caller adds the first one
+REGPATHID REGPATHTABLE::Insert(REGPATHID idParent, std::string_view vName, DWORD dwHash) {
+	REGPATHID idNew;
+	if (!vFreeIds.empty()) {
+		idNew = vFreeIds.back();
+		vFreeIds.pop_back();
+	}
+	else {
+		idNew = static_cast<REGPATHID>(dNodes.size());
+		dNodes.emplace_back();
+	}
+	NODE& nParent = dNodes[idParent];
+	NODE& nNew = dNodes[idNew];
+	nNew.idParent = idParent;
+	nNew.idFold = idNew;
+	nNew.dwHash = dwHash;
+	nNew.dwLen = nParent.dwLen + (idParent != REG_PATH_EMPTY ? 1 : 0) + static_cast<DWORD>(vName.size());
+	nNew.lpName = Store(vName);
+	nNew.dwNameLen = static_cast<DWORD>(vName.size());
+	nNew.lRef = 0;
+	nNew.bLive = TRUE;
+	if (idParent != REG_PATH_EMPTY) nParent.lRef++;
+	REGPATHID idParentFold = nParent.idFold;
+
+	// The folded path is the first spelling below the folded parent
+	REGPATHID idFold = idNew;
+	BOOL bFound = FALSE;
+	auto pRange = mChildren.equal_range(ChildKey(idParentFold, dwHash));
+	for (auto it = pRange.first; it != pRange.second; ++it) {
+		const NODE& n = dNodes[it->second];
+		if (n.idFold == it->second && n.dwNameLen == vName.size() && EqualsNoCase(n.lpName, vName.data(), vName.size())) {
+			idFold = it->second;
+			bFound = TRUE;
+			break;
+		}
+	}
+	if (!bFound && idParentFold != idParent) idFold = Insert(idParentFold, vName, dwHash);
+	if (idFold != idNew) dNodes[idFold].lRef++;
+	dNodes[idNew].idFold = idFold;
+	mChildren.emplace(ChildKey(idParent, dwHash), idNew);
+	return idNew;
+}
+
+// Free a node that lost its last reference, then the parent and folded paths it held (under the exclusive lock)
+void REGPATHTABLE::Free(REGPATHID idPath) {
+	NODE& n = dNodes[idPath];
+	n.bLive = FALSE;
+	auto pRange = mChildren.equal_range(ChildKey(n.idParent, n.dwHash));
+	for (auto it = pRange.first; it != pRange.second; ++it) {
+		if (it->second != idPath) continue;
+		mChildren.erase(it);
+		break;
+	}
+	if (n.dwNameLen != 0) mFreeNames[n.dwNameLen].push_back(n.lpName);
+	vFreeIds.push_back(idPath);
+	if (n.idParent != REG_PATH_EMPTY && --dNodes[n.idParent].lRef == 0) Free(n.idParent);
+	if (n.idFold != idPath && --dNodes[n.idFold].lRef == 0) Free(n.idFold);
+}
+
+REGPATHID REGPATHTABLE::Intern(std::string_view vPath) {
+	return Append(REG_PATH_EMPTY, vPath);
+}
+
+REGPATHID REGPATHTABLE::Append(REGPATHID idBase, std::string_view vPath) {
+	{
+		// Most paths are already interned, look them up under the shared lock
+		std::shared_lock<std::shared_mutex> lGuard(mLock);
+		if (idBase >= dNodes.size()) return REG_PATH_EMPTY;
+		REGPATHID idPath = idBase;
+		BOOL bFound = TRUE;
+		for (size_t ulPos = 0; !vPath.empty();) {
+			size_t ulEnd = vPath.find('\\', ulPos);
+			std::string_view vName = vPath.substr(ulPos, ulEnd == std::string_view::npos ? std::string_view::npos : ulEnd - ulPos);
+			bFound = Find(idPath, vName, HashName(vName), &idPath);
+			if (!bFound || ulEnd == std::string_view::npos) break;
+			ulPos = ulEnd + 1;
+		}
+		if (bFound) {
+			// A reference is added under the shared lock, a node is only freed under the exclusive lock
+			if (idPath != REG_PATH_EMPTY) dNodes[idPath].lRef++;
+			return idPath;
+		}
+	}
+	// The nodes found above may be freed once the lock is dropped, start again from idBase (held by the caller)
+	std::unique_lock<std::shared_mutex> lGuard(mLock);
+	REGPATHID idPath = idBase;
+	for (size_t ulPos = 0;;) {
+		size_t ulEnd = vPath.find('\\', ulPos);
+		std::string_view vName = vPath.substr(ulPos, ulEnd == std::string_view::npos ? std::string_view::npos : ulEnd - ulPos);
+		DWORD dwHash = HashName(vName);
+		if (!Find(idPath, vName, dwHash, &idPath)) idPath = Insert(idPath, vName, dwHash);
+		if (ulEnd == std::string_view::npos) break;
+		ulPos = ulEnd + 1;
+	}
+	dNodes[idPath].lRef++;
+	return idPath;
+}
+
+void REGPATHTABLE::AddRef(REGPATHID idPath) {
+	if (idPath == REG_PATH_EMPTY) return;
+	std::shared_lock<std::shared_mutex> lGuard(mLock);
+	if (idPath < dNodes.size()) dNodes[idPath].lRef++;
+}
+
+void REGPATHTABLE::Release(REGPATHID idPath) {
+	if (idPath == REG_PATH_EMPTY) return;
+	{
+		std::shared_lock<std::shared_mutex> lGuard(mLock);
+		if (idPath >= dNodes.size() || --dNodes[idPath].lRef != 0) return;
+	}
+	// Last reference: free the path, unless Append found it again before the exclusive lock was taken
+	std::unique_lock<std::shared_mutex> lGuard(mLock);
+	NODE& n = dNodes[idPath];
+	if (n.bLive && n.lRef == 0) Free(idPath);
+}
+
+REGPATHID REGPATHTABLE::GetParent(REGPATHID idPath) const {
+	std::shared_lock<std::shared_mutex> lGuard(mLock);
+	if (idPath >= dNodes.size()) return REG_PATH_EMPTY;
+	return dNodes[idPath].idParent;
+}
+
+REGPATHID REGPATHTABLE::GetFold(REGPATHID idPath) const {
+	std::shared_lock<std::shared_mutex> lGuard(mLock);
+	if (idPath >= dNodes.size()) return REG_PATH_EMPTY;
+	return dNodes[idPath].idFold;
+}
+
+BOOL REGPATHTABLE::Equals(REGPATHID idLeft, REGPATHID idRight) const {
+	if (idLeft == idRight) return TRUE;
+	std::shared_lock<std::shared_mutex> lGuard(mLock);
+	if (idLeft >= dNodes.size() || idRight >= dNodes.size()) return FALSE;
+	return dNodes[idLeft].idFold == dNodes[idRight].idFold;
+}
+
+BOOL REGPATHTABLE::IsBelow(REGPATHID idPath, REGPATHID idBase) const {
+	std::shared_lock<std::shared_mutex> lGuard(mLock);
+	if (idPath >= dNodes.size() || idBase >= dNodes.size()) return FALSE;
+	// The parents of a folded path are folded paths
+	REGPATHID idFold = dNodes[idPath].idFold, idBaseFold = dNodes[idBase].idFold;
+	for (;;) {
+		if (idFold == idBaseFold) return TRUE;
+		if (idFold == REG_PATH_EMPTY) return FALSE;
+		idFold = dNodes[idFold].idParent;
+	}
+}
+
+size_t REGPATHTABLE::GetLength(REGPATHID idPath) const {
+	std::shared_lock<std::shared_mutex> lGuard(mLock);
+	if (idPath >= dNodes.size()) return 0;
+	return dNodes[idPath].dwLen;
+}
+
+void REGPATHTABLE::GetPath(REGPATHID idPath, std::string* lpOutPath) const {
+	std::shared_lock<std::shared_mutex> lGuard(mLock);
+	if (idPath >= dNodes.size()) {
+		lpOutPath->clear();
+		return;
+	}
+	// Fill from the end, one component per parent
+	lpOutPath->resize(dNodes[idPath].dwLen);
+	size_t ulEnd = lpOutPath->size();
+	while (idPath != REG_PATH_EMPTY) {
+		const NODE& n = dNodes[idPath];
+		ulEnd -= n.dwNameLen;
+		if (n.dwNameLen != 0) memcpy(&(*lpOutPath)[ulEnd], n.lpName, n.dwNameLen);
+		if (n.idParent != REG_PATH_EMPTY) (*lpOutPath)[--ulEnd] = '\\';
+		idPath = n.idParent;
+	}
+}
+
+size_t REGPATHTABLE::GetCount() const {
+	std::shared_lock<std::shared_mutex> lGuard(mLock);
+	return dNodes.size() - vFreeIds.size();
+}
+
+REGPATHTABLE* GetRegPathTable() {
+	// Never destroyed, like the handle pool
+	static REGPATHTABLE* pTable = new REGPATHTABLE;
+	return pTable;
+}
@@ -0,0 +1,101 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGPATH_H
+#define REGPATH_H
+
+#include "RegKey.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+// Interned key paths
+// A path is a chain of name atoms in a trie with parent pointers, and interning it returns an id. Keys hold, copy
+// and extend paths as ids without allocating, and a path is only turned back into a string when it is asked for.
+// Ids are counted references: Intern and Append return one, AddRef adds one and Release drops one. A path is held
+// by its own references, by the paths below it and by the spellings it is the folded path of; when nothing holds
+// it, its id and name storage are reused, so the table stays as large as the set of paths in use (a long scan
+// does not make it grow without bound).
+// Atoms keep the spelling they were interned with, so a path converts back to exactly the string it was interned
+// from (empty components included). Every id also has a folded id shared by all spellings of the path (ASCII
+// case-insensitive, like registry names): two paths name the same key if and only if their folded ids are equal.
+class REGPATHTABLE {
+private:
+	struct NODE {
+		REGPATHID idParent; // Parent path (REG_PATH_EMPTY for the first component)
+		REGPATHID idFold; // First spelling of the path
+		DWORD dwHash; // Hash of the folded name
+		DWORD dwLen; // Length of the whole path
+		CHAR* lpName; // Name in the arena
+		DWORD dwNameLen; // Length of the name
+		std::atomic<LONG> lRef; // References, sub paths and spellings that hold the path
+		BOOL bLive; // FALSE while the id is free
+	};
+
+	std::deque<NODE> dNodes; // Id -> node
+	std::vector<REGPATHID> vFreeIds; // Ids of freed nodes
+	std::vector<std::unique_ptr<CHAR[]>> vArena; // Name storage
+	size_t ulArenaFree; // Bytes left in the last arena block
+	std::unordered_map<DWORD, std::vector<CHAR*>> mFreeNames; // Name length -> freed name storage
+	std::unordered_multimap<ULONGLONG, REGPATHID> mChildren; // (parent, folded name hash) -> children
+	mutable std::shared_mutex mLock;
+
+	CHAR* Store(std::string_view vName);
+	BOOL Find(REGPATHID idParent, std::string_view vName, DWORD dwHash, REGPATHID* pidOut) const;
+	REGPATHID Insert(REGPATHID idParent, std::string_view vName, DWORD dwHash);
+	void Free(REGPATHID idPath);
+
+public:
+	REGPATHTABLE();
+	REGPATHTABLE(const REGPATHTABLE&) = delete;
+	REGPATHTABLE& operator=(const REGPATHTABLE&) = delete;
+
+	// Intern a path ("" is REG_PATH_EMPTY). The caller owns a reference to the result.
+	REGPATHID Intern(std::string_view vPath);
+	// Intern the path idBase\vPath (vPath may have several components, "" returns idBase). The caller owns a
+	// reference to the result.
+	REGPATHID Append(REGPATHID idBase, std::string_view vPath);
+	// Add / drop a reference (REG_PATH_EMPTY is never freed)
+	void AddRef(REGPATHID idPath);
+	void Release(REGPATHID idPath);
+	// Parent path (REG_PATH_EMPTY for a path with one component and for REG_PATH_EMPTY itself)
+	REGPATHID GetParent(REGPATHID idPath) const;
+	// Folded id of a path
+	REGPATHID GetFold(REGPATHID idPath) const;
+	// Whether two paths name the same key (case-insensitive)
+	BOOL Equals(REGPATHID idLeft, REGPATHID idRight) const;
+	// Whether idPath is idBase or below it (case-insensitive)
+	BOOL IsBelow(REGPATHID idPath, REGPATHID idBase) const;
+	// Length of the path string
+	size_t GetLength(REGPATHID idPath) const;
+	// Build the path string
+	void GetPath(REGPATHID idPath, std::string* lpOutPath) const;
+	// Number of interned paths in use
+	size_t GetCount() const;
+};
+
+// Get the path table used by REGKEY
+REGPATHTABLE* GetRegPathTable();
+
+#endif
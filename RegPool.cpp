@@ -0,0 +1,279 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegPool.h"
+
+size_t REGHANDLEIDHASH::operator()(const REGHANDLEID& rId) const {
+	ULONGLONG ullHash = reinterpret_cast<ULONG_PTR>(rId.pBackend);
+	ullHash = ullHash * 0x100000001B3ULL ^ reinterpret_cast<ULONG_PTR>(rId.hRoot);
+	ullHash = ullHash * 0x100000001B3ULL ^ rId.ulSam;
+	ullHash = ullHash * 0x100000001B3ULL ^ rId.idFold;
+	ullHash = ullHash * 0x100000001B3ULL ^ rId.bWide;
+	return static_cast<size_t>(ullHash ^ (ullHash >> 29));
+}
+
+static REGHANDLEID MakeId(REGBACKEND* pBackend, HKEY hRoot, REGSAM ulSam, REGPATHID idPath, BOOL bWide) {
+	REGHANDLEID kId = { pBackend, hRoot, ulSam, GetRegPathTable()->GetFold(idPath), bWide };
+	return kId;
+}
+
+// Close handles that were removed from the pool (without the pool lock)
+static LSTATUS CloseHandles(const std::vector<REGHANDLE*>& vClose, const REGHANDLE* pWanted) {
+	LSTATUS lRes = ERROR_SUCCESS;
+	for (REGHANDLE* pHandle : vClose) {
+		LSTATUS lClose = pHandle->kId.pBackend->CloseKey(pHandle->hKey);
+		if (pHandle == pWanted) lRes = lClose;
+		GetRegPathTable()->Release(pHandle->kId.idFold);
+		delete pHandle;
+	}
+	return lRes;
+}
+
+
+REGHANDLEPOOL::REGHANDLEPOOL() : ulIdleCapacity(0) {
+	return;
+}
+REGHANDLEPOOL::~REGHANDLEPOOL() {
+	Flush();
+}
+
+void REGHANDLEPOOL::Unindex(REGHANDLE* pHandle) {
+	if (!pHandle->bIndexed) return;
+	mIndex.erase(pHandle->kId);
+	pHandle->bIndexed = FALSE;
+}
+
+void REGHANDLEPOOL::Trim(std::vector<REGHANDLE*>* pvClose) {
+	while (lIdle.size() > ulIdleCapacity) {
+		REGHANDLE* pHandle = lIdle.back();
+		lIdle.pop_back();
+		Unindex(pHandle);
+		pvClose->push_back(pHandle);
+	}
+}
+
+BOOL REGHANDLEPOOL::Find(const REGHANDLEID& kId, REGHANDLE** ppOutHandle) {
+	auto it = mIndex.find(kId);
+	if (it == mIndex.end()) return FALSE;
+	REGHANDLE* pHandle = it->second;
+	if (pHandle->lRef == 0) lIdle.erase(pHandle->itIdle);
+	pHandle->lRef++;
+	*ppOutHandle = pHandle;
+	return TRUE;
+}
+
+// Whether the key of a handle still exists. Every call on a handle of a deleted key fails with ERROR_KEY_DELETED,
+// enumerating past the last sub key is the cheapest one.
+static BOOL IsLive(const REGHANDLE* pHandle) {
+	CHAR cName[1];
+	DWORD dwSize = 1;
+	return pHandle->kId.pBackend->EnumKey(pHandle->hKey, MAXDWORD, cName, &dwSize) != ERROR_KEY_DELETED;
+}
+
+// Take a pooled handle if its key still exists (without the pool lock)
+BOOL REGHANDLEPOOL::Reuse(const REGHANDLEID& kId, REGHANDLE** ppOutHandle) {
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		if (!Find(kId, ppOutHandle)) return FALSE;
+	}
+	if (IsLive(*ppOutHandle)) return TRUE;
+	Detach(*ppOutHandle);
+	Release(*ppOutHandle);
+	return FALSE;
+}
+
+void REGHANDLEPOOL::Insert(const REGHANDLEID& kId, HKEY hKey, REGHANDLE** ppOutHandle) {
+	REGHANDLE* pHandle = new REGHANDLE;
+	pHandle->kId = kId;
+	pHandle->hKey = hKey;
+	pHandle->lRef = 1;
+	pHandle->bIndexed = TRUE;
+	// The handle holds its folded path, so the id is not reused while it is in the index
+	GetRegPathTable()->AddRef(kId.idFold);
+	mIndex.emplace(kId, pHandle);
+	*ppOutHandle = pHandle;
+}
+
+// Open a key that was not found in the pool and add it
+LSTATUS REGHANDLEPOOL::Open(const REGHANDLEID& kId, HKEY hParent, LPCSTR lpPath, BOOL bCreate, REGHANDLE** ppOutHandle) {
+	// Open without the lock, the backend call is the slow part
+	HKEY hKey = NULL;
+	LSTATUS lRes = kId.pBackend->OpenKey(hParent, lpPath, kId.ulSam, bCreate, &hKey);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		// Another thread may have opened the same key meanwhile
+		if (!Find(kId, ppOutHandle)) {
+			Insert(kId, hKey, ppOutHandle);
+			return ERROR_SUCCESS;
+		}
+	}
+	kId.pBackend->CloseKey(hKey);
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGHANDLEPOOL::Acquire(REGBACKEND* pBackend, HKEY hRoot, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, REGHANDLE** ppOutHandle) {
+	REGPATHID idPath = GetRegPathTable()->Intern(lpPath == nullptr ? "" : lpPath);
+	LSTATUS lRes = Acquire(pBackend, hRoot, idPath, ulSam, bCreate, ppOutHandle);
+	GetRegPathTable()->Release(idPath);
+	return lRes;
+}
+
+LSTATUS REGHANDLEPOOL::Acquire(REGBACKEND* pBackend, HKEY hRoot, REGPATHID idPath, REGSAM ulSam, BOOL bCreate, REGHANDLE** ppOutHandle) {
+	if (pBackend == nullptr || ppOutHandle == nullptr) return ERROR_INVALID_PARAMETER;
+	REGHANDLEID kId = MakeId(pBackend, hRoot, ulSam, idPath, FALSE);
+	if (Reuse(kId, ppOutHandle)) return ERROR_SUCCESS;
+	std::string cPath;
+	GetRegPathTable()->GetPath(idPath, &cPath);
+	return Open(kId, hRoot, cPath.c_str(), bCreate, ppOutHandle);
+}
+
+LSTATUS REGHANDLEPOOL::AcquireSub(REGHANDLE* pParent, REGPATHID idPath, LPCSTR lpName, REGSAM ulSam, REGHANDLE** ppOutHandle) {
+	if (pParent == nullptr || lpName == nullptr || ppOutHandle == nullptr) return ERROR_INVALID_PARAMETER;
+	// Every path below a path with non-ASCII characters has them too
+	REGHANDLEID kId = MakeId(pParent->kId.pBackend, pParent->kId.hRoot, ulSam, idPath, pParent->kId.bWide);
+	if (Reuse(kId, ppOutHandle)) return ERROR_SUCCESS;
+	return Open(kId, pParent->hKey, lpName, FALSE, ppOutHandle);
+}
+
+LSTATUS REGHANDLEPOOL::Acquire(REGBACKEND* pBackend, HKEY hRoot, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, REGHANDLE** ppOutHandle) {
+	size_t ulLen = (lpPath == nullptr ? 0 : wcslen(lpPath));
+	std::string cUtf8(ulLen * 3, '\0');
+	cUtf8.resize(Utf16ToUtf8(lpPath, ulLen, &cUtf8[0]));
+	REGPATHID idUtf8 = GetRegPathTable()->Intern(cUtf8);
+	LSTATUS lRes = AcquireW(pBackend, hRoot, idUtf8, ulSam, bCreate, ppOutHandle);
+	GetRegPathTable()->Release(idUtf8);
+	return lRes;
+}
+
+LSTATUS REGHANDLEPOOL::AcquireW(REGBACKEND* pBackend, HKEY hRoot, REGPATHID idUtf8, REGSAM ulSam, BOOL bCreate, REGHANDLE** ppOutHandle) {
+	if (pBackend == nullptr || ppOutHandle == nullptr) return ERROR_INVALID_PARAMETER;
+	// An ASCII path is the same in UTF-8 and ANSI. A path with non-ASCII characters is marked as wide,
+	// so that it never matches an ANSI path with the same bytes.
+	std::string cUtf8;
+	GetRegPathTable()->GetPath(idUtf8, &cUtf8);
+	BOOL bWide = FALSE;
+	for (CHAR c : cUtf8) {
+		if (static_cast<BYTE>(c) >= 0x80) {
+			bWide = TRUE;
+			break;
+		}
+	}
+	if (!bWide) return Acquire(pBackend, hRoot, idUtf8, ulSam, bCreate, ppOutHandle);
+	REGHANDLEID kId = MakeId(pBackend, hRoot, ulSam, idUtf8, TRUE);
+	if (Reuse(kId, ppOutHandle)) return ERROR_SUCCESS;
+
+	std::wstring cPath(cUtf8.size(), L'\0');
+	cPath.resize(Utf8ToUtf16(cUtf8.data(), cUtf8.size(), &cPath[0]));
+	HKEY hKey = NULL;
+	LSTATUS lRes = pBackend->OpenKeyW(hRoot, cPath.c_str(), ulSam, bCreate, &hKey);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		if (!Find(kId, ppOutHandle)) {
+			Insert(kId, hKey, ppOutHandle);
+			return ERROR_SUCCESS;
+		}
+	}
+	pBackend->CloseKey(hKey);
+	return ERROR_SUCCESS;
+}
+
+void REGHANDLEPOOL::AddRef(REGHANDLE* pHandle) {
+	std::lock_guard<std::mutex> lGuard(mLock);
+	pHandle->lRef++;
+}
+
+LSTATUS REGHANDLEPOOL::Release(REGHANDLE* pHandle) {
+	std::vector<REGHANDLE*> vClose;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		if (--pHandle->lRef > 0) return ERROR_SUCCESS;
+		if (pHandle->bIndexed && ulIdleCapacity != 0) {
+			lIdle.push_front(pHandle);
+			pHandle->itIdle = lIdle.begin();
+			Trim(&vClose);
+		}
+		else {
+			Unindex(pHandle);
+			vClose.push_back(pHandle);
+		}
+	}
+	return CloseHandles(vClose, pHandle);
+}
+
+void REGHANDLEPOOL::Detach(REGHANDLE* pHandle) {
+	std::vector<REGHANDLE*> vClose;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		REGPATHTABLE* pTable = GetRegPathTable();
+		for (auto it = mIndex.begin(); it != mIndex.end();) {
+			REGHANDLE* p = it->second;
+			BOOL bBelow = (p->kId.pBackend == pHandle->kId.pBackend && p->kId.hRoot == pHandle->kId.hRoot);
+			if (bBelow) bBelow = pTable->IsBelow(p->kId.idFold, pHandle->kId.idFold);
+			if (!bBelow) {
+				++it;
+				continue;
+			}
+			it = mIndex.erase(it);
+			p->bIndexed = FALSE;
+			if (p->lRef == 0) {
+				lIdle.erase(p->itIdle);
+				vClose.push_back(p);
+			}
+		}
+		Unindex(pHandle);
+	}
+	CloseHandles(vClose, nullptr);
+}
+
+size_t REGHANDLEPOOL::GetIdleCapacity() {
+	std::lock_guard<std::mutex> lGuard(mLock);
+	return ulIdleCapacity;
+}
+void REGHANDLEPOOL::SetIdleCapacity(size_t ulCapacity) {
+	std::vector<REGHANDLE*> vClose;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		ulIdleCapacity = ulCapacity;
+		Trim(&vClose);
+	}
+	CloseHandles(vClose, nullptr);
+}
+void REGHANDLEPOOL::Flush() {
+	std::vector<REGHANDLE*> vClose;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		for (REGHANDLE* pHandle : lIdle) {
+			Unindex(pHandle);
+			vClose.push_back(pHandle);
+		}
+		lIdle.clear();
+	}
+	CloseHandles(vClose, nullptr);
+}
+
+REGHANDLEPOOL* GetRegHandlePool() {
+	// Never destroyed, so that static REGKEY objects can release their handles at exit
+	static REGHANDLEPOOL* pPool = new REGHANDLEPOOL;
+	return pPool;
+}
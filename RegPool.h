@@ -0,0 +1,115 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGPOOL_H
+#define REGPOOL_H
+
+#include "RegKey.h"
+#include "RegPath.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+// Identity of a pooled handle
+struct REGHANDLEID {
+	REGBACKEND* pBackend; // Backend that opened the handle
+	HKEY hRoot; // Root term
+	REGSAM ulSam; // Authority
+	REGPATHID idFold; // Folded path (case-insensitive), a reference held by the handle
+	BOOL bWide; // Opened by a UTF-16 path with non-ASCII characters (idFold is its UTF-8 form)
+
+	bool operator==(const REGHANDLEID& rOther) const {
+		return pBackend == rOther.pBackend && hRoot == rOther.hRoot && ulSam == rOther.ulSam && idFold == rOther.idFold && bWide == rOther.bWide;
+	}
+};
+struct REGHANDLEIDHASH {
+	size_t operator()(const REGHANDLEID& rId) const;
+};
+
+// Open key handle shared by REGKEY objects
+struct REGHANDLE {
+	REGHANDLEID kId; // Identity in the pool
+	HKEY hKey; // Backend handle
+	LONG lRef; // Number of REGKEY objects using the handle
+	BOOL bIndexed; // Whether the handle can still be handed out (FALSE after its key was deleted)
+	std::list<REGHANDLE*>::iterator itIdle; // Position in the idle list when lRef is 0
+};
+
+// Open key handle pool
+// Handles are shared by (backend, root, path, authority), path names are case-insensitive. Paths are compared by
+// their folded interned ids (RegPath.h), so a lookup hashes a few integers instead of a path string. Copying a REGKEY or
+// opening a key that is already open adds a reference instead of opening the key again.
+// A handle keeps pointing to its key when the key is deleted and created again by another program, so a pooled
+// handle is checked before it is handed to another open: if its key was deleted it is dropped and the key is opened
+// again. Copies share the handle without the check.
+// When the last reference is released the handle is kept in an LRU list of idle handles, up to the idle capacity,
+// and reused by the next open of the same key. The idle capacity is 0 by default.
+class REGHANDLEPOOL {
+private:
+	std::unordered_map<REGHANDLEID, REGHANDLE*, REGHANDLEIDHASH> mIndex; // Identity -> handle
+	std::list<REGHANDLE*> lIdle; // Idle handles, most recently used first
+	size_t ulIdleCapacity;
+	std::mutex mLock;
+
+	void Unindex(REGHANDLE* pHandle);
+	void Trim(std::vector<REGHANDLE*>* pvClose);
+	BOOL Find(const REGHANDLEID& kId, REGHANDLE** ppOutHandle);
+	BOOL Reuse(const REGHANDLEID& kId, REGHANDLE** ppOutHandle);
+	void Insert(const REGHANDLEID& kId, HKEY hKey, REGHANDLE** ppOutHandle);
+	LSTATUS Open(const REGHANDLEID& kId, HKEY hParent, LPCSTR lpPath, BOOL bCreate, REGHANDLE** ppOutHandle);
+
+public:
+	REGHANDLEPOOL();
+	REGHANDLEPOOL(const REGHANDLEPOOL&) = delete;
+	REGHANDLEPOOL& operator=(const REGHANDLEPOOL&) = delete;
+	~REGHANDLEPOOL();
+
+	// Get a handle of the key lpPath under hRoot, opening (or creating if bCreate is TRUE) it if it is not in the pool.
+	// Return the Win32 error code of the backend.
+	LSTATUS Acquire(REGBACKEND* pBackend, HKEY hRoot, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, REGHANDLE** ppOutHandle);
+	// Same with an interned path (the path string is only built if the key is not in the pool)
+	LSTATUS Acquire(REGBACKEND* pBackend, HKEY hRoot, REGPATHID idPath, REGSAM ulSam, BOOL bCreate, REGHANDLE** ppOutHandle);
+	// Get a handle of the sub key lpName of pParent, whose path is idPath. If it is not in the pool it is opened
+	// relative to the handle of pParent. Below a handle opened by a UTF-16 path, idPath is a UTF-8 path too.
+	LSTATUS AcquireSub(REGHANDLE* pParent, REGPATHID idPath, LPCSTR lpName, REGSAM ulSam, REGHANDLE** ppOutHandle);
+	// Same with a UTF-16 path (opened by OpenKeyW). ASCII paths share handles with the ANSI form.
+	LSTATUS Acquire(REGBACKEND* pBackend, HKEY hRoot, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, REGHANDLE** ppOutHandle);
+	// Same with the interned UTF-8 form of a UTF-16 path
+	LSTATUS AcquireW(REGBACKEND* pBackend, HKEY hRoot, REGPATHID idUtf8, REGSAM ulSam, BOOL bCreate, REGHANDLE** ppOutHandle);
+	// Add a reference to a handle
+	void AddRef(REGHANDLE* pHandle);
+	// Release a reference. Return the result of CloseKey if the handle was closed.
+	LSTATUS Release(REGHANDLE* pHandle);
+	// The key of the handle was deleted: stop handing out the handle and every pooled handle below it
+	void Detach(REGHANDLE* pHandle);
+
+	// Get / set the number of idle handles kept open
+	size_t GetIdleCapacity();
+	void SetIdleCapacity(size_t ulCapacity);
+	// Close all idle handles
+	void Flush();
+};
+
+// Get the handle pool used by REGKEY
+REGHANDLEPOOL* GetRegHandlePool();
+
+#endif
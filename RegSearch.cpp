@@ -0,0 +1,368 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegSearch.h"
+#include "RegMetrics.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define REGSEARCH_SSE2
+#include <emmintrin.h>
+#endif
+
+#define REGSEARCH_MAX_COMPONENTS 63
+
+static CHAR FoldChar(CHAR c) {
+	return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+#ifdef REGSEARCH_SSE2
+// Lower case 16 bytes: add 0x20 where 'A' <= c <= 'Z' (bytes >= 0x80 compare as negative and are kept)
+static __m128i FoldBlock(__m128i vIn) {
+	__m128i vUpper = _mm_and_si128(_mm_cmpgt_epi8(vIn, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(vIn, _mm_set1_epi8('Z' + 1)));
+	return _mm_or_si128(vIn, _mm_and_si128(vUpper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+BOOL EqualsNoCase(std::string_view vLeft, std::string_view vRight) {
+	if (vLeft.size() != vRight.size()) return FALSE;
+	size_t i = 0;
+#ifdef REGSEARCH_SSE2
+	for (; i + 16 <= vLeft.size(); i += 16) {
+		__m128i a = FoldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(vLeft.data() + i)));
+		__m128i b = FoldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(vRight.data() + i)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) return FALSE;
+	}
+#endif
+	for (; i < vLeft.size(); i++) {
+		if (FoldChar(vLeft[i]) != FoldChar(vRight[i])) return FALSE;
+	}
+	return TRUE;
+}
+
+INT CompareNoCase(std::string_view vLeft, std::string_view vRight) {
+	size_t ulLen = (vLeft.size() < vRight.size() ? vLeft.size() : vRight.size());
+	for (size_t i = 0; i < ulLen; i++) {
+		BYTE x = static_cast<BYTE>(FoldChar(vLeft[i])), y = static_cast<BYTE>(FoldChar(vRight[i]));
+		if (x != y) return x < y ? -1 : 1;
+	}
+	if (vLeft.size() == vRight.size()) return 0;
+	return vLeft.size() < vRight.size() ? -1 : 1;
+}
+
+size_t FindNoCase(std::string_view vHay, std::string_view vNeedle) {
+	size_t n = vNeedle.size();
+	if (n == 0) return 0;
+	if (n > vHay.size()) return std::string_view::npos;
+	CHAR cFirst = FoldChar(vNeedle[0]), cLast = FoldChar(vNeedle[n - 1]);
+	size_t i = 0;
+#ifdef REGSEARCH_SSE2
+	// Compare the first and the last character at 16 positions at once, and the middle only for candidates
+	const __m128i vFirst = _mm_set1_epi8(cFirst), vLast = _mm_set1_epi8(cLast);
+	for (; i + n - 1 + 16 <= vHay.size(); i += 16) {
+		__m128i a = FoldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(vHay.data() + i)));
+		__m128i b = FoldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(vHay.data() + i + n - 1)));
+		INT iMask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, vFirst), _mm_cmpeq_epi8(b, vLast)));
+		for (INT k = 0; iMask != 0; k++, iMask >>= 1) {
+			if ((iMask & 1) && (n <= 2 || EqualsNoCase(vHay.substr(i + k + 1, n - 2), vNeedle.substr(1, n - 2)))) return i + k;
+		}
+	}
+#endif
+	for (; i + n <= vHay.size(); i++) {
+		if (FoldChar(vHay[i]) == cFirst && EqualsNoCase(vHay.substr(i, n), vNeedle)) return i;
+	}
+	return std::string_view::npos;
+}
+
+
+REGNAMEPATTERN::REGNAMEPATTERN() : eMode(REG_MATCH_GLOB) {
+	Assign("*", REG_MATCH_GLOB);
+}
+REGNAMEPATTERN::REGNAMEPATTERN(std::string_view vPattern, REGMATCHMODE eMode) : eMode(eMode) {
+	Assign(vPattern, eMode);
+}
+
+void REGNAMEPATTERN::Assign(std::string_view vPattern, REGMATCHMODE eInMode) {
+	eMode = eInMode;
+	cPattern.assign(vPattern.data(), vPattern.size());
+	vParts.clear();
+	vParts.emplace_back();
+	for (CHAR c : vPattern) {
+		if (eMode == REG_MATCH_GLOB && c == '*') {
+			vParts.emplace_back();
+			continue;
+		}
+		if (eMode == REG_MATCH_GLOB && c == '?') vParts.back().bWild = TRUE;
+		vParts.back().cText.push_back(FoldChar(c));
+	}
+}
+
+BOOL REGNAMEPATTERN::MatchAt(std::string_view vName, size_t ulPos, const PART& rPart) {
+	if (ulPos + rPart.cText.size() > vName.size()) return FALSE;
+	if (!rPart.bWild) return EqualsNoCase(vName.substr(ulPos, rPart.cText.size()), rPart.cText);
+	for (size_t i = 0; i < rPart.cText.size(); i++) {
+		if (rPart.cText[i] != '?' && rPart.cText[i] != FoldChar(vName[ulPos + i])) return FALSE;
+	}
+	return TRUE;
+}
+
+size_t REGNAMEPATTERN::FindPart(std::string_view vName, size_t ulPos, size_t ulEnd, const PART& rPart) {
+	if (!rPart.bWild) {
+		size_t ulRes = FindNoCase(vName.substr(ulPos, ulEnd - ulPos), rPart.cText);
+		return (ulRes == std::string_view::npos ? ulRes : ulPos + ulRes);
+	}
+	for (size_t i = ulPos; i + rPart.cText.size() <= ulEnd; i++) {
+		if (MatchAt(vName, i, rPart)) return i;
+	}
+	return std::string_view::npos;
+}
+
+BOOL REGNAMEPATTERN::Match(std::string_view vName) const {
+	const PART& rFirst = vParts.front();
+	switch (eMode) {
+	case REG_MATCH_EXACT:
+		return EqualsNoCase(vName, rFirst.cText);
+	case REG_MATCH_PREFIX:
+		return MatchAt(vName, 0, rFirst);
+	case REG_MATCH_SUBSTRING:
+		return FindPart(vName, 0, vName.size(), rFirst) != std::string_view::npos;
+	default:
+		break;
+	}
+	if (vParts.size() == 1) return vName.size() == rFirst.cText.size() && MatchAt(vName, 0, rFirst);
+
+	// Anchored first and last part, leftmost match of every part in between
+	const PART& rLast = vParts.back();
+	if (vName.size() < rFirst.cText.size() + rLast.cText.size()) return FALSE;
+	if (!MatchAt(vName, 0, rFirst) || !MatchAt(vName, vName.size() - rLast.cText.size(), rLast)) return FALSE;
+	size_t ulPos = rFirst.cText.size(), ulEnd = vName.size() - rLast.cText.size();
+	for (size_t i = 1; i + 1 < vParts.size(); i++) {
+		size_t ulFound = FindPart(vName, ulPos, ulEnd, vParts[i]);
+		if (ulFound == std::string_view::npos) return FALSE;
+		ulPos = ulFound + vParts[i].cText.size();
+	}
+	return TRUE;
+}
+
+BOOL REGNAMEPATTERN::MatchesAll() const {
+	if (eMode == REG_MATCH_PREFIX || eMode == REG_MATCH_SUBSTRING) return vParts.front().cText.empty();
+	if (eMode != REG_MATCH_GLOB || vParts.size() < 2) return FALSE;
+	for (const PART& rPart : vParts) {
+		if (!rPart.cText.empty()) return FALSE;
+	}
+	return TRUE;
+}
+
+BOOL REGNAMEPATTERN::IsLiteral() const {
+	if (eMode == REG_MATCH_EXACT) return TRUE;
+	return eMode == REG_MATCH_GLOB && vParts.size() == 1 && !vParts.front().bWild;
+}
+
+const std::string& REGNAMEPATTERN::GetText() const {
+	return cPattern;
+}
+
+
+// Search of a key tree (REGKEY::Search)
+// The path glob runs as a set of positions in its components, kept in a bit mask: a key is searched when the
+// position after the last component is in its set, and a sub tree is dropped as soon as its set is empty.
+class REGSEARCH {
+private:
+	const REGSEARCHOPTIONS& rOptions;
+	REGSEARCHVISITOR fVisit;
+	std::vector<REGNAMEPATTERN> vComponents; // Path glob components
+	std::vector<BOOL> vAnyDepth; // Whether the component is "**"
+	REGNAMEPATTERN pName; // Item name pattern
+	std::vector<CHAR> vName; // Value name buffer
+	std::vector<BYTE> vData; // Value data buffer
+	std::string cPath; // Path of the current key
+	BOOL bStop;
+
+	ULONGLONG Accept() const { return 1ULL << vComponents.size(); }
+	ULONGLONG Closure(ULONGLONG ullState) const;
+	ULONGLONG Step(ULONGLONG ullState, std::string_view vSon) const;
+	HRESULT SearchValues(const REGKEY& rKey);
+	HRESULT Descend(const REGKEY& rKey, LPCSTR lpSon, ULONGLONG ullState, DWORD dwDepth);
+
+public:
+	REGSEARCH(const REGSEARCHOPTIONS& rOptions, REGSEARCHVISITOR fVisit) : rOptions(rOptions), fVisit(fVisit), vData(1024), bStop(FALSE) {}
+
+	HRESULT Compile();
+	ULONGLONG Start() const { return Closure(1); }
+	HRESULT Run(const REGKEY& rKey, ULONGLONG ullState, DWORD dwDepth);
+};
+
+HRESULT REGSEARCH::Compile() {
+	std::string_view vPath(rOptions.lpPath == nullptr ? "" : rOptions.lpPath);
+	if (vPath.empty()) vPath = "**";
+	size_t ulPos = 0;
+	while (ulPos <= vPath.size()) {
+		size_t ulEnd = vPath.find('\\', ulPos);
+		if (ulEnd == std::string_view::npos) ulEnd = vPath.size();
+		std::string_view vComponent = vPath.substr(ulPos, ulEnd - ulPos);
+		ulPos = ulEnd + 1;
+		if (vComponent.empty()) continue;
+		if (vComponents.size() == REGSEARCH_MAX_COMPONENTS) return REG_INVAILD_PATH;
+		vAnyDepth.push_back(vComponent == "**");
+		vComponents.emplace_back(vComponent, REG_MATCH_GLOB);
+	}
+	if (rOptions.lpName == nullptr || rOptions.lpName[0] == '\0') pName.Assign("*", REG_MATCH_GLOB);
+	else pName.Assign(rOptions.lpName, rOptions.eMode);
+	return REG_SUCCESS;
+}
+
+ULONGLONG REGSEARCH::Closure(ULONGLONG ullState) const {
+	// "**" can match no key
+	for (size_t i = 0; i < vComponents.size(); i++) {
+		if ((ullState & (1ULL << i)) && vAnyDepth[i]) ullState |= 1ULL << (i + 1);
+	}
+	return ullState;
+}
+
+ULONGLONG REGSEARCH::Step(ULONGLONG ullState, std::string_view vSon) const {
+	ULONGLONG ullNext = 0;
+	for (size_t i = 0; i < vComponents.size(); i++) {
+		if (!(ullState & (1ULL << i))) continue;
+		if (vAnyDepth[i]) ullNext |= 1ULL << i;
+		else if (vComponents[i].Match(vSon)) ullNext |= 1ULL << (i + 1);
+	}
+	return Closure(ullNext);
+}
+
+HRESULT REGSEARCH::SearchValues(const REGKEY& rKey) {
+	REGSEARCHMATCH mMatch = { &rKey, cPath, nullptr, FALSE, REG_NONE, nullptr, 0 };
+	REGKEYINFO iInfo;
+	rKey.QueryEnumInfo(&iInfo);
+	REGKEY::SizeEnumBuffers(iInfo, TRUE, &vName, nullptr);
+	for (DWORD dwIndex = 0;; dwIndex++) {
+		DWORD dwNameSize = 0;
+		LSTATUS lRes = rKey.EnumValueEntry(dwIndex, &vName, &dwNameSize, &mMatch.dwType, nullptr, nullptr);
+		if (lRes == ERROR_NO_MORE_ITEMS) break;
+		if (lRes != ERROR_SUCCESS) return (lRes == ERROR_ACCESS_DENIED ? REG_ACCESS_DENIED : REG_UNKNOWN_ERROR);
+		if (!pName.Match(std::string_view(vName.data(), dwNameSize))) continue;
+		mMatch.lpName = vName.data();
+		mMatch.lpData = nullptr;
+		mMatch.dwSize = 0;
+		if (rOptions.dwFlags & REGSEARCH_DATA) {
+			// Only the data of matching values is read
+			DWORD dwSize = static_cast<DWORD>(vData.size());
+			lRes = rKey.pBackend->QueryValue(rKey.hKey, vName.data(), &mMatch.dwType, vData.data(), &dwSize);
+			while (lRes == ERROR_MORE_DATA) {
+				vData.resize(dwSize);
+				lRes = rKey.pBackend->QueryValue(rKey.hKey, vName.data(), &mMatch.dwType, vData.data(), &dwSize);
+			}
+			// Deleted since it was enumerated
+			if (lRes == ERROR_FILE_NOT_FOUND) continue;
+			REG_METRIC_STATUS(lRes);
+			if (lRes != ERROR_SUCCESS) return (lRes == ERROR_ACCESS_DENIED ? REG_ACCESS_DENIED : REG_UNKNOWN_ERROR);
+			REG_METRIC_BYTES_READ(dwSize);
+			mMatch.lpData = vData.data();
+			mMatch.dwSize = dwSize;
+		}
+		REGVISIT vRes = fVisit(mMatch);
+		if (vRes == REG_VISIT_STOP) bStop = TRUE;
+		if (vRes != REG_VISIT_CONTINUE) break;
+	}
+	return REG_SUCCESS;
+}
+
+HRESULT REGSEARCH::Descend(const REGKEY& rKey, LPCSTR lpSon, ULONGLONG ullState, DWORD dwDepth) {
+	// The items of the sub key are at dwDepth + 2
+	if (rOptions.dwMaxDepth != 0 && dwDepth + 2 > rOptions.dwMaxDepth) return REG_SUCCESS;
+	REGKEY rSon(rKey.pBackend);
+	if (rKey.GetSon(lpSon, &rSon, rKey.ulSam) != REG_SUCCESS) return REG_SUCCESS;
+	size_t ulLen = cPath.size();
+	if (ulLen != 0) cPath.push_back('\\');
+	cPath.append(lpSon);
+	HRESULT hRes = Run(rSon, ullState, dwDepth + 1);
+	cPath.resize(ulLen);
+	return hRes;
+}
+
+HRESULT REGSEARCH::Run(const REGKEY& rKey, ULONGLONG ullState, DWORD dwDepth) {
+	BOOL bAccept = (ullState & Accept()) != 0;
+	if (bAccept && (rOptions.dwFlags & REGSEARCH_VALUES)) {
+		HRESULT hRes = SearchValues(rKey);
+		if (bStop || hRes != REG_SUCCESS) return hRes;
+	}
+	BOOL bKeys = bAccept && (rOptions.dwFlags & REGSEARCH_KEYS);
+	ULONGLONG ullOpen = ullState & (Accept() - 1);
+	if (!bKeys && ullOpen == 0) return REG_SUCCESS;
+
+	// Only literal components can continue: open them instead of enumerating the sub keys
+	BOOL bLiteral = !bKeys;
+	for (size_t i = 0; bLiteral && i < vComponents.size(); i++) {
+		if ((ullOpen & (1ULL << i)) && (vAnyDepth[i] || !vComponents[i].IsLiteral())) bLiteral = FALSE;
+	}
+	if (bLiteral) {
+		for (size_t i = 0; i < vComponents.size(); i++) {
+			if (!(ullOpen & (1ULL << i))) continue;
+			const std::string& cSon = vComponents[i].GetText();
+			BOOL bDone = FALSE;
+			for (size_t j = 0; j < i && !bDone; j++) {
+				bDone = (ullOpen & (1ULL << j)) && EqualsNoCase(vComponents[j].GetText(), cSon);
+			}
+			if (bDone) continue;
+			HRESULT hRes = Descend(rKey, cSon.c_str(), Step(ullState, cSon), dwDepth);
+			if (bStop || hRes != REG_SUCCESS) return hRes;
+		}
+		return REG_SUCCESS;
+	}
+
+	REGSEARCHMATCH mMatch = { &rKey, std::string_view(), nullptr, TRUE, REG_NONE, nullptr, 0 };
+	// One name buffer per level: the sub keys are searched before the next sibling is read
+	REGKEYINFO iInfo;
+	std::vector<CHAR> vKey;
+	rKey.QueryEnumInfo(&iInfo);
+	REGKEY::SizeEnumBuffers(iInfo, FALSE, &vKey, nullptr);
+	for (DWORD dwIndex = 0;; dwIndex++) {
+		DWORD dwNameSize = 0;
+		LSTATUS lRes = rKey.EnumKeyName(dwIndex, &vKey, &dwNameSize);
+		if (lRes == ERROR_NO_MORE_ITEMS) break;
+		if (lRes != ERROR_SUCCESS) return (lRes == ERROR_ACCESS_DENIED ? REG_ACCESS_DENIED : REG_UNKNOWN_ERROR);
+		const CHAR* kName = vKey.data();
+		std::string_view vSon(kName, dwNameSize);
+		if (bKeys && pName.Match(vSon)) {
+			mMatch.vPath = cPath;
+			mMatch.lpName = kName;
+			REGVISIT vRes = fVisit(mMatch);
+			if (vRes == REG_VISIT_STOP) {
+				bStop = TRUE;
+				return REG_SUCCESS;
+			}
+			if (vRes == REG_VISIT_SKIP) continue;
+		}
+		ULONGLONG ullNext = Step(ullState, vSon);
+		if (ullNext == 0) continue;
+		HRESULT hRes = Descend(rKey, kName, ullNext, dwDepth);
+		if (bStop || hRes != REG_SUCCESS) return hRes;
+	}
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::Search(const REGSEARCHOPTIONS& rOptions, REGSEARCHVISITOR fVisit) const {
+	REG_METRIC_SCOPE(REG_METRIC_SEARCH, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	REGSEARCH sSearch(rOptions, fVisit);
+	HRESULT hRes = sSearch.Compile();
+	if (hRes != REG_SUCCESS) return hRes;
+	return sSearch.Run(*this, sSearch.Start(), 0);
+}
@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGSEARCH_H
+#define REGSEARCH_H
+
+#include "RegKey.h"
+
+// ASCII case-insensitive comparison of names (16 bytes at a time with SSE2)
+BOOL EqualsNoCase(std::string_view vLeft, std::string_view vRight);
+// ASCII case-insensitive ordering of names: negative, zero or positive like strcmp
+INT CompareNoCase(std::string_view vLeft, std::string_view vRight);
+// Position of the first occurrence of vNeedle in vHay, std::string_view::npos if there is none
+size_t FindNoCase(std::string_view vHay, std::string_view vNeedle);
+
+// Compiled name pattern
+// The pattern is folded to lower case once; a glob is split at '*' into parts, the first and last part are
+// compared in place and the middle parts are found with FindNoCase, so no backtracking is needed.
+class REGNAMEPATTERN {
+private:
+	struct PART {
+		std::string cText; // Text in lower case
+		BOOL bWild; // Whether the text has '?'
+	};
+
+	REGMATCHMODE eMode;
+	std::string cPattern; // Pattern as given
+	std::vector<PART> vParts; // Glob parts between '*' (one part for the other modes)
+
+	static BOOL MatchAt(std::string_view vName, size_t ulPos, const PART& rPart);
+	static size_t FindPart(std::string_view vName, size_t ulPos, size_t ulEnd, const PART& rPart);
+
+public:
+	REGNAMEPATTERN();
+	explicit REGNAMEPATTERN(std::string_view vPattern, REGMATCHMODE eMode = REG_MATCH_GLOB);
+
+	// Compile a pattern
+	void Assign(std::string_view vPattern, REGMATCHMODE eMode);
+	// Whether a name matches
+	BOOL Match(std::string_view vName) const;
+	// Whether every name matches
+	BOOL MatchesAll() const;
+	// Whether the pattern matches exactly one name (no wildcards), which is GetText
+	BOOL IsLiteral() const;
+	// Pattern as given
+	const std::string& GetText() const;
+};
+
+#endif
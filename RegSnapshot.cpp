@@ -0,0 +1,260 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegSnapshot.h"
+#include "RegSearch.h"
+#include <algorithm>
+#include <unordered_map>
+
+// Collects a tree and turns it into a sorted snapshot
+class REGSNAPSHOTBUILDER {
+private:
+	REGSNAPSHOT* pOut;
+	std::unordered_map<std::string, DWORD> mIntern; // String -> offset in the string table
+
+	DWORD Intern(std::string_view vStr) {
+		auto it = mIntern.find(std::string(vStr));
+		if (it != mIntern.end()) return it->second;
+		DWORD dwOffset = static_cast<DWORD>(pOut->vStrings.size());
+		pOut->vStrings.insert(pOut->vStrings.end(), vStr.begin(), vStr.end());
+		mIntern.emplace(std::string(vStr), dwOffset);
+		return dwOffset;
+	}
+
+	std::string_view String(DWORD dwOffset, DWORD dwLen) const {
+		return std::string_view(pOut->vStrings.data() + dwOffset, dwLen);
+	}
+
+public:
+	explicit REGSNAPSHOTBUILDER(REGSNAPSHOT* pOut) : pOut(pOut) {}
+
+	HRESULT AddKey(const REGKEY& rKey, const std::string& cPath, REGSAM ulSam) {
+		REGSNAPSHOT::KEYREC kRec;
+		kRec.dwPath = Intern(cPath);
+		kRec.dwPathLen = static_cast<DWORD>(cPath.size());
+		kRec.dwFirstValue = static_cast<DWORD>(pOut->vValues.size());
+		HRESULT hRes = rKey.VisitValue([&](const REGKEY&, const REGVALUEINFO& rValue) {
+			REGSNAPSHOT::VALUEREC vRec;
+			size_t ulNameLen = strlen(rValue.lpName);
+			vRec.dwName = Intern(std::string_view(rValue.lpName, ulNameLen));
+			vRec.dwNameLen = static_cast<DWORD>(ulNameLen);
+			vRec.dwType = rValue.dwType;
+			vRec.dwSize = rValue.dwSize;
+			vRec.ullData = pOut->vData.size();
+			pOut->vData.insert(pOut->vData.end(), rValue.lpData, rValue.lpData + rValue.dwSize);
+			pOut->vValues.push_back(vRec);
+		}, TRUE);
+		if (hRes != REG_SUCCESS) return hRes;
+		kRec.dwValueCount = static_cast<DWORD>(pOut->vValues.size()) - kRec.dwFirstValue;
+		pOut->vKeys.push_back(kRec);
+
+		std::vector<std::string> vSons;
+		hRes = rKey.VisitKey([&](const REGKEY&, LPCSTR lpName) { vSons.emplace_back(lpName); });
+		if (hRes != REG_SUCCESS) return hRes;
+		for (const std::string& cSon : vSons) {
+			REGKEY rSon;
+			hRes = rKey.GetSon(cSon.c_str(), &rSon, ulSam);
+			// Deleted while the tree was captured
+			if (hRes == REG_PATH_NOT_EXIST) continue;
+			if (hRes != REG_SUCCESS) return hRes;
+			hRes = AddKey(rSon, cPath.empty() ? cSon : cPath + "\\" + cSon, ulSam);
+			if (hRes != REG_SUCCESS) return hRes;
+		}
+		return REG_SUCCESS;
+	}
+
+	// Sort the values of every key by name and the keys by path, keeping the values grouped by key
+	void Finish() {
+		std::vector<REGSNAPSHOT::VALUEREC>& vValues = pOut->vValues;
+		std::vector<REGSNAPSHOT::KEYREC>& vKeys = pOut->vKeys;
+		auto fNameLess = [this](const REGSNAPSHOT::VALUEREC& a, const REGSNAPSHOT::VALUEREC& b) {
+			return CompareNoCase(String(a.dwName, a.dwNameLen), String(b.dwName, b.dwNameLen)) < 0;
+		};
+		for (const REGSNAPSHOT::KEYREC& k : vKeys) {
+			std::sort(vValues.begin() + k.dwFirstValue, vValues.begin() + k.dwFirstValue + k.dwValueCount, fNameLess);
+		}
+		std::sort(vKeys.begin(), vKeys.end(), [this](const REGSNAPSHOT::KEYREC& a, const REGSNAPSHOT::KEYREC& b) {
+			return CompareNoCase(String(a.dwPath, a.dwPathLen), String(b.dwPath, b.dwPathLen)) < 0;
+		});
+		std::vector<REGSNAPSHOT::VALUEREC> vSorted;
+		vSorted.reserve(vValues.size());
+		for (REGSNAPSHOT::KEYREC& k : vKeys) {
+			DWORD dwFirst = static_cast<DWORD>(vSorted.size());
+			vSorted.insert(vSorted.end(), vValues.begin() + k.dwFirstValue, vValues.begin() + k.dwFirstValue + k.dwValueCount);
+			k.dwFirstValue = dwFirst;
+		}
+		vValues.swap(vSorted);
+		pOut->vStrings.shrink_to_fit();
+		pOut->vData.shrink_to_fit();
+		vKeys.shrink_to_fit();
+	}
+};
+
+HRESULT REGSNAPSHOT::Capture(const REGKEY& rRoot, REGSNAPSHOT* pOut) {
+	if (pOut == nullptr) return REG_INVAILD_POINTER;
+	if (!rRoot.Opened()) return REG_KEY_NOT_OPENED;
+	REGSAM ulSam = 0;
+	rRoot.GetSam(&ulSam);
+	REGSNAPSHOT sNew;
+	REGSNAPSHOTBUILDER bBuilder(&sNew);
+	HRESULT hRes = bBuilder.AddKey(rRoot, "", ulSam);
+	if (hRes != REG_SUCCESS) return hRes;
+	bBuilder.Finish();
+	*pOut = std::move(sNew);
+	return REG_SUCCESS;
+}
+
+DWORD REGSNAPSHOT::GetKeyCount() const {
+	return static_cast<DWORD>(vKeys.size());
+}
+DWORD REGSNAPSHOT::GetValueCount() const {
+	return static_cast<DWORD>(vValues.size());
+}
+std::string_view REGSNAPSHOT::GetKeyPath(DWORD dwKey) const {
+	if (dwKey >= vKeys.size()) return std::string_view();
+	return std::string_view(vStrings.data() + vKeys[dwKey].dwPath, vKeys[dwKey].dwPathLen);
+}
+DWORD REGSNAPSHOT::GetKeyValueCount(DWORD dwKey) const {
+	if (dwKey >= vKeys.size()) return 0;
+	return vKeys[dwKey].dwValueCount;
+}
+REGSNAPVALUE REGSNAPSHOT::GetValue(DWORD dwKey, DWORD dwIndex) const {
+	REGSNAPVALUE vRes = { std::string_view(), REG_NONE, nullptr, 0 };
+	if (dwKey >= vKeys.size() || dwIndex >= vKeys[dwKey].dwValueCount) return vRes;
+	const VALUEREC& r = vValues[vKeys[dwKey].dwFirstValue + dwIndex];
+	vRes.vName = std::string_view(vStrings.data() + r.dwName, r.dwNameLen);
+	vRes.dwType = r.dwType;
+	vRes.lpData = vData.data() + r.ullData;
+	vRes.dwSize = r.dwSize;
+	return vRes;
+}
+
+BOOL REGSNAPSHOT::FindKey(std::string_view vPath, DWORD* pdwKey) const {
+	size_t ulLow = 0, ulHigh = vKeys.size();
+	while (ulLow < ulHigh) {
+		size_t ulMid = (ulLow + ulHigh) / 2;
+		INT iCmp = CompareNoCase(GetKeyPath(static_cast<DWORD>(ulMid)), vPath);
+		if (iCmp == 0) {
+			if (pdwKey != nullptr) *pdwKey = static_cast<DWORD>(ulMid);
+			return TRUE;
+		}
+		if (iCmp < 0) ulLow = ulMid + 1;
+		else ulHigh = ulMid;
+	}
+	return FALSE;
+}
+
+BOOL REGSNAPSHOT::FindValue(DWORD dwKey, std::string_view vName, REGSNAPVALUE* pOut) const {
+	DWORD dwLow = 0, dwHigh = GetKeyValueCount(dwKey);
+	while (dwLow < dwHigh) {
+		DWORD dwMid = (dwLow + dwHigh) / 2;
+		REGSNAPVALUE vValue = GetValue(dwKey, dwMid);
+		INT iCmp = CompareNoCase(vValue.vName, vName);
+		if (iCmp == 0) {
+			if (pOut != nullptr) *pOut = vValue;
+			return TRUE;
+		}
+		if (iCmp < 0) dwLow = dwMid + 1;
+		else dwHigh = dwMid;
+	}
+	return FALSE;
+}
+
+size_t REGSNAPSHOT::GetMemoryUsage() const {
+	return sizeof(*this) + vStrings.capacity() + vKeys.capacity() * sizeof(KEYREC) + vValues.capacity() * sizeof(VALUEREC) + vData.capacity();
+}
+
+
+// Report the values of a key that exists on one side only
+static BOOL ReportValues(const REGSNAPSHOT& rSnap, DWORD dwKey, REGDIFFTYPE eType, std::string_view vPath, REGDIFFVISITOR& fVisit) {
+	for (DWORD i = 0; i < rSnap.GetKeyValueCount(dwKey); i++) {
+		REGSNAPVALUE vValue = rSnap.GetValue(dwKey, i);
+		REGDIFFENTRY dEntry = { eType, vPath, vValue.vName, nullptr, nullptr };
+		if (eType == REG_DIFF_VALUE_ADDED) dEntry.pNew = &vValue;
+		else dEntry.pOld = &vValue;
+		if (fVisit(dEntry) == REG_VISIT_STOP) return FALSE;
+	}
+	return TRUE;
+}
+
+HRESULT DiffSnapshots(const REGSNAPSHOT& rOld, const REGSNAPSHOT& rNew, REGDIFFVISITOR fVisit) {
+	DWORD i = 0, j = 0;
+	DWORD dwOldKeys = rOld.GetKeyCount(), dwNewKeys = rNew.GetKeyCount();
+	while (i < dwOldKeys || j < dwNewKeys) {
+		INT iCmp = 0;
+		if (i == dwOldKeys) iCmp = 1;
+		else if (j == dwNewKeys) iCmp = -1;
+		else iCmp = CompareNoCase(rOld.GetKeyPath(i), rNew.GetKeyPath(j));
+
+		if (iCmp != 0) {
+			// Key on one side only
+			const REGSNAPSHOT& rSnap = (iCmp < 0 ? rOld : rNew);
+			DWORD dwKey = (iCmp < 0 ? i++ : j++);
+			REGDIFFENTRY dEntry = { iCmp < 0 ? REG_DIFF_KEY_REMOVED : REG_DIFF_KEY_ADDED, rSnap.GetKeyPath(dwKey), std::string_view(), nullptr, nullptr };
+			REGVISIT eRes = fVisit(dEntry);
+			if (eRes == REG_VISIT_STOP) return REG_SUCCESS;
+			if (eRes == REG_VISIT_SKIP) continue;
+			if (!ReportValues(rSnap, dwKey, iCmp < 0 ? REG_DIFF_VALUE_REMOVED : REG_DIFF_VALUE_ADDED, dEntry.vPath, fVisit)) return REG_SUCCESS;
+			continue;
+		}
+
+		// Same key: merge the values
+		std::string_view vPath = rNew.GetKeyPath(j);
+		DWORD x = 0, y = 0;
+		DWORD dwOldValues = rOld.GetKeyValueCount(i), dwNewValues = rNew.GetKeyValueCount(j);
+		while (x < dwOldValues || y < dwNewValues) {
+			REGSNAPVALUE vOld = rOld.GetValue(i, x);
+			REGSNAPVALUE vNew = rNew.GetValue(j, y);
+			INT iValue = 0;
+			if (x == dwOldValues) iValue = 1;
+			else if (y == dwNewValues) iValue = -1;
+			else iValue = CompareNoCase(vOld.vName, vNew.vName);
+			REGDIFFENTRY dEntry = { REG_DIFF_VALUE_CHANGED, vPath, std::string_view(), nullptr, nullptr };
+			if (iValue < 0) {
+				dEntry.eType = REG_DIFF_VALUE_REMOVED;
+				dEntry.vName = vOld.vName;
+				dEntry.pOld = &vOld;
+				x++;
+			}
+			else if (iValue > 0) {
+				dEntry.eType = REG_DIFF_VALUE_ADDED;
+				dEntry.vName = vNew.vName;
+				dEntry.pNew = &vNew;
+				y++;
+			}
+			else {
+				x++;
+				y++;
+				if (vOld.dwType == vNew.dwType && vOld.dwSize == vNew.dwSize && (vOld.dwSize == 0 || memcmp(vOld.lpData, vNew.lpData, vOld.dwSize) == 0)) continue;
+				dEntry.vName = vNew.vName;
+				dEntry.pOld = &vOld;
+				dEntry.pNew = &vNew;
+			}
+			REGVISIT eRes = fVisit(dEntry);
+			if (eRes == REG_VISIT_STOP) return REG_SUCCESS;
+			if (eRes == REG_VISIT_SKIP) break;
+		}
+		i++;
+		j++;
+	}
+	return REG_SUCCESS;
+}
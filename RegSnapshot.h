@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGSNAPSHOT_H
+#define REGSNAPSHOT_H
+
+#include "RegKey.h"
+
+// Value of a snapshot
+struct REGSNAPVALUE {
+	std::string_view vName; // Name
+	DWORD dwType; // Type
+	const BYTE* lpData; // Data in the snapshot
+	DWORD dwSize; // Size of the data
+};
+
+// Immutable snapshot of a key tree
+// Names are interned in one string table, value data is stored in one blob, keys are sorted by path and the
+// values of every key by name (case-insensitive), so two snapshots can be compared in one linear pass.
+// Paths are relative to the captured key ("" is the captured key itself).
+class REGSNAPSHOT {
+private:
+	struct KEYREC {
+		DWORD dwPath; // Path offset in the string table
+		DWORD dwPathLen; // Path length
+		DWORD dwFirstValue; // First value in vValues
+		DWORD dwValueCount; // Number of values
+	};
+	struct VALUEREC {
+		DWORD dwName; // Name offset in the string table
+		DWORD dwNameLen; // Name length
+		DWORD dwType; // Type
+		DWORD dwSize; // Size of the data
+		ULONGLONG ullData; // Data offset in the blob
+	};
+
+	std::vector<CHAR> vStrings; // String table
+	std::vector<KEYREC> vKeys; // Keys, sorted by path
+	std::vector<VALUEREC> vValues; // Values, grouped by key and sorted by name
+	std::vector<BYTE> vData; // Value data
+
+	friend class REGSNAPSHOTBUILDER;
+
+public:
+	// Capture the tree below rRoot (the sub keys are opened with the authority of rRoot)
+	static HRESULT Capture(const REGKEY& rRoot, REGSNAPSHOT* pOut);
+
+	// Number of keys / values
+	DWORD GetKeyCount() const;
+	DWORD GetValueCount() const;
+	// Path of the dwKey-th key (sorted order)
+	std::string_view GetKeyPath(DWORD dwKey) const;
+	// Number of values of the dwKey-th key
+	DWORD GetKeyValueCount(DWORD dwKey) const;
+	// The dwIndex-th value of the dwKey-th key (sorted by name)
+	REGSNAPVALUE GetValue(DWORD dwKey, DWORD dwIndex) const;
+	// Binary search a key by path / a value by name (case-insensitive)
+	BOOL FindKey(std::string_view vPath, DWORD* pdwKey) const;
+	BOOL FindValue(DWORD dwKey, std::string_view vName, REGSNAPVALUE* pOut) const;
+	// Bytes used by the snapshot
+	size_t GetMemoryUsage() const;
+};
+
+// Kind of a difference between two snapshots
+enum REGDIFFTYPE {
+	REG_DIFF_KEY_ADDED,
+	REG_DIFF_KEY_REMOVED,
+	REG_DIFF_VALUE_ADDED,
+	REG_DIFF_VALUE_REMOVED,
+	REG_DIFF_VALUE_CHANGED // Type or data changed
+};
+
+// Difference between two snapshots
+struct REGDIFFENTRY {
+	REGDIFFTYPE eType;
+	std::string_view vPath; // Key path
+	std::string_view vName; // Value name (empty for key differences)
+	const REGSNAPVALUE* pOld; // Old value (empty if added or for key differences)
+	const REGSNAPVALUE* pNew; // New value (empty if removed or for key differences)
+};
+typedef REGFUNCREF<REGVISIT(const REGDIFFENTRY& rDiff)> REGDIFFVISITOR;
+
+// Compare two snapshots in one merge pass, in key path order. The values of an added or removed key are reported
+// after the key. REG_VISIT_SKIP skips the values of the current key, REG_VISIT_STOP ends the comparison.
+HRESULT DiffSnapshots(const REGSNAPSHOT& rOld, const REGSNAPSHOT& rNew, REGDIFFVISITOR fVisit);
+
+#endif
@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegStream.h"
+
+REGVALUEREADER::REGVALUEREADER(std::vector<BYTE>* pBuffer) : pBuffer(pBuffer), dwType(REG_NONE), ulPos(0) {
+	return;
+}
+
+HRESULT REGVALUEREADER::Open(const REGKEY& rKey, LPCSTR lpName, DWORD dwExpectType) {
+	if (pBuffer == nullptr) return REG_INVAILD_POINTER;
+	dwType = REG_NONE;
+	ulPos = 0;
+	DWORD dwRead = REG_NONE;
+	HRESULT hRes = rKey.ReadValue(lpName, &dwRead, pBuffer);
+	if (hRes != REG_SUCCESS) return hRes;
+	if (dwExpectType != REG_ANY_TYPE && dwRead != dwExpectType) {
+		pBuffer->clear();
+		return REG_INCORRECT_TYPE;
+	}
+	dwType = dwRead;
+	return REG_SUCCESS;
+}
+
+HRESULT REGVALUEREADER::Read(BYTE* lpOut, DWORD dwSize, DWORD* pdwRead) {
+	const BYTE* lpData = nullptr;
+	if (lpOut == nullptr && dwSize != 0) return REG_INVAILD_POINTER;
+	HRESULT hRes = Next(dwSize, &lpData, pdwRead);
+	if (hRes != REG_SUCCESS) return hRes;
+	if (*pdwRead != 0) memcpy(lpOut, lpData, *pdwRead);
+	return REG_SUCCESS;
+}
+
+HRESULT REGVALUEREADER::Next(DWORD dwMax, const BYTE** ppData, DWORD* pdwSize) {
+	if (pBuffer == nullptr || ppData == nullptr || pdwSize == nullptr) return REG_INVAILD_POINTER;
+	size_t ulLeft = pBuffer->size() - ulPos;
+	DWORD dwSize = static_cast<DWORD>(ulLeft < dwMax ? ulLeft : dwMax);
+	*ppData = pBuffer->data() + ulPos;
+	*pdwSize = dwSize;
+	ulPos += dwSize;
+	return REG_SUCCESS;
+}
+
+DWORD REGVALUEREADER::GetType() const {
+	return dwType;
+}
+DWORD REGVALUEREADER::GetSize() const {
+	return pBuffer == nullptr ? 0 : static_cast<DWORD>(pBuffer->size());
+}
+DWORD REGVALUEREADER::GetPosition() const {
+	return static_cast<DWORD>(ulPos);
+}
+
+
+REGVALUEWRITER::REGVALUEWRITER(std::vector<BYTE>* pBuffer) : pBuffer(pBuffer), pKey(nullptr), dwType(REG_NONE) {
+	return;
+}
+
+HRESULT REGVALUEWRITER::Begin(const REGKEY& rKey, LPCSTR lpName, DWORD dwInType, DWORD dwSizeHint) {
+	if (pBuffer == nullptr) return REG_INVAILD_POINTER;
+	if (!rKey.Opened()) return REG_KEY_NOT_OPENED;
+	pKey = &rKey;
+	cName = (lpName == nullptr ? "" : lpName);
+	dwType = dwInType;
+	pBuffer->clear();
+	if (pBuffer->capacity() < dwSizeHint) pBuffer->reserve(dwSizeHint);
+	return REG_SUCCESS;
+}
+
+HRESULT REGVALUEWRITER::Write(const BYTE* lpData, DWORD dwSize) {
+	if (pKey == nullptr) return REG_KEY_NOT_OPENED;
+	if (lpData == nullptr && dwSize != 0) return REG_INVAILD_POINTER;
+	if (pBuffer->size() + dwSize > 0xFFFFFFFFull) return REG_STR_TOO_LONG;
+	pBuffer->insert(pBuffer->end(), lpData, lpData + dwSize);
+	return REG_SUCCESS;
+}
+
+HRESULT REGVALUEWRITER::Commit() {
+	if (pKey == nullptr) return REG_KEY_NOT_OPENED;
+	if ((dwType == REG_SZ || dwType == REG_EXPAND_SZ) && (pBuffer->empty() || pBuffer->back() != 0)) pBuffer->push_back(0);
+	HRESULT hRes = pKey->WriteValue(cName.c_str(), dwType, pBuffer->data(), static_cast<DWORD>(pBuffer->size()));
+	pKey = nullptr;
+	return hRes;
+}
+
+void REGVALUEWRITER::Abort() {
+	pKey = nullptr;
+	if (pBuffer != nullptr) pBuffer->clear();
+}
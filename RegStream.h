@@ -0,0 +1,79 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGSTREAM_H
+#define REGSTREAM_H
+
+#include "RegKey.h"
+
+// Chunked reader of a large value
+// The registry reads a value in one call, so Open reads the whole value once into the caller's buffer (reused
+// across values, grown only when a value is larger than any before) and Read / Next hand it out in chunks.
+class REGVALUEREADER {
+private:
+	std::vector<BYTE>* pBuffer; // Caller buffer holding the value
+	DWORD dwType; // Type of the value
+	size_t ulPos; // Read position
+
+public:
+	// pBuffer must outlive the reader
+	explicit REGVALUEREADER(std::vector<BYTE>* pBuffer);
+
+	// Read the value lpName of rKey. dwExpectType can be REG_ANY_TYPE.
+	HRESULT Open(const REGKEY& rKey, LPCSTR lpName, DWORD dwExpectType);
+	// Copy up to dwSize bytes to lpOut. *pdwRead is 0 at the end of the value.
+	HRESULT Read(BYTE* lpOut, DWORD dwSize, DWORD* pdwRead);
+	// Get up to dwMax bytes without copying (valid until the next Open). *pdwSize is 0 at the end of the value.
+	HRESULT Next(DWORD dwMax, const BYTE** ppData, DWORD* pdwSize);
+
+	// Get the type / size of the value
+	DWORD GetType() const;
+	DWORD GetSize() const;
+	// Get the read position
+	DWORD GetPosition() const;
+};
+
+// Chunked writer of a large value
+// Chunks are appended to the caller's buffer (reused across values) and Commit writes the value with one call,
+// so a value is never half written.
+class REGVALUEWRITER {
+private:
+	std::vector<BYTE>* pBuffer; // Caller buffer collecting the value
+	const REGKEY* pKey; // Key being written, empty when no value is begun
+	std::string cName; // Value name
+	DWORD dwType; // Type of the value
+
+public:
+	// pBuffer must outlive the writer
+	explicit REGVALUEWRITER(std::vector<BYTE>* pBuffer);
+
+	// Begin the value lpName of rKey (rKey must stay open until Commit). dwSizeHint reserves the buffer up front.
+	HRESULT Begin(const REGKEY& rKey, LPCSTR lpName, DWORD dwType, DWORD dwSizeHint);
+	// Append a chunk
+	HRESULT Write(const BYTE* lpData, DWORD dwSize);
+	// Write the value. A REG_SZ / REG_EXPAND_SZ value gets its terminator if the chunks did not end with one.
+	HRESULT Commit();
+	// Drop the begun value
+	void Abort();
+};
+
+#endif
@@ -0,0 +1,508 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegKey.h"
+#include "RegMetrics.h"
+#include "RegPath.h"
+#include "RegPool.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define REGUTF_SSE2
+#include <emmintrin.h>
+#endif
+
+#define REG_VAILD_ROOTKEY(i) ((i) == HKEY_CLASSES_ROOT || (i) == HKEY_CURRENT_USER || (i) == HKEY_LOCAL_MACHINE || (i) == HKEY_USERS || (i) == HKEY_CURRENT_CONFIG)
+#define REG_REPLACEMENT_CHAR 0xFFFD
+
+// Values up to this size are read without allocation
+#define REG_SMALL_BUFFER 256
+
+size_t Utf8ToUtf16(const CHAR* lpIn, size_t ulLen, WCHAR* lpOut) {
+	const BYTE* p = reinterpret_cast<const BYTE*>(lpIn);
+	size_t i = 0;
+	size_t o = 0;
+	while (i < ulLen) {
+#ifdef REGUTF_SSE2
+		// ASCII run: widen 16 bytes at a time
+		const __m128i vZero = _mm_setzero_si128();
+		while (i + 16 <= ulLen) {
+			__m128i vIn = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+			if (_mm_movemask_epi8(vIn) != 0) break;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lpOut + o), _mm_unpacklo_epi8(vIn, vZero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lpOut + o + 8), _mm_unpackhi_epi8(vIn, vZero));
+			i += 16;
+			o += 16;
+		}
+		if (i >= ulLen) break;
+#endif
+		BYTE c = p[i];
+		if (c < 0x80) {
+			lpOut[o++] = c;
+			i++;
+			continue;
+		}
+		DWORD dwCode = 0;
+		size_t ulNeed = 0;
+		DWORD dwMin = 0;
+		if (c >= 0xC2 && c <= 0xDF) { ulNeed = 1; dwCode = c & 0x1F; dwMin = 0x80; }
+		else if (c >= 0xE0 && c <= 0xEF) { ulNeed = 2; dwCode = c & 0x0F; dwMin = 0x800; }
+		else if (c >= 0xF0 && c <= 0xF4) { ulNeed = 3; dwCode = c & 0x07; dwMin = 0x10000; }
+		else {
+			lpOut[o++] = REG_REPLACEMENT_CHAR;
+			i++;
+			continue;
+		}
+		size_t k = 1;
+		for (; k <= ulNeed && i + k < ulLen && (p[i + k] & 0xC0) == 0x80; k++) dwCode = (dwCode << 6) | (p[i + k] & 0x3F);
+		i += k;
+		// Truncated, overlong, surrogate or out of range: one replacement for the whole sequence
+		if (k <= ulNeed || dwCode < dwMin || (dwCode >= 0xD800 && dwCode <= 0xDFFF) || dwCode > 0x10FFFF) {
+			lpOut[o++] = REG_REPLACEMENT_CHAR;
+			continue;
+		}
+		if (dwCode >= 0x10000) {
+			dwCode -= 0x10000;
+			lpOut[o++] = static_cast<WCHAR>(0xD800 | (dwCode >> 10));
+			lpOut[o++] = static_cast<WCHAR>(0xDC00 | (dwCode & 0x3FF));
+		}
+		else lpOut[o++] = static_cast<WCHAR>(dwCode);
+	}
+	return o;
+}
+
+size_t Utf16ToUtf8(const WCHAR* lpIn, size_t ulLen, CHAR* lpOut) {
+	BYTE* q = reinterpret_cast<BYTE*>(lpOut);
+	size_t i = 0;
+	size_t o = 0;
+	while (i < ulLen) {
+#ifdef REGUTF_SSE2
+		// ASCII run: narrow 8 units at a time
+		const __m128i vHigh = _mm_set1_epi16(static_cast<SHORT>(0xFF80));
+		const __m128i vZero = _mm_setzero_si128();
+		while (i + 8 <= ulLen) {
+			__m128i vIn = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lpIn + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(vIn, vHigh), vZero)) != 0xFFFF) break;
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(q + o), _mm_packus_epi16(vIn, vIn));
+			i += 8;
+			o += 8;
+		}
+		if (i >= ulLen) break;
+#endif
+		DWORD dwCode = static_cast<WORD>(lpIn[i++]);
+		if (dwCode < 0x80) {
+			q[o++] = static_cast<BYTE>(dwCode);
+			continue;
+		}
+		if (dwCode < 0x800) {
+			q[o++] = static_cast<BYTE>(0xC0 | (dwCode >> 6));
+			q[o++] = static_cast<BYTE>(0x80 | (dwCode & 0x3F));
+			continue;
+		}
+		if (dwCode >= 0xD800 && dwCode <= 0xDFFF) {
+			DWORD dwLow = (i < ulLen ? static_cast<WORD>(lpIn[i]) : 0);
+			if (dwCode <= 0xDBFF && dwLow >= 0xDC00 && dwLow <= 0xDFFF) {
+				i++;
+				dwCode = 0x10000 + ((dwCode - 0xD800) << 10) + (dwLow - 0xDC00);
+				q[o++] = static_cast<BYTE>(0xF0 | (dwCode >> 18));
+				q[o++] = static_cast<BYTE>(0x80 | ((dwCode >> 12) & 0x3F));
+				q[o++] = static_cast<BYTE>(0x80 | ((dwCode >> 6) & 0x3F));
+				q[o++] = static_cast<BYTE>(0x80 | (dwCode & 0x3F));
+				continue;
+			}
+			// Unpaired surrogate
+			dwCode = REG_REPLACEMENT_CHAR;
+		}
+		q[o++] = static_cast<BYTE>(0xE0 | (dwCode >> 12));
+		q[o++] = static_cast<BYTE>(0x80 | ((dwCode >> 6) & 0x3F));
+		q[o++] = static_cast<BYTE>(0x80 | (dwCode & 0x3F));
+	}
+	return o;
+}
+
+
+static BOOL IsStringType(DWORD dwType) {
+	return dwType == REG_SZ || dwType == REG_EXPAND_SZ || dwType == REG_MULTI_SZ;
+}
+
+// UTF-16 to the ANSI code page, like the *A functions do
+static void WideToAnsi(const WCHAR* lpIn, size_t ulLen, std::string* pOut) {
+	pOut->clear();
+	if (ulLen == 0) return;
+	INT iLen = WideCharToMultiByte(CP_ACP, 0, lpIn, static_cast<INT>(ulLen), nullptr, 0, nullptr, nullptr);
+	pOut->resize(iLen);
+	WideCharToMultiByte(CP_ACP, 0, lpIn, static_cast<INT>(ulLen), &(*pOut)[0], iLen, nullptr, nullptr);
+}
+static void WideToAnsi(LPCWSTR lpIn, std::string* pOut) {
+	WideToAnsi(lpIn, lpIn == nullptr ? 0 : wcslen(lpIn), pOut);
+}
+
+LSTATUS REGBACKEND::OpenKeyW(HKEY hParent, LPCWSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) {
+	std::string cPath;
+	WideToAnsi(lpPath, &cPath);
+	return OpenKey(hParent, cPath.c_str(), ulSam, bCreate, phOutKey);
+}
+
+LSTATUS REGBACKEND::SetValueW(HKEY hKey, LPCWSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	std::string cName;
+	WideToAnsi(lpName, &cName);
+	if (!IsStringType(dwType) || lpData == nullptr) return SetValue(hKey, cName.c_str(), dwType, lpData, dwSize);
+	std::string cData;
+	WideToAnsi(reinterpret_cast<const WCHAR*>(lpData), dwSize / sizeof(WCHAR), &cData);
+	return SetValue(hKey, cName.c_str(), dwType, reinterpret_cast<const BYTE*>(cData.data()), static_cast<DWORD>(cData.size()));
+}
+
+LSTATUS REGBACKEND::QueryValueW(HKEY hKey, LPCWSTR lpName, DWORD* pdwType, BYTE* lpData, DWORD* pdwSize) {
+	if (lpData != nullptr && pdwSize == nullptr) return ERROR_INVALID_PARAMETER;
+	std::string cName;
+	WideToAnsi(lpName, &cName);
+	DWORD dwType = 0;
+	DWORD dwSize = 0;
+	std::vector<BYTE> vData;
+	LSTATUS lRes = QueryValue(hKey, cName.c_str(), &dwType, nullptr, &dwSize);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	do {
+		vData.resize(dwSize);
+		lRes = QueryValue(hKey, cName.c_str(), &dwType, vData.data(), &dwSize);
+	} while (lRes == ERROR_MORE_DATA);
+	if (lRes != ERROR_SUCCESS) return lRes;
+	vData.resize(dwSize);
+
+	// Size of the data in UTF-16
+	const CHAR* lpAnsi = reinterpret_cast<const CHAR*>(vData.data());
+	INT iWide = 0;
+	DWORD dwNeed = dwSize;
+	if (IsStringType(dwType) && dwSize != 0) {
+		iWide = MultiByteToWideChar(CP_ACP, 0, lpAnsi, static_cast<INT>(dwSize), nullptr, 0);
+		dwNeed = static_cast<DWORD>(iWide * sizeof(WCHAR));
+	}
+	if (pdwType != nullptr) *pdwType = dwType;
+	if (pdwSize == nullptr) return ERROR_SUCCESS;
+	DWORD dwHave = *pdwSize;
+	*pdwSize = dwNeed;
+	if (lpData == nullptr) return ERROR_SUCCESS;
+	if (dwHave < dwNeed) return ERROR_MORE_DATA;
+	if (IsStringType(dwType) && dwSize != 0) MultiByteToWideChar(CP_ACP, 0, lpAnsi, static_cast<INT>(dwSize), reinterpret_cast<WCHAR*>(lpData), iWide);
+	else if (dwSize != 0) memcpy(lpData, vData.data(), dwSize);
+	return ERROR_SUCCESS;
+}
+
+LSTATUS REGBACKEND::DeleteValueW(HKEY hKey, LPCWSTR lpName) {
+	std::string cName;
+	WideToAnsi(lpName, &cName);
+	return DeleteValue(hKey, cName.c_str());
+}
+
+
+// Conversion buffers of the calling thread, reused by every call
+struct REGUNICODEBUFFERS {
+	std::wstring cName; // Terminated value name
+	std::wstring cData; // Terminated string data
+	std::string cAnsi; // ANSI or UTF-8 form of a path or name
+};
+static REGUNICODEBUFFERS& GetUnicodeBuffers() {
+	thread_local REGUNICODEBUFFERS Buffers;
+	return Buffers;
+}
+
+// Copy a view into a terminated buffer
+static LPCWSTR Terminate(std::wstring_view lpIn, std::wstring* pBuffer) {
+	pBuffer->assign(lpIn.data(), lpIn.size());
+	return pBuffer->c_str();
+}
+
+// Convert a UTF-8 view into a terminated UTF-16 buffer
+static LPCWSTR Widen(std::string_view lpIn, std::wstring* pBuffer) {
+	pBuffer->resize(lpIn.size());
+	pBuffer->resize(Utf8ToUtf16(lpIn.data(), lpIn.size(), &(*pBuffer)[0]));
+	return pBuffer->c_str();
+}
+
+// Buffer of the calling thread a value of type T is read into
+template <typename T>
+static T* GetQueryBuffer() {
+	thread_local T tBuffer;
+	return &tBuffer;
+}
+
+// Read a value with QueryValueW into the thread's buffer (std::wstring or std::vector<BYTE>), using its capacity
+// first and growing it only when the backend reports ERROR_MORE_DATA. On success the buffer is swapped into
+// *pBuffer and *pdwSize receives the size in bytes; on failure *pBuffer is left untouched.
+template <typename T>
+static HRESULT QueryValueInto(REGBACKEND* pBackend, HKEY hKey, LPCWSTR lpName, DWORD dwExpectType, T* pBuffer, DWORD* pdwType, DWORD* pdwSize) {
+	typedef typename T::value_type C;
+	T* pQuery = GetQueryBuffer<T>();
+	if (pQuery->capacity() * sizeof(C) < REG_SMALL_BUFFER) pQuery->reserve(REG_SMALL_BUFFER / sizeof(C));
+	pQuery->resize(pQuery->capacity());
+	DWORD dwType = 0;
+	DWORD dwSize = static_cast<DWORD>(pQuery->size() * sizeof(C));
+	LSTATUS lRes = pBackend->QueryValueW(hKey, lpName, &dwType, reinterpret_cast<BYTE*>(&(*pQuery)[0]), &dwSize);
+	REG_METRIC_STATUS(lRes);
+	while (lRes == ERROR_MORE_DATA) {
+		if (dwExpectType != REG_ANY_TYPE && dwType != dwExpectType) break;
+		pQuery->resize((dwSize + sizeof(C) - 1) / sizeof(C));
+		dwSize = static_cast<DWORD>(pQuery->size() * sizeof(C));
+		lRes = pBackend->QueryValueW(hKey, lpName, &dwType, reinterpret_cast<BYTE*>(&(*pQuery)[0]), &dwSize);
+		REG_METRIC_STATUS(lRes);
+	}
+	if (lRes != ERROR_SUCCESS && lRes != ERROR_MORE_DATA) {
+		if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+		if (lRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
+		return REG_UNKNOWN_ERROR;
+	}
+	if (dwExpectType != REG_ANY_TYPE && dwType != dwExpectType) return REG_INCORRECT_TYPE;
+	pBuffer->swap(*pQuery);
+	if (pdwType != nullptr) *pdwType = dwType;
+	*pdwSize = dwSize;
+	REG_METRIC_BYTES_READ(dwSize);
+	return REG_SUCCESS;
+}
+
+// Read a string value into *lpRes, cut at the first terminator
+static HRESULT QueryStringInto(REGBACKEND* pBackend, HKEY hKey, LPCWSTR lpName, DWORD dwType, std::wstring* lpRes) {
+	DWORD dwSize = 0;
+	HRESULT hRes = QueryValueInto(pBackend, hKey, lpName, dwType, lpRes, nullptr, &dwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	lpRes->resize(wcsnlen(lpRes->c_str(), dwSize / sizeof(WCHAR)));
+	return REG_SUCCESS;
+}
+
+static HRESULT SetValueResult(LSTATUS lRes) {
+	if (lRes == ERROR_SUCCESS) return REG_SUCCESS;
+	if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+	return REG_UNKNOWN_ERROR;
+}
+
+// Set a value with SetValueW
+static HRESULT WriteValueW(REGBACKEND* pBackend, HKEY hKey, LPCWSTR lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) {
+	LSTATUS lRes = pBackend->SetValueW(hKey, lpName, dwType, lpData, dwSize);
+	REG_METRIC_STATUS(lRes);
+	if (lRes == ERROR_SUCCESS) REG_METRIC_BYTES_WRITTEN(dwSize);
+	return SetValueResult(lRes);
+}
+
+
+// Open or create a key by the UTF-8 form of a UTF-16 path through the handle pool
+HRESULT REGKEY::AcquireW(HKEY hInRootKey, std::string_view lpInPath, REGSAM ulInSam, BOOL bCreate) {
+	if (!REG_VAILD_ROOTKEY(hInRootKey)) return REG_INVAILD_ROOT;
+	LSTATUS lRes = ERROR_SUCCESS;
+	REGPATHID idInPath = GetRegPathTable()->Intern(lpInPath);
+	HRESULT hRes = Acquire(hInRootKey, idInPath, ulInSam, bCreate, TRUE, &lRes);
+	GetRegPathTable()->Release(idInPath);
+	if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+	if (lRes == ERROR_FILE_NOT_FOUND && !bCreate) return REG_PATH_NOT_EXIST;
+	return hRes;
+}
+
+REGPATHID REGKEY::AppendName(REGPATHID idBase, BOOL bWide, std::string_view vName) {
+	if (!bWide) return GetRegPathTable()->Append(idBase, vName);
+	REGUNICODEBUFFERS& rBuffers = GetUnicodeBuffers();
+	INT iLen = (vName.empty() ? 0 : MultiByteToWideChar(CP_ACP, 0, vName.data(), static_cast<INT>(vName.size()), nullptr, 0));
+	rBuffers.cName.resize(iLen);
+	if (iLen != 0) MultiByteToWideChar(CP_ACP, 0, vName.data(), static_cast<INT>(vName.size()), &rBuffers.cName[0], iLen);
+	rBuffers.cAnsi.resize(rBuffers.cName.size() * 3);
+	rBuffers.cAnsi.resize(Utf16ToUtf8(rBuffers.cName.data(), rBuffers.cName.size(), &rBuffers.cAnsi[0]));
+	return GetRegPathTable()->Append(idBase, rBuffers.cAnsi);
+}
+
+void REGKEY::Utf8ToAnsi(std::string* pPath) {
+	std::wstring& cWide = GetUnicodeBuffers().cData;
+	Widen(*pPath, &cWide);
+	WideToAnsi(cWide.data(), cWide.size(), pPath);
+}
+
+// UTF-16 to the UTF-8 form the path table holds
+static std::string_view Narrow(std::wstring_view lpIn, std::string* pBuffer) {
+	pBuffer->resize(lpIn.size() * 3);
+	pBuffer->resize(Utf16ToUtf8(lpIn.data(), lpIn.size(), &(*pBuffer)[0]));
+	return *pBuffer;
+}
+
+HRESULT REGKEY::CreateW(HKEY hInRootKey, std::wstring_view lpInPath, REGSAM ulInSam) {
+	REG_METRIC_SCOPE(REG_METRIC_OPEN, hInRootKey);
+	return AcquireW(hInRootKey, Narrow(lpInPath, &GetUnicodeBuffers().cAnsi), ulInSam, TRUE);
+}
+HRESULT REGKEY::OpenW(HKEY hInRootKey, std::wstring_view lpInPath, REGSAM ulInSam) {
+	REG_METRIC_SCOPE(REG_METRIC_OPEN, hInRootKey);
+	return AcquireW(hInRootKey, Narrow(lpInPath, &GetUnicodeBuffers().cAnsi), ulInSam, FALSE);
+}
+HRESULT REGKEY::CreateUTF8(HKEY hInRootKey, std::string_view lpInPath, REGSAM ulInSam) {
+	REG_METRIC_SCOPE(REG_METRIC_OPEN, hInRootKey);
+	return AcquireW(hInRootKey, lpInPath, ulInSam, TRUE);
+}
+HRESULT REGKEY::OpenUTF8(HKEY hInRootKey, std::string_view lpInPath, REGSAM ulInSam) {
+	REG_METRIC_SCOPE(REG_METRIC_OPEN, hInRootKey);
+	return AcquireW(hInRootKey, lpInPath, ulInSam, FALSE);
+}
+
+HRESULT REGKEY::GetPathUTF8(std::string* lpOutPath) const {
+	if (lpOutPath == nullptr) return REG_INVAILD_POINTER;
+	GetRegPathTable()->GetPath(idPath, lpOutPath);
+	if (IsWide()) return REG_SUCCESS;
+	// ANSI path
+	std::wstring& cWide = GetUnicodeBuffers().cData;
+	INT iLen = (lpOutPath->empty() ? 0 : MultiByteToWideChar(CP_ACP, 0, lpOutPath->data(), static_cast<INT>(lpOutPath->size()), nullptr, 0));
+	cWide.resize(iLen);
+	if (iLen != 0) MultiByteToWideChar(CP_ACP, 0, lpOutPath->data(), static_cast<INT>(lpOutPath->size()), &cWide[0], iLen);
+	Narrow(cWide, lpOutPath);
+	return REG_SUCCESS;
+}
+
+HRESULT REGKEY::WriteREGSZ(std::wstring_view lpName, std::wstring_view lpVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	REGUNICODEBUFFERS& rBuffers = GetUnicodeBuffers();
+	LPCWSTR lpData = Terminate(lpVal, &rBuffers.cData);
+	return WriteValueW(
+		pBackend, 
+		hKey, 
+		Terminate(lpName, &rBuffers.cName), 
+		REG_SZ, 
+		reinterpret_cast<const BYTE*>(lpData), 
+		static_cast<DWORD>((rBuffers.cData.size() + 1) * sizeof(WCHAR))
+	);
+}
+HRESULT REGKEY::WriteREGEXPANDSZ(std::wstring_view lpName, std::wstring_view lpVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	REGUNICODEBUFFERS& rBuffers = GetUnicodeBuffers();
+	LPCWSTR lpData = Terminate(lpVal, &rBuffers.cData);
+	return WriteValueW(
+		pBackend, 
+		hKey, 
+		Terminate(lpName, &rBuffers.cName), 
+		REG_EXPAND_SZ, 
+		reinterpret_cast<const BYTE*>(lpData), 
+		static_cast<DWORD>((rBuffers.cData.size() + 1) * sizeof(WCHAR))
+	);
+}
+HRESULT REGKEY::WriteValue(std::wstring_view lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpData == nullptr && dwSize != 0) return REG_INVAILD_POINTER;
+	return WriteValueW(pBackend, hKey, Terminate(lpName, &GetUnicodeBuffers().cName), dwType, lpData, dwSize);
+}
+HRESULT REGKEY::WriteREGSZUTF8(std::string_view lpName, std::string_view lpVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	REGUNICODEBUFFERS& rBuffers = GetUnicodeBuffers();
+	LPCWSTR lpData = Widen(lpVal, &rBuffers.cData);
+	return WriteValueW(
+		pBackend, 
+		hKey, 
+		Widen(lpName, &rBuffers.cName), 
+		REG_SZ, 
+		reinterpret_cast<const BYTE*>(lpData), 
+		static_cast<DWORD>((rBuffers.cData.size() + 1) * sizeof(WCHAR))
+	);
+}
+HRESULT REGKEY::WriteREGEXPANDSZUTF8(std::string_view lpName, std::string_view lpVal) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	REGUNICODEBUFFERS& rBuffers = GetUnicodeBuffers();
+	LPCWSTR lpData = Widen(lpVal, &rBuffers.cData);
+	return WriteValueW(
+		pBackend, 
+		hKey, 
+		Widen(lpName, &rBuffers.cName), 
+		REG_EXPAND_SZ, 
+		reinterpret_cast<const BYTE*>(lpData), 
+		static_cast<DWORD>((rBuffers.cData.size() + 1) * sizeof(WCHAR))
+	);
+}
+HRESULT REGKEY::WriteValueUTF8(std::string_view lpName, DWORD dwType, const BYTE* lpData, DWORD dwSize) const {
+	REG_METRIC_SCOPE(REG_METRIC_WRITE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpData == nullptr && dwSize != 0) return REG_INVAILD_POINTER;
+	return WriteValueW(pBackend, hKey, Widen(lpName, &GetUnicodeBuffers().cName), dwType, lpData, dwSize);
+}
+
+HRESULT REGKEY::DeleteValue(std::wstring_view lpName) const {
+	REG_METRIC_SCOPE(REG_METRIC_DELETEVALUE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	LSTATUS lRes = pBackend->DeleteValueW(hKey, Terminate(lpName, &GetUnicodeBuffers().cName));
+	REG_METRIC_STATUS(lRes);
+	if (lRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
+	return SetValueResult(lRes);
+}
+HRESULT REGKEY::DeleteValueUTF8(std::string_view lpName) const {
+	REG_METRIC_SCOPE(REG_METRIC_DELETEVALUE, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	LSTATUS lRes = pBackend->DeleteValueW(hKey, Widen(lpName, &GetUnicodeBuffers().cName));
+	REG_METRIC_STATUS(lRes);
+	if (lRes == ERROR_FILE_NOT_FOUND) return REG_VALUE_NOT_EXIST;
+	return SetValueResult(lRes);
+}
+
+HRESULT REGKEY::ReadREGSZ(std::wstring_view lpName, std::wstring* lpRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpRes == nullptr) return REG_INVAILD_POINTER;
+	return QueryStringInto(pBackend, hKey, Terminate(lpName, &GetUnicodeBuffers().cName), REG_SZ, lpRes);
+}
+HRESULT REGKEY::ReadREGEXPANDSZ(std::wstring_view lpName, std::wstring* lpRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpRes == nullptr) return REG_INVAILD_POINTER;
+	return QueryStringInto(pBackend, hKey, Terminate(lpName, &GetUnicodeBuffers().cName), REG_EXPAND_SZ, lpRes);
+}
+HRESULT REGKEY::ReadValue(std::wstring_view lpName, DWORD* pdwType, std::vector<BYTE>* lpRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	DWORD dwSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpRes == nullptr) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryValueInto(pBackend, hKey, Terminate(lpName, &GetUnicodeBuffers().cName), REG_ANY_TYPE, lpRes, pdwType, &dwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	lpRes->resize(dwSize);
+	return REG_SUCCESS;
+}
+
+// Read a string value as UTF-16 into the thread's buffer, then transcode it into *lpRes
+static HRESULT ReadStringUTF8(REGBACKEND* pBackend, HKEY hKey, std::string_view lpName, DWORD dwType, std::string* lpRes) {
+	REGUNICODEBUFFERS& rBuffers = GetUnicodeBuffers();
+	HRESULT hRes = QueryStringInto(pBackend, hKey, Widen(lpName, &rBuffers.cName), dwType, &rBuffers.cData);
+	if (hRes != REG_SUCCESS) return hRes;
+	lpRes->resize(rBuffers.cData.size() * 3);
+	lpRes->resize(Utf16ToUtf8(rBuffers.cData.data(), rBuffers.cData.size(), &(*lpRes)[0]));
+	return REG_SUCCESS;
+}
+HRESULT REGKEY::ReadREGSZUTF8(std::string_view lpName, std::string* lpRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpRes == nullptr) return REG_INVAILD_POINTER;
+	return ReadStringUTF8(pBackend, hKey, lpName, REG_SZ, lpRes);
+}
+HRESULT REGKEY::ReadREGEXPANDSZUTF8(std::string_view lpName, std::string* lpRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpRes == nullptr) return REG_INVAILD_POINTER;
+	return ReadStringUTF8(pBackend, hKey, lpName, REG_EXPAND_SZ, lpRes);
+}
+HRESULT REGKEY::ReadValueUTF8(std::string_view lpName, DWORD* pdwType, std::vector<BYTE>* lpRes) const {
+	REG_METRIC_SCOPE(REG_METRIC_READ, hRootKey);
+	DWORD dwSize = 0;
+	if (!Opened()) return REG_KEY_NOT_OPENED;
+	if (lpRes == nullptr) return REG_INVAILD_POINTER;
+	HRESULT hRes = QueryValueInto(pBackend, hKey, Widen(lpName, &GetUnicodeBuffers().cName), REG_ANY_TYPE, lpRes, pdwType, &dwSize);
+	if (hRes != REG_SUCCESS) return hRes;
+	lpRes->resize(dwSize);
+	return REG_SUCCESS;
+}
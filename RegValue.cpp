@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegValue.h"
+
+HRESULT REGVALUE::SetRaw(DWORD dwInType, const BYTE* lpData, DWORD dwSize) {
+	if (lpData == nullptr && dwSize != 0) return REG_INVAILD_POINTER;
+	switch (dwInType) {
+	case REG_SZ:
+	case REG_EXPAND_SZ: {
+		std::string cStr;
+		REGVALUETRAITS<std::string>::Decode(dwInType, lpData, dwSize, &cStr);
+		vData = std::move(cStr);
+		break;
+	}
+	case REG_DWORD: {
+		DWORD dwVal = 0;
+		if (dwSize != sizeof(DWORD)) return REG_INVAILD_VALUE;
+		memcpy(&dwVal, lpData, sizeof(DWORD));
+		vData = dwVal;
+		break;
+	}
+	case REG_QWORD: {
+		QWORD ullVal = 0;
+		if (dwSize != sizeof(QWORD)) return REG_INVAILD_VALUE;
+		memcpy(&ullVal, lpData, sizeof(QWORD));
+		vData = ullVal;
+		break;
+	}
+	case REG_MULTI_SZ: {
+		std::vector<std::string> vStrs;
+		REGVALUETRAITS<std::vector<std::string>>::Decode(dwInType, lpData, dwSize, &vStrs);
+		vData = std::move(vStrs);
+		break;
+	}
+	default:
+		if (dwInType == REG_NONE && dwSize == 0) {
+			vData = std::monostate();
+			break;
+		}
+		vData = std::vector<BYTE>(lpData, lpData + dwSize);
+		break;
+	}
+	dwType = dwInType;
+	return REG_SUCCESS;
+}
+
+void REGVALUE::Encode(std::vector<BYTE>* lpOut) const {
+	if (const std::string* pStr = std::get_if<std::string>(&vData)) REGVALUETRAITS<std::string>::Encode(*pStr, dwType, lpOut);
+	else if (const DWORD* pDword = std::get_if<DWORD>(&vData)) REGVALUETRAITS<DWORD>::Encode(*pDword, dwType, lpOut);
+	else if (const QWORD* pQword = std::get_if<QWORD>(&vData)) REGVALUETRAITS<QWORD>::Encode(*pQword, dwType, lpOut);
+	else if (const std::vector<std::string>* pMulti = std::get_if<std::vector<std::string>>(&vData)) REGVALUETRAITS<std::vector<std::string>>::Encode(*pMulti, dwType, lpOut);
+	else if (const std::vector<BYTE>* pBytes = std::get_if<std::vector<BYTE>>(&vData)) *lpOut = *pBytes;
+	else lpOut->clear();
+}
+
+HRESULT ReadRegValue(const REGKEY& rKey, LPCSTR lpName, REGVALUE* pOut) {
+	if (pOut == nullptr) return REG_INVAILD_POINTER;
+	// Type and data come from the same call
+	DWORD dwType = REG_NONE;
+	std::vector<BYTE> vData;
+	HRESULT hRes = rKey.ReadValue(lpName, &dwType, &vData);
+	if (hRes != REG_SUCCESS) return hRes;
+	return pOut->SetRaw(dwType, vData.data(), static_cast<DWORD>(vData.size()));
+}
+
+HRESULT WriteRegValue(const REGKEY& rKey, LPCSTR lpName, const REGVALUE& rValue) {
+	std::vector<BYTE> vData;
+	rValue.Encode(&vData);
+	return rKey.WriteValue(lpName, rValue.GetType(), vData.data(), static_cast<DWORD>(vData.size()));
+}
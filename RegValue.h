@@ -0,0 +1,278 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGVALUE_H
+#define REGVALUE_H
+
+#include "RegKey.h"
+#include "RegBatch.h"
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// Decoded value of any type
+// REG_SZ / REG_EXPAND_SZ hold a std::string (cut at the first terminator), REG_DWORD a DWORD, REG_QWORD a QWORD,
+// REG_MULTI_SZ a std::vector<std::string>, and every other type its raw bytes. An empty value has type REG_NONE.
+class REGVALUE {
+public:
+	typedef std::variant<std::monostate, std::string, DWORD, QWORD, std::vector<std::string>, std::vector<BYTE>> DATA;
+
+private:
+	DWORD dwType; // Registry type
+	DATA vData; // Decoded data
+
+public:
+	REGVALUE() : dwType(REG_NONE) {}
+
+	// Get the registry type
+	DWORD GetType() const { return dwType; }
+	// Get the decoded data
+	const DATA& GetData() const { return vData; }
+	// Get the data as T, or nullptr if the value does not hold a T
+	template <typename T> const T* GetIf() const { return std::get_if<T>(&vData); }
+
+	void SetSZ(std::string_view lpVal) { dwType = REG_SZ; vData = std::string(lpVal); }
+	void SetEXPANDSZ(std::string_view lpVal) { dwType = REG_EXPAND_SZ; vData = std::string(lpVal); }
+	void SetDWORD(DWORD dwVal) { dwType = REG_DWORD; vData = dwVal; }
+	void SetQWORD(QWORD ullVal) { dwType = REG_QWORD; vData = ullVal; }
+	void SetMULTISZ(std::vector<std::string> vVal) { dwType = REG_MULTI_SZ; vData = std::move(vVal); }
+	void SetBINARY(const BYTE* lpData, DWORD dwSize) { SetRaw(REG_BINARY, lpData, dwSize); }
+	// Set raw data of any type (REG_DWORD / REG_QWORD data must have the size of the integer)
+	HRESULT SetRaw(DWORD dwInType, const BYTE* lpData, DWORD dwSize);
+	// Clear to REG_NONE
+	void Clear() { dwType = REG_NONE; vData = std::monostate(); }
+
+	// Encode into the registry format
+	void Encode(std::vector<BYTE>* lpOut) const;
+
+	bool operator==(const REGVALUE& rOther) const { return dwType == rOther.dwType && vData == rOther.vData; }
+	bool operator!=(const REGVALUE& rOther) const { return !(*this == rOther); }
+};
+
+// Read a value of any type with one backend call
+HRESULT ReadRegValue(const REGKEY& rKey, LPCSTR lpName, REGVALUE* pOut);
+// Write a value of any type
+HRESULT WriteRegValue(const REGKEY& rKey, LPCSTR lpName, const REGVALUE& rValue);
+
+// Registry format of a C++ type, resolved at compile time
+// dwType is the type a field is bound to by default. Accepts tells whether a field of this type can be bound to
+// another registry type. Decode converts data that ReadValues already checked to be of type dwType.
+// Encode returns the type actually written.
+template <typename T, typename = void> struct REGVALUETRAITS;
+
+// Integers, enums and bool: REG_DWORD up to 32 bits, REG_QWORD for 64 bits
+template <typename T> struct REGVALUETRAITS<T, std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value>> {
+	static constexpr DWORD dwType = (sizeof(T) <= sizeof(DWORD) ? REG_DWORD : REG_QWORD);
+	static constexpr BOOL Accepts(DWORD dwInType) { return dwInType == dwType; }
+	static HRESULT Decode(DWORD dwInType, const BYTE* lpData, DWORD dwSize, T* pOut) {
+		if (dwType == REG_DWORD) {
+			DWORD dwVal = 0;
+			if (dwSize != sizeof(DWORD)) return REG_INVAILD_VALUE;
+			memcpy(&dwVal, lpData, sizeof(DWORD));
+			*pOut = static_cast<T>(dwVal);
+		}
+		else {
+			QWORD ullVal = 0;
+			if (dwSize != sizeof(QWORD)) return REG_INVAILD_VALUE;
+			memcpy(&ullVal, lpData, sizeof(QWORD));
+			*pOut = static_cast<T>(ullVal);
+		}
+		return REG_SUCCESS;
+	}
+	static DWORD Encode(const T& rIn, DWORD dwInType, std::vector<BYTE>* lpOut) {
+		if (dwType == REG_DWORD) {
+			DWORD dwVal = static_cast<DWORD>(rIn);
+			lpOut->assign(reinterpret_cast<const BYTE*>(&dwVal), reinterpret_cast<const BYTE*>(&dwVal) + sizeof(DWORD));
+		}
+		else {
+			QWORD ullVal = static_cast<QWORD>(rIn);
+			lpOut->assign(reinterpret_cast<const BYTE*>(&ullVal), reinterpret_cast<const BYTE*>(&ullVal) + sizeof(QWORD));
+		}
+		return dwType;
+	}
+};
+
+// Strings: REG_SZ, or REG_EXPAND_SZ when bound so (not expanded)
+template <> struct REGVALUETRAITS<std::string> {
+	static constexpr DWORD dwType = REG_SZ;
+	static constexpr BOOL Accepts(DWORD dwInType) { return dwInType == REG_SZ || dwInType == REG_EXPAND_SZ; }
+	static HRESULT Decode(DWORD dwInType, const BYTE* lpData, DWORD dwSize, std::string* pOut) {
+		const CHAR* lpStr = reinterpret_cast<const CHAR*>(lpData);
+		pOut->assign(lpStr, dwSize == 0 ? 0 : strnlen(lpStr, dwSize));
+		return REG_SUCCESS;
+	}
+	static DWORD Encode(const std::string& rIn, DWORD dwInType, std::vector<BYTE>* lpOut) {
+		lpOut->assign(rIn.c_str(), rIn.c_str() + rIn.size() + 1);
+		return dwInType;
+	}
+};
+
+// String lists: REG_MULTI_SZ (empty strings are skipped)
+template <> struct REGVALUETRAITS<std::vector<std::string>> {
+	static constexpr DWORD dwType = REG_MULTI_SZ;
+	static constexpr BOOL Accepts(DWORD dwInType) { return dwInType == REG_MULTI_SZ; }
+	static HRESULT Decode(DWORD dwInType, const BYTE* lpData, DWORD dwSize, std::vector<std::string>* pOut) {
+		REGMULTISZVIEW vMulti(reinterpret_cast<const CHAR*>(lpData), dwSize);
+		pOut->clear();
+		for (std::string_view vStr : vMulti) pOut->emplace_back(vStr);
+		return REG_SUCCESS;
+	}
+	static DWORD Encode(const std::vector<std::string>& rIn, DWORD dwInType, std::vector<BYTE>* lpOut) {
+		lpOut->resize(MultiSzSize(rIn));
+		MultiSzEncode(rIn, reinterpret_cast<CHAR*>(lpOut->data()));
+		return REG_MULTI_SZ;
+	}
+};
+
+// Raw bytes: REG_BINARY, or any other non-string type when bound so
+template <> struct REGVALUETRAITS<std::vector<BYTE>> {
+	static constexpr DWORD dwType = REG_BINARY;
+	static constexpr BOOL Accepts(DWORD dwInType) {
+		return dwInType != REG_ANY_TYPE && dwInType != REG_SZ && dwInType != REG_EXPAND_SZ && dwInType != REG_MULTI_SZ;
+	}
+	static HRESULT Decode(DWORD dwInType, const BYTE* lpData, DWORD dwSize, std::vector<BYTE>* pOut) {
+		pOut->assign(lpData, lpData + dwSize);
+		return REG_SUCCESS;
+	}
+	static DWORD Encode(const std::vector<BYTE>& rIn, DWORD dwInType, std::vector<BYTE>* lpOut) {
+		*lpOut = rIn;
+		return dwInType;
+	}
+};
+
+// REGVALUE: any type, the type read is kept
+template <> struct REGVALUETRAITS<REGVALUE> {
+	static constexpr DWORD dwType = REG_ANY_TYPE;
+	static constexpr BOOL Accepts(DWORD dwInType) { return dwInType == REG_ANY_TYPE; }
+	static HRESULT Decode(DWORD dwInType, const BYTE* lpData, DWORD dwSize, REGVALUE* pOut) {
+		return pOut->SetRaw(dwInType, lpData, dwSize);
+	}
+	static DWORD Encode(const REGVALUE& rIn, DWORD dwInType, std::vector<BYTE>* lpOut) {
+		rIn.Encode(lpOut);
+		return rIn.GetType();
+	}
+};
+
+// Binding of one struct field to a value name
+template <typename S, typename T> struct REGFIELD {
+	typedef S STRUCT;
+	typedef T TYPE;
+	LPCSTR lpName; // Value name
+	T S::* pMember; // Field
+	DWORD dwType; // Registry type
+};
+
+// Bind a field to a value name with the default registry type of the field, or with dwType
+template <typename S, typename T> constexpr REGFIELD<S, T> RegField(LPCSTR lpName, T S::* pMember, DWORD dwType = REGVALUETRAITS<T>::dwType) {
+	return REGFIELD<S, T>{ lpName, pMember, dwType };
+}
+
+// Schema of a struct, declared by specializing REGSCHEMA with a constexpr tuple of fields:
+//   template <> struct REGSCHEMA<CONFIG> {
+//       static constexpr auto rFields = std::make_tuple(
+//           RegField("Name", &CONFIG::cName),
+//           RegField("Path", &CONFIG::cPath, REG_EXPAND_SZ),
+//           RegField("Port", &CONFIG::dwPort));
+//   };
+template <typename S> struct REGSCHEMA;
+
+// Load / store of a struct through its schema. The field list is expanded at compile time, so no per-field
+// type lookup happens at run time.
+template <typename S, typename I = std::make_index_sequence<std::tuple_size<std::decay_t<decltype(REGSCHEMA<S>::rFields)>>::value>>
+class REGSCHEMABINDER;
+
+template <typename S, size_t... I> class REGSCHEMABINDER<S, std::index_sequence<I...>> {
+private:
+	static constexpr size_t ulCount = sizeof...(I);
+
+	template <size_t J> static constexpr const auto& Field() { return std::get<J>(REGSCHEMA<S>::rFields); }
+	template <size_t J> using FIELDTYPE = typename std::decay_t<decltype(std::get<J>(REGSCHEMA<S>::rFields))>::TYPE;
+
+	template <size_t J> static void DecodeField(const REGBATCHVALUE& rValue, S* pOut, HRESULT* pFirst, HRESULT* pResults) {
+		HRESULT hRes = rValue.hRes;
+		if (hRes == REG_SUCCESS) hRes = REGVALUETRAITS<FIELDTYPE<J>>::Decode(rValue.dwType, rValue.lpData, rValue.dwSize, &(pOut->*Field<J>().pMember));
+		if (pResults != nullptr) pResults[J] = hRes;
+		// A missing value keeps the default of the field
+		if (hRes != REG_SUCCESS && hRes != REG_VALUE_NOT_EXIST && *pFirst == REG_SUCCESS) *pFirst = hRes;
+	}
+
+	template <size_t J> static HRESULT EncodeField(REGWRITEBATCH* pBatch, HKEY hRoot, LPCSTR lpPath, const S& rIn, std::vector<BYTE>* pData) {
+		DWORD dwType = REGVALUETRAITS<FIELDTYPE<J>>::Encode(rIn.*Field<J>().pMember, Field<J>().dwType, pData);
+		// An empty REGVALUE field is not written
+		if (dwType == REG_NONE && pData->empty()) return REG_SUCCESS;
+		return pBatch->Put(hRoot, lpPath, Field<J>().lpName, dwType, pData->data(), static_cast<DWORD>(pData->size()));
+	}
+
+public:
+	static_assert(ulCount != 0, "REGSCHEMA has no fields");
+	static_assert((... && std::is_same<typename std::decay_t<decltype(std::get<I>(REGSCHEMA<S>::rFields))>::STRUCT, S>::value),
+		"REGSCHEMA field of another struct");
+	static_assert((... && REGVALUETRAITS<FIELDTYPE<I>>::Accepts(Field<I>().dwType)), "REGSCHEMA field bound to an unsupported registry type");
+
+	static HRESULT Load(const REGKEY& rKey, S* pOut, std::vector<BYTE>* pBuffer, HRESULT* pResults) {
+		REGBATCHVALUE vValues[ulCount] = { { Field<I>().lpName, Field<I>().dwType, REG_SUCCESS, REG_NONE, nullptr, 0 }... };
+		HRESULT hRes = rKey.ReadValues(vValues, static_cast<DWORD>(ulCount), pBuffer);
+		if (hRes != REG_SUCCESS) return hRes;
+		HRESULT hFirst = REG_SUCCESS;
+		(DecodeField<I>(vValues[I], pOut, &hFirst, pResults), ...);
+		return hFirst;
+	}
+
+	static HRESULT Store(REGWRITEBATCH* pBatch, HKEY hRoot, LPCSTR lpPath, const S& rIn) {
+		std::vector<BYTE> vData;
+		HRESULT hRes = REG_SUCCESS;
+		// Stop at the first failure
+		(void)(... && ((hRes = EncodeField<I>(pBatch, hRoot, lpPath, rIn, &vData)) == REG_SUCCESS));
+		return hRes;
+	}
+};
+
+// Load every field of *pOut from the key with one batched read (REGKEY::ReadValues).
+// Fields of missing values keep their current contents. Return the first other failure (a value of another type
+// gives REG_INCORRECT_TYPE), after all fields that could be read were set. pResults, if given, receives the result
+// of every field in schema order. pBuffer is reused across calls.
+template <typename S> HRESULT LoadRegStruct(const REGKEY& rKey, S* pOut, std::vector<BYTE>* pBuffer, HRESULT* pResults = nullptr) {
+	if (pOut == nullptr || pBuffer == nullptr) return REG_INVAILD_POINTER;
+	if (!rKey.Opened()) return REG_KEY_NOT_OPENED;
+	return REGSCHEMABINDER<S>::Load(rKey, pOut, pBuffer, pResults);
+}
+template <typename S> HRESULT LoadRegStruct(const REGKEY& rKey, S* pOut) {
+	std::vector<BYTE> vBuffer;
+	return LoadRegStruct(rKey, pOut, &vBuffer);
+}
+
+// Record every field of rIn as a write of the key (hRoot, lpPath) in a batch
+template <typename S> HRESULT StoreRegStruct(REGWRITEBATCH* pBatch, HKEY hRoot, LPCSTR lpPath, const S& rIn) {
+	if (pBatch == nullptr || lpPath == nullptr) return REG_INVAILD_POINTER;
+	return REGSCHEMABINDER<S>::Store(pBatch, hRoot, lpPath, rIn);
+}
+// Write every field of rIn to the key (hRoot, lpPath) in one batch, opening the key once
+// (nullptr means the default backend). The key is created if it does not exist.
+template <typename S> HRESULT StoreRegStruct(HKEY hRoot, LPCSTR lpPath, const S& rIn, REGBACKEND* pBackend = nullptr) {
+	REGWRITEBATCH rBatch;
+	HRESULT hRes = StoreRegStruct(&rBatch, hRoot, lpPath, rIn);
+	if (hRes != REG_SUCCESS) return hRes;
+	return rBatch.Apply(pBackend, FALSE);
+}
+
+#endif
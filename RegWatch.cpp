@@ -0,0 +1,520 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegWatch.h"
+#include "RegSearch.h"
+
+// Handles of one WaitForMultipleObjects call: the wake event and the watched keys
+#define REG_WAIT_KEYS (MAXIMUM_WAIT_OBJECTS - 1)
+// Pause of a wait thread whose wait failed without a watch to blame
+#define REG_WAIT_FAILED_DELAY std::chrono::milliseconds(100)
+// Shortest delay before a watch whose capture failed is captured again
+#define REG_WATCH_RETRY_DELAY std::chrono::milliseconds(100)
+
+static std::string Fold(const std::string& cStr) {
+	std::string cRes(cStr);
+	for (CHAR& c : cRes) {
+		if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+	}
+	return cRes;
+}
+
+static HRESULT OpenResult(LSTATUS lRes) {
+	if (lRes == ERROR_FILE_NOT_FOUND) return REG_PATH_NOT_EXIST;
+	if (lRes == ERROR_ACCESS_DENIED) return REG_ACCESS_DENIED;
+	return REG_UNKNOWN_ERROR;
+}
+
+
+struct REGWAITNOTIFYSOURCE::WATCH {
+	HKEY hRoot;
+	std::string cPath;
+	BOOL bSubtree;
+	REGNOTIFYSINK* pSink;
+	HKEY hKey; // Key opened with KEY_NOTIFY
+	HANDLE hEvent; // Auto reset event signaled by the registry
+	std::atomic<bool> bArmed; // FALSE after the notification could not be armed again (the key was deleted)
+};
+
+struct REGWAITNOTIFYSOURCE::GROUP {
+	std::thread tLoop; // Wait thread
+	HANDLE hWake; // Signaled when vWatches changes or the thread has to stop
+	std::vector<WATCH*> vWatches; // At most REG_WAIT_KEYS
+	std::vector<WATCH*> vRetired; // Removed watches, freed by the wait thread
+	ULONGLONG ullGen; // Incremented by every change of vWatches
+	ULONGLONG ullSeen; // ullGen when the wait thread last took vWatches
+	std::condition_variable cvSeen;
+	BOOL bStop;
+};
+
+static LSTATUS ArmWatch(HKEY hKey, BOOL bSubtree, HANDLE hEvent) {
+	// A subtree watch also reports sub keys being added or removed
+	DWORD dwFilter = REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC;
+	if (bSubtree) dwFilter |= REG_NOTIFY_CHANGE_NAME;
+	return RegNotifyChangeKeyValue(hKey, bSubtree, dwFilter, hEvent, TRUE);
+}
+
+REGWAITNOTIFYSOURCE::REGWAITNOTIFYSOURCE() {
+	return;
+}
+REGWAITNOTIFYSOURCE::~REGWAITNOTIFYSOURCE() {
+	std::vector<GROUP*> vOld;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		vOld.swap(vGroups);
+		for (GROUP* pGroup : vOld) {
+			pGroup->bStop = TRUE;
+			SetEvent(pGroup->hWake);
+		}
+	}
+	for (GROUP* pGroup : vOld) {
+		pGroup->tLoop.join();
+		for (WATCH* pWatch : pGroup->vWatches) FreeWatch(pWatch);
+		for (WATCH* pWatch : pGroup->vRetired) FreeWatch(pWatch);
+		CloseHandle(pGroup->hWake);
+		delete pGroup;
+	}
+}
+
+void REGWAITNOTIFYSOURCE::Loop(GROUP* pGroup) {
+	std::vector<WATCH*> vCurrent;
+	std::vector<HANDLE> vHandles;
+	while (1) {
+		{
+			std::lock_guard<std::mutex> lGuard(mLock);
+			// Nothing waits for the retired watches any more
+			for (WATCH* pWatch : pGroup->vRetired) FreeWatch(pWatch);
+			pGroup->vRetired.clear();
+			if (pGroup->bStop) break;
+			vCurrent = pGroup->vWatches;
+			pGroup->ullSeen = pGroup->ullGen;
+		}
+		pGroup->cvSeen.notify_all();
+		vHandles.assign(1, pGroup->hWake);
+		for (WATCH* pWatch : vCurrent) vHandles.push_back(pWatch->hEvent);
+
+		DWORD dwRes = WaitForMultipleObjects(static_cast<DWORD>(vHandles.size()), vHandles.data(), FALSE, INFINITE);
+		if (dwRes == WAIT_FAILED) {
+			DropFailed(pGroup, vCurrent);
+			continue;
+		}
+		if (dwRes <= WAIT_OBJECT_0 || dwRes >= WAIT_OBJECT_0 + vHandles.size()) continue;
+		WATCH* pWatch = vCurrent[dwRes - WAIT_OBJECT_0 - 1];
+		{
+			// Skip a watch removed since the handles were taken (it is freed on the next round)
+			std::lock_guard<std::mutex> lGuard(mLock);
+			BOOL bFound = FALSE;
+			for (WATCH* p : pGroup->vWatches) bFound |= (p == pWatch);
+			if (!bFound) continue;
+		}
+		// Arm again first, so that changes made while the sink runs are reported
+		if (ArmWatch(pWatch->hKey, pWatch->bSubtree, pWatch->hEvent) != ERROR_SUCCESS) pWatch->bArmed.store(false);
+		pWatch->pSink->OnKeyChanged(pWatch->hRoot, pWatch->cPath.c_str());
+	}
+}
+
+// The wait failed on an invalid handle: retire the watches whose event cannot be waited for and tell their sinks,
+// which watch the key again with a new event. Without such a watch the thread backs off instead of spinning.
+void REGWAITNOTIFYSOURCE::DropFailed(GROUP* pGroup, const std::vector<WATCH*>& vCurrent) {
+	std::vector<WATCH*> vBad;
+	for (WATCH* pWatch : vCurrent) {
+		if (WaitForSingleObject(pWatch->hEvent, 0) == WAIT_FAILED) vBad.push_back(pWatch);
+	}
+	std::vector<std::pair<REGNOTIFYSINK*, WATCH*>> vNotify;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		std::vector<WATCH*>& vList = pGroup->vWatches;
+		for (WATCH* pWatch : vBad) {
+			for (size_t i = 0; i < vList.size(); i++) {
+				if (vList[i] != pWatch) continue;
+				vList.erase(vList.begin() + i);
+				pGroup->vRetired.push_back(pWatch);
+				pGroup->ullGen++;
+				vNotify.emplace_back(pWatch->pSink, pWatch);
+				break;
+			}
+		}
+	}
+	// Retired watches are only freed by this thread, on its next round
+	for (const auto& itNotify : vNotify) itNotify.first->OnKeyChanged(itNotify.second->hRoot, itNotify.second->cPath.c_str());
+	if (vNotify.empty()) std::this_thread::sleep_for(REG_WAIT_FAILED_DELAY);
+}
+
+void REGWAITNOTIFYSOURCE::FreeWatch(WATCH* pWatch) {
+	RegCloseKey(pWatch->hKey);
+	CloseHandle(pWatch->hEvent);
+	delete pWatch;
+}
+
+HRESULT REGWAITNOTIFYSOURCE::Watch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) {
+	if (pSink == nullptr || lpPath == nullptr) return REG_INVAILD_POINTER;
+	std::lock_guard<std::mutex> lGuard(mLock);
+	for (GROUP* pGroup : vGroups) {
+		for (WATCH* p : pGroup->vWatches) {
+			if (p->pSink != pSink || p->hRoot != hRoot || p->bSubtree != bSubtree || !EqualsNoCase(p->cPath, lpPath)) continue;
+			if (p->bArmed.load()) return REG_SUCCESS;
+			// The key was deleted, watch the key that has the path now
+			HKEY hKey = NULL;
+			LSTATUS lRes = RegOpenKeyExA(hRoot, lpPath, 0, KEY_NOTIFY, &hKey);
+			if (lRes == ERROR_SUCCESS) lRes = ArmWatch(hKey, bSubtree, p->hEvent);
+			if (lRes != ERROR_SUCCESS) {
+				if (hKey != NULL) RegCloseKey(hKey);
+				return OpenResult(lRes);
+			}
+			RegCloseKey(p->hKey);
+			p->hKey = hKey;
+			p->bArmed.store(true);
+			return REG_SUCCESS;
+		}
+	}
+
+	HKEY hKey = NULL;
+	LSTATUS lRes = RegOpenKeyExA(hRoot, lpPath, 0, KEY_NOTIFY, &hKey);
+	if (lRes != ERROR_SUCCESS) return OpenResult(lRes);
+	HANDLE hEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+	if (hEvent == NULL || ArmWatch(hKey, bSubtree, hEvent) != ERROR_SUCCESS) {
+		if (hEvent != NULL) CloseHandle(hEvent);
+		RegCloseKey(hKey);
+		return REG_UNKNOWN_ERROR;
+	}
+	WATCH* pWatch = new WATCH;
+	pWatch->hRoot = hRoot;
+	pWatch->cPath = lpPath;
+	pWatch->bSubtree = bSubtree;
+	pWatch->pSink = pSink;
+	pWatch->hKey = hKey;
+	pWatch->hEvent = hEvent;
+	pWatch->bArmed.store(true);
+
+	// First group with room, or a new wait thread
+	GROUP* pGroup = nullptr;
+	for (GROUP* p : vGroups) {
+		if (p->vWatches.size() < REG_WAIT_KEYS) {
+			pGroup = p;
+			break;
+		}
+	}
+	if (pGroup == nullptr) {
+		HANDLE hWake = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+		if (hWake == NULL) {
+			FreeWatch(pWatch);
+			return REG_UNKNOWN_ERROR;
+		}
+		pGroup = new GROUP;
+		pGroup->hWake = hWake;
+		pGroup->ullGen = 0;
+		pGroup->ullSeen = 0;
+		pGroup->bStop = FALSE;
+		pGroup->tLoop = std::thread(&REGWAITNOTIFYSOURCE::Loop, this, pGroup);
+		vGroups.push_back(pGroup);
+	}
+	pGroup->vWatches.push_back(pWatch);
+	pGroup->ullGen++;
+	SetEvent(pGroup->hWake);
+	return REG_SUCCESS;
+}
+
+// Retire removed watches and wait until their wait threads no longer use them
+void REGWAITNOTIFYSOURCE::Remove(const std::vector<std::pair<GROUP*, WATCH*>>& vOld, std::unique_lock<std::mutex>* pLock) {
+	std::vector<std::pair<GROUP*, ULONGLONG>> vWait;
+	for (const auto& itOld : vOld) {
+		GROUP* pGroup = itOld.first;
+		pGroup->vRetired.push_back(itOld.second);
+		pGroup->ullGen++;
+		SetEvent(pGroup->hWake);
+		// A sink removing watches from its own wait thread cannot wait for it
+		if (pGroup->tLoop.get_id() != std::this_thread::get_id()) vWait.emplace_back(pGroup, pGroup->ullGen);
+	}
+	for (const auto& itWait : vWait) {
+		GROUP* pGroup = itWait.first;
+		pGroup->cvSeen.wait(*pLock, [&]() { return pGroup->ullSeen >= itWait.second; });
+	}
+}
+
+void REGWAITNOTIFYSOURCE::Unwatch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) {
+	if (lpPath == nullptr) return;
+	std::unique_lock<std::mutex> lGuard(mLock);
+	std::vector<std::pair<GROUP*, WATCH*>> vOld;
+	for (GROUP* pGroup : vGroups) {
+		std::vector<WATCH*>& vList = pGroup->vWatches;
+		for (size_t i = 0; i < vList.size() && vOld.empty(); i++) {
+			WATCH* p = vList[i];
+			if (p->pSink == pSink && p->hRoot == hRoot && p->bSubtree == bSubtree && EqualsNoCase(p->cPath, lpPath)) {
+				vOld.emplace_back(pGroup, p);
+				vList.erase(vList.begin() + i);
+			}
+		}
+	}
+	Remove(vOld, &lGuard);
+}
+
+void REGWAITNOTIFYSOURCE::Unwatch(REGNOTIFYSINK* pSink) {
+	std::unique_lock<std::mutex> lGuard(mLock);
+	std::vector<std::pair<GROUP*, WATCH*>> vOld;
+	for (GROUP* pGroup : vGroups) {
+		std::vector<WATCH*>& vList = pGroup->vWatches;
+		for (size_t i = 0; i < vList.size();) {
+			if (vList[i]->pSink == pSink) {
+				vOld.emplace_back(pGroup, vList[i]);
+				vList.erase(vList.begin() + i);
+			}
+			else i++;
+		}
+	}
+	Remove(vOld, &lGuard);
+}
+
+size_t REGWAITNOTIFYSOURCE::GetThreadCount() {
+	std::lock_guard<std::mutex> lGuard(mLock);
+	return vGroups.size();
+}
+
+
+REGWATCHER::REGWATCHER(REGBACKEND* pBackend, REGNOTIFYSOURCE* pSource, DWORD dwDelayMs, BOOL bThread) :
+	pBackend(pBackend == nullptr ? GetDefaultRegBackend() : pBackend),
+	pOwnSource(pSource == nullptr ? new REGWAITNOTIFYSOURCE : nullptr),
+	pSource(pSource == nullptr ? pOwnSource.get() : pSource),
+	tDelay(dwDelayMs), dwNextId(0), bStop(FALSE),
+	ullNotifications(0), ullCoalesced(0), ullScans(0), ullDeliveries(0) {
+	if (bThread) tDispatch = std::thread(&REGWATCHER::DispatchLoop, this);
+}
+REGWATCHER::~REGWATCHER() {
+	// No notification arrives after this
+	pSource->Unwatch(this);
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		bStop = TRUE;
+	}
+	cvWake.notify_all();
+	if (tDispatch.joinable()) tDispatch.join();
+}
+
+// Read the values of a watch. A key that does not exist (any more) has no values.
+HRESULT REGWATCHER::Capture(const WATCH& rWatch, SNAPSHOT* pOut) const {
+	pOut->clear();
+	REGKEY rKey(pBackend);
+	HRESULT hRes = rKey.Open(rWatch.hRoot, rWatch.cPath.c_str(), KEY_READ);
+	if (hRes == REG_PATH_NOT_EXIST) return REG_SUCCESS;
+	if (hRes != REG_SUCCESS) return hRes;
+	size_t ulBase = rWatch.cPath.size();
+	std::string cParent;
+	auto fVisit = [&](const REGKEY& rParent, const REGVALUEINFO& rValue) {
+		rParent.GetPath(&cParent);
+		std::string cRel = cParent.substr(ulBase < cParent.size() ? ulBase : cParent.size());
+		if (!cRel.empty() && cRel[0] == '\\') cRel.erase(0, 1);
+		std::string cKey = Fold(cRel);
+		cKey.push_back('\0');
+		cKey += Fold(rValue.lpName);
+		VALUE& rOut = (*pOut)[cKey];
+		rOut.cPath = std::move(cRel);
+		rOut.cName = rValue.lpName;
+		rOut.dwType = rValue.dwType;
+		rOut.lpData.assign(rValue.lpData, rValue.lpData + rValue.dwSize);
+	};
+	if (rWatch.bSubtree) return rKey.VisitAllValue(fVisit, TRUE);
+	return rKey.VisitValue(fVisit, TRUE);
+}
+
+// Merge the two sorted snapshots
+void REGWATCHER::Diff(const SNAPSHOT& mOld, const SNAPSHOT& mNew, std::vector<REGVALUECHANGE>* pvOut) {
+	auto itOld = mOld.begin();
+	auto itNew = mNew.begin();
+	while (itOld != mOld.end() || itNew != mNew.end()) {
+		if (itNew == mNew.end() || (itOld != mOld.end() && itOld->first < itNew->first)) {
+			pvOut->push_back({ REG_CHANGE_REMOVED, itOld->second.cPath, itOld->second.cName, itOld->second.dwType });
+			++itOld;
+		}
+		else if (itOld == mOld.end() || itNew->first < itOld->first) {
+			pvOut->push_back({ REG_CHANGE_ADDED, itNew->second.cPath, itNew->second.cName, itNew->second.dwType });
+			++itNew;
+		}
+		else {
+			if (itOld->second.dwType != itNew->second.dwType || itOld->second.lpData != itNew->second.lpData) {
+				pvOut->push_back({ REG_CHANGE_CHANGED, itNew->second.cPath, itNew->second.cName, itNew->second.dwType });
+			}
+			++itOld;
+			++itNew;
+		}
+	}
+}
+
+HRESULT REGWATCHER::Subscribe(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGWATCHSUBSCRIBER* pSubscriber, DWORD* pdwId) {
+	if (lpPath == nullptr || pSubscriber == nullptr || pdwId == nullptr) return REG_INVAILD_POINTER;
+	std::shared_ptr<WATCH> pWatch = std::make_shared<WATCH>();
+	pWatch->hRoot = hRoot;
+	pWatch->cPath = lpPath;
+	pWatch->bSubtree = bSubtree;
+	pWatch->pSubscriber = pSubscriber;
+	pWatch->bActive = TRUE;
+	pWatch->bDirty = FALSE;
+
+	// The first snapshot is taken after the watch is armed, so no change in between is lost. Holding mDeliver
+	// keeps pending notifications from being processed against a missing snapshot.
+	std::lock_guard<std::mutex> lDeliver(mDeliver);
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		pWatch->dwId = ++dwNextId;
+		vWatches.push_back(pWatch);
+	}
+	HRESULT hRes = pSource->Watch(hRoot, lpPath, bSubtree, this);
+	if (hRes == REG_SUCCESS) hRes = Capture(*pWatch, &pWatch->mSnapshot);
+	if (hRes != REG_SUCCESS) {
+		BOOL bShared = FALSE;
+		{
+			std::lock_guard<std::mutex> lGuard(mLock);
+			for (size_t i = 0; i < vWatches.size(); i++) {
+				if (vWatches[i] == pWatch) {
+					vWatches.erase(vWatches.begin() + i);
+					break;
+				}
+			}
+			for (const auto& p : vWatches) {
+				bShared |= (p->hRoot == hRoot && p->bSubtree == bSubtree && EqualsNoCase(p->cPath, lpPath));
+			}
+		}
+		if (!bShared) pSource->Unwatch(hRoot, lpPath, bSubtree, this);
+		return hRes;
+	}
+	*pdwId = pWatch->dwId;
+	return REG_SUCCESS;
+}
+
+void REGWATCHER::Unsubscribe(DWORD dwId) {
+	std::shared_ptr<WATCH> pWatch;
+	BOOL bShared = FALSE;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		for (size_t i = 0; i < vWatches.size(); i++) {
+			if (vWatches[i]->dwId == dwId) {
+				pWatch = vWatches[i];
+				vWatches.erase(vWatches.begin() + i);
+				break;
+			}
+		}
+		if (pWatch == nullptr) return;
+		pWatch->bActive = FALSE;
+		// The source watch is shared by the subscriptions of the same key
+		for (const auto& p : vWatches) {
+			bShared |= (p->hRoot == pWatch->hRoot && p->bSubtree == pWatch->bSubtree && EqualsNoCase(p->cPath, pWatch->cPath));
+		}
+	}
+	// Wait for a running delivery, which could arm the source watch again
+	std::lock_guard<std::mutex> lDeliver(mDeliver);
+	if (!bShared) pSource->Unwatch(pWatch->hRoot, pWatch->cPath.c_str(), pWatch->bSubtree, this);
+}
+
+size_t REGWATCHER::ProcessPending(BOOL bAll) {
+	std::lock_guard<std::mutex> lDeliver(mDeliver);
+	std::vector<std::shared_ptr<WATCH>> vDue;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		CLOCK::time_point tNow = CLOCK::now();
+		for (const auto& p : vWatches) {
+			if (!p->bDirty || (!bAll && p->tDue > tNow)) continue;
+			p->bDirty = FALSE;
+			vDue.push_back(p);
+		}
+	}
+	size_t ulDelivered = 0;
+	SNAPSHOT mNew;
+	std::vector<REGVALUECHANGE> vChanges;
+	for (const auto& p : vDue) {
+		// Arm the source watch again if it was lost (the key was deleted); while the key cannot be watched or read,
+		// the notification is kept pending and retried
+		BOOL bRetry = (pSource->Watch(p->hRoot, p->cPath.c_str(), p->bSubtree, this) != REG_SUCCESS);
+		vChanges.clear();
+		if (Capture(*p, &mNew) != REG_SUCCESS) bRetry = TRUE;
+		else {
+			ullScans.fetch_add(1, std::memory_order_relaxed);
+			Diff(p->mSnapshot, mNew, &vChanges);
+			p->mSnapshot.swap(mNew);
+		}
+		BOOL bActive = FALSE;
+		{
+			std::lock_guard<std::mutex> lGuard(mLock);
+			bActive = p->bActive;
+			if (bRetry && bActive && !p->bDirty) {
+				p->bDirty = TRUE;
+				p->tDue = CLOCK::now() + (tDelay > REG_WATCH_RETRY_DELAY ? tDelay : REG_WATCH_RETRY_DELAY);
+				cvWake.notify_one();
+			}
+		}
+		if (vChanges.empty() || !bActive) continue;
+		p->pSubscriber->OnValuesChanged(p->hRoot, p->cPath.c_str(), vChanges);
+		ullDeliveries.fetch_add(1, std::memory_order_relaxed);
+		ulDelivered++;
+	}
+	return ulDelivered;
+}
+
+void REGWATCHER::DispatchLoop() {
+	std::unique_lock<std::mutex> lGuard(mLock);
+	while (!bStop) {
+		// Earliest pending notification
+		BOOL bPending = FALSE;
+		CLOCK::time_point tNext;
+		for (const auto& p : vWatches) {
+			if (!p->bDirty) continue;
+			if (!bPending || p->tDue < tNext) tNext = p->tDue;
+			bPending = TRUE;
+		}
+		if (!bPending) {
+			cvWake.wait(lGuard);
+			continue;
+		}
+		if (tNext > CLOCK::now()) {
+			cvWake.wait_until(lGuard, tNext);
+			continue;
+		}
+		lGuard.unlock();
+		ProcessPending(FALSE);
+		lGuard.lock();
+	}
+}
+
+REGWATCHSTATS REGWATCHER::GetStats() const {
+	REGWATCHSTATS sRes;
+	sRes.ullNotifications = ullNotifications.load();
+	sRes.ullCoalesced = ullCoalesced.load();
+	sRes.ullScans = ullScans.load();
+	sRes.ullDeliveries = ullDeliveries.load();
+	return sRes;
+}
+
+void REGWATCHER::OnKeyChanged(HKEY hRoot, LPCSTR lpPath) {
+	BOOL bWake = FALSE;
+	{
+		std::lock_guard<std::mutex> lGuard(mLock);
+		ullNotifications.fetch_add(1, std::memory_order_relaxed);
+		for (const auto& p : vWatches) {
+			if (p->hRoot != hRoot || !EqualsNoCase(p->cPath, lpPath)) continue;
+			if (p->bDirty) {
+				ullCoalesced.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+			p->bDirty = TRUE;
+			p->tDue = CLOCK::now() + tDelay;
+			bWake = TRUE;
+		}
+	}
+	if (bWake) cvWake.notify_one();
+}
@@ -0,0 +1,166 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGWATCH_H
+#define REGWATCH_H
+
+#include "RegCache.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <thread>
+
+// Windows registry notification source on dedicated wait threads
+// Every thread waits for up to 63 watched keys with one WaitForMultipleObjects loop (the 64th handle wakes it
+// when its watches change), so a few threads serve any number of keys. Sinks are called by the wait threads.
+class REGWAITNOTIFYSOURCE : public REGNOTIFYSOURCE {
+private:
+	struct WATCH;
+	struct GROUP;
+
+	std::vector<GROUP*> vGroups;
+	std::mutex mLock;
+
+	void Loop(GROUP* pGroup);
+	void DropFailed(GROUP* pGroup, const std::vector<WATCH*>& vCurrent);
+	static void FreeWatch(WATCH* pWatch);
+	void Remove(const std::vector<std::pair<GROUP*, WATCH*>>& vOld, std::unique_lock<std::mutex>* pLock);
+
+public:
+	REGWAITNOTIFYSOURCE();
+	REGWAITNOTIFYSOURCE(const REGWAITNOTIFYSOURCE&) = delete;
+	REGWAITNOTIFYSOURCE& operator=(const REGWAITNOTIFYSOURCE&) = delete;
+	~REGWAITNOTIFYSOURCE();
+
+	HRESULT Watch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) override;
+	void Unwatch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) override;
+	void Unwatch(REGNOTIFYSINK* pSink) override;
+
+	// Number of wait threads
+	size_t GetThreadCount();
+};
+
+// Kind of a value change
+enum REGCHANGETYPE {
+	REG_CHANGE_ADDED,
+	REG_CHANGE_CHANGED, // Type or data changed
+	REG_CHANGE_REMOVED
+};
+
+// Value change reported by REGWATCHER
+struct REGVALUECHANGE {
+	REGCHANGETYPE eType;
+	std::string cPath; // Path of the key of the value, relative to the watched key ("" for the watched key itself)
+	std::string cName; // Value name
+	DWORD dwType; // Type of the new value (of the old value if it was removed)
+};
+
+// Receiver of value changes
+class REGWATCHSUBSCRIBER {
+public:
+	virtual ~REGWATCHSUBSCRIBER() {}
+
+	// Values of the watched key (hRoot, lpPath) changed. vChanges is never empty.
+	virtual void OnValuesChanged(HKEY hRoot, LPCSTR lpPath, const std::vector<REGVALUECHANGE>& vChanges) = 0;
+};
+
+// Watcher statistics
+struct REGWATCHSTATS {
+	ULONGLONG ullNotifications; // Notifications received
+	ULONGLONG ullCoalesced; // Notifications merged into a pending one
+	ULONGLONG ullScans; // Snapshots taken to compute a diff
+	ULONGLONG ullDeliveries; // Non-empty diffs delivered
+};
+
+// Change watcher
+// Keys and subtrees are watched through a notification source. The first notification of a watch starts a delay,
+// and every notification within the delay is merged into it. When the delay ends the values of the watch are read
+// again and compared with the previous snapshot, and the differences are delivered to the subscriber.
+// Names are case-insensitive. Subscribers are called one at a time and must not call Unsubscribe.
+class REGWATCHER : public REGNOTIFYSINK {
+private:
+	typedef std::chrono::steady_clock CLOCK;
+
+	struct VALUE {
+		std::string cPath; // Relative path of the key
+		std::string cName; // Value name
+		DWORD dwType;
+		std::vector<BYTE> lpData;
+	};
+	typedef std::map<std::string, VALUE> SNAPSHOT; // Folded "path \0 name" -> value
+
+	struct WATCH {
+		DWORD dwId; // Subscription id
+		HKEY hRoot;
+		std::string cPath;
+		BOOL bSubtree;
+		REGWATCHSUBSCRIBER* pSubscriber;
+		SNAPSHOT mSnapshot; // Values at the last scan (only used with mDeliver held)
+		BOOL bActive; // FALSE after Unsubscribe
+		BOOL bDirty; // A notification is pending
+		CLOCK::time_point tDue; // When the pending notification is processed
+	};
+
+	REGBACKEND* pBackend; // Backend used for the snapshots
+	std::unique_ptr<REGNOTIFYSOURCE> pOwnSource; // Source created by the watcher
+	REGNOTIFYSOURCE* pSource; // Notification source
+	std::chrono::milliseconds tDelay; // Coalescing delay
+	std::vector<std::shared_ptr<WATCH>> vWatches;
+	DWORD dwNextId;
+	std::mutex mLock;
+	std::mutex mDeliver; // Held while snapshots are taken and subscribers are called
+	std::condition_variable cvWake;
+	std::thread tDispatch;
+	BOOL bStop;
+	std::atomic<ULONGLONG> ullNotifications;
+	std::atomic<ULONGLONG> ullCoalesced;
+	std::atomic<ULONGLONG> ullScans;
+	std::atomic<ULONGLONG> ullDeliveries;
+
+	HRESULT Capture(const WATCH& rWatch, SNAPSHOT* pOut) const;
+	static void Diff(const SNAPSHOT& mOld, const SNAPSHOT& mNew, std::vector<REGVALUECHANGE>* pvOut);
+	void DispatchLoop();
+
+public:
+	// pBackend (nullptr: the default backend) is used for the snapshots, pSource (nullptr: a REGWAITNOTIFYSOURCE of
+	// the watcher) for the notifications; both must outlive the watcher. dwDelayMs is the coalescing delay.
+	// If bThread is FALSE no dispatch thread is started and changes are only delivered by ProcessPending.
+	explicit REGWATCHER(REGBACKEND* pBackend = nullptr, REGNOTIFYSOURCE* pSource = nullptr, DWORD dwDelayMs = 50, BOOL bThread = TRUE);
+	REGWATCHER(const REGWATCHER&) = delete;
+	REGWATCHER& operator=(const REGWATCHER&) = delete;
+	~REGWATCHER();
+
+	// Watch the values of the key (hRoot, lpPath), and of all its sub keys if bSubtree is TRUE. The key must exist.
+	HRESULT Subscribe(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGWATCHSUBSCRIBER* pSubscriber, DWORD* pdwId);
+	// Stop a subscription. Its subscriber is not called after this returns.
+	void Unsubscribe(DWORD dwId);
+	// Process pending notifications on the calling thread: those whose delay has ended, or all if bAll is TRUE.
+	// Return the number of diffs delivered.
+	size_t ProcessPending(BOOL bAll);
+
+	// Get the counters
+	REGWATCHSTATS GetStats() const;
+
+	void OnKeyChanged(HKEY hRoot, LPCSTR lpPath) override;
+};
+
+#endif
@@ -0,0 +1,490 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// REGKEY micro benchmarks
+// Every benchmark runs on a REGMEMORYBACKEND holding a synthetic tree that is built the same way on every run,
+// so the numbers measure the REGKEY layer and can be compared across commits.
+
+#include "RegKey.h"
+#include "RegMemory.h"
+#include <benchmark/benchmark.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_ROOT "Software\\RegKeyBench"
+#define BENCH_MAX_WIDE 10000
+#define BENCH_MAX_DEEP 64
+
+// Deterministic payload of ulSize bytes
+static std::string MakeString(size_t ulSize) {
+	std::string cStr(ulSize, '\0');
+	for (size_t i = 0; i < ulSize; i++) cStr[i] = static_cast<CHAR>('a' + (i * 7 + 3) % 26);
+	return cStr;
+}
+
+static std::vector<BYTE> MakeBytes(size_t ulSize) {
+	std::vector<BYTE> vData(ulSize);
+	for (size_t i = 0; i < ulSize; i++) vData[i] = static_cast<BYTE>(i * 31 + 7);
+	return vData;
+}
+
+static std::vector<std::string> MakeStrings(size_t ulCount) {
+	std::vector<std::string> vStrs(ulCount);
+	for (size_t i = 0; i < ulCount; i++) vStrs[i] = MakeString(8 + i % 24);
+	return vStrs;
+}
+
+static std::string ChildName(LPCSTR lpPrefix, DWORD dwIndex) {
+	CHAR kName[32];
+	snprintf(kName, sizeof(kName), "%s%05lu", lpPrefix, static_cast<unsigned long>(dwIndex));
+	return kName;
+}
+
+static std::string WidePath(DWORD dwWidth) {
+	return ChildName(BENCH_ROOT "\\Wide", dwWidth);
+}
+
+static std::string DeepPath(DWORD dwDepth) {
+	std::string cPath = BENCH_ROOT "\\Deep";
+	for (DWORD i = 0; i < dwDepth; i++) cPath += "\\" + ChildName("D", i);
+	return cPath;
+}
+
+// Synthetic tree
+//   Wide<n>       n sub keys (10, 100, 1000, 10000) and n values
+//   Deep\D00000\...\D<depth-1>   a chain of BENCH_MAX_DEEP keys, every level with 4 values
+//   Values        scratch key for the read / write benchmarks
+static REGMEMORYBACKEND* GetBenchBackend() {
+	// Never destroyed, shared by all benchmarks
+	static REGMEMORYBACKEND* pBackend = []() {
+		REGMEMORYBACKEND* pNew = new REGMEMORYBACKEND();
+		for (DWORD dwWidth = 10; dwWidth <= BENCH_MAX_WIDE; dwWidth *= 10) {
+			REGKEY rWide(pNew);
+			rWide.Create(HKEY_CURRENT_USER, WidePath(dwWidth).c_str(), KEY_ALL_ACCESS);
+			for (DWORD i = 0; i < dwWidth; i++) {
+				REGKEY rSon(pNew);
+				rSon.Create(HKEY_CURRENT_USER, (WidePath(dwWidth) + "\\" + ChildName("K", i)).c_str(), KEY_ALL_ACCESS);
+				rWide.WriteREGDWORD(ChildName("V", i).c_str(), i);
+			}
+		}
+		std::string cPath = BENCH_ROOT "\\Deep";
+		for (DWORD i = 0; i < BENCH_MAX_DEEP; i++) {
+			cPath += "\\" + ChildName("D", i);
+			REGKEY rLevel(pNew);
+			rLevel.Create(HKEY_CURRENT_USER, cPath.c_str(), KEY_ALL_ACCESS);
+			rLevel.WriteREGSZ("Name", cPath.c_str());
+			rLevel.WriteREGDWORD("Level", i);
+			rLevel.WriteREGQWORD("Stamp", 0x0123456789ABCDEFull + i);
+			rLevel.WriteREGBINARY("Blob", MakeBytes(64).data(), 64);
+		}
+		REGKEY rValues(pNew);
+		rValues.Create(HKEY_CURRENT_USER, BENCH_ROOT "\\Values", KEY_ALL_ACCESS);
+		return pNew;
+	}();
+	return pBackend;
+}
+
+static REGKEY OpenBenchKey(LPCSTR lpPath) {
+	REGKEY rKey(GetBenchBackend());
+	rKey.Open(HKEY_CURRENT_USER, lpPath, KEY_ALL_ACCESS);
+	return rKey;
+}
+
+// Open / Close and GetSon
+
+static void BM_OpenClose(benchmark::State& rState) {
+	std::string cPath = DeepPath(static_cast<DWORD>(rState.range(0)));
+	REGKEY rKey(GetBenchBackend());
+	for (auto _ : rState) {
+		benchmark::DoNotOptimize(rKey.Open(HKEY_CURRENT_USER, cPath.c_str(), KEY_READ));
+		rKey.Close();
+	}
+}
+BENCHMARK(BM_OpenClose)->Arg(1)->Arg(8)->Arg(BENCH_MAX_DEEP);
+
+static void BM_GetSon(benchmark::State& rState) {
+	REGKEY rParent = OpenBenchKey(WidePath(BENCH_MAX_WIDE).c_str());
+	REGKEY rSon(GetBenchBackend());
+	DWORD dwIndex = 0;
+	std::vector<std::string> vNames;
+	for (DWORD i = 0; i < 256; i++) vNames.push_back(ChildName("K", i * 37 % BENCH_MAX_WIDE));
+	for (auto _ : rState) {
+		benchmark::DoNotOptimize(rParent.GetSon(vNames[dwIndex++ & 255].c_str(), &rSon, KEY_READ));
+	}
+}
+BENCHMARK(BM_GetSon);
+
+// Typed writes and reads at several payload sizes
+
+static void BM_WriteREGSZ(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	std::string cVal = MakeString(static_cast<size_t>(rState.range(0)));
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.WriteREGSZ("Sz", cVal.c_str()));
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_WriteREGSZ)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+static void BM_ReadREGSZ(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	rKey.WriteREGSZ("SzRead", MakeString(static_cast<size_t>(rState.range(0))).c_str());
+	std::string cRes;
+	for (auto _ : rState) {
+		cRes.clear();
+		benchmark::DoNotOptimize(rKey.ReadREGSZ("SzRead", &cRes));
+	}
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_ReadREGSZ)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+static void BM_ReadREGSZScratch(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	rKey.WriteREGSZ("SzScratch", MakeString(static_cast<size_t>(rState.range(0))).c_str());
+	std::vector<BYTE> vScratch;
+	std::string_view vRes;
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.ReadREGSZ("SzScratch", &vScratch, &vRes));
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_ReadREGSZScratch)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+static void BM_WriteREGEXPANDSZ(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	std::string cVal = "%SystemRoot%\\" + MakeString(static_cast<size_t>(rState.range(0)));
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.WriteREGEXPANDSZ("Expand", cVal.c_str()));
+}
+BENCHMARK(BM_WriteREGEXPANDSZ)->Arg(16)->Arg(256);
+
+static void BM_ReadREGEXPANDSZ(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	rKey.WriteREGEXPANDSZ("ExpandRead", ("%SystemRoot%\\" + MakeString(static_cast<size_t>(rState.range(0)))).c_str());
+	std::string cRes;
+	for (auto _ : rState) {
+		cRes.clear();
+		benchmark::DoNotOptimize(rKey.ReadREGEXPANDSZ("ExpandRead", &cRes));
+	}
+}
+BENCHMARK(BM_ReadREGEXPANDSZ)->Arg(16)->Arg(256);
+
+static void BM_WriteREGDWORD(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	DWORD dwVal = 0;
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.WriteREGDWORD("Dword", dwVal++));
+}
+BENCHMARK(BM_WriteREGDWORD);
+
+static void BM_ReadREGDWORD(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	rKey.WriteREGDWORD("DwordRead", 0x12345678);
+	DWORD dwRes = 0;
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.ReadREGDWORD("DwordRead", &dwRes));
+}
+BENCHMARK(BM_ReadREGDWORD);
+
+static void BM_WriteREGQWORD(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	QWORD qwVal = 0;
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.WriteREGQWORD("Qword", qwVal++));
+}
+BENCHMARK(BM_WriteREGQWORD);
+
+static void BM_ReadREGQWORD(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	rKey.WriteREGQWORD("QwordRead", 0x0123456789ABCDEFull);
+	QWORD qwRes = 0;
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.ReadREGQWORD("QwordRead", &qwRes));
+}
+BENCHMARK(BM_ReadREGQWORD);
+
+static void BM_WriteREGBINARY(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.WriteREGBINARY("Binary", vData.data(), static_cast<DWORD>(vData.size())));
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_WriteREGBINARY)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+static void BM_ReadREGBINARY(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	rKey.WriteREGBINARY("BinaryRead", vData.data(), static_cast<DWORD>(vData.size()));
+	std::vector<BYTE> vRes;
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.ReadREGBINARY("BinaryRead", &vRes));
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_ReadREGBINARY)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+// REG_BINARY through the hexadecimal string interface
+static void BM_WriteREGBINARYHex(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	std::string cHex = ByteArrayToHexString(vData.data(), vData.size());
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.WriteREGBINARY("BinaryHex", cHex.c_str()));
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_WriteREGBINARYHex)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+static void BM_ReadREGBINARYHex(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	rKey.WriteREGBINARY("BinaryHexRead", vData.data(), static_cast<DWORD>(vData.size()));
+	std::string cRes;
+	for (auto _ : rState) {
+		cRes.clear();
+		benchmark::DoNotOptimize(rKey.ReadREGBINARY("BinaryHexRead", &cRes));
+	}
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_ReadREGBINARYHex)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+// REG_MULTI_SZ with 10 to 100K strings
+static void BM_WriteREGMULTISZ(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	std::vector<std::string> vStrs = MakeStrings(static_cast<size_t>(rState.range(0)));
+	std::vector<std::string_view> vViews(vStrs.begin(), vStrs.end());
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.WriteREGMULTISZ("Multi", vViews.data(), vViews.size()));
+	rState.SetItemsProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_WriteREGMULTISZ)->Arg(10)->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void BM_ReadREGMULTISZ(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	std::vector<std::string> vStrs = MakeStrings(static_cast<size_t>(rState.range(0)));
+	std::vector<std::string_view> vViews(vStrs.begin(), vStrs.end());
+	rKey.WriteREGMULTISZ("MultiRead", vViews.data(), vViews.size());
+	std::vector<std::string> vRes;
+	for (auto _ : rState) benchmark::DoNotOptimize(rKey.ReadREGMULTISZ("MultiRead", &vRes));
+	rState.SetItemsProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_ReadREGMULTISZ)->Arg(10)->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void BM_ReadREGMULTISZView(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Values");
+	std::vector<std::string> vStrs = MakeStrings(static_cast<size_t>(rState.range(0)));
+	std::vector<std::string_view> vViews(vStrs.begin(), vStrs.end());
+	rKey.WriteREGMULTISZ("MultiView", vViews.data(), vViews.size());
+	std::vector<BYTE> vScratch;
+	REGMULTISZVIEW vRes;
+	for (auto _ : rState) {
+		benchmark::DoNotOptimize(rKey.ReadREGMULTISZ("MultiView", &vScratch, &vRes));
+		size_t ulCount = 0;
+		for (std::string_view vStr : vRes) ulCount += vStr.size();
+		benchmark::DoNotOptimize(ulCount);
+	}
+	rState.SetItemsProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_ReadREGMULTISZView)->Arg(10)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Enumeration of wide and deep trees
+
+static DWORD dwEnumCount;
+
+static void CountKey(const REGKEY* pParent, LPCSTR lpName) {
+	dwEnumCount++;
+}
+
+static void CountValue(const REGKEY* pParent, LPCSTR lpName, DWORD dwType) {
+	dwEnumCount++;
+}
+
+static void BM_EnumKeyWide(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(WidePath(static_cast<DWORD>(rState.range(0))).c_str());
+	for (auto _ : rState) {
+		dwEnumCount = 0;
+		benchmark::DoNotOptimize(rKey.EnumKey(CountKey));
+	}
+	rState.SetItemsProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_EnumKeyWide)->RangeMultiplier(10)->Range(10, BENCH_MAX_WIDE);
+
+static void BM_EnumValueWide(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(WidePath(static_cast<DWORD>(rState.range(0))).c_str());
+	for (auto _ : rState) {
+		dwEnumCount = 0;
+		benchmark::DoNotOptimize(rKey.EnumValue(CountValue));
+	}
+	rState.SetItemsProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_EnumValueWide)->RangeMultiplier(10)->Range(10, BENCH_MAX_WIDE);
+
+static void BM_ListKeysWide(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(WidePath(static_cast<DWORD>(rState.range(0))).c_str());
+	std::vector<std::string> vNames;
+	for (auto _ : rState) {
+		benchmark::DoNotOptimize(rKey.ListKeys(&vNames));
+	}
+	rState.SetItemsProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_ListKeysWide)->RangeMultiplier(10)->Range(10, BENCH_MAX_WIDE);
+
+static void BM_ListValuesWide(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(WidePath(static_cast<DWORD>(rState.range(0))).c_str());
+	std::vector<REGVALUEENTRY> vValues;
+	for (auto _ : rState) {
+		benchmark::DoNotOptimize(rKey.ListValues(&vValues, TRUE));
+	}
+	rState.SetItemsProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_ListValuesWide)->RangeMultiplier(10)->Range(10, BENCH_MAX_WIDE);
+
+static void BM_EnumAllKeyDeep(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Deep");
+	for (auto _ : rState) {
+		dwEnumCount = 0;
+		benchmark::DoNotOptimize(rKey.EnumAllKey(CountKey));
+	}
+	rState.SetItemsProcessed(rState.iterations() * BENCH_MAX_DEEP);
+}
+BENCHMARK(BM_EnumAllKeyDeep);
+
+static void BM_EnumAllValueDeep(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Deep");
+	for (auto _ : rState) {
+		dwEnumCount = 0;
+		benchmark::DoNotOptimize(rKey.EnumAllValue(CountValue));
+	}
+	rState.SetItemsProcessed(rState.iterations() * BENCH_MAX_DEEP * 4);
+}
+BENCHMARK(BM_EnumAllValueDeep);
+
+static void BM_VisitAllValueDeepData(benchmark::State& rState) {
+	REGKEY rKey = OpenBenchKey(BENCH_ROOT "\\Deep");
+	for (auto _ : rState) {
+		DWORD dwBytes = 0;
+		benchmark::DoNotOptimize(rKey.VisitAllValue([&](const REGKEY& rParent, const REGVALUEINFO& rValue) {
+			dwBytes += rValue.dwSize;
+			return REG_VISIT_CONTINUE;
+		}, TRUE));
+		benchmark::DoNotOptimize(dwBytes);
+	}
+	rState.SetItemsProcessed(rState.iterations() * BENCH_MAX_DEEP * 4);
+}
+BENCHMARK(BM_VisitAllValueDeepData);
+
+// Codecs
+
+static void BM_HexStringToByteArray(benchmark::State& rState) {
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	std::string cHex = ByteArrayToHexString(vData.data(), vData.size());
+	for (auto _ : rState) benchmark::DoNotOptimize(HexStringToByteArray(cHex.c_str()));
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_HexStringToByteArray)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+static void BM_ByteArrayToHexString(benchmark::State& rState) {
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	for (auto _ : rState) benchmark::DoNotOptimize(ByteArrayToHexString(vData.data(), vData.size()));
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_ByteArrayToHexString)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+// Reference: the per character codec HexStringToByteArray / ByteArrayToHexString used before the SIMD paths
+static std::vector<BYTE> BaselineHexDecode(LPCSTR lpHex) {
+	std::vector<BYTE> vRes;
+	size_t ulLen = strlen(lpHex);
+	for (size_t i = 0; i + 1 < ulLen; i += 2) vRes.push_back(static_cast<BYTE>(HexCharToByte(lpHex[i]) << 4 | HexCharToByte(lpHex[i + 1])));
+	return vRes;
+}
+
+static std::string BaselineHexEncode(const BYTE* lpData, size_t ulSize) {
+	std::string cRes;
+	CHAR kHex[3];
+	for (size_t i = 0; i < ulSize; i++) {
+		snprintf(kHex, sizeof(kHex), "%02X", lpData[i]);
+		cRes += kHex;
+	}
+	return cRes;
+}
+
+static void BM_HexDecodeBaseline(benchmark::State& rState) {
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	std::string cHex = ByteArrayToHexString(vData.data(), vData.size());
+	for (auto _ : rState) benchmark::DoNotOptimize(BaselineHexDecode(cHex.c_str()));
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_HexDecodeBaseline)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+static void BM_HexEncodeBaseline(benchmark::State& rState) {
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	for (auto _ : rState) benchmark::DoNotOptimize(BaselineHexEncode(vData.data(), vData.size()));
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_HexEncodeBaseline)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+// Each codec path forced, on preallocated buffers
+static void BM_HexDecodePath(benchmark::State& rState, REGHEXPATH ePath) {
+	if (!HexPathSupported(ePath)) {
+		rState.SkipWithError("Codec path not supported on this CPU");
+		return;
+	}
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	std::string cHex = ByteArrayToHexString(vData.data(), vData.size());
+	for (auto _ : rState) {
+		benchmark::DoNotOptimize(HexDecodeWith(ePath, cHex.data(), cHex.size(), vData.data()));
+		benchmark::ClobberMemory();
+	}
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK_CAPTURE(BM_HexDecodePath, Scalar, REG_HEX_SCALAR)->RangeMultiplier(16)->Range(16, 64 << 10);
+BENCHMARK_CAPTURE(BM_HexDecodePath, SSE2, REG_HEX_SSE2)->RangeMultiplier(16)->Range(16, 64 << 10);
+BENCHMARK_CAPTURE(BM_HexDecodePath, AVX2, REG_HEX_AVX2)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+static void BM_HexEncodePath(benchmark::State& rState, REGHEXPATH ePath) {
+	if (!HexPathSupported(ePath)) {
+		rState.SkipWithError("Codec path not supported on this CPU");
+		return;
+	}
+	std::vector<BYTE> vData = MakeBytes(static_cast<size_t>(rState.range(0)));
+	std::vector<CHAR> vOut(vData.size() * 2);
+	for (auto _ : rState) {
+		benchmark::DoNotOptimize(HexEncodeWith(ePath, vData.data(), vData.size(), vOut.data()));
+		benchmark::ClobberMemory();
+	}
+	rState.SetBytesProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK_CAPTURE(BM_HexEncodePath, Scalar, REG_HEX_SCALAR)->RangeMultiplier(16)->Range(16, 64 << 10);
+BENCHMARK_CAPTURE(BM_HexEncodePath, SSE2, REG_HEX_SSE2)->RangeMultiplier(16)->Range(16, 64 << 10);
+BENCHMARK_CAPTURE(BM_HexEncodePath, AVX2, REG_HEX_AVX2)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+static void BM_MultiSzPack(benchmark::State& rState) {
+	std::vector<std::string> vStrs = MakeStrings(static_cast<size_t>(rState.range(0)));
+	std::vector<CHAR> vOut(MultiSzSize(vStrs));
+	for (auto _ : rState) {
+		benchmark::DoNotOptimize(MultiSzEncode(vStrs, vOut.data()));
+		benchmark::ClobberMemory();
+	}
+	rState.SetItemsProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_MultiSzPack)->Arg(10)->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void BM_MultiSzUnpack(benchmark::State& rState) {
+	std::vector<std::string> vStrs = MakeStrings(static_cast<size_t>(rState.range(0)));
+	std::vector<CHAR> vData(MultiSzSize(vStrs));
+	MultiSzEncode(vStrs, vData.data());
+	for (auto _ : rState) {
+		size_t ulCount = 0;
+		for (std::string_view vStr : REGMULTISZVIEW(vData.data(), static_cast<DWORD>(vData.size()))) ulCount += vStr.size();
+		benchmark::DoNotOptimize(ulCount);
+	}
+	rState.SetItemsProcessed(rState.iterations() * rState.range(0));
+}
+BENCHMARK(BM_MultiSzUnpack)->Arg(10)->Arg(1000)->Arg(10000)->Arg(100000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Every heap allocation of the process is counted
+static std::atomic<LONGLONG> llAllocations(0);
+
+void* operator new(size_t ulSize) {
+	llAllocations++;
+	void* p = malloc(ulSize == 0 ? 1 : ulSize);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+void* operator new[](size_t ulSize) {
+	return operator new(ulSize);
+}
+void operator delete(void* p) noexcept {
+	free(p);
+}
+void operator delete[](void* p) noexcept {
+	free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+	free(p);
+}
+
+// Once the scratch buffer has grown, string reads into it make no heap allocation
+static void TestScratchReads(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Alloc", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGSZ("Name", "a string value longer than any small string buffer"), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGSZ("Short", "abc"), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGMULTISZ("List", std::vector<LPCSTR>{ "first", "second", "third" }), REG_SUCCESS);
+
+	std::vector<BYTE> vScratch;
+	std::string_view vStr;
+	REGMULTISZVIEW vMulti;
+	// Grow the buffer
+	REG_CHECK_EQ(rKey.ReadREGSZ("Name", &vScratch, &vStr), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.ReadREGMULTISZ("List", &vScratch, &vMulti), REG_SUCCESS);
+
+	LONGLONG llBefore = llAllocations.load();
+	size_t ulCount = 0;
+	for (INT i = 0; i < 1000; i++) {
+		REG_CHECK_EQ(rKey.ReadREGSZ("Name", &vScratch, &vStr), REG_SUCCESS);
+		REG_CHECK_EQ(rKey.ReadREGSZ("Short", &vScratch, &vStr), REG_SUCCESS);
+		ulCount += vStr.size();
+		REG_CHECK_EQ(rKey.ReadREGMULTISZ("List", &vScratch, &vMulti), REG_SUCCESS);
+		for (std::string_view vItem : vMulti) ulCount += vItem.size();
+	}
+	REG_CHECK_EQ(llAllocations.load() - llBefore, 0);
+	REG_CHECK_EQ(ulCount, 1000 * strlen("abcfirstsecondthird"));
+
+	// The reads into a string allocate, which the counter sees
+	std::string cStr;
+	llBefore = llAllocations.load();
+	REG_CHECK_EQ(rKey.ReadREGSZ("Name", &cStr), REG_SUCCESS);
+	REG_CHECK(llAllocations.load() > llBefore);
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	TestScratchReads(&rBackend);
+	return REG_TEST_RESULT();
+}
@@ -0,0 +1,167 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include "RegBaseline.h"
+#include <sstream>
+
+// Offsets in the header: the data CRC and the header CRC, which covers the bytes before it
+#define HEADER_DATA_CRC 96
+#define HEADER_CRC 100
+
+// Bitwise CRC-32 (IEEE 802.3)
+static DWORD RefCrc32(const BYTE* lpData, size_t ulSize) {
+	DWORD c = 0xFFFFFFFF;
+	for (size_t i = 0; i < ulSize; i++) {
+		c ^= lpData[i];
+		for (INT k = 0; k < 8; k++) c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : c >> 1;
+	}
+	return ~c;
+}
+
+static DWORD GetDword(const BYTE* lpData) {
+	DWORD dwVal = 0;
+	memcpy(&dwVal, lpData, sizeof(DWORD));
+	return dwVal;
+}
+
+// Baseline image of the tree below HKEY_CURRENT_USER\Software\Base, kept 8-byte aligned for Load
+static size_t MakeImage(REGMEMORYBACKEND* pBackend, REGSNAPSHOT* pSnap, std::vector<ULONGLONG>* pImage) {
+	REGKEY rRoot(pBackend);
+	REG_CHECK_EQ(rRoot.Create(HKEY_CURRENT_USER, "Software\\Base", KEY_ALL_ACCESS), REG_SUCCESS);
+	LPCSTR lpNames[] = { "gamma", "Alpha", "delta", "Beta", "epsilon" };
+	for (LPCSTR lpName : lpNames) {
+		REGKEY rSub(pBackend);
+		REG_CHECK_EQ(rSub.Create(HKEY_CURRENT_USER, (std::string("Software\\Base\\") + lpName + "\\Deep").c_str(), KEY_ALL_ACCESS), REG_SUCCESS);
+		REG_CHECK_EQ(rSub.WriteREGSZ("Name", lpName), REG_SUCCESS);
+	}
+	REG_CHECK_EQ(rRoot.WriteREGSZ("zeta", "payload"), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.WriteREGDWORD("Count", 5), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.WriteREGQWORD("big", 1ULL << 40), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.WriteValue("Empty", REG_BINARY, nullptr, 0), REG_SUCCESS);
+	REG_CHECK_EQ(REGSNAPSHOT::Capture(rRoot, pSnap), REG_SUCCESS);
+
+	std::ostringstream osImage(std::ios::binary);
+	REG_CHECK_EQ(SaveBaselineStream(*pSnap, osImage), REG_SUCCESS);
+	std::string cImage = osImage.str();
+	pImage->assign((cImage.size() + 7) / 8, 0);
+	memcpy(pImage->data(), cImage.data(), cImage.size());
+	return cImage.size();
+}
+
+static void TestCrc(const std::vector<ULONGLONG>& vImage, size_t ulSize) {
+	const BYTE* lpImage = reinterpret_cast<const BYTE*>(vImage.data());
+	REG_CHECK_EQ(RefCrc32(reinterpret_cast<const BYTE*>("123456789"), 9), 0xCBF43926);
+	// The stored CRCs follow the standard polynomial
+	REG_CHECK_EQ(GetDword(lpImage + HEADER_CRC), RefCrc32(lpImage, HEADER_CRC));
+	REGBASELINEBACKEND rBaseline;
+	REG_CHECK_EQ(rBaseline.Load(lpImage, ulSize), REG_SUCCESS);
+	REG_CHECK_EQ(rBaseline.Verify(), REG_SUCCESS);
+	REG_CHECK_EQ(rBaseline.Unload(), REG_SUCCESS);
+
+	// A changed header is refused by Load
+	std::vector<ULONGLONG> vBad = vImage;
+	BYTE* lpBad = reinterpret_cast<BYTE*>(vBad.data());
+	lpBad[12] ^= 1;
+	REG_CHECK_EQ(rBaseline.Load(lpBad, ulSize), REG_INVAILD_FILE);
+	REG_CHECK_EQ(rBaseline.Loaded(), FALSE);
+
+	// A changed section is only found by Verify, which reads the whole image
+	vBad = vImage;
+	std::string_view vImageView(reinterpret_cast<const CHAR*>(lpBad), ulSize);
+	size_t ulPayload = vImageView.find("payload");
+	REG_CHECK(ulPayload != std::string_view::npos);
+	lpBad[ulPayload] = 'P';
+	REG_CHECK_EQ(rBaseline.Load(lpBad, ulSize), REG_SUCCESS);
+	REG_CHECK_EQ(rBaseline.Verify(), REG_INVAILD_FILE);
+	// Even with the section CRC rewritten, the header CRC no longer matches
+	DWORD dwDataCrc = GetDword(lpBad + HEADER_DATA_CRC) ^ 1;
+	memcpy(lpBad + HEADER_DATA_CRC, &dwDataCrc, sizeof(DWORD));
+	REG_CHECK_EQ(rBaseline.Load(lpBad, ulSize), REG_INVAILD_FILE);
+
+	// Truncated or misaligned images
+	REG_CHECK_EQ(rBaseline.Load(lpImage, HEADER_CRC), REG_INVAILD_FILE);
+	REG_CHECK_EQ(rBaseline.Load(lpImage, ulSize - 8), REG_INVAILD_FILE);
+	REG_CHECK_EQ(rBaseline.Load(lpImage + 1, ulSize - 1), REG_INVAILD_POINTER);
+}
+
+static void TestLookup(const REGSNAPSHOT& rSnap, const std::vector<ULONGLONG>& vImage, size_t ulSize) {
+	REGBASELINEBACKEND rBaseline;
+	REG_CHECK_EQ(rBaseline.Load(reinterpret_cast<const BYTE*>(vImage.data()), ulSize), REG_SUCCESS);
+	REG_CHECK_EQ(rBaseline.GetKeyCount(), 11);
+	REG_CHECK_EQ(rBaseline.GetValueCount(), 9);
+
+	// Sub keys and values are found by name, case-insensitively, below every root key
+	REGKEY rKey(&rBaseline);
+	std::string cStr;
+	DWORD dwVal = 0;
+	QWORD ullVal = 0;
+	LPCSTR lpNames[] = { "Alpha", "Beta", "delta", "epsilon", "gamma" };
+	for (LPCSTR lpName : lpNames) {
+		REG_CHECK_EQ(rKey.Open(HKEY_LOCAL_MACHINE, (std::string("\\") + lpName + "\\Deep").c_str(), KEY_READ), REG_SUCCESS);
+		REG_CHECK_EQ(rKey.ReadREGSZ("NAME", &cStr), REG_SUCCESS);
+		REG_CHECK(cStr == lpName);
+		REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, lpName, KEY_READ), REG_SUCCESS);
+	}
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "BETA\\deep", KEY_READ), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Beta\\Deep\\None", KEY_READ), REG_PATH_NOT_EXIST);
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Bet", KEY_READ), REG_PATH_NOT_EXIST);
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Zeta", KEY_READ), REG_PATH_NOT_EXIST);
+
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "", KEY_READ), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.ReadREGSZ("ZETA", &cStr), REG_SUCCESS);
+	REG_CHECK(cStr == "payload");
+	REG_CHECK_EQ(rKey.ReadREGDWORD("count", &dwVal), REG_SUCCESS);
+	REG_CHECK_EQ(dwVal, 5);
+	REG_CHECK_EQ(rKey.ReadREGQWORD("Big", &ullVal), REG_SUCCESS);
+	REG_CHECK_EQ(ullVal, 1ULL << 40);
+	DWORD dwType = REG_NONE;
+	std::vector<BYTE> vData(4);
+	REG_CHECK_EQ(rKey.ReadValue("empty", &dwType, &vData), REG_SUCCESS);
+	REG_CHECK(dwType == REG_BINARY && vData.empty());
+	REG_CHECK_EQ(rKey.ReadREGSZ("Name", &cStr), REG_VALUE_NOT_EXIST);
+	REG_CHECK_EQ(rKey.ReadREGSZ("zet", &cStr), REG_VALUE_NOT_EXIST);
+
+	// Read-only
+	REG_CHECK_EQ(rKey.WriteREGDWORD("Count", 6), REG_ACCESS_DENIED);
+	HKEY hNew = NULL;
+	REG_CHECK_EQ(rBaseline.OpenKey(HKEY_CURRENT_USER, "New", KEY_ALL_ACCESS, TRUE, &hNew), ERROR_ACCESS_DENIED);
+
+	// The whole tree reads back as captured
+	REGSNAPSHOT rCopy;
+	REG_CHECK_EQ(REGSNAPSHOT::Capture(rKey, &rCopy), REG_SUCCESS);
+	size_t ulDiffs = 0;
+	REG_CHECK_EQ(DiffSnapshots(rSnap, rCopy, [&](const REGDIFFENTRY&) { ulDiffs++; return REG_VISIT_CONTINUE; }), REG_SUCCESS);
+	REG_CHECK_EQ(ulDiffs, 0);
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	REGSNAPSHOT rSnap;
+	std::vector<ULONGLONG> vImage;
+	size_t ulSize = MakeImage(&rBackend, &rSnap, &vImage);
+	TestCrc(vImage, ulSize);
+	TestLookup(rSnap, vImage, ulSize);
+	return REG_TEST_RESULT();
+}
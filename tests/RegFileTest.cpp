@@ -0,0 +1,121 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegTest.h"
+#include "RegFile.h"
+#include "RegMemory.h"
+#include <sstream>
+
+static const CHAR lpImport[] =
+	"REGEDIT4\r\n"
+	"\r\n"
+	"; Comment\r\n"
+	"[HKEY_CURRENT_USER\\Software\\File]\r\n"
+	"@=\"default\"\r\n"
+	"\"Quoted\"=\"a \\\"b\\\" c:\\\\d\"\r\n"
+	"\"Num\"=dword:0000002a\r\n"
+	"\"Bin\"=hex:00,01,02,\\\r\n"
+	"  03,fe,ff\r\n"
+	"\"Expand\"=hex(2):25,54,45,4d,50,25,00\r\n"
+	"\"List\"=hex(7):61,00,62,62,00,00\r\n"
+	"\"Gone\"=\"x\"\r\n"
+	"\"Gone\"=-\r\n"
+	"\r\n"
+	"[HKCU\\Software\\File\\Sub]\r\n"
+	"\"Name\"=\"sub\"\r\n"
+	"\r\n"
+	"[HKEY_CURRENT_USER\\Software\\File\\Old]\r\n"
+	"[-HKEY_CURRENT_USER\\Software\\File\\Old]\r\n"
+	"\"Ignored\"=\"x\"\r\n";
+
+static void CheckImported(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\File", KEY_READ), REG_SUCCESS);
+	std::string cStr;
+	DWORD dwNum = 0;
+	std::vector<BYTE> vBin;
+	std::vector<std::string> vList;
+	REG_CHECK_EQ(rKey.ReadREGSZ("", &cStr), REG_SUCCESS);
+	REG_CHECK(cStr == "default");
+	REG_CHECK_EQ(rKey.ReadREGSZ("Quoted", &cStr), REG_SUCCESS);
+	REG_CHECK(cStr == "a \"b\" c:\\d");
+	REG_CHECK_EQ(rKey.ReadREGDWORD("Num", &dwNum), REG_SUCCESS);
+	REG_CHECK_EQ(dwNum, 42);
+	REG_CHECK_EQ(rKey.ReadREGBINARY("Bin", &vBin), REG_SUCCESS);
+	REG_CHECK(vBin == std::vector<BYTE>({ 0x00, 0x01, 0x02, 0x03, 0xFE, 0xFF }));
+	REG_CHECK_EQ(rKey.ReadREGEXPANDSZ("Expand", &cStr), REG_SUCCESS);
+	REG_CHECK(cStr == "%TEMP%");
+	REG_CHECK_EQ(rKey.ReadREGMULTISZ("List", &vList), REG_SUCCESS);
+	REG_CHECK(vList == std::vector<std::string>({ "a", "bb" }));
+	REG_CHECK_EQ(rKey.ReadREGSZ("Gone", &cStr), REG_VALUE_NOT_EXIST);
+	std::vector<std::string> vKeys;
+	REG_CHECK_EQ(rKey.ListKeys(&vKeys), REG_SUCCESS);
+	REG_CHECK(vKeys == std::vector<std::string>({ "Sub" }));
+	REGKEY rSub(pBackend);
+	REG_CHECK_EQ(rSub.Open(HKEY_CURRENT_USER, "Software\\File\\Sub", KEY_READ), REG_SUCCESS);
+	REG_CHECK_EQ(rSub.ReadREGSZ("Name", &cStr), REG_SUCCESS);
+	REG_CHECK(cStr == "sub");
+}
+
+static void TestImport(REGMEMORYBACKEND* pBackend) {
+	std::istringstream isInput(std::string(lpImport, sizeof(lpImport) - 1), std::ios::binary);
+	REG_CHECK_EQ(ImportRegStream(isInput, pBackend), REG_SUCCESS);
+	CheckImported(pBackend);
+}
+
+// Exported files import to the same values, in both formats
+static void TestRoundTrip(REGMEMORYBACKEND* pBackend, BOOL bUnicode) {
+	std::ostringstream osOutput(std::ios::binary);
+	{
+		REGKEY rKey(pBackend);
+		REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\File", KEY_READ), REG_SUCCESS);
+		REG_CHECK_EQ(ExportRegStream(rKey, osOutput, bUnicode), REG_SUCCESS);
+		REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\File", KEY_ALL_ACCESS), REG_SUCCESS);
+		REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+	}
+	std::string cFile = osOutput.str();
+	if (bUnicode) REG_CHECK(cFile.compare(0, 4, std::string("\xFF\xFEW\0", 4)) == 0);
+	else REG_CHECK(cFile.compare(0, 10, "REGEDIT4\r\n") == 0);
+	std::istringstream isInput(cFile, std::ios::binary);
+	REG_CHECK_EQ(ImportRegStream(isInput, pBackend), REG_SUCCESS);
+	CheckImported(pBackend);
+}
+
+static void TestInvalid(REGMEMORYBACKEND* pBackend) {
+	std::istringstream isHeader("REGEDIT5\r\n", std::ios::binary);
+	REG_CHECK_EQ(ImportRegStream(isHeader, pBackend), REG_INVAILD_FILE);
+	std::istringstream isRoot("REGEDIT4\r\n[HKEY_NOWHERE\\Software]\r\n", std::ios::binary);
+	REG_CHECK_EQ(ImportRegStream(isRoot, pBackend), REG_INVAILD_ROOT);
+	std::istringstream isNoKey("REGEDIT4\r\n\"Name\"=\"x\"\r\n", std::ios::binary);
+	REG_CHECK_EQ(ImportRegStream(isNoKey, pBackend), REG_INVAILD_FILE);
+	std::istringstream isHex("REGEDIT4\r\n[HKCU\\Software\\File]\r\n\"Bin\"=hex:0g\r\n", std::ios::binary);
+	REG_CHECK_EQ(ImportRegStream(isHex, pBackend), REG_INVAILD_FILE);
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	TestImport(&rBackend);
+	TestRoundTrip(&rBackend, FALSE);
+	TestRoundTrip(&rBackend, TRUE);
+	TestInvalid(&rBackend);
+	return REG_TEST_RESULT();
+}
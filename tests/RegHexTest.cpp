@@ -0,0 +1,137 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include <algorithm>
+
+static BYTE RefNibble(CHAR c) {
+	if (c >= '0' && c <= '9') return static_cast<BYTE>(c - '0');
+	if (c >= 'a' && c <= 'f') return static_cast<BYTE>(c - 'a' + 10);
+	if (c >= 'A' && c <= 'F') return static_cast<BYTE>(c - 'A' + 10);
+	return 0;
+}
+
+// Every length up to a few vector widths and every start offset, so the vector loops and their tails are all run
+static void TestEncode() {
+	std::vector<BYTE> vData(300);
+	for (size_t i = 0; i < vData.size(); i++) vData[i] = static_cast<BYTE>(i * 151 + 7);
+	std::vector<CHAR> vOut(2 * vData.size() + 1);
+	BOOL bSame = TRUE;
+	for (size_t ulStart = 0; ulStart < 8; ulStart++) {
+		for (size_t ulSize = 0; ulStart + ulSize <= 140; ulSize++) {
+			vOut.assign(vOut.size(), '#');
+			REG_CHECK_EQ(HexEncode(vData.data() + ulStart, ulSize, vOut.data()), ulSize * 2);
+			for (size_t i = 0; i < ulSize; i++) {
+				BYTE b = vData[ulStart + i];
+				bSame = bSame && vOut[i * 2] == "0123456789ABCDEF"[b >> 4] && vOut[i * 2 + 1] == "0123456789ABCDEF"[b & 0xF];
+			}
+			// Nothing is written after the output
+			bSame = bSame && vOut[ulSize * 2] == '#';
+		}
+	}
+	REG_CHECK(bSame);
+
+	// All byte values
+	std::vector<BYTE> vAll(256);
+	for (INT i = 0; i < 256; i++) vAll[i] = static_cast<BYTE>(i);
+	std::string cHex = ByteArrayToHexString(vAll.data(), vAll.size());
+	REG_CHECK(cHex.compare(0, 8, "00010203") == 0 && cHex.compare(cHex.size() - 8, 8, "FCFDFEFF") == 0);
+	REG_CHECK(HexStringToByteArray(cHex.c_str()) == vAll);
+}
+
+static void TestDecode() {
+	// Every character, in both positions of a byte, against the scalar rule of HexCharToByte
+	std::vector<CHAR> vHex;
+	for (INT i = 1; i < 256; i++) {
+		vHex.push_back(static_cast<CHAR>(i));
+		vHex.push_back(static_cast<CHAR>(256 - i));
+	}
+	std::vector<BYTE> vOut(vHex.size() / 2 + 1, 0xCC);
+	BOOL bSame = TRUE;
+	for (size_t ulStart = 0; ulStart < 4; ulStart++) {
+		for (size_t ulLen = 0; ulStart + ulLen <= vHex.size(); ulLen += 13) {
+			const CHAR* p = vHex.data() + ulStart;
+			vOut.assign(vOut.size(), 0xCC);
+			REG_CHECK_EQ(HexDecode(p, ulLen, vOut.data()), ulLen / 2);
+			for (size_t i = 0; i < ulLen / 2; i++) {
+				bSame = bSame && vOut[i] == ((RefNibble(p[i * 2]) << 4) | RefNibble(p[i * 2 + 1]));
+				bSame = bSame && RefNibble(p[i * 2]) == HexCharToByte(p[i * 2]);
+			}
+			bSame = bSame && vOut[ulLen / 2] == 0xCC;
+		}
+	}
+	REG_CHECK(bSame);
+
+	// Mixed case, and the last odd character is ignored
+	BYTE lpBytes[4] = {};
+	REG_CHECK_EQ(HexDecode("aBcD0f7", 7, lpBytes), 3);
+	REG_CHECK(lpBytes[0] == 0xAB && lpBytes[1] == 0xCD && lpBytes[2] == 0x0F && lpBytes[3] == 0);
+}
+
+// Every path the CPU supports matches the scalar codec, not only the one selected at run time
+static void TestPaths() {
+	REG_CHECK(HexPathSupported(REG_HEX_SCALAR));
+	std::vector<BYTE> vData(200);
+	for (size_t i = 0; i < vData.size(); i++) vData[i] = static_cast<BYTE>(i * 151 + 7);
+	std::vector<CHAR> vRef(2 * vData.size()), vHex(2 * vData.size());
+	std::vector<BYTE> vOut(vData.size());
+	const REGHEXPATH lpPaths[] = { REG_HEX_SSE2, REG_HEX_AVX2 };
+	for (REGHEXPATH ePath : lpPaths) {
+		if (!HexPathSupported(ePath)) {
+			REG_CHECK_EQ(HexEncodeWith(ePath, vData.data(), 1, vHex.data()), 0);
+			continue;
+		}
+		BOOL bSame = TRUE;
+		for (size_t ulSize = 0; ulSize <= 140; ulSize++) {
+			REG_CHECK_EQ(HexEncodeWith(REG_HEX_SCALAR, vData.data() + 1, ulSize, vRef.data()), ulSize * 2);
+			REG_CHECK_EQ(HexEncodeWith(ePath, vData.data() + 1, ulSize, vHex.data()), ulSize * 2);
+			bSame = bSame && std::equal(vRef.begin(), vRef.begin() + ulSize * 2, vHex.begin());
+			REG_CHECK_EQ(HexDecodeWith(ePath, vHex.data(), ulSize * 2, vOut.data()), ulSize);
+			bSame = bSame && std::equal(vOut.begin(), vOut.begin() + ulSize, vData.begin() + 1);
+		}
+		REG_CHECK(bSame);
+	}
+}
+
+// REG_BINARY values written and read as hex strings
+static void TestValue(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Hex", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGBINARY("Bin", "00ff7Fa0"), REG_SUCCESS);
+	std::vector<BYTE> vBin;
+	REG_CHECK_EQ(rKey.ReadREGBINARY("Bin", &vBin), REG_SUCCESS);
+	REG_CHECK(vBin == std::vector<BYTE>({ 0x00, 0xFF, 0x7F, 0xA0 }));
+	std::string cHex = "x";
+	REG_CHECK_EQ(rKey.ReadREGBINARY("Bin", &cHex), REG_SUCCESS);
+	REG_CHECK(cHex == "x00FF7FA0");
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	TestEncode();
+	TestDecode();
+	TestPaths();
+	TestValue(&rBackend);
+	return REG_TEST_RESULT();
+}
@@ -0,0 +1,283 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegTest.h"
+#include "RegHive.h"
+
+// Hive image builder: cells are appended to a single bin and referred to by their offset from the first bin
+class HIVEIMAGE {
+private:
+	std::vector<BYTE> vBins;
+
+public:
+	HIVEIMAGE() : vBins(0x20, 0) {
+		memcpy(vBins.data(), "hbin", 4);
+	}
+
+	static void Put16(std::vector<BYTE>* pData, size_t ulOffset, WORD wVal) {
+		memcpy(pData->data() + ulOffset, &wVal, sizeof(WORD));
+	}
+	static void Put32(std::vector<BYTE>* pData, size_t ulOffset, DWORD dwVal) {
+		memcpy(pData->data() + ulOffset, &dwVal, sizeof(DWORD));
+	}
+	static std::vector<BYTE> Utf16(LPCSTR lpStr, size_t ulLen) {
+		std::vector<BYTE> vRes;
+		for (size_t i = 0; i < ulLen; i++) {
+			vRes.push_back(static_cast<BYTE>(lpStr[i]));
+			vRes.push_back(0);
+		}
+		return vRes;
+	}
+	// Hash of the upcased UTF-16 name (names here are Latin-1, which upcases by -0x20 except U+00F7 and U+00FF)
+	static DWORD Hash(LPCSTR lpName) {
+		DWORD dwHash = 0;
+		for (; *lpName; lpName++) {
+			DWORD dwChar = static_cast<BYTE>(*lpName);
+			if ((dwChar >= 'a' && dwChar <= 'z') || (dwChar >= 0xE0 && dwChar <= 0xFE && dwChar != 0xF7)) dwChar -= 0x20;
+			dwHash = dwHash * 37 + dwChar;
+		}
+		return dwHash;
+	}
+
+	// Append an allocated cell (negative size, 8 byte aligned)
+	DWORD Cell(const std::vector<BYTE>& vData) {
+		DWORD dwOffset = static_cast<DWORD>(vBins.size());
+		DWORD dwSize = static_cast<DWORD>((vData.size() + 4 + 7) & ~static_cast<size_t>(7));
+		vBins.resize(vBins.size() + dwSize, 0);
+		Put32(&vBins, dwOffset, static_cast<DWORD>(-static_cast<LONG>(dwSize)));
+		memcpy(vBins.data() + dwOffset + 4, vData.data(), vData.size());
+		return dwOffset;
+	}
+	DWORD Key(LPCSTR lpName, BOOL bCompressed, const std::vector<DWORD>& vValues, DWORD dwSubKeys, DWORD dwSubKeyList) {
+		std::vector<BYTE> vName = (bCompressed ? std::vector<BYTE>(lpName, lpName + strlen(lpName)) : Utf16(lpName, strlen(lpName)));
+		std::vector<BYTE> vNode(0x4C + vName.size(), 0);
+		vNode[0] = 'n';
+		vNode[1] = 'k';
+		Put16(&vNode, 0x02, bCompressed ? 0x0020 : 0);
+		Put32(&vNode, 0x14, dwSubKeys);
+		Put32(&vNode, 0x1C, dwSubKeys == 0 ? 0xFFFFFFFF : dwSubKeyList);
+		Put32(&vNode, 0x24, static_cast<DWORD>(vValues.size()));
+		Put32(&vNode, 0x28, 0xFFFFFFFF);
+		if (!vValues.empty()) {
+			std::vector<BYTE> vList(vValues.size() * 4);
+			for (size_t i = 0; i < vValues.size(); i++) Put32(&vList, i * 4, vValues[i]);
+			Put32(&vNode, 0x28, Cell(vList));
+		}
+		Put16(&vNode, 0x48, static_cast<WORD>(vName.size()));
+		memcpy(vNode.data() + 0x4C, vName.data(), vName.size());
+		return Cell(vNode);
+	}
+	// A value whose data is in a cell (dwDataCell), inline (bInline, up to 4 bytes in dwData) or empty
+	DWORD Value(LPCSTR lpName, BOOL bCompressed, DWORD dwType, DWORD dwSize, DWORD dwData, BOOL bInline) {
+		std::vector<BYTE> vName = (bCompressed ? std::vector<BYTE>(lpName, lpName + strlen(lpName)) : Utf16(lpName, strlen(lpName)));
+		std::vector<BYTE> vValue(0x14 + vName.size(), 0);
+		vValue[0] = 'v';
+		vValue[1] = 'k';
+		Put16(&vValue, 0x02, static_cast<WORD>(vName.size()));
+		Put32(&vValue, 0x04, bInline ? (dwSize | 0x80000000) : dwSize);
+		Put32(&vValue, 0x08, dwData);
+		Put32(&vValue, 0x0C, dwType);
+		Put16(&vValue, 0x10, bCompressed ? 0x0001 : 0);
+		memcpy(vValue.data() + 0x14, vName.data(), vName.size());
+		return Cell(vValue);
+	}
+	// lf / lh list (8 byte entries with a hash) or li list (4 byte entries)
+	DWORD List(CHAR cKind, const std::vector<std::pair<DWORD, LPCSTR>>& vKeys) {
+		DWORD dwStride = (cKind == 'i' ? 4 : 8);
+		std::vector<BYTE> vList(4 + vKeys.size() * dwStride, 0);
+		vList[0] = 'l';
+		vList[1] = static_cast<BYTE>(cKind);
+		Put16(&vList, 2, static_cast<WORD>(vKeys.size()));
+		for (size_t i = 0; i < vKeys.size(); i++) {
+			Put32(&vList, 4 + i * dwStride, vKeys[i].first);
+			if (dwStride == 8) Put32(&vList, 8 + i * dwStride, Hash(vKeys[i].second));
+		}
+		return Cell(vList);
+	}
+	DWORD IndexRoot(const std::vector<DWORD>& vLists) {
+		std::vector<BYTE> vList(4 + vLists.size() * 4, 0);
+		vList[0] = 'r';
+		vList[1] = 'i';
+		Put16(&vList, 2, static_cast<WORD>(vLists.size()));
+		for (size_t i = 0; i < vLists.size(); i++) Put32(&vList, 4 + i * 4, vLists[i]);
+		return Cell(vList);
+	}
+	std::vector<BYTE> Build(DWORD dwRoot) {
+		std::vector<BYTE> vImage(0x1000, 0);
+		memcpy(vImage.data(), "regf", 4);
+		Put32(&vImage, 0x14, 1);
+		Put32(&vImage, 0x18, 5);
+		Put32(&vImage, 0x24, dwRoot);
+		Put32(&vImage, 0x28, static_cast<DWORD>(vBins.size()));
+		vImage.insert(vImage.end(), vBins.begin(), vBins.end());
+		return vImage;
+	}
+};
+
+// Root
+//   Alpha, Software (lh list) and Zeta (li list) under one ri list
+//   Software: Name (REG_SZ), Num (inline REG_DWORD), List (REG_MULTI_SZ), Big (REG_BINARY in a db cell),
+//             Wide (UTF-16 name, REG_DWORD in a cell); sub key Wide (UTF-16 name)
+static std::vector<BYTE> BuildHive() {
+	HIVEIMAGE iImage;
+	std::vector<BYTE> vSz = HIVEIMAGE::Utf16("hello", 6);
+	std::vector<BYTE> vMulti = HIVEIMAGE::Utf16("a\0bb\0", 6);
+	std::vector<BYTE> vDword(4, 0);
+	HIVEIMAGE::Put32(&vDword, 0, 7);
+	std::vector<DWORD> vValues;
+	vValues.push_back(iImage.Value("Name", TRUE, REG_SZ, static_cast<DWORD>(vSz.size()), iImage.Cell(vSz), FALSE));
+	vValues.push_back(iImage.Value("Num", TRUE, REG_DWORD, 4, 42, TRUE));
+	vValues.push_back(iImage.Value("List", TRUE, REG_MULTI_SZ, static_cast<DWORD>(vMulti.size()), iImage.Cell(vMulti), FALSE));
+
+	// 20000 bytes in two big data segments
+	std::vector<BYTE> vBig(20000);
+	for (size_t i = 0; i < vBig.size(); i++) vBig[i] = static_cast<BYTE>(i * 7);
+	DWORD dwSeg1 = iImage.Cell(std::vector<BYTE>(vBig.begin(), vBig.begin() + 16344));
+	DWORD dwSeg2 = iImage.Cell(std::vector<BYTE>(vBig.begin() + 16344, vBig.end()));
+	std::vector<BYTE> vSegs(8);
+	HIVEIMAGE::Put32(&vSegs, 0, dwSeg1);
+	HIVEIMAGE::Put32(&vSegs, 4, dwSeg2);
+	std::vector<BYTE> vDb(8, 0);
+	vDb[0] = 'd';
+	vDb[1] = 'b';
+	HIVEIMAGE::Put16(&vDb, 2, 2);
+	HIVEIMAGE::Put32(&vDb, 4, iImage.Cell(vSegs));
+	vValues.push_back(iImage.Value("Big", TRUE, REG_BINARY, static_cast<DWORD>(vBig.size()), iImage.Cell(vDb), FALSE));
+	vValues.push_back(iImage.Value("Wide", FALSE, REG_DWORD, 4, iImage.Cell(vDword), FALSE));
+
+	DWORD dwWide = iImage.Key("Wide", FALSE, {}, 0, 0);
+	DWORD dwSoftware = iImage.Key("Software", TRUE, vValues, 1, iImage.List('f', { { dwWide, "Wide" } }));
+	DWORD dwAlpha = iImage.Key("Alpha", TRUE, {}, 0, 0);
+	DWORD dwZeta = iImage.Key("Zeta", TRUE, {}, 0, 0);
+	DWORD dwFirst = iImage.List('h', { { dwAlpha, "Alpha" }, { dwSoftware, "Software" } });
+	DWORD dwSecond = iImage.List('i', { { dwZeta, "Zeta" } });
+	DWORD dwRoot = iImage.Key("ROOT", TRUE, {}, 3, iImage.IndexRoot({ dwFirst, dwSecond }));
+	return iImage.Build(dwRoot);
+}
+
+static void TestRead() {
+	std::vector<BYTE> vImage = BuildHive();
+	REGHIVEBACKEND rHive;
+	REG_CHECK_EQ(rHive.Load(vImage.data(), vImage.size()), REG_SUCCESS);
+	REG_CHECK(rHive.Loaded());
+	{
+		// Sub keys of an ri list are enumerated list by list
+		REGKEY rRoot(&rHive);
+		std::vector<std::string> vKeys;
+		REG_CHECK_EQ(rRoot.Open(HKEY_LOCAL_MACHINE, "", KEY_READ), REG_SUCCESS);
+		REG_CHECK_EQ(rRoot.ListKeys(&vKeys), REG_SUCCESS);
+		REG_CHECK(vKeys == std::vector<std::string>({ "Alpha", "Software", "Zeta" }));
+
+		REGKEY rKey(&rHive);
+		REG_CHECK_EQ(rKey.Open(HKEY_LOCAL_MACHINE, "Zeta", KEY_READ), REG_SUCCESS);
+		REG_CHECK_EQ(rKey.Open(HKEY_LOCAL_MACHINE, "Missing", KEY_READ), REG_PATH_NOT_EXIST);
+		REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "SOFTWARE\\wide", KEY_READ), REG_SUCCESS);
+		REG_CHECK_EQ(rKey.Open(HKEY_LOCAL_MACHINE, "software", KEY_READ), REG_SUCCESS);
+
+		std::string cStr;
+		DWORD dwNum = 0;
+		std::vector<std::string> vList;
+		std::vector<BYTE> vBig;
+		REG_CHECK_EQ(rKey.ReadREGSZ("name", &cStr), REG_SUCCESS);
+		REG_CHECK(cStr == "hello");
+		REG_CHECK_EQ(rKey.ReadREGDWORD("Num", &dwNum), REG_SUCCESS);
+		REG_CHECK_EQ(dwNum, 42);
+		REG_CHECK_EQ(rKey.ReadREGDWORD("WIDE", &dwNum), REG_SUCCESS);
+		REG_CHECK_EQ(dwNum, 7);
+		REG_CHECK_EQ(rKey.ReadREGMULTISZ("List", &vList), REG_SUCCESS);
+		REG_CHECK(vList == std::vector<std::string>({ "a", "bb" }));
+		REG_CHECK_EQ(rKey.ReadREGBINARY("Big", &vBig), REG_SUCCESS);
+		REG_CHECK_EQ(vBig.size(), 20000);
+		BOOL bSame = TRUE;
+		for (size_t i = 0; i < vBig.size(); i++) bSame = bSame && (vBig[i] == static_cast<BYTE>(i * 7));
+		REG_CHECK(bSame);
+		REG_CHECK_EQ(rKey.ReadREGSZ("None", &cStr), REG_VALUE_NOT_EXIST);
+
+		std::vector<REGVALUEENTRY> vValues;
+		REG_CHECK_EQ(rKey.ListValues(&vValues, FALSE), REG_SUCCESS);
+		REG_CHECK_EQ(vValues.size(), 5);
+		REG_CHECK(vValues.size() == 5 && vValues[4].cName == "Wide" && vValues[4].dwType == REG_DWORD);
+
+		// The hive is read-only
+		REG_CHECK_EQ(rKey.WriteREGDWORD("Num", 1), REG_ACCESS_DENIED);
+		REG_CHECK(rKey.Create(HKEY_LOCAL_MACHINE, "Software\\New", KEY_ALL_ACCESS) != REG_SUCCESS);
+	}
+	REG_CHECK_EQ(rHive.Unload(), REG_SUCCESS);
+	REG_CHECK(!rHive.Loaded());
+}
+
+// A non-ASCII name in an lh list is hashed by the kernel over its upcased UTF-16 form
+static void TestNonAscii() {
+	HIVEIMAGE iImage;
+	DWORD dwCafe = iImage.Key("Cafe", TRUE, {}, 0, 0);
+	DWORD dwAccent = iImage.Key("Caf\xE9", FALSE, {}, 0, 0);
+	DWORD dwRoot = iImage.Key("ROOT", TRUE, {}, 2, iImage.List('h', { { dwCafe, "Cafe" }, { dwAccent, "Caf\xE9" } }));
+	std::vector<BYTE> vImage = iImage.Build(dwRoot);
+	REGHIVEBACKEND rHive;
+	REG_CHECK_EQ(rHive.Load(vImage.data(), vImage.size()), REG_SUCCESS);
+
+	REGKEY rKey(&rHive);
+	REG_CHECK_EQ(rKey.Open(HKEY_LOCAL_MACHINE, "CAF\xE9", KEY_READ), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.Open(HKEY_LOCAL_MACHINE, "cafe", KEY_READ), REG_SUCCESS);
+	REGKEY rRoot(&rHive);
+	REGKEY rSon(&rHive);
+	REG_CHECK_EQ(rRoot.Open(HKEY_LOCAL_MACHINE, "", KEY_READ), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.GetSon("Caf\xE9", &rSon, KEY_READ), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.GetSon("Caf\xE8", &rSon, KEY_READ), REG_PATH_NOT_EXIST);
+}
+
+static void TestInvalid() {
+	std::vector<BYTE> vImage = BuildHive();
+	REGHIVEBACKEND rHive;
+	REG_CHECK_EQ(rHive.Load(vImage.data(), 0x800), REG_INVAILD_FILE);
+
+	std::vector<BYTE> vBad = vImage;
+	vBad[0] = 'x';
+	REG_CHECK_EQ(rHive.Load(vBad.data(), vBad.size()), REG_INVAILD_FILE);
+
+	// Root cell outside the bins
+	vBad = vImage;
+	HIVEIMAGE::Put32(&vBad, 0x24, static_cast<DWORD>(vImage.size()));
+	REG_CHECK_EQ(rHive.Load(vBad.data(), vBad.size()), REG_INVAILD_FILE);
+	REG_CHECK(!rHive.Loaded());
+
+	// A sub key list outside the bins is reported as corrupt
+	vBad = vImage;
+	DWORD dwRoot = 0;
+	memcpy(&dwRoot, vImage.data() + 0x24, sizeof(DWORD));
+	HIVEIMAGE::Put32(&vBad, 0x1000 + dwRoot + 4 + 0x1C, 0x7FFFFFF0);
+	REG_CHECK_EQ(rHive.Load(vBad.data(), vBad.size()), REG_SUCCESS);
+	{
+		REGKEY rKey(&rHive);
+		REG_CHECK_EQ(rKey.Open(HKEY_LOCAL_MACHINE, "", KEY_READ), REG_SUCCESS);
+		std::vector<std::string> vKeys;
+		REG_CHECK(rKey.ListKeys(&vKeys) != REG_SUCCESS);
+	}
+	rHive.Unload();
+}
+
+int main() {
+	TestRead();
+	TestNonAscii();
+	TestInvalid();
+	return REG_TEST_RESULT();
+}
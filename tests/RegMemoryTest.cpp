@@ -0,0 +1,360 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include "RegAsync.h"
+#include "RegBatch.h"
+#include "RegCache.h"
+#include "RegCounting.h"
+#include <atomic>
+#include <thread>
+
+static void TestKeys(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\Test", KEY_READ), REG_PATH_NOT_EXIST);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Test\\Sub", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGSZ("Name", "hello"), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("Num", 42), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGQWORD("Big", 1ULL << 40), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGMULTISZ("List", std::vector<LPCSTR>{ "a", "bb" }), REG_SUCCESS);
+
+	// Names are case-insensitive
+	REGKEY rOther(pBackend);
+	REG_CHECK_EQ(rOther.Open(HKEY_CURRENT_USER, "SOFTWARE\\test\\SUB", KEY_READ), REG_SUCCESS);
+	std::string cStr;
+	DWORD dwNum = 0;
+	QWORD ullBig = 0;
+	std::vector<std::string> vList;
+	REG_CHECK_EQ(rOther.ReadREGSZ("name", &cStr), REG_SUCCESS);
+	REG_CHECK(cStr == "hello");
+	REG_CHECK_EQ(rOther.ReadREGDWORD("NUM", &dwNum), REG_SUCCESS);
+	REG_CHECK_EQ(dwNum, 42);
+	REG_CHECK_EQ(rOther.ReadREGQWORD("Big", &ullBig), REG_SUCCESS);
+	REG_CHECK_EQ(ullBig, 1ULL << 40);
+	REG_CHECK_EQ(rOther.ReadREGMULTISZ("List", &vList), REG_SUCCESS);
+	REG_CHECK(vList.size() == 2 && vList[1] == "bb");
+	REG_CHECK_EQ(rOther.ReadREGDWORD("Name", &dwNum), REG_INCORRECT_TYPE);
+	REG_CHECK_EQ(rOther.ReadREGSZ("None", &cStr), REG_VALUE_NOT_EXIST);
+
+	// A failed read leaves a preset default untouched
+	std::string cDefault = "default";
+	REG_CHECK_EQ(rOther.ReadREGSZ("None", &cDefault), REG_VALUE_NOT_EXIST);
+	REG_CHECK(cDefault == "default");
+	REG_CHECK_EQ(rOther.ReadREGEXPANDSZ("Name", &cDefault), REG_INCORRECT_TYPE);
+	REG_CHECK(cDefault == "default");
+	std::vector<BYTE> vDefault = { 1, 2, 3 };
+	REG_CHECK_EQ(rOther.ReadREGBINARY("Num", &vDefault), REG_INCORRECT_TYPE);
+	REG_CHECK(vDefault == std::vector<BYTE>({ 1, 2, 3 }));
+	DWORD dwType = REG_NONE;
+	REG_CHECK_EQ(rOther.ReadValue("None", &dwType, &vDefault), REG_VALUE_NOT_EXIST);
+	REG_CHECK(vDefault == std::vector<BYTE>({ 1, 2, 3 }) && dwType == REG_NONE);
+	REG_CHECK_EQ(rOther.ReadREGSZ("Name", &cDefault), REG_SUCCESS);
+	REG_CHECK(cDefault == "hello");
+
+	// Enumeration
+	std::vector<REGVALUEENTRY> vValues;
+	REG_CHECK_EQ(rOther.ListValues(&vValues, TRUE), REG_SUCCESS);
+	REG_CHECK_EQ(vValues.size(), 4);
+	REG_CHECK(vValues[0].cName == "Name" && vValues[0].dwType == REG_SZ);
+	REGKEY rParent(pBackend);
+	std::vector<std::string> vKeys;
+	REG_CHECK_EQ(rParent.Open(HKEY_CURRENT_USER, "Software\\Test", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rParent.ListKeys(&vKeys), REG_SUCCESS);
+	REG_CHECK(vKeys.size() == 1 && vKeys[0] == "Sub");
+
+	// Batch read: a missing value fails only its own entry
+	REGBATCHVALUE vBatch[3] = {
+		{ "Name", REG_SZ, REG_SUCCESS, 0, nullptr, 0 },
+		{ "Missing", REG_ANY_TYPE, REG_SUCCESS, 0, nullptr, 0 },
+		{ "Num", REG_DWORD, REG_SUCCESS, 0, nullptr, 0 }
+	};
+	std::vector<BYTE> vBuffer;
+	REG_CHECK_EQ(rOther.ReadValues(vBatch, 3, &vBuffer), REG_SUCCESS);
+	REG_CHECK_EQ(vBatch[0].hRes, REG_SUCCESS);
+	REG_CHECK_EQ(vBatch[1].hRes, REG_VALUE_NOT_EXIST);
+	REG_CHECK_EQ(vBatch[2].hRes, REG_SUCCESS);
+	REG_CHECK(vBatch[2].dwSize == sizeof(DWORD) && *reinterpret_cast<const DWORD*>(vBatch[2].lpData) == 42);
+
+	REG_CHECK_EQ(rOther.DeleteValue("Name"), REG_SUCCESS);
+	REG_CHECK_EQ(rOther.ReadREGSZ("Name", &cStr), REG_VALUE_NOT_EXIST);
+	REG_CHECK_EQ(rParent.DeleteTree(), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\Test", KEY_READ), REG_PATH_NOT_EXIST);
+}
+
+// A warm typed read costs exactly one backend call
+static void TestCalls(REGMEMORYBACKEND* pBackend) {
+	REGCOUNTINGBACKEND rCounting(pBackend);
+	REGKEY rKey(&rCounting);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Calls", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("Num", 7), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGSZ("Name", "value"), REG_SUCCESS);
+	DWORD dwNum = 0;
+	std::string cStr;
+	REG_CHECK_EQ(rKey.ReadREGSZ("Name", &cStr), REG_SUCCESS);
+
+	rCounting.Reset();
+	REG_CHECK_EQ(rKey.ReadREGDWORD("Num", &dwNum), REG_SUCCESS);
+	REG_CHECK_EQ(dwNum, 7);
+	REG_CHECK_EQ(rCounting.GetCount(REG_OP_QUERYVALUE), 1);
+	REG_CHECK_EQ(rCounting.GetTotal(), 1);
+	rCounting.Reset();
+	REG_CHECK_EQ(rKey.ReadREGSZ("Name", &cStr), REG_SUCCESS);
+	REG_CHECK(cStr == "value");
+	REG_CHECK_EQ(rCounting.GetCount(REG_OP_QUERYVALUE), 1);
+	REG_CHECK_EQ(rCounting.GetTotal(), 1);
+	// A miss or a wrong type is found by the same single call
+	rCounting.Reset();
+	REG_CHECK_EQ(rKey.ReadREGDWORD("Name", &dwNum), REG_INCORRECT_TYPE);
+	REG_CHECK_EQ(rKey.ReadREGSZ("Missing", &cStr), REG_VALUE_NOT_EXIST);
+	REG_CHECK_EQ(rCounting.GetTotal(), 2);
+
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+}
+
+// A key deleted and created again behind the pool is opened again, not reused
+static void TestStaleHandle(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Stale", KEY_ALL_ACCESS), REG_SUCCESS);
+	HKEY hParent = NULL;
+	HKEY hKey = NULL;
+	REG_CHECK_EQ(pBackend->OpenKey(HKEY_CURRENT_USER, "Software", KEY_ALL_ACCESS, FALSE, &hParent), ERROR_SUCCESS);
+	REG_CHECK_EQ(pBackend->DeleteKey(hParent, "Stale", KEY_ALL_ACCESS), ERROR_SUCCESS);
+	REG_CHECK_EQ(pBackend->OpenKey(hParent, "Stale", KEY_ALL_ACCESS, TRUE, &hKey), ERROR_SUCCESS);
+
+	REGKEY rAgain(pBackend);
+	REG_CHECK_EQ(rAgain.Open(HKEY_CURRENT_USER, "Software\\Stale", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rAgain.WriteREGDWORD("Num", 7), REG_SUCCESS);
+	DWORD dwNum = 0;
+	DWORD dwSize = sizeof(dwNum);
+	REG_CHECK_EQ(pBackend->QueryValue(hKey, "Num", nullptr, reinterpret_cast<BYTE*>(&dwNum), &dwSize), ERROR_SUCCESS);
+	REG_CHECK_EQ(dwNum, 7);
+	// The old handle still points to the deleted key
+	REG_CHECK(rKey.WriteREGDWORD("Num", 8) != REG_SUCCESS);
+
+	pBackend->CloseKey(hKey);
+	REG_CHECK_EQ(pBackend->DeleteKey(hParent, "Stale", KEY_ALL_ACCESS), ERROR_SUCCESS);
+	pBackend->CloseKey(hParent);
+}
+
+static std::vector<std::string> vWalked;
+static void RecordKey(const REGKEY* pParent, LPCSTR lpName) {
+	std::string cPath;
+	pParent->GetPath(&cPath);
+	vWalked.push_back(cPath + "\\" + lpName);
+}
+
+// The ordered parallel walk reports the keys of the sequential walk in the same order, also when it has more keys
+// than fit in its window
+static void TestOrderedWalk(REGMEMORYBACKEND* pBackend) {
+	REGKEY rRoot(pBackend);
+	REG_CHECK_EQ(rRoot.Create(HKEY_CURRENT_USER, "Software\\Walk", KEY_ALL_ACCESS), REG_SUCCESS);
+	for (INT i = 0; i < 40; i++) {
+		for (INT j = 0; j < 60; j++) {
+			REGKEY rKey(pBackend);
+			std::string cPath = "Software\\Walk\\K" + std::to_string(i) + "\\S" + std::to_string(j);
+			REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, cPath.c_str(), KEY_ALL_ACCESS), REG_SUCCESS);
+		}
+	}
+	vWalked.clear();
+	REG_CHECK_EQ(rRoot.EnumAllKey(RecordKey), REG_SUCCESS);
+	std::vector<std::string> vSequential;
+	vSequential.swap(vWalked);
+	REG_CHECK_EQ(vSequential.size(), 40 * 61);
+	REGENUMOPTIONS oOptions = { 4, 0, REGENUM_ORDERED };
+	REG_CHECK_EQ(rRoot.EnumAllKey(RecordKey, oOptions), REG_SUCCESS);
+	REG_CHECK(vWalked == vSequential);
+	REG_CHECK_EQ(rRoot.DeleteTree(), REG_SUCCESS);
+}
+
+// Misses read the backend outside the cache lock while other threads hit and the values change. The read after the
+// last notification returns the last value.
+static void TestCache(REGMEMORYBACKEND* pBackend) {
+	REGSIMNOTIFYSOURCE rSource;
+	REGVALUECACHE rCache(pBackend, &rSource);
+	REGKEY rKey[4] = { REGKEY(pBackend), REGKEY(pBackend), REGKEY(pBackend), REGKEY(pBackend) };
+	for (INT i = 0; i < 4; i++) {
+		std::string cPath = "Software\\Cache\\K" + std::to_string(i);
+		REG_CHECK_EQ(rKey[i].Create(HKEY_CURRENT_USER, cPath.c_str(), KEY_ALL_ACCESS), REG_SUCCESS);
+		REG_CHECK_EQ(rKey[i].WriteREGDWORD("Num", 0), REG_SUCCESS);
+	}
+	std::atomic<bool> bStop(false);
+	std::atomic<INT> iFailed(0);
+	std::vector<std::thread> vThreads;
+	for (INT t = 0; t < 4; t++) {
+		vThreads.emplace_back([&rCache, &bStop, &iFailed, t]() {
+			while (!bStop.load()) {
+				std::string cPath = "Software\\Cache\\K" + std::to_string(t % 2);
+				DWORD dwNum = 0;
+				if (rCache.ReadREGDWORD(HKEY_CURRENT_USER, cPath.c_str(), "Num", &dwNum) != REG_SUCCESS) iFailed.fetch_add(1);
+			}
+		});
+	}
+	for (DWORD n = 1; n <= 500; n++) {
+		INT i = n % 4;
+		std::string cPath = "Software\\Cache\\K" + std::to_string(i);
+		REG_CHECK_EQ(rKey[i].WriteREGDWORD("Num", n), REG_SUCCESS);
+		rSource.Notify(HKEY_CURRENT_USER, cPath.c_str());
+	}
+	bStop.store(true);
+	for (std::thread& tThread : vThreads) tThread.join();
+	REG_CHECK_EQ(iFailed.load(), 0);
+	for (INT i = 0; i < 4; i++) {
+		std::string cPath = "Software\\Cache\\K" + std::to_string(i);
+		DWORD dwNum = 0;
+		REG_CHECK_EQ(rCache.ReadREGDWORD(HKEY_CURRENT_USER, cPath.c_str(), "Num", &dwNum), REG_SUCCESS);
+		REG_CHECK_EQ(dwNum, static_cast<DWORD>(i == 0 ? 500 : 496 + i));
+	}
+	REGKEY rRoot(pBackend);
+	REG_CHECK_EQ(rRoot.Open(HKEY_CURRENT_USER, "Software\\Cache", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.DeleteTree(), REG_SUCCESS);
+}
+
+// A failed batch restores the values and deletes the keys it created
+static void TestRollback(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Roll", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("X", 1), REG_SUCCESS);
+	REGWRITEBATCH rBatch;
+	rBatch.PutREGDWORD(HKEY_CURRENT_USER, "Software\\Roll\\New\\Deep", "V", 2);
+	rBatch.PutREGDWORD(HKEY_CURRENT_USER, "Software\\Roll", "X", 3);
+	rBatch.PutREGDWORD(HKEY_CURRENT_USER, "Software\\Roll\\New\\Other", "V", 4);
+	// A key name over 255 characters fails the batch
+	rBatch.PutREGDWORD(HKEY_CURRENT_USER, ("Software\\Roll\\" + std::string(300, 'k')).c_str(), "V", 5);
+	REG_CHECK(rBatch.Apply(pBackend, TRUE) != REG_SUCCESS);
+	DWORD dwValue = 0;
+	REG_CHECK_EQ(rKey.ReadREGDWORD("X", &dwValue), REG_SUCCESS);
+	REG_CHECK_EQ(dwValue, 1);
+	REGKEY rNew(pBackend);
+	REG_CHECK_EQ(rNew.Open(HKEY_CURRENT_USER, "Software\\Roll\\New", KEY_READ), REG_PATH_NOT_EXIST);
+
+	// Without rollback the keys are kept
+	REG_CHECK(rBatch.Apply(pBackend, FALSE) != REG_SUCCESS);
+	REG_CHECK_EQ(rNew.Open(HKEY_CURRENT_USER, "Software\\Roll\\New\\Deep", KEY_READ), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+}
+
+// A read queued before a create runs on the missing key
+static void TestBatch(REGMEMORYBACKEND* pBackend) {
+	REGIOPOOL rPool(1, 16, pBackend);
+	std::atomic<BOOL> bRelease(FALSE);
+	std::atomic<INT> iDone(0);
+	std::atomic<HRESULT> hRead(REG_SUCCESS), hCreate(REG_CANCELLED);
+	// Hold the only worker until both requests are queued
+	REG_CHECK_EQ(rPool.Submit(HKEY_CURRENT_USER, "Software", KEY_READ, FALSE, [&](const REGKEY& rKey) {
+		while (!bRelease) std::this_thread::yield();
+		return REG_SUCCESS;
+	}, [&](HRESULT hRes) { iDone++; }), REG_SUCCESS);
+	REG_CHECK_EQ(rPool.Submit(HKEY_CURRENT_USER, "Software\\Batch", KEY_READ, FALSE, [](const REGKEY& rKey) { return REG_SUCCESS; },
+		[&](HRESULT hRes) {
+			hRead = hRes;
+			iDone++;
+		}), REG_SUCCESS);
+	REG_CHECK_EQ(rPool.Submit(HKEY_CURRENT_USER, "Software\\Batch", KEY_ALL_ACCESS, TRUE, [](const REGKEY& rKey) { return REG_SUCCESS; },
+		[&](HRESULT hRes) {
+			hCreate = hRes;
+			iDone++;
+		}), REG_SUCCESS);
+	bRelease = TRUE;
+	while (iDone < 3) std::this_thread::yield();
+	REG_CHECK_EQ(hRead.load(), REG_PATH_NOT_EXIST);
+	REG_CHECK_EQ(hCreate.load(), REG_SUCCESS);
+
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\Batch", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.Delete(), REG_SUCCESS);
+}
+
+#ifdef REGASYNC_COROUTINE
+static REGDETACHEDTASK AsyncSequence(REGIOPOOL* pPool, REGEXECUTOR* pExecutor, BOOL* pbDone) {
+	REGVALUE rValue;
+	rValue.SetDWORD(7);
+	REGASYNCRESULT<REGVALUE> rWrite = co_await WriteAsync(*pPool, HKEY_CURRENT_USER, "Software\\Async", "Value", rValue, pExecutor);
+	REG_CHECK_EQ(rWrite.hRes, REG_SUCCESS);
+	REGASYNCRESULT<REGVALUE> rRead = co_await ReadAsync(*pPool, HKEY_CURRENT_USER, "software\\ASYNC", "Value", pExecutor);
+	REG_CHECK_EQ(rRead.hRes, REG_SUCCESS);
+	REG_CHECK(rRead.rValue.GetIf<DWORD>() != nullptr && *rRead.rValue.GetIf<DWORD>() == 7);
+	REGASYNCRESULT<REGENUMRESULT> rEnum = co_await EnumAsync(*pPool, HKEY_CURRENT_USER, "Software", pExecutor);
+	REG_CHECK_EQ(rEnum.hRes, REG_SUCCESS);
+	REG_CHECK(rEnum.rValue.vKeys.size() == 1 && rEnum.rValue.vKeys[0] == "Async");
+	REGASYNCRESULT<REGKEY> rOpen = co_await OpenAsync(*pPool, HKEY_CURRENT_USER, "Software\\Missing", KEY_READ, FALSE, pExecutor);
+	REG_CHECK_EQ(rOpen.hRes, REG_PATH_NOT_EXIST);
+	*pbDone = TRUE;
+}
+
+static void TestAsync(REGMEMORYBACKEND* pBackend) {
+	REGDELAYBACKEND rSlow(pBackend, 1);
+	{
+		// Completions are delivered on the thread running the executor
+		REGIOPOOL rPool(2, 16, &rSlow);
+		REGQUEUEEXECUTOR rExecutor;
+		BOOL bDone = FALSE;
+		AsyncSequence(&rPool, &rExecutor, &bDone);
+		while (!bDone) {
+			rExecutor.WaitPending(100);
+			rExecutor.RunPending();
+		}
+	}
+	{
+		// A full queue refuses requests; cancelled requests complete with REG_CANCELLED
+		REGIOPOOL rPool(1, 2, &rSlow);
+		REGCANCELSOURCE rCancel;
+		REGQUEUEEXECUTOR rExecutor;
+		INT iCancelled = 0, iDone = 0;
+		HRESULT hRes[4];
+		for (INT i = 0; i < 4; i++) {
+			hRes[i] = rPool.Submit(HKEY_CURRENT_USER, "Software\\Async", KEY_READ, FALSE, [](const REGKEY& rKey) { return REG_SUCCESS; },
+				[&](HRESULT hDone) {
+					iDone++;
+					if (hDone == REG_CANCELLED) iCancelled++;
+				}, &rExecutor, rCancel.GetToken());
+		}
+		rCancel.Cancel();
+		INT iQueued = 0;
+		for (INT i = 0; i < 4; i++) {
+			if (hRes[i] == REG_SUCCESS) iQueued++;
+			else REG_CHECK_EQ(hRes[i], REG_QUEUE_FULL);
+		}
+		REG_CHECK(iQueued >= 2);
+		while (iDone < iQueued) {
+			rExecutor.WaitPending(100);
+			rExecutor.RunPending();
+		}
+		REG_CHECK(iCancelled >= 1);
+	}
+}
+#endif
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	TestKeys(&rBackend);
+	TestStaleHandle(&rBackend);
+	TestCalls(&rBackend);
+	TestOrderedWalk(&rBackend);
+	TestCache(&rBackend);
+	TestRollback(&rBackend);
+	TestBatch(&rBackend);
+#ifdef REGASYNC_COROUTINE
+	TestAsync(&rBackend);
+#endif
+	return REG_TEST_RESULT();
+}
@@ -0,0 +1,161 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include "RegMetrics.h"
+#include <thread>
+
+#ifndef REGKEY_NO_METRICS
+
+static void ClearSnapshot(REGMETRICSSNAPSHOT* pSnap) {
+	for (REGMETRICSSNAPSHOT::OPSTATS& rOp : pSnap->rOps) {
+		rOp = REGMETRICSSNAPSHOT::OPSTATS();
+		rOp.vHistogram.assign(REG_METRIC_BUCKETS, 0);
+	}
+	pSnap->vFailures.clear();
+}
+
+// Exact up to REG_METRIC_SUB_COUNT, then REG_METRIC_SUB_COUNT linear buckets per power of two
+static void TestBuckets() {
+	for (DWORD i = 0; i < 2 * REG_METRIC_SUB_COUNT; i++) REG_CHECK_EQ(GetRegMetricBucketLow(i), i);
+	REG_CHECK_EQ(GetRegMetricBucketLow(2 * REG_METRIC_SUB_COUNT + 1), 34);
+	REG_CHECK_EQ(GetRegMetricBucketLow(3 * REG_METRIC_SUB_COUNT), 64);
+	REG_CHECK_EQ(GetRegMetricBucketLow(100), 640);
+	// The last bucket holds the clamped latencies up to 2^37 - 1 ns
+	REG_CHECK_EQ(GetRegMetricBucketLow(REG_METRIC_BUCKETS - 1), 31ull << 32);
+	BOOL bGrowing = TRUE, bNarrow = TRUE;
+	for (DWORD i = 1; i < REG_METRIC_BUCKETS; i++) {
+		ULONGLONG ullLow = GetRegMetricBucketLow(i - 1), ullHigh = GetRegMetricBucketLow(i);
+		bGrowing = bGrowing && ullHigh > ullLow;
+		// A bucket is at most 1 / REG_METRIC_SUB_COUNT of its lowest value wide
+		bNarrow = bNarrow && (ullLow < REG_METRIC_SUB_COUNT || (ullHigh - ullLow) * REG_METRIC_SUB_COUNT <= ullLow);
+	}
+	REG_CHECK(bGrowing);
+	REG_CHECK(bNarrow);
+
+	// A percentile is the upper bound of the bucket holding its rank, capped by the maximum
+	REGMETRICSSNAPSHOT rSnap;
+	ClearSnapshot(&rSnap);
+	REGMETRICSSNAPSHOT::OPSTATS& rRead = rSnap.rOps[REG_METRIC_READ];
+	REG_CHECK_EQ(rSnap.GetPercentile(REG_METRIC_READ, 50.0), 0);
+	rRead.vHistogram[20] = 3;
+	rRead.vHistogram[100] = 1;
+	rRead.ullMaxNs = 700;
+	REG_CHECK_EQ(rSnap.GetPercentile(REG_METRIC_READ, 0.0), 20);
+	REG_CHECK_EQ(rSnap.GetPercentile(REG_METRIC_READ, 50.0), 20);
+	REG_CHECK_EQ(rSnap.GetPercentile(REG_METRIC_READ, 75.0), 20);
+	REG_CHECK_EQ(rSnap.GetPercentile(REG_METRIC_READ, 90.0), 671);
+	REG_CHECK_EQ(rSnap.GetPercentile(REG_METRIC_READ, 200.0), 671);
+	rRead.ullMaxNs = 650;
+	REG_CHECK_EQ(rSnap.GetPercentile(REG_METRIC_READ, 99.0), 650);
+}
+
+static void TestExport() {
+	REGMETRICSSNAPSHOT rSnap;
+	ClearSnapshot(&rSnap);
+	std::string cJson;
+	REG_CHECK_EQ(ExportRegMetrics(rSnap, nullptr), REG_INVAILD_POINTER);
+	REG_CHECK_EQ(ExportRegMetrics(rSnap, &cJson), REG_SUCCESS);
+	REG_CHECK(cJson == "{\"ops\":[],\"failures\":[]}");
+
+	REGMETRICSSNAPSHOT::OPSTATS& rRead = rSnap.rOps[REG_METRIC_READ];
+	rRead.ullCalls[REG_METRIC_ROOT_HKCU] = 3;
+	rRead.ullCalls[REG_METRIC_ROOT_HKLM] = 1;
+	rRead.ullFailures[REG_METRIC_ROOT_HKLM] = 1;
+	rRead.ullBytesRead = 40;
+	rRead.ullTotalNs = 4000;
+	rRead.ullMaxNs = 700;
+	rRead.vHistogram[20] = 3;
+	rRead.vHistogram[100] = 1;
+	rSnap.rOps[REG_METRIC_CLOSE].ullCalls[REG_METRIC_ROOT_OTHER] = 1;
+	rSnap.vFailures.push_back({ REG_METRIC_READ, REG_METRIC_ROOT_HKLM, ERROR_FILE_NOT_FOUND, 123 });
+	REG_CHECK_EQ(ExportRegMetrics(rSnap, &cJson), REG_SUCCESS);
+	REG_CHECK(cJson ==
+		"{\"ops\":["
+		"{\"op\":\"close\",\"calls\":1,\"failures\":0,\"bytes_read\":0,\"bytes_written\":0,\"mean_ns\":0,"
+		"\"p50_ns\":0,\"p90_ns\":0,\"p99_ns\":0,\"p999_ns\":0,\"max_ns\":0,\"roots\":{\"other\":{\"calls\":1,\"failures\":0}},\"histogram\":[]},"
+		"{\"op\":\"read\",\"calls\":4,\"failures\":1,\"bytes_read\":40,\"bytes_written\":0,\"mean_ns\":1000,"
+		"\"p50_ns\":20,\"p90_ns\":671,\"p99_ns\":671,\"p999_ns\":671,\"max_ns\":700,"
+		"\"roots\":{\"HKCU\":{\"calls\":3,\"failures\":0},\"HKLM\":{\"calls\":1,\"failures\":1}},\"histogram\":[[20,3],[640,1]]}],"
+		"\"failures\":[{\"op\":\"read\",\"root\":\"HKLM\",\"status\":2,\"time_ns\":123}]}");
+}
+
+// REGKEY operations are counted once per call, per root, from every thread
+static void TestRecord(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Metrics", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGSZ("Name", "abcdefg"), REG_SUCCESS);
+	ResetRegMetrics();
+
+	std::string cStr;
+	for (INT i = 0; i < 3; i++) REG_CHECK_EQ(rKey.ReadREGSZ("Name", &cStr), REG_SUCCESS);
+	REG_CHECK_EQ(GetRegLastStatus(), ERROR_SUCCESS);
+	REG_CHECK_EQ(rKey.ReadREGSZ("None", &cStr), REG_VALUE_NOT_EXIST);
+	REG_CHECK_EQ(GetRegLastStatus(), ERROR_FILE_NOT_FOUND);
+	std::thread tOther([pBackend]() {
+		REGKEY rOther(pBackend);
+		DWORD dwVal = 0;
+		REG_CHECK_EQ(rOther.Open(HKEY_CURRENT_USER, "Software\\Metrics", KEY_ALL_ACCESS), REG_SUCCESS);
+		REG_CHECK_EQ(rOther.WriteREGDWORD("Num", 5), REG_SUCCESS);
+		REG_CHECK_EQ(rOther.ReadREGDWORD("Num", &dwVal), REG_SUCCESS);
+	});
+	tOther.join();
+
+	REGMETRICSSNAPSHOT rSnap;
+	CaptureRegMetrics(&rSnap);
+	const REGMETRICSSNAPSHOT::OPSTATS& rRead = rSnap.rOps[REG_METRIC_READ];
+	REG_CHECK_EQ(rSnap.GetCalls(REG_METRIC_READ), 5);
+	REG_CHECK_EQ(rRead.ullCalls[REG_METRIC_ROOT_HKCU], 5);
+	REG_CHECK_EQ(rSnap.GetFailures(REG_METRIC_READ), 1);
+	REG_CHECK_EQ(rRead.ullBytesRead, 3 * 8 + 4);
+	REG_CHECK_EQ(rSnap.GetCalls(REG_METRIC_WRITE), 1);
+	REG_CHECK_EQ(rSnap.rOps[REG_METRIC_WRITE].ullBytesWritten, 4);
+	REG_CHECK_EQ(rSnap.GetCalls(REG_METRIC_OPEN), 1);
+	ULONGLONG ullCount = 0;
+	for (ULONGLONG ullBucket : rRead.vHistogram) ullCount += ullBucket;
+	REG_CHECK_EQ(ullCount, 5);
+	REG_CHECK(rRead.ullMaxNs >= rSnap.GetPercentile(REG_METRIC_READ, 50.0));
+	REG_CHECK_EQ(rSnap.vFailures.size(), 1);
+	REG_CHECK(rSnap.vFailures[0].eOp == REG_METRIC_READ && rSnap.vFailures[0].eRoot == REG_METRIC_ROOT_HKCU);
+	REG_CHECK_EQ(rSnap.vFailures[0].lStatus, ERROR_FILE_NOT_FOUND);
+
+	// A reset drops the counters of every thread
+	ResetRegMetrics();
+	CaptureRegMetrics(&rSnap);
+	REG_CHECK_EQ(rSnap.GetCalls(REG_METRIC_READ), 0);
+	REG_CHECK_EQ(rSnap.vFailures.size(), 0);
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+}
+
+#endif
+
+int main() {
+#ifndef REGKEY_NO_METRICS
+	REGMEMORYBACKEND rBackend;
+	TestBuckets();
+	TestExport();
+	TestRecord(&rBackend);
+#endif
+	return REG_TEST_RESULT();
+}
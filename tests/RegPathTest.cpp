@@ -0,0 +1,121 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include "RegPath.h"
+#include <atomic>
+#include <thread>
+
+static std::atomic<LONG> lVisited(0);
+static void CountKey(const REGKEY* pParent, LPCSTR lpName) {
+	lVisited++;
+}
+
+static void TestRoundTrip() {
+	REGPATHTABLE* pTable = GetRegPathTable();
+	REGPATHID idPath = pTable->Intern("Software\\Test\\Key");
+	REGPATHID idOther = pTable->Intern("SOFTWARE\\test\\KEY");
+	std::string cPath;
+	pTable->GetPath(idOther, &cPath);
+	REG_CHECK(cPath == "SOFTWARE\\test\\KEY");
+	REG_CHECK(idPath != idOther && pTable->Equals(idPath, idOther));
+	REG_CHECK(pTable->IsBelow(idOther, pTable->GetParent(idPath)));
+	REGPATHID idSon = pTable->Append(idPath, "Son");
+	REG_CHECK(pTable->GetParent(idSon) == idPath);
+	REG_CHECK_EQ(pTable->GetLength(idSon), strlen("Software\\Test\\Key\\Son"));
+	pTable->Release(idSon);
+	pTable->Release(idOther);
+	pTable->Release(idPath);
+}
+
+// Paths nothing holds are freed, so a scan leaves the table as it found it
+static void TestBounded(REGMEMORYBACKEND* pBackend) {
+	REGPATHTABLE* pTable = GetRegPathTable();
+	size_t ulBefore = pTable->GetCount();
+	REGKEY rRoot(pBackend);
+	REG_CHECK_EQ(rRoot.Create(HKEY_CURRENT_USER, "Software\\Scan", KEY_ALL_ACCESS), REG_SUCCESS);
+	for (INT i = 0; i < 200; i++) {
+		REGKEY rKey(pBackend);
+		std::string cPath = "Software\\Scan\\K" + std::to_string(i) + "\\Sub";
+		REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, cPath.c_str(), KEY_ALL_ACCESS), REG_SUCCESS);
+	}
+	size_t ulOpen = pTable->GetCount();
+	REG_CHECK_EQ(ulOpen, ulBefore + 2);
+
+	for (DWORD dwFlags : { 0, REGENUM_ORDERED }) {
+		REGENUMOPTIONS oOptions = { 4, 0, dwFlags };
+		lVisited = 0;
+		REG_CHECK_EQ(rRoot.EnumAllKey(CountKey, oOptions), REG_SUCCESS);
+		REG_CHECK_EQ(lVisited.load(), 400);
+		REG_CHECK_EQ(pTable->GetCount(), ulOpen);
+	}
+	lVisited = 0;
+	REG_CHECK_EQ(rRoot.EnumAllKey(CountKey), REG_SUCCESS);
+	REG_CHECK_EQ(lVisited.load(), 400);
+	REG_CHECK_EQ(pTable->GetCount(), ulOpen);
+
+	// Freed ids are reused with their new spelling
+	REGKEY rSon(pBackend);
+	REG_CHECK_EQ(rRoot.GetSon("k7", &rSon, KEY_READ), REG_SUCCESS);
+	std::string cPath;
+	REG_CHECK_EQ(rSon.GetPath(&cPath), REG_SUCCESS);
+	REG_CHECK(cPath == "Software\\Scan\\k7");
+	rSon.Close();
+	REG_CHECK_EQ(rRoot.DeleteTree(), REG_SUCCESS);
+	rRoot.Close();
+	REG_CHECK_EQ(pTable->GetCount(), ulBefore);
+}
+
+// Threads intern and release the same paths while others are freed
+static void TestConcurrent() {
+	REGPATHTABLE* pTable = GetRegPathTable();
+	size_t ulBefore = pTable->GetCount();
+	std::vector<std::thread> vThreads;
+	std::atomic<LONG> lErrors(0);
+	for (INT t = 0; t < 4; t++) {
+		vThreads.emplace_back([pTable, t, &lErrors]() {
+			std::string cPath;
+			for (INT i = 0; i < 2000; i++) {
+				std::string cWant = "Root\\A" + std::to_string(i % 16) + "\\B" + std::to_string((i + t) % 8);
+				REGPATHID idPath = pTable->Intern(cWant);
+				REGPATHID idCopy = pTable->Append(pTable->GetParent(idPath), "b" + std::to_string((i + t) % 8));
+				pTable->GetPath(idPath, &cPath);
+				if (cPath != cWant || !pTable->Equals(idPath, idCopy)) lErrors++;
+				pTable->Release(idCopy);
+				pTable->Release(idPath);
+			}
+		});
+	}
+	for (std::thread& tThread : vThreads) tThread.join();
+	REG_CHECK_EQ(lErrors.load(), 0);
+	REG_CHECK_EQ(pTable->GetCount(), ulBefore);
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	TestRoundTrip();
+	TestBounded(&rBackend);
+	TestConcurrent();
+	return REG_TEST_RESULT();
+}
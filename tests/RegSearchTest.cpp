@@ -0,0 +1,199 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include "RegCounting.h"
+#include "RegSearch.h"
+#include <algorithm>
+
+static CHAR RefFold(CHAR c) {
+	return (c >= 'A' && c <= 'Z') ? static_cast<CHAR>(c - 'A' + 'a') : c;
+}
+
+static size_t RefFind(std::string_view vHay, std::string_view vNeedle) {
+	std::string cHay(vHay), cNeedle(vNeedle);
+	std::transform(cHay.begin(), cHay.end(), cHay.begin(), RefFold);
+	std::transform(cNeedle.begin(), cNeedle.end(), cNeedle.begin(), RefFold);
+	return cHay.find(cNeedle);
+}
+
+// Backtracking glob, '*' any characters and '?' one character
+static BOOL RefGlob(std::string_view vPattern, std::string_view vName) {
+	if (vPattern.empty()) return vName.empty();
+	if (vPattern[0] == '*') return RefGlob(vPattern.substr(1), vName) || (!vName.empty() && RefGlob(vPattern, vName.substr(1)));
+	if (vName.empty()) return FALSE;
+	if (vPattern[0] != '?' && RefFold(vPattern[0]) != RefFold(vName[0])) return FALSE;
+	return RefGlob(vPattern.substr(1), vName.substr(1));
+}
+
+// Every needle position and length around the 16-byte blocks, in both cases
+static void TestFind() {
+	std::string cHay;
+	for (size_t i = 0; i < 80; i++) cHay.push_back(static_cast<CHAR>((i % 3 == 0 ? 'A' : 'a') + (i * 7) % 26));
+	std::string cUpper(cHay);
+	std::transform(cUpper.begin(), cUpper.end(), cUpper.begin(), [](CHAR c) { return static_cast<CHAR>(c >= 'a' && c <= 'z' ? c - 32 : c); });
+	BOOL bSame = TRUE;
+	for (size_t ulLen = 1; ulLen <= 20; ulLen++) {
+		for (size_t ulPos = 0; ulPos + ulLen <= cHay.size(); ulPos++) {
+			std::string_view vNeedle = std::string_view(cUpper).substr(ulPos, ulLen);
+			for (size_t ulHay = ulPos + ulLen; ulHay <= cHay.size(); ulHay += 7) {
+				std::string_view vHay = std::string_view(cHay).substr(0, ulHay);
+				bSame = bSame && FindNoCase(vHay, vNeedle) == RefFind(vHay, vNeedle);
+			}
+		}
+	}
+	REG_CHECK(bSame);
+	REG_CHECK_EQ(FindNoCase(cHay, ""), 0);
+	REG_CHECK(FindNoCase("abc", "abcd") == std::string_view::npos);
+	REG_CHECK(FindNoCase(cHay, "zzz") == std::string_view::npos);
+	// A match that only the scalar tail can hold
+	REG_CHECK_EQ(FindNoCase("0123456789abcdef0123456789ABCDEF_xY", "f_XY"), 31);
+	// Only ASCII letters fold, and '@' / '[' next to the upper case range stay themselves
+	REG_CHECK(FindNoCase("0123456789abcdef\xC9" "abc", "\xE9" "ABC") == std::string_view::npos);
+	REG_CHECK(FindNoCase("0123456789abcdef`{", "@[") == std::string_view::npos);
+
+	// Whole name comparison across the vector width
+	std::string cLong(40, 'k');
+	std::string cOther(cLong);
+	cOther[33] = 'K';
+	REG_CHECK(EqualsNoCase(cLong, cOther));
+	cOther[20] = 'j';
+	REG_CHECK(!EqualsNoCase(cLong, cOther));
+	REG_CHECK(!EqualsNoCase(cLong, std::string(39, 'k')));
+	REG_CHECK(CompareNoCase("Alpha", "alpha") == 0);
+	REG_CHECK(CompareNoCase("alpha", "BETA") < 0 && CompareNoCase("Beta", "ALPHA") > 0);
+	REG_CHECK(CompareNoCase("Run", "runner") < 0 && CompareNoCase("_", "a") < 0);
+}
+
+static void TestPattern() {
+	LPCSTR lpPatterns[] = { "*", "run", "R?n", "*run*", "run*", "*RUN", "a*b*c", "*?*", "??", "*a*a*", "x*?y*", "" };
+	LPCSTR lpNames[] = { "", "Run", "RUN", "ran", "Runner", "autorun", "abc", "aXbYc", "acb", "banana", "xay", "xy", "xzzyq", "R" };
+	BOOL bSame = TRUE;
+	for (LPCSTR lpPattern : lpPatterns) {
+		REGNAMEPATTERN pPattern(lpPattern);
+		for (LPCSTR lpName : lpNames) bSame = bSame && pPattern.Match(lpName) == RefGlob(lpPattern, lpName);
+	}
+	REG_CHECK(bSame);
+
+	REG_CHECK(REGNAMEPATTERN("un", REG_MATCH_SUBSTRING).Match("RUNNER"));
+	REG_CHECK(!REGNAMEPATTERN("un", REG_MATCH_PREFIX).Match("RUNNER"));
+	REG_CHECK(REGNAMEPATTERN("ru", REG_MATCH_PREFIX).Match("RUNNER"));
+	REG_CHECK(!REGNAMEPATTERN("ru*", REG_MATCH_EXACT).Match("RUNNER"));
+	REG_CHECK(REGNAMEPATTERN("ru*", REG_MATCH_EXACT).Match("RU*"));
+	REG_CHECK(REGNAMEPATTERN("**").MatchesAll());
+	REG_CHECK(!REGNAMEPATTERN("*?").MatchesAll());
+	REG_CHECK(REGNAMEPATTERN("Run").IsLiteral());
+	REG_CHECK(!REGNAMEPATTERN("R?n").IsLiteral());
+	REG_CHECK(REGNAMEPATTERN("R?n", REG_MATCH_EXACT).IsLiteral());
+}
+
+// One reported item: path of the parent and name
+typedef std::vector<std::string> RESULTS;
+
+static RESULTS Search(const REGKEY& rKey, LPCSTR lpPath, LPCSTR lpName, DWORD dwMaxDepth, DWORD dwFlags) {
+	RESULTS vRes;
+	REGSEARCHOPTIONS rOptions = { lpPath, lpName, REG_MATCH_GLOB, dwMaxDepth, dwFlags };
+	REG_CHECK_EQ(rKey.Search(rOptions, [&](const REGSEARCHMATCH& rMatch) {
+		std::string cItem = std::string(rMatch.vPath) + "|" + rMatch.lpName;
+		// Values carry their data: the path of the key
+		if (rMatch.lpData != nullptr) cItem += "=" + std::string(reinterpret_cast<const CHAR*>(rMatch.lpData));
+		vRes.push_back(cItem);
+		return REG_VISIT_CONTINUE;
+	}), REG_SUCCESS);
+	std::sort(vRes.begin(), vRes.end());
+	return vRes;
+}
+
+// Tree below HKEY_CURRENT_USER\Software\Search:
+//   Run, A\Run, A\B\Run, A\B\C\Run (each with a value Cmd holding its path), Other\Runner
+static void TestSearch(REGMEMORYBACKEND* pBackend) {
+	LPCSTR lpKeys[] = { "Run", "A\\Run", "A\\B\\Run", "A\\B\\C\\Run" };
+	for (LPCSTR lpKey : lpKeys) {
+		REGKEY rKey(pBackend);
+		REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, (std::string("Software\\Search\\") + lpKey).c_str(), KEY_ALL_ACCESS), REG_SUCCESS);
+		REG_CHECK_EQ(rKey.WriteREGSZ("Cmd", lpKey), REG_SUCCESS);
+		REG_CHECK_EQ(rKey.WriteREGSZ("Other", "-"), REG_SUCCESS);
+	}
+	REGKEY rOther(pBackend);
+	REG_CHECK_EQ(rOther.Create(HKEY_CURRENT_USER, "Software\\Search\\Other\\Runner", KEY_ALL_ACCESS), REG_SUCCESS);
+	REGCOUNTINGBACKEND rCounting(pBackend);
+	REGKEY rRoot(&rCounting);
+	REG_CHECK_EQ(rRoot.Open(HKEY_CURRENT_USER, "Software\\Search", KEY_READ), REG_SUCCESS);
+
+	// "**" matches any number of keys, none included
+	REG_CHECK(Search(rRoot, "**\\Run", "cmd", 0, REGSEARCH_VALUES | REGSEARCH_DATA) ==
+		RESULTS({ "A\\B\\C\\Run|Cmd=A\\B\\C\\Run", "A\\B\\Run|Cmd=A\\B\\Run", "A\\Run|Cmd=A\\Run", "Run|Cmd=Run" }));
+	// A literal component is opened directly, so the path has its spelling
+	REG_CHECK(Search(rRoot, "a\\**\\run", "Cmd", 0, REGSEARCH_VALUES) == RESULTS({ "a\\B\\C\\Run|Cmd", "a\\B\\Run|Cmd", "a\\Run|Cmd" }));
+	REG_CHECK(Search(rRoot, "**\\B\\**\\Run", "Cmd", 0, REGSEARCH_VALUES) == RESULTS({ "A\\B\\C\\Run|Cmd", "A\\B\\Run|Cmd" }));
+	// '*' and '?' match exactly one key
+	REG_CHECK(Search(rRoot, "A\\*\\Run", "Cmd", 0, REGSEARCH_VALUES) == RESULTS({ "A\\B\\Run|Cmd" }));
+	REG_CHECK(Search(rRoot, "?\\Run", "Cmd", 0, REGSEARCH_VALUES) == RESULTS({ "A\\Run|Cmd" }));
+	REG_CHECK(Search(rRoot, "*\\*\\*\\Run", "Cmd", 0, REGSEARCH_VALUES) == RESULTS({ "A\\B\\C\\Run|Cmd" }));
+	// Items deeper than dwMaxDepth are not reported
+	REG_CHECK(Search(rRoot, "**\\Run", "Cmd", 2, REGSEARCH_VALUES) == RESULTS({ "Run|Cmd" }));
+	REG_CHECK(Search(rRoot, "**\\Run", "Cmd", 3, REGSEARCH_VALUES) == RESULTS({ "A\\Run|Cmd", "Run|Cmd" }));
+
+	// Sub keys of every key
+	REG_CHECK(Search(rRoot, "", "run*", 0, REGSEARCH_KEYS) == RESULTS({ "A\\B\\C|Run", "A\\B|Run", "A|Run", "Other|Runner", "|Run" }));
+	REG_CHECK(Search(rRoot, "**", "?", 0, REGSEARCH_KEYS) == RESULTS({ "A\\B|C", "A|B", "|A" }));
+	REG_CHECK(Search(rRoot, "Missing\\**", "*", 0, REGSEARCH_KEYS | REGSEARCH_VALUES).empty());
+
+	// A literal path is opened key by key, no sub keys are listed
+	rCounting.Reset();
+	REG_CHECK(Search(rRoot, "A\\B\\Run", "Cmd", 0, REGSEARCH_VALUES) == RESULTS({ "A\\B\\Run|Cmd" }));
+	REG_CHECK_EQ(rCounting.GetCount(REG_OP_ENUMKEY), 0);
+	// A sub tree that cannot match is not entered: only A, A\B, A\B\C and A\B\C\Run are opened
+	rCounting.Reset();
+	REG_CHECK(Search(rRoot, "?\\?\\?\\Run", "Cmd", 0, REGSEARCH_VALUES) == RESULTS({ "A\\B\\C\\Run|Cmd" }));
+	REG_CHECK_EQ(rCounting.GetCount(REG_OP_OPENKEY), 4);
+
+	// REG_VISIT_SKIP does not search below a key, REG_VISIT_STOP ends the search
+	REGSEARCHOPTIONS rOptions = { "**", "*", REG_MATCH_GLOB, 0, REGSEARCH_KEYS };
+	RESULTS vSkip;
+	REG_CHECK_EQ(rRoot.Search(rOptions, [&](const REGSEARCHMATCH& rMatch) {
+		vSkip.push_back(std::string(rMatch.vPath) + "|" + rMatch.lpName);
+		return EqualsNoCase(rMatch.lpName, "A") ? REG_VISIT_SKIP : REG_VISIT_CONTINUE;
+	}), REG_SUCCESS);
+	std::sort(vSkip.begin(), vSkip.end());
+	REG_CHECK(vSkip == RESULTS({ "Other|Runner", "|A", "|Other", "|Run" }));
+	size_t ulCount = 0;
+	REG_CHECK_EQ(rRoot.Search(rOptions, [&](const REGSEARCHMATCH&) { ulCount++; return REG_VISIT_STOP; }), REG_SUCCESS);
+	REG_CHECK_EQ(ulCount, 1);
+
+	// Too many path components
+	std::string cDeep;
+	for (INT i = 0; i < 64; i++) cDeep += "K\\";
+	rOptions.lpPath = cDeep.c_str();
+	REG_CHECK_EQ(rRoot.Search(rOptions, [](const REGSEARCHMATCH&) { return REG_VISIT_CONTINUE; }), REG_INVAILD_PATH);
+	REG_CHECK_EQ(REGKEY(pBackend).Search(rOptions, [](const REGSEARCHMATCH&) { return REG_VISIT_CONTINUE; }), REG_KEY_NOT_OPENED);
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	TestFind();
+	TestPattern();
+	TestSearch(&rBackend);
+	return REG_TEST_RESULT();
+}
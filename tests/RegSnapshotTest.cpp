@@ -0,0 +1,164 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include "RegSnapshot.h"
+
+// One reported difference
+struct DIFF {
+	REGDIFFTYPE eType;
+	std::string cPath;
+	std::string cName;
+	BOOL bOld;
+	BOOL bNew;
+};
+
+static std::vector<DIFF> Diff(const REGSNAPSHOT& rOld, const REGSNAPSHOT& rNew, REGVISIT eOnKey, size_t ulStopAfter) {
+	std::vector<DIFF> vRes;
+	REG_CHECK_EQ(DiffSnapshots(rOld, rNew, [&](const REGDIFFENTRY& rDiff) {
+		vRes.push_back({ rDiff.eType, std::string(rDiff.vPath), std::string(rDiff.vName), rDiff.pOld != nullptr, rDiff.pNew != nullptr });
+		if (vRes.size() == ulStopAfter) return REG_VISIT_STOP;
+		if (rDiff.eType == REG_DIFF_KEY_ADDED || rDiff.eType == REG_DIFF_KEY_REMOVED) return eOnKey;
+		return REG_VISIT_CONTINUE;
+	}), REG_SUCCESS);
+	return vRes;
+}
+
+static BOOL IsDiff(const std::vector<DIFF>& vDiffs, size_t ulIndex, REGDIFFTYPE eType, LPCSTR lpPath, LPCSTR lpName) {
+	if (ulIndex >= vDiffs.size()) return FALSE;
+	const DIFF& d = vDiffs[ulIndex];
+	BOOL bKey = (eType == REG_DIFF_KEY_ADDED || eType == REG_DIFF_KEY_REMOVED);
+	BOOL bOld = !bKey && eType != REG_DIFF_VALUE_ADDED;
+	BOOL bNew = !bKey && eType != REG_DIFF_VALUE_REMOVED;
+	return d.eType == eType && d.cPath == lpPath && d.cName == lpName && d.bOld == bOld && d.bNew == bNew;
+}
+
+// Keys are sorted by path and values by name (case-insensitive)
+static void TestCapture(REGMEMORYBACKEND* pBackend, REGSNAPSHOT* pOut) {
+	REGKEY rRoot(pBackend);
+	REGKEY rSub(pBackend);
+	REGKEY rDeep(pBackend);
+	REG_CHECK_EQ(rRoot.Create(HKEY_CURRENT_USER, "Software\\Snap", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rSub.Create(HKEY_CURRENT_USER, "Software\\Snap\\Sub", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rDeep.Create(HKEY_CURRENT_USER, "Software\\Snap\\Sub\\Deep", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.WriteREGDWORD("b", 1), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.WriteREGSZ("Gone", "g"), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.WriteREGSZ("A", "x"), REG_SUCCESS);
+	REG_CHECK_EQ(rSub.WriteREGDWORD("V", 2), REG_SUCCESS);
+	REG_CHECK_EQ(rDeep.WriteREGSZ("W", "w"), REG_SUCCESS);
+
+	REG_CHECK_EQ(REGSNAPSHOT::Capture(rRoot, pOut), REG_SUCCESS);
+	REG_CHECK_EQ(pOut->GetKeyCount(), 3);
+	REG_CHECK_EQ(pOut->GetValueCount(), 5);
+	REG_CHECK(pOut->GetKeyPath(0) == "");
+	REG_CHECK(pOut->GetKeyPath(1) == "Sub");
+	REG_CHECK(pOut->GetKeyPath(2) == "Sub\\Deep");
+	REG_CHECK_EQ(pOut->GetKeyValueCount(0), 3);
+	REG_CHECK(pOut->GetValue(0, 0).vName == "A");
+	REG_CHECK(pOut->GetValue(0, 1).vName == "b");
+	REG_CHECK(pOut->GetValue(0, 2).vName == "Gone");
+	REG_CHECK(pOut->GetValue(0, 3).vName.empty());
+	DWORD dwKey = 0;
+	REG_CHECK(pOut->FindKey("sub\\DEEP", &dwKey) && dwKey == 2);
+	REG_CHECK(!pOut->FindKey("Sub\\Missing", &dwKey));
+	REGSNAPVALUE vValue;
+	REG_CHECK(pOut->FindValue(0, "B", &vValue) && vValue.dwType == REG_DWORD && vValue.dwSize == sizeof(DWORD));
+	REG_CHECK(vValue.dwSize == sizeof(DWORD) && *reinterpret_cast<const DWORD*>(vValue.lpData) == 1);
+	REG_CHECK(pOut->FindValue(2, "w", &vValue) && vValue.dwType == REG_SZ);
+	REG_CHECK(!pOut->FindValue(1, "W", &vValue));
+	REG_CHECK(pOut->GetMemoryUsage() > sizeof(REGSNAPSHOT));
+
+	// Nothing changed
+	REGSNAPSHOT sSame;
+	REG_CHECK_EQ(REGSNAPSHOT::Capture(rRoot, &sSame), REG_SUCCESS);
+	REG_CHECK(Diff(*pOut, sSame, REG_VISIT_CONTINUE, 0).empty());
+}
+
+// Differences are reported in key path order, the values of an added or removed key after the key
+static void TestDiff(REGMEMORYBACKEND* pBackend, const REGSNAPSHOT& rOld) {
+	REGKEY rRoot(pBackend);
+	REGKEY rAdd(pBackend);
+	REGKEY rDeep(pBackend);
+	REG_CHECK_EQ(rRoot.Open(HKEY_CURRENT_USER, "Software\\Snap", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.WriteREGDWORD("A", 5), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.WriteREGDWORD("B", 7), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.DeleteValue("Gone"), REG_SUCCESS);
+	REG_CHECK_EQ(rRoot.WriteREGSZ("New", "n"), REG_SUCCESS);
+	REG_CHECK_EQ(rAdd.Create(HKEY_CURRENT_USER, "Software\\Snap\\Add", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rAdd.WriteREGDWORD("Y", 2), REG_SUCCESS);
+	REG_CHECK_EQ(rAdd.WriteREGDWORD("X", 1), REG_SUCCESS);
+	REG_CHECK_EQ(rDeep.Open(HKEY_CURRENT_USER, "Software\\Snap\\Sub\\Deep", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rDeep.DeleteTree(), REG_SUCCESS);
+
+	REGSNAPSHOT sNew;
+	REG_CHECK_EQ(REGSNAPSHOT::Capture(rRoot, &sNew), REG_SUCCESS);
+	std::vector<DIFF> vDiffs = Diff(rOld, sNew, REG_VISIT_CONTINUE, 0);
+	REG_CHECK_EQ(vDiffs.size(), 9);
+	REG_CHECK(IsDiff(vDiffs, 0, REG_DIFF_VALUE_CHANGED, "", "A"));
+	REG_CHECK(IsDiff(vDiffs, 1, REG_DIFF_VALUE_CHANGED, "", "b"));
+	REG_CHECK(IsDiff(vDiffs, 2, REG_DIFF_VALUE_REMOVED, "", "Gone"));
+	REG_CHECK(IsDiff(vDiffs, 3, REG_DIFF_VALUE_ADDED, "", "New"));
+	REG_CHECK(IsDiff(vDiffs, 4, REG_DIFF_KEY_ADDED, "Add", ""));
+	REG_CHECK(IsDiff(vDiffs, 5, REG_DIFF_VALUE_ADDED, "Add", "X"));
+	REG_CHECK(IsDiff(vDiffs, 6, REG_DIFF_VALUE_ADDED, "Add", "Y"));
+	REG_CHECK(IsDiff(vDiffs, 7, REG_DIFF_KEY_REMOVED, "Sub\\Deep", ""));
+	REG_CHECK(IsDiff(vDiffs, 8, REG_DIFF_VALUE_REMOVED, "Sub\\Deep", "W"));
+
+	// The old and new values are passed with a change
+	BOOL bSeen = FALSE;
+	DiffSnapshots(rOld, sNew, [&](const REGDIFFENTRY& rDiff) {
+		if (rDiff.eType != REG_DIFF_VALUE_CHANGED || rDiff.vName != "A") return REG_VISIT_CONTINUE;
+		bSeen = TRUE;
+		REG_CHECK(rDiff.pOld->dwType == REG_SZ && rDiff.pNew->dwType == REG_DWORD);
+		REG_CHECK(rDiff.pNew->dwSize == sizeof(DWORD) && *reinterpret_cast<const DWORD*>(rDiff.pNew->lpData) == 5);
+		return REG_VISIT_STOP;
+	});
+	REG_CHECK(bSeen);
+
+	// Skipping an added or removed key skips its values
+	vDiffs = Diff(rOld, sNew, REG_VISIT_SKIP, 0);
+	REG_CHECK_EQ(vDiffs.size(), 6);
+	REG_CHECK(IsDiff(vDiffs, 4, REG_DIFF_KEY_ADDED, "Add", ""));
+	REG_CHECK(IsDiff(vDiffs, 5, REG_DIFF_KEY_REMOVED, "Sub\\Deep", ""));
+
+	// Stopping ends the comparison
+	vDiffs = Diff(rOld, sNew, REG_VISIT_CONTINUE, 5);
+	REG_CHECK_EQ(vDiffs.size(), 5);
+	REG_CHECK(IsDiff(vDiffs, 4, REG_DIFF_KEY_ADDED, "Add", ""));
+
+	// Reversed, additions become removals
+	vDiffs = Diff(sNew, rOld, REG_VISIT_CONTINUE, 0);
+	REG_CHECK_EQ(vDiffs.size(), 9);
+	REG_CHECK(IsDiff(vDiffs, 2, REG_DIFF_VALUE_ADDED, "", "Gone"));
+	REG_CHECK(IsDiff(vDiffs, 4, REG_DIFF_KEY_REMOVED, "Add", ""));
+	REG_CHECK(IsDiff(vDiffs, 7, REG_DIFF_KEY_ADDED, "Sub\\Deep", ""));
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	REGSNAPSHOT sOld;
+	TestCapture(&rBackend, &sOld);
+	TestDiff(&rBackend, sOld);
+	return REG_TEST_RESULT();
+}
@@ -0,0 +1,48 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REGTEST_H
+#define REGTEST_H
+
+#include <windows.h>
+#include <cstdio>
+
+// Minimal test harness (one translation unit per test)
+// A failed check is printed and counted; main returns REG_TEST_RESULT().
+static INT iRegTestFailures = 0;
+
+#define REG_CHECK(e) do { \
+	if (!(e)) { \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #e); \
+		iRegTestFailures++; \
+	} \
+} while (0)
+#define REG_CHECK_EQ(a, b) do { \
+	long long llA = (long long)(a), llB = (long long)(b); \
+	if (llA != llB) { \
+		printf("%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, llA, llB); \
+		iRegTestFailures++; \
+	} \
+} while (0)
+#define REG_TEST_RESULT() (iRegTestFailures == 0 ? 0 : 1)
+
+#endif
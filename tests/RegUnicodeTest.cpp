@@ -0,0 +1,167 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegTest.h"
+#include "RegMemory.h"
+
+// Reference encoders over code points
+static void AppendUtf8(std::string* pOut, DWORD dwCode) {
+	if (dwCode < 0x80) pOut->push_back(static_cast<CHAR>(dwCode));
+	else if (dwCode < 0x800) {
+		pOut->push_back(static_cast<CHAR>(0xC0 | (dwCode >> 6)));
+		pOut->push_back(static_cast<CHAR>(0x80 | (dwCode & 0x3F)));
+	}
+	else if (dwCode < 0x10000) {
+		pOut->push_back(static_cast<CHAR>(0xE0 | (dwCode >> 12)));
+		pOut->push_back(static_cast<CHAR>(0x80 | ((dwCode >> 6) & 0x3F)));
+		pOut->push_back(static_cast<CHAR>(0x80 | (dwCode & 0x3F)));
+	}
+	else {
+		pOut->push_back(static_cast<CHAR>(0xF0 | (dwCode >> 18)));
+		pOut->push_back(static_cast<CHAR>(0x80 | ((dwCode >> 12) & 0x3F)));
+		pOut->push_back(static_cast<CHAR>(0x80 | ((dwCode >> 6) & 0x3F)));
+		pOut->push_back(static_cast<CHAR>(0x80 | (dwCode & 0x3F)));
+	}
+}
+static void AppendUtf16(std::wstring* pOut, DWORD dwCode) {
+	if (dwCode < 0x10000) pOut->push_back(static_cast<WCHAR>(dwCode));
+	else {
+		pOut->push_back(static_cast<WCHAR>(0xD800 | ((dwCode - 0x10000) >> 10)));
+		pOut->push_back(static_cast<WCHAR>(0xDC00 | ((dwCode - 0x10000) & 0x3FF)));
+	}
+}
+
+static std::wstring ToUtf16(const std::string& cIn) {
+	std::wstring cRes(cIn.size(), L'\0');
+	cRes.resize(Utf8ToUtf16(cIn.data(), cIn.size(), &cRes[0]));
+	return cRes;
+}
+static std::string ToUtf8(const std::wstring& cIn) {
+	std::string cRes(cIn.size() * 3, '\0');
+	cRes.resize(Utf16ToUtf8(cIn.data(), cIn.size(), &cRes[0]));
+	return cRes;
+}
+
+// ASCII runs of every length between characters of every size, so the vector loops stop at every position
+static void TestRoundTrip() {
+	static const DWORD dwCodes[] = { 0xE9, 0x7FF, 0x800, 0x4E2D, 0xFFFD, 0xFFFF, 0x10000, 0x1F600, 0x10FFFF };
+	std::string cUtf8;
+	std::wstring cUtf16;
+	for (DWORD dwRun = 0; dwRun < 40; dwRun++) {
+		for (DWORD i = 0; i < dwRun; i++) {
+			AppendUtf8(&cUtf8, 'a' + i % 26);
+			AppendUtf16(&cUtf16, 'a' + i % 26);
+		}
+		DWORD dwCode = dwCodes[dwRun % (sizeof(dwCodes) / sizeof(dwCodes[0]))];
+		AppendUtf8(&cUtf8, dwCode);
+		AppendUtf16(&cUtf16, dwCode);
+	}
+	BOOL bSame = TRUE;
+	for (size_t ulStart = 0; ulStart < cUtf8.size(); ulStart += 37) {
+		// Start and end only at character boundaries
+		while (ulStart < cUtf8.size() && (static_cast<BYTE>(cUtf8[ulStart]) & 0xC0) == 0x80) ulStart++;
+		std::string cPart = cUtf8.substr(ulStart);
+		std::wstring cWide = ToUtf16(cPart);
+		bSame = bSame && ToUtf8(cWide) == cPart;
+	}
+	REG_CHECK(bSame);
+	REG_CHECK(ToUtf16(cUtf8) == cUtf16);
+	REG_CHECK(ToUtf8(cUtf16) == cUtf8);
+	REG_CHECK(ToUtf16("").empty() && ToUtf8(L"").empty());
+}
+
+static void TestInvalid() {
+	std::wstring cFFFD(1, static_cast<WCHAR>(0xFFFD));
+	// Lone continuation byte, invalid lead bytes, overlong forms, surrogates, above U+10FFFF, truncated
+	REG_CHECK(ToUtf16("a\x80z") == L"a" + cFFFD + L"z");
+	REG_CHECK(ToUtf16("\xC0\x80") == cFFFD + cFFFD);
+	REG_CHECK(ToUtf16("\xE0\x80\x80z") == cFFFD + L"z");
+	REG_CHECK(ToUtf16("\xED\xA0\x80z") == cFFFD + L"z");
+	REG_CHECK(ToUtf16("\xF4\x90\x80\x80z") == cFFFD + L"z");
+	REG_CHECK(ToUtf16("\xF5z") == cFFFD + L"z");
+	REG_CHECK(ToUtf16("z\xE2\x82") == L"z" + cFFFD);
+	REG_CHECK(ToUtf16("\xE2\x82z") == cFFFD + L"z");
+
+	// Unpaired surrogates become U+FFFD
+	std::wstring cHigh(1, static_cast<WCHAR>(0xD800));
+	std::wstring cLow(1, static_cast<WCHAR>(0xDC00));
+	REG_CHECK(ToUtf8(L"a" + cHigh + L"z") == "a\xEF\xBF\xBDz");
+	REG_CHECK(ToUtf8(cLow + cHigh) == "\xEF\xBF\xBD\xEF\xBF\xBD");
+	REG_CHECK(ToUtf8(cHigh) == "\xEF\xBF\xBD");
+}
+
+// Keys opened by a UTF-8 path keep that path; values are read and written through the UTF-16 functions
+static void TestKey(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.CreateUTF8(HKEY_CURRENT_USER, "Software\\Caf\xC3\xA9\\Sub", KEY_ALL_ACCESS), REG_SUCCESS);
+	std::string cPath;
+	REG_CHECK_EQ(rKey.GetPathUTF8(&cPath), REG_SUCCESS);
+	REG_CHECK(cPath == "Software\\Caf\xC3\xA9\\Sub");
+	REGKEY rParent(pBackend);
+	REG_CHECK_EQ(rKey.GetParent(&rParent, KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rParent.GetPathUTF8(&cPath), REG_SUCCESS);
+	REG_CHECK(cPath == "Software\\Caf\xC3\xA9");
+
+	REG_CHECK_EQ(rKey.WriteREGSZUTF8("Name", "value"), REG_SUCCESS);
+	std::string cStr;
+	std::wstring cWide;
+	REG_CHECK_EQ(rKey.ReadREGSZUTF8("name", &cStr), REG_SUCCESS);
+	REG_CHECK(cStr == "value");
+	REG_CHECK_EQ(rKey.ReadREGSZ(std::wstring_view(L"Name"), &cWide), REG_SUCCESS);
+	REG_CHECK(cWide == L"value");
+	REG_CHECK_EQ(rKey.WriteREGSZ(std::wstring_view(L"Wide"), std::wstring_view(L"wide value")), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.ReadREGSZ("Wide", &cStr), REG_SUCCESS);
+	REG_CHECK(cStr == "wide value");
+	REG_CHECK_EQ(rKey.DeleteValueUTF8("Wide"), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.ReadREGSZUTF8("Wide", &cStr), REG_VALUE_NOT_EXIST);
+
+	// A failed read leaves a preset default untouched
+	std::wstring cWideDefault = L"default";
+	REG_CHECK_EQ(rKey.ReadREGSZ(std::wstring_view(L"Missing"), &cWideDefault), REG_VALUE_NOT_EXIST);
+	REG_CHECK(cWideDefault == L"default");
+	REG_CHECK_EQ(rKey.ReadREGEXPANDSZ(std::wstring_view(L"Name"), &cWideDefault), REG_INCORRECT_TYPE);
+	REG_CHECK(cWideDefault == L"default");
+	std::string cDefault = "default";
+	REG_CHECK_EQ(rKey.ReadREGSZUTF8("Missing", &cDefault), REG_VALUE_NOT_EXIST);
+	REG_CHECK(cDefault == "default");
+	REG_CHECK_EQ(rKey.ReadREGEXPANDSZUTF8("Name", &cDefault), REG_INCORRECT_TYPE);
+	REG_CHECK(cDefault == "default");
+	std::vector<BYTE> vDefault = { 1, 2, 3 };
+	DWORD dwType = REG_NONE;
+	REG_CHECK_EQ(rKey.ReadValueUTF8("Missing", &dwType, &vDefault), REG_VALUE_NOT_EXIST);
+	REG_CHECK(vDefault == std::vector<BYTE>({ 1, 2, 3 }) && dwType == REG_NONE);
+	REG_CHECK_EQ(rKey.ReadValue(std::wstring_view(L"Missing"), &dwType, &vDefault), REG_VALUE_NOT_EXIST);
+	REG_CHECK(vDefault == std::vector<BYTE>({ 1, 2, 3 }) && dwType == REG_NONE);
+	REG_CHECK_EQ(rKey.ReadREGSZ(std::wstring_view(L"Name"), &cWideDefault), REG_SUCCESS);
+	REG_CHECK(cWideDefault == L"value");
+
+	REG_CHECK_EQ(rKey.Close(), REG_SUCCESS);
+	REG_CHECK_EQ(rParent.DeleteTree(), REG_SUCCESS);
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	TestRoundTrip();
+	TestInvalid();
+	TestKey(&rBackend);
+	return REG_TEST_RESULT();
+}
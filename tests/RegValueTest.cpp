@@ -0,0 +1,222 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include "RegValue.h"
+
+enum COLOR { COLOR_RED, COLOR_GREEN, COLOR_BLUE };
+
+struct CONFIG {
+	std::string cName;
+	std::string cPath;
+	DWORD dwPort = 0;
+	QWORD ullSize = 0;
+	COLOR eColor = COLOR_RED;
+	bool bEnabled = false;
+	std::vector<std::string> vHosts;
+	std::vector<BYTE> vKey;
+	REGVALUE rExtra;
+};
+
+template <> struct REGSCHEMA<CONFIG> {
+	static constexpr auto rFields = std::make_tuple(
+		RegField("Name", &CONFIG::cName),
+		RegField("Path", &CONFIG::cPath, REG_EXPAND_SZ),
+		RegField("Port", &CONFIG::dwPort),
+		RegField("Size", &CONFIG::ullSize),
+		RegField("Color", &CONFIG::eColor),
+		RegField("Enabled", &CONFIG::bEnabled),
+		RegField("Hosts", &CONFIG::vHosts),
+		RegField("Key", &CONFIG::vKey),
+		RegField("Extra", &CONFIG::rExtra));
+};
+
+// Raw bytes bind to any type but the string types
+static_assert(REGVALUETRAITS<std::vector<BYTE>>::Accepts(REG_BINARY) && REGVALUETRAITS<std::vector<BYTE>>::Accepts(REG_NONE), "");
+static_assert(!REGVALUETRAITS<std::vector<BYTE>>::Accepts(REG_SZ) && !REGVALUETRAITS<std::vector<BYTE>>::Accepts(REG_EXPAND_SZ), "");
+static_assert(!REGVALUETRAITS<std::vector<BYTE>>::Accepts(REG_MULTI_SZ) && !REGVALUETRAITS<std::vector<BYTE>>::Accepts(REG_ANY_TYPE), "");
+
+static REGVALUE RoundTrip(const REGKEY& rKey, const REGVALUE& rValue) {
+	REGVALUE rRead;
+	REG_CHECK_EQ(WriteRegValue(rKey, "Value", rValue), REG_SUCCESS);
+	REG_CHECK_EQ(ReadRegValue(rKey, "Value", &rRead), REG_SUCCESS);
+	return rRead;
+}
+
+static void TestValue(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Value", KEY_ALL_ACCESS), REG_SUCCESS);
+
+	// Every type reads back as written
+	REGVALUE rValue;
+	rValue.SetSZ("text");
+	REG_CHECK(RoundTrip(rKey, rValue) == rValue);
+	rValue.SetEXPANDSZ("%TEMP%\\x");
+	REG_CHECK(RoundTrip(rKey, rValue) == rValue);
+	REG_CHECK_EQ(RoundTrip(rKey, rValue).GetType(), REG_EXPAND_SZ);
+	rValue.SetDWORD(0xDEADBEEF);
+	REG_CHECK(RoundTrip(rKey, rValue) == rValue);
+	rValue.SetQWORD(1ULL << 40);
+	REG_CHECK(RoundTrip(rKey, rValue) == rValue);
+	rValue.SetMULTISZ({ "a", "bb", "ccc" });
+	REG_CHECK(RoundTrip(rKey, rValue) == rValue);
+	const BYTE lpBytes[] = { 0x00, 0xFF, 0x10 };
+	rValue.SetBINARY(lpBytes, sizeof(lpBytes));
+	REG_CHECK(RoundTrip(rKey, rValue) == rValue);
+	REG_CHECK(*RoundTrip(rKey, rValue).GetIf<std::vector<BYTE>>() == std::vector<BYTE>({ 0x00, 0xFF, 0x10 }));
+	rValue.Clear();
+	REG_CHECK(RoundTrip(rKey, rValue) == rValue);
+	REG_CHECK(RoundTrip(rKey, rValue).GetIf<std::monostate>() != nullptr);
+
+	// The same type with the same data is equal, another type is not
+	REGVALUE rSz, rExpand;
+	rSz.SetSZ("same");
+	rExpand.SetEXPANDSZ("same");
+	REG_CHECK(rSz != rExpand);
+	REG_CHECK(rSz.GetIf<DWORD>() == nullptr);
+
+	// Integer data must have the size of the integer, and a failure leaves the value as it was
+	REG_CHECK_EQ(rValue.SetRaw(REG_DWORD, lpBytes, sizeof(lpBytes)), REG_INVAILD_VALUE);
+	REG_CHECK_EQ(rValue.SetRaw(REG_QWORD, lpBytes, sizeof(lpBytes)), REG_INVAILD_VALUE);
+	REG_CHECK_EQ(rValue.GetType(), REG_NONE);
+	REG_CHECK_EQ(rValue.SetRaw(REG_BINARY, nullptr, 1), REG_INVAILD_POINTER);
+	REG_CHECK_EQ(rKey.WriteValue("Bad", REG_DWORD, lpBytes, sizeof(lpBytes)), REG_SUCCESS);
+	REG_CHECK_EQ(ReadRegValue(rKey, "Bad", &rValue), REG_INVAILD_VALUE);
+	REG_CHECK_EQ(ReadRegValue(rKey, "None", &rValue), REG_VALUE_NOT_EXIST);
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+}
+
+static CONFIG MakeConfig() {
+	CONFIG rConfig;
+	rConfig.cName = "server";
+	rConfig.cPath = "%ProgramFiles%\\App";
+	rConfig.dwPort = 8080;
+	rConfig.ullSize = 5ULL << 33;
+	rConfig.eColor = COLOR_BLUE;
+	rConfig.bEnabled = true;
+	rConfig.vHosts = { "alpha", "beta" };
+	rConfig.vKey = { 1, 2, 3, 4 };
+	rConfig.rExtra.SetDWORD(7);
+	return rConfig;
+}
+
+static BOOL SameConfig(const CONFIG& rLeft, const CONFIG& rRight) {
+	return rLeft.cName == rRight.cName && rLeft.cPath == rRight.cPath && rLeft.dwPort == rRight.dwPort &&
+		rLeft.ullSize == rRight.ullSize && rLeft.eColor == rRight.eColor && rLeft.bEnabled == rRight.bEnabled &&
+		rLeft.vHosts == rRight.vHosts && rLeft.vKey == rRight.vKey && rLeft.rExtra == rRight.rExtra;
+}
+
+static void TestSchema(REGMEMORYBACKEND* pBackend) {
+	// Stored in one batch, the key is created
+	CONFIG rConfig = MakeConfig();
+	REG_CHECK_EQ(StoreRegStruct(HKEY_CURRENT_USER, "Software\\Schema", rConfig, pBackend), REG_SUCCESS);
+	REGKEY rKey(pBackend);
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\Schema", KEY_ALL_ACCESS), REG_SUCCESS);
+
+	// Every field is written with its registry type
+	DWORD dwType = REG_NONE;
+	std::vector<BYTE> vData;
+	REG_CHECK_EQ(rKey.ReadValue("Path", &dwType, &vData), REG_SUCCESS);
+	REG_CHECK_EQ(dwType, REG_EXPAND_SZ);
+	REG_CHECK_EQ(rKey.ReadValue("Size", &dwType, &vData), REG_SUCCESS);
+	REG_CHECK_EQ(dwType, REG_QWORD);
+	REG_CHECK_EQ(rKey.ReadValue("Enabled", &dwType, &vData), REG_SUCCESS);
+	REG_CHECK_EQ(dwType, REG_DWORD);
+	REG_CHECK_EQ(rKey.ReadValue("Key", &dwType, &vData), REG_SUCCESS);
+	REG_CHECK_EQ(dwType, REG_BINARY);
+
+	// And loaded back
+	CONFIG rLoaded;
+	std::vector<BYTE> vBuffer;
+	HRESULT lpResults[9] = {};
+	REG_CHECK_EQ(LoadRegStruct(rKey, &rLoaded, &vBuffer, lpResults), REG_SUCCESS);
+	REG_CHECK(SameConfig(rLoaded, rConfig));
+	for (HRESULT hRes : lpResults) REG_CHECK_EQ(hRes, REG_SUCCESS);
+
+	// A value of another type fails its field only, a missing value keeps the default
+	REG_CHECK_EQ(rKey.WriteREGSZ("Port", "8080"), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("Hosts", 1), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.DeleteValue("Name"), REG_SUCCESS);
+	CONFIG rPartial;
+	rPartial.cName = "default";
+	rPartial.dwPort = 1;
+	REG_CHECK_EQ(LoadRegStruct(rKey, &rPartial, &vBuffer, lpResults), REG_INCORRECT_TYPE);
+	REG_CHECK_EQ(lpResults[0], REG_VALUE_NOT_EXIST);
+	REG_CHECK_EQ(lpResults[2], REG_INCORRECT_TYPE);
+	REG_CHECK_EQ(lpResults[6], REG_INCORRECT_TYPE);
+	REG_CHECK_EQ(lpResults[3], REG_SUCCESS);
+	REG_CHECK(rPartial.cName == "default" && rPartial.dwPort == 1 && rPartial.vHosts.empty());
+	REG_CHECK(rPartial.cPath == rConfig.cPath && rPartial.ullSize == rConfig.ullSize && rPartial.vKey == rConfig.vKey);
+
+	// An integer of the wrong size is rejected
+	const BYTE lpShort[] = { 1, 2 };
+	REG_CHECK_EQ(rKey.WriteValue("Size", REG_QWORD, lpShort, sizeof(lpShort)), REG_SUCCESS);
+	REG_CHECK_EQ(LoadRegStruct(rKey, &rPartial, &vBuffer, lpResults), REG_INCORRECT_TYPE);
+	REG_CHECK_EQ(lpResults[3], REG_INVAILD_VALUE);
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+	REG_CHECK_EQ(LoadRegStruct(REGKEY(pBackend), &rPartial), REG_KEY_NOT_OPENED);
+}
+
+static void TestBatch(REGMEMORYBACKEND* pBackend) {
+	// Two structs recorded in one batch, rewrites of a value coalesce
+	REGWRITEBATCH rBatch;
+	CONFIG rFirst = MakeConfig(), rSecond = MakeConfig();
+	rSecond.cName = "second";
+	rSecond.rExtra.Clear();
+	REG_CHECK_EQ(StoreRegStruct(&rBatch, HKEY_CURRENT_USER, "Software\\Batch\\A", rFirst), REG_SUCCESS);
+	REG_CHECK_EQ(StoreRegStruct(&rBatch, HKEY_CURRENT_USER, "Software\\Batch\\B", rSecond), REG_SUCCESS);
+	REG_CHECK_EQ(rBatch.GetCount(), 9 + 8);
+	rFirst.dwPort = 9090;
+	REG_CHECK_EQ(StoreRegStruct(&rBatch, HKEY_CURRENT_USER, "Software\\Batch\\A", rFirst), REG_SUCCESS);
+	REG_CHECK_EQ(rBatch.GetCount(), 9 + 8);
+	REG_CHECK_EQ(StoreRegStruct(&rBatch, HKEY_CURRENT_USER, nullptr, rFirst), REG_INVAILD_POINTER);
+
+	// Nothing is written before the batch is applied
+	REGKEY rKey(pBackend);
+	DWORD dwType = REG_NONE;
+	std::vector<BYTE> vData;
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\Batch\\A", KEY_READ), REG_PATH_NOT_EXIST);
+	REG_CHECK_EQ(rBatch.Apply(pBackend, TRUE), REG_SUCCESS);
+
+	CONFIG rLoaded;
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\Batch\\A", KEY_READ), REG_SUCCESS);
+	REG_CHECK_EQ(LoadRegStruct(rKey, &rLoaded), REG_SUCCESS);
+	REG_CHECK(SameConfig(rLoaded, rFirst));
+	// The empty REGVALUE field was not written
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\Batch\\B", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.ReadValue("Extra", &dwType, &vData), REG_VALUE_NOT_EXIST);
+	rLoaded = CONFIG();
+	REG_CHECK_EQ(LoadRegStruct(rKey, &rLoaded), REG_SUCCESS);
+	REG_CHECK(SameConfig(rLoaded, rSecond));
+	REG_CHECK_EQ(rKey.Open(HKEY_CURRENT_USER, "Software\\Batch", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	TestValue(&rBackend);
+	TestSchema(&rBackend);
+	TestBatch(&rBackend);
+	return REG_TEST_RESULT();
+}
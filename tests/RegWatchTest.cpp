@@ -0,0 +1,223 @@
+// MIT License
+//
+// Copyright (c) 2025 RegKey - xmc0211 <xmc0211@qq.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RegTest.h"
+#include "RegMemory.h"
+#include "RegWatch.h"
+
+// Subscriber keeping every delivered diff
+class RECORDER : public REGWATCHSUBSCRIBER {
+public:
+	std::vector<std::vector<REGVALUECHANGE>> vDiffs;
+
+	void OnValuesChanged(HKEY hRoot, LPCSTR lpPath, const std::vector<REGVALUECHANGE>& vChanges) override {
+		vDiffs.push_back(vChanges);
+	}
+};
+
+static BOOL IsChange(const REGVALUECHANGE& rChange, REGCHANGETYPE eType, LPCSTR lpPath, LPCSTR lpName, DWORD dwType) {
+	return rChange.eType == eType && rChange.cPath == lpPath && rChange.cName == lpName && rChange.dwType == dwType;
+}
+
+// Notifications within the delay are merged, and one diff of all the value changes below the key is delivered
+static void TestSubtree(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REGKEY rSub(pBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Watch", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rSub.Create(HKEY_CURRENT_USER, "Software\\Watch\\Sub", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("A", 1), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGSZ("Same", "x"), REG_SUCCESS);
+	REG_CHECK_EQ(rSub.WriteREGSZ("B", "x"), REG_SUCCESS);
+
+	REGSIMNOTIFYSOURCE rSource;
+	RECORDER rRecorder;
+	REGWATCHER rWatcher(pBackend, &rSource, 0, FALSE);
+	DWORD dwId = 0;
+	REG_CHECK_EQ(rWatcher.Subscribe(HKEY_CURRENT_USER, "Software\\Watch", TRUE, &rRecorder, &dwId), REG_SUCCESS);
+	REG_CHECK_EQ(rSource.GetWatchCount(), 1);
+
+	REG_CHECK_EQ(rKey.WriteREGSZ("A", "now a string"), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("C", 3), REG_SUCCESS);
+	REG_CHECK_EQ(rSub.DeleteValue("B"), REG_SUCCESS);
+	REGKEY rOther(pBackend);
+	REG_CHECK_EQ(rOther.Create(HKEY_CURRENT_USER, "Software\\Watch\\Sub2", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rOther.WriteREGQWORD("D", 4), REG_SUCCESS);
+	rSource.Notify(HKEY_CURRENT_USER, "Software\\Watch");
+	rSource.Notify(HKEY_CURRENT_USER, "Software\\Watch\\Sub");
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 1);
+	REG_CHECK_EQ(rRecorder.vDiffs.size(), 1);
+	if (rRecorder.vDiffs.size() == 1) {
+		// Ordered by folded path, then by folded name
+		const std::vector<REGVALUECHANGE>& vDiff = rRecorder.vDiffs[0];
+		REG_CHECK_EQ(vDiff.size(), 4);
+		REG_CHECK(vDiff.size() == 4 && IsChange(vDiff[0], REG_CHANGE_CHANGED, "", "A", REG_SZ));
+		REG_CHECK(vDiff.size() == 4 && IsChange(vDiff[1], REG_CHANGE_ADDED, "", "C", REG_DWORD));
+		REG_CHECK(vDiff.size() == 4 && IsChange(vDiff[2], REG_CHANGE_REMOVED, "Sub", "B", REG_SZ));
+		REG_CHECK(vDiff.size() == 4 && IsChange(vDiff[3], REG_CHANGE_ADDED, "Sub2", "D", REG_QWORD));
+	}
+	REGWATCHSTATS sStats = rWatcher.GetStats();
+	REG_CHECK_EQ(sStats.ullNotifications, 2);
+	REG_CHECK_EQ(sStats.ullCoalesced, 1);
+	REG_CHECK_EQ(sStats.ullScans, 1);
+	REG_CHECK_EQ(sStats.ullDeliveries, 1);
+
+	// A notification without a change delivers nothing
+	rSource.Notify(HKEY_CURRENT_USER, "Software\\Watch");
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 0);
+	// Data changes of the same type are reported
+	REG_CHECK_EQ(rKey.WriteREGDWORD("C", 5), REG_SUCCESS);
+	rSource.Notify(HKEY_CURRENT_USER, "Software\\Watch");
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 1);
+	REG_CHECK(rRecorder.vDiffs.size() == 2 && rRecorder.vDiffs[1].size() == 1 && IsChange(rRecorder.vDiffs[1][0], REG_CHANGE_CHANGED, "", "C", REG_DWORD));
+
+	// Nothing is delivered after Unsubscribe
+	rWatcher.Unsubscribe(dwId);
+	REG_CHECK_EQ(rSource.GetWatchCount(), 0);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("C", 6), REG_SUCCESS);
+	rSource.Notify(HKEY_CURRENT_USER, "Software\\Watch");
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 0);
+	REG_CHECK_EQ(rRecorder.vDiffs.size(), 2);
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+}
+
+// A key watch sees only its own values, and pending notifications wait for their delay
+static void TestKey(REGMEMORYBACKEND* pBackend) {
+	REGKEY rKey(pBackend);
+	REGKEY rSub(pBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Watch", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rSub.Create(HKEY_CURRENT_USER, "Software\\Watch\\Sub", KEY_ALL_ACCESS), REG_SUCCESS);
+
+	REGSIMNOTIFYSOURCE rSource;
+	RECORDER rRecorder;
+	REGWATCHER rWatcher(pBackend, &rSource, 60000, FALSE);
+	DWORD dwId = 0;
+	REG_CHECK_EQ(rWatcher.Subscribe(HKEY_CURRENT_USER, "SOFTWARE\\watch", FALSE, &rRecorder, &dwId), REG_SUCCESS);
+
+	REG_CHECK_EQ(rSub.WriteREGDWORD("Below", 1), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("Own", 1), REG_SUCCESS);
+	rSource.Notify(HKEY_CURRENT_USER, "Software\\Watch");
+	REG_CHECK_EQ(rWatcher.ProcessPending(FALSE), 0);
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 1);
+	REG_CHECK(rRecorder.vDiffs.size() == 1 && rRecorder.vDiffs[0].size() == 1 && IsChange(rRecorder.vDiffs[0][0], REG_CHANGE_ADDED, "", "Own", REG_DWORD));
+
+	// The deleted key has no values left
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+	rSource.Notify(HKEY_CURRENT_USER, "Software\\Watch");
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 1);
+	REG_CHECK(rRecorder.vDiffs.size() == 2 && rRecorder.vDiffs[1].size() == 1 && IsChange(rRecorder.vDiffs[1][0], REG_CHANGE_REMOVED, "", "Own", REG_DWORD));
+}
+
+// Memory backend whose keys cannot be opened while bFail is set
+class FAILINGBACKEND : public REGMEMORYBACKEND {
+public:
+	BOOL bFail = FALSE;
+
+	LSTATUS OpenKey(HKEY hParent, LPCSTR lpPath, REGSAM ulSam, BOOL bCreate, HKEY* phOutKey) override {
+		if (bFail) return ERROR_ACCESS_DENIED;
+		return REGMEMORYBACKEND::OpenKey(hParent, lpPath, ulSam, bCreate, phOutKey);
+	}
+};
+
+// A notification whose scan failed stays pending
+static void TestRetry() {
+	FAILINGBACKEND rBackend;
+	REGKEY rKey(&rBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Retry", KEY_ALL_ACCESS), REG_SUCCESS);
+	REGSIMNOTIFYSOURCE rSource;
+	RECORDER rRecorder;
+	REGWATCHER rWatcher(&rBackend, &rSource, 0, FALSE);
+	DWORD dwId = 0;
+	REG_CHECK_EQ(rWatcher.Subscribe(HKEY_CURRENT_USER, "Software\\Retry", FALSE, &rRecorder, &dwId), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("A", 1), REG_SUCCESS);
+	rSource.Notify(HKEY_CURRENT_USER, "Software\\Retry");
+	rBackend.bFail = TRUE;
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 0);
+	rBackend.bFail = FALSE;
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 1);
+	REG_CHECK(rRecorder.vDiffs.size() == 1 && rRecorder.vDiffs[0].size() == 1 && IsChange(rRecorder.vDiffs[0][0], REG_CHANGE_ADDED, "", "A", REG_DWORD));
+}
+
+// Simulated source that, like the registry, cannot watch a missing key and loses the watch of a deleted key
+class ARMINGSOURCE : public REGSIMNOTIFYSOURCE {
+public:
+	REGBACKEND* pBackend = nullptr;
+	INT iArms = 0;
+
+	HRESULT Watch(HKEY hRoot, LPCSTR lpPath, BOOL bSubtree, REGNOTIFYSINK* pSink) override {
+		REGKEY rKey(pBackend);
+		HRESULT hRes = rKey.Open(hRoot, lpPath, KEY_READ);
+		if (hRes != REG_SUCCESS) return hRes;
+		iArms++;
+		return REGSIMNOTIFYSOURCE::Watch(hRoot, lpPath, bSubtree, pSink);
+	}
+	// The key was deleted: report it and drop the watch
+	void Delete(HKEY hRoot, LPCSTR lpPath, REGNOTIFYSINK* pSink) {
+		Notify(hRoot, lpPath);
+		Unwatch(hRoot, lpPath, FALSE, pSink);
+	}
+};
+
+// A key deleted and created again is watched again
+static void TestRecreate() {
+	REGMEMORYBACKEND rBackend;
+	REGKEY rKey(&rBackend);
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Again", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("A", 1), REG_SUCCESS);
+	ARMINGSOURCE rSource;
+	rSource.pBackend = &rBackend;
+	RECORDER rRecorder;
+	REGWATCHER rWatcher(&rBackend, &rSource, 0, FALSE);
+	DWORD dwId = 0;
+	REG_CHECK_EQ(rWatcher.Subscribe(HKEY_CURRENT_USER, "Software\\Again", FALSE, &rRecorder, &dwId), REG_SUCCESS);
+
+	REG_CHECK_EQ(rKey.DeleteTree(), REG_SUCCESS);
+	rSource.Delete(HKEY_CURRENT_USER, "Software\\Again", &rWatcher);
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 1);
+	REG_CHECK(rRecorder.vDiffs.size() == 1 && rRecorder.vDiffs[0].size() == 1 && IsChange(rRecorder.vDiffs[0][0], REG_CHANGE_REMOVED, "", "A", REG_DWORD));
+	REG_CHECK_EQ(rSource.GetWatchCount(), 0);
+
+	// The watch is armed again by the retry once the key exists
+	REG_CHECK_EQ(rKey.Create(HKEY_CURRENT_USER, "Software\\Again", KEY_ALL_ACCESS), REG_SUCCESS);
+	REG_CHECK_EQ(rKey.WriteREGDWORD("B", 2), REG_SUCCESS);
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 1);
+	REG_CHECK_EQ(rSource.GetWatchCount(), 1);
+	REG_CHECK(rRecorder.vDiffs.size() == 2 && rRecorder.vDiffs[1].size() == 1 && IsChange(rRecorder.vDiffs[1][0], REG_CHANGE_ADDED, "", "B", REG_DWORD));
+
+	// A later change is delivered again
+	REG_CHECK_EQ(rKey.WriteREGDWORD("C", 3), REG_SUCCESS);
+	rSource.Notify(HKEY_CURRENT_USER, "Software\\Again");
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 1);
+	REG_CHECK(rRecorder.vDiffs.size() == 3 && rRecorder.vDiffs[2].size() == 1 && IsChange(rRecorder.vDiffs[2][0], REG_CHANGE_ADDED, "", "C", REG_DWORD));
+	REG_CHECK_EQ(rWatcher.ProcessPending(TRUE), 0);
+
+	rWatcher.Unsubscribe(dwId);
+	REG_CHECK_EQ(rSource.GetWatchCount(), 0);
+}
+
+int main() {
+	REGMEMORYBACKEND rBackend;
+	TestSubtree(&rBackend);
+	TestKey(&rBackend);
+	TestRetry();
+	TestRecreate();
+	return REG_TEST_RESULT();
+}